@@ -0,0 +1,179 @@
+/**
+ * @file vivid_hal.cpp
+ * @brief OpenCV HAL entry points: argument checks, row splitting and dispatch
+ *
+ * Each entry point takes the cases our operators hit and returns
+ * CV_HAL_ERROR_NOT_IMPLEMENTED for everything else, so OpenCV runs its own
+ * implementation. The kernels live in vivid_hal.simd.hpp; this file builds
+ * the baseline variant and picks the widest one CMake built
+ * (VIVID_OPENCV_HAL_AVX2, VIVID_OPENCV_HAL_AVX512_SKX) that the CPU runs.
+ */
+
+#define VIVID_HAL_NAMESPACE cpu_baseline
+#define VIVID_HAL_ISA "baseline"
+#include "vivid_hal.simd.hpp"
+
+#include "vivid_hal.hpp"
+#include <opencv2/core/hal/interface.h>
+#include <cmath>
+
+namespace vivid_hal {
+
+#ifdef VIVID_OPENCV_HAL_AVX2
+namespace opt_AVX2 {
+const Kernels& kernels();
+}
+#endif
+#ifdef VIVID_OPENCV_HAL_AVX512_SKX
+namespace opt_AVX512_SKX {
+const Kernels& kernels();
+}
+#endif
+
+namespace {
+
+constexpr int kInterArea = 3;        // cv::INTER_AREA
+constexpr int kBorderReplicate = 1;  // cv::BORDER_REPLICATE
+constexpr int kBorderIsolated = 16;  // cv::BORDER_ISOLATED
+constexpr int kThreshTozeroInv = 4;  // cv::THRESH_TOZERO_INV, the last simple type
+
+// Same choice as the addon's kernels (src/kernels.cpp)
+const Kernels& selectKernels() {
+#ifdef VIVID_OPENCV_HAL_AVX512_SKX
+    if (cv::checkHardwareSupport(CV_CPU_AVX512_SKX)) {
+        return opt_AVX512_SKX::kernels();
+    }
+#endif
+#ifdef VIVID_OPENCV_HAL_AVX2
+    if (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3)) {
+        return opt_AVX2::kernels();
+    }
+#endif
+    return cpu_baseline::kernels();
+}
+
+const Kernels& active() {
+    static const Kernels& kernels = selectKernels();
+    return kernels;
+}
+
+// Split rows over OpenCV's parallel_for_ (the addon's pool); small images run inline
+template<class Body>
+void forRows(int height, int64_t pixels, Body body) {
+    if (pixels < (1 << 16)) {
+        body(0, height);
+        return;
+    }
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        body(rows.start, rows.end);
+    });
+}
+
+} // namespace
+
+const char* isa() {
+    return active().isa;
+}
+
+int cvtBGRtoGray(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+                 int width, int height, int depth, int scn, bool swapBlue) {
+    if (depth != CV_8U || (scn != 3 && scn != 4)) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    auto gray = active().gray;
+    forRows(height, static_cast<int64_t>(width) * height, [&](int begin, int end) {
+        gray(src_data, src_step, dst_data, dst_step, width, begin, end, scn, swapBlue);
+    });
+    return CV_HAL_ERROR_OK;
+}
+
+int cvtHSVtoBGR(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+                int width, int height, int depth, int dcn, bool swapBlue, bool isFullRange,
+                bool isHSV) {
+    // The same hook serves HLS -> BGR, which we don't implement
+    if (!isHSV || depth != CV_8U || (dcn != 3 && dcn != 4)) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    const float hscale = 6.0f / (isFullRange ? 256.0f : 180.0f);
+    auto hsvToBgr = active().hsvToBgr;
+    forRows(height, static_cast<int64_t>(width) * height, [&](int begin, int end) {
+        hsvToBgr(src_data, src_step, dst_data, dst_step, width, begin, end, dcn, swapBlue, hscale);
+    });
+    return CV_HAL_ERROR_OK;
+}
+
+int resize(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height,
+           uchar* dst_data, size_t dst_step, int dst_width, int dst_height,
+           double inv_scale_x, double inv_scale_y, int interpolation) {
+    // Only exact integer INTER_AREA downscales, which are plain box averages
+    if (interpolation != kInterArea || CV_MAT_DEPTH(src_type) != CV_8U ||
+        dst_width <= 0 || dst_height <= 0) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    const int cn = CV_MAT_CN(src_type);
+    const int fx = src_width / dst_width;
+    const int fy = src_height / dst_height;
+    if ((cn != 1 && cn != 4) || fx * dst_width != src_width || fy * dst_height != src_height ||
+        fx > 256 || fy > 256 || (fx == 1 && fy == 1) ||
+        std::abs(1.0 / inv_scale_x - fx) >= DBL_EPSILON ||
+        std::abs(1.0 / inv_scale_y - fy) >= DBL_EPSILON) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    auto areaDown = active().areaDown;
+    forRows(dst_height, static_cast<int64_t>(src_width) * src_height, [&](int begin, int end) {
+        areaDown(src_data, src_step, dst_data, dst_step, dst_width, begin, end, cn, fx, fy);
+    });
+    return CV_HAL_ERROR_OK;
+}
+
+int threshold(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+              int width, int height, int depth, int cn, double thresh, double maxValue,
+              int thresholdType) {
+    if (depth != CV_8U || thresholdType < 0 || thresholdType > kThreshTozeroInv) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    // OpenCV floors the threshold for 8-bit and special-cases the ends itself
+    const int ithresh = cvFloor(thresh);
+    if (ithresh < 0 || ithresh >= 255) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    // Called per stripe from OpenCV's own parallel loop: no further splitting
+    active().threshold(src_data, src_step, dst_data, dst_step, width * cn, 0, height,
+                       static_cast<uchar>(ithresh), cv::saturate_cast<uchar>(maxValue),
+                       thresholdType);
+    return CV_HAL_ERROR_OK;
+}
+
+int sobel(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+          int width, int height, int src_depth, int dst_depth, int cn,
+          int margin_left, int margin_top, int margin_right, int margin_bottom,
+          int dx, int dy, int ksize, double scale, double delta, int border_type) {
+    // The gradients Canny asks for: 3x3, 8-bit in, 16-bit out, replicated border
+    bool gradient = (dx == 1 && dy == 0) || (dx == 0 && dy == 1);
+    if (src_depth != CV_8U || dst_depth != CV_16S || cn != 1 || ksize != 3 || !gradient ||
+        scale != 1.0 || delta != 0.0 || (border_type & ~kBorderIsolated) != kBorderReplicate) {
+        return CV_HAL_ERROR_NOT_IMPLEMENTED;
+    }
+    if (border_type & kBorderIsolated) {
+        margin_left = margin_top = margin_right = margin_bottom = 0;
+    }
+    auto sobel3 = active().sobel3;
+    short* dst = reinterpret_cast<short*>(dst_data);
+    forRows(height, static_cast<int64_t>(width) * height, [&](int begin, int end) {
+        sobel3(src_data, src_step, dst, dst_step, width, height, begin, end, dx == 1,
+               margin_left, margin_top, margin_right, margin_bottom);
+    });
+    return CV_HAL_ERROR_OK;
+}
+
+int magnitude32f(const float* x, const float* y, float* dst, int len) {
+    active().magnitude(x, y, dst, len);
+    return CV_HAL_ERROR_OK;
+}
+
+int fastAtan32f(const float* y, const float* x, float* dst, int len, bool angleInDegrees) {
+    active().fastAtan(y, x, dst, len, angleInDegrees);
+    return CV_HAL_ERROR_OK;
+}
+
+} // namespace vivid_hal
@@ -0,0 +1,81 @@
+/**
+ * @file vivid_hal.hpp
+ * @brief vivid-opencv's custom OpenCV HAL (hardware acceleration layer)
+ *
+ * OpenCV includes this header from its generated custom_hal.hpp when it is
+ * configured with OpenCV_HAL=vivid_opencv_hal (see the top-level
+ * CMakeLists.txt). The macros below redirect OpenCV's HAL hooks for the
+ * calls our operators spend their time in to the kernels in this
+ * directory, so every existing cvtColor, resize, threshold, Canny and
+ * cartToPolar call picks them up without changes to the operators.
+ *
+ * Each function returns CV_HAL_ERROR_NOT_IMPLEMENTED for the cases it does
+ * not cover and OpenCV falls back to its own code:
+ * - cvtBGRtoGray: 8-bit, 3 or 4 channels (bit-exact with OpenCV)
+ * - cvtHSVtoBGR: 8-bit HSV (not HLS), to 3 or 4 channels
+ * - resize: 8-bit 1 or 4 channels, INTER_AREA by exact integer factors
+ * - threshold: 8-bit, the five simple types
+ * - sobel: 3x3 first derivatives, 8-bit to 16-bit, replicated border (Canny's gradients)
+ * - magnitude32f, fastAtan32f: cartToPolar's inner loops
+ */
+
+#ifndef VIVID_OPENCV_HAL_HPP
+#define VIVID_OPENCV_HAL_HPP
+
+#include <opencv2/core/hal/interface.h>
+#include <cstddef>
+
+namespace vivid_hal {
+
+/// Kernel variant in use: "baseline", "AVX2" or "AVX512_SKX"
+const char* isa();
+
+int cvtBGRtoGray(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+                 int width, int height, int depth, int scn, bool swapBlue);
+
+int cvtHSVtoBGR(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+                int width, int height, int depth, int dcn, bool swapBlue, bool isFullRange,
+                bool isHSV);
+
+int resize(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height,
+           uchar* dst_data, size_t dst_step, int dst_width, int dst_height,
+           double inv_scale_x, double inv_scale_y, int interpolation);
+
+int threshold(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+              int width, int height, int depth, int cn, double thresh, double maxValue,
+              int thresholdType);
+
+int sobel(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
+          int width, int height, int src_depth, int dst_depth, int cn,
+          int margin_left, int margin_top, int margin_right, int margin_bottom,
+          int dx, int dy, int ksize, double scale, double delta, int border_type);
+
+int magnitude32f(const float* x, const float* y, float* dst, int len);
+
+int fastAtan32f(const float* y, const float* x, float* dst, int len, bool angleInDegrees);
+
+} // namespace vivid_hal
+
+#endif // VIVID_OPENCV_HAL_HPP
+
+// Outside the include guard: core and imgproc each define their defaults
+// right before including custom_hal.hpp, so override whichever is current.
+#ifdef OPENCV_CORE_HAL_REPLACEMENT_HPP
+#undef cv_hal_magnitude32f
+#define cv_hal_magnitude32f vivid_hal::magnitude32f
+#undef cv_hal_fastAtan32f
+#define cv_hal_fastAtan32f vivid_hal::fastAtan32f
+#endif
+
+#ifdef OPENCV_IMGPROC_HAL_REPLACEMENT_HPP
+#undef cv_hal_cvtBGRtoGray
+#define cv_hal_cvtBGRtoGray vivid_hal::cvtBGRtoGray
+#undef cv_hal_cvtHSVtoBGR
+#define cv_hal_cvtHSVtoBGR vivid_hal::cvtHSVtoBGR
+#undef cv_hal_resize
+#define cv_hal_resize vivid_hal::resize
+#undef cv_hal_threshold
+#define cv_hal_threshold vivid_hal::threshold
+#undef cv_hal_sobel
+#define cv_hal_sobel vivid_hal::sobel
+#endif
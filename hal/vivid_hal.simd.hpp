@@ -0,0 +1,577 @@
+/**
+ * @file vivid_hal.simd.hpp
+ * @brief HAL kernel bodies compiled once per instruction set
+ *
+ * Included once by vivid_hal.cpp for the baseline build, and by
+ * vivid_hal_avx2.cpp and vivid_hal_avx512.cpp, which CMake compiles with
+ * wider instruction sets (see vivid_opencv_simd_variants in the top-level
+ * CMakeLists.txt). The includer names the variant's namespace and ISA
+ * first. Kernels work on a range of rows; vivid_hal.cpp checks the
+ * arguments, splits the rows and picks the variant.
+ *
+ * Every variant emits its own copy of any inline function or template with
+ * external linkage it uses, and the linker keeps just one of them, maybe
+ * the AVX-512 one. So the kernels only call the helpers in their anonymous
+ * namespace, OpenCV's intrinsics (always inlined: the variant objects are
+ * compiled optimized, and the simd_symbols tests check) and C functions:
+ * no std::min, cv::saturate_cast, std::vector and the like.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <math.h>
+
+#if !defined(VIVID_HAL_NAMESPACE) || !defined(VIVID_HAL_ISA)
+#error "Define VIVID_HAL_NAMESPACE and VIVID_HAL_ISA before including vivid_hal.simd.hpp"
+#endif
+
+namespace vivid_hal {
+
+/// The kernels of one variant
+struct Kernels {
+    const char* isa;
+
+    /// 8-bit BGR(A)/RGB(A) -> gray for rows [rowBegin, rowEnd), bit-exact with cvtColor
+    void (*gray)(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                 int width, int rowBegin, int rowEnd, int scn, bool swapBlue);
+
+    /// 8-bit HSV -> BGR(A)/RGB(A); `hscale` is 6 / hue range
+    void (*hsvToBgr)(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                     int width, int rowBegin, int rowEnd, int dcn, bool swapBlue, float hscale);
+
+    /// 8-bit box downscale by integer factors (INTER_AREA), `cn` interleaved channels
+    void (*areaDown)(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                     int dstWidth, int rowBegin, int rowEnd, int cn, int fx, int fy);
+
+    /// 8-bit threshold of `width` bytes per row; `type` is THRESH_BINARY..THRESH_TOZERO_INV
+    void (*threshold)(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                      int width, int rowBegin, int rowEnd, uchar thresh, uchar maxval, int type);
+
+    /// 3x3 Sobel, 8-bit -> 16-bit, first derivative in x (dx) or y, replicated border.
+    /// Rows and columns outside the image but inside the margins are read, as cv::Sobel does.
+    void (*sobel3)(const uchar* src, size_t srcStep, short* dst, size_t dstStep,
+                   int width, int height, int rowBegin, int rowEnd, bool dx,
+                   int marginLeft, int marginTop, int marginRight, int marginBottom);
+
+    void (*magnitude)(const float* x, const float* y, float* mag, int len);
+
+    /// Same polynomial as cv::fastAtan2 (about 0.3 degree accuracy)
+    void (*fastAtan)(const float* y, const float* x, float* angle, int len, bool degrees);
+};
+
+namespace VIVID_HAL_NAMESPACE {
+
+namespace {
+
+// cvtColor's fixed-point luma weights: Y = (1868 B + 9617 G + 4899 R + 2^13) >> 14
+constexpr int kB2Y = 1868;
+constexpr int kG2Y = 9617;
+constexpr int kR2Y = 4899;
+constexpr int kYShift = 14;
+
+// cv::fastAtan2's coefficients, in degrees
+constexpr float kAtanP1 = 0.9997878412794807f * 57.29577951308232f;
+constexpr float kAtanP3 = -0.3258083974640975f * 57.29577951308232f;
+constexpr float kAtanP5 = 0.1555786518463281f * 57.29577951308232f;
+constexpr float kAtanP7 = -0.04432655554792128f * 57.29577951308232f;
+
+// Local stand-ins for std::min / std::max and cv::saturate_cast<uchar>(float)
+inline int minOf(int a, int b) { return a < b ? a : b; }
+inline int maxOf(int a, int b) { return a > b ? a : b; }
+inline int clampTo(int v, int lo, int hi) { return minOf(maxOf(v, lo), hi); }
+inline uchar saturateU8(float v) { return static_cast<uchar>(clampTo(cvRound(v), 0, 255)); }
+
+// Per-thread scratch row for areaDownRows, grown on demand
+struct SumRow {
+    ushort* data = nullptr;
+    size_t size = 0;
+
+    ~SumRow() { delete[] data; }
+
+    ushort* reserve(size_t count) {
+        if (size < count) {
+            delete[] data;
+            data = new ushort[count];
+            size = count;
+        }
+        return data;
+    }
+};
+
+#if CV_SIMD
+// Weighted sum of three 16-bit channels in 32-bit lanes, descaled and narrowed
+inline cv::v_uint16 lumaOf(const cv::v_uint16& b, const cv::v_uint16& g, const cv::v_uint16& r,
+                           const cv::v_uint16& wb, const cv::v_uint16& wg, const cv::v_uint16& wr,
+                           const cv::v_uint32& bias) {
+    cv::v_uint32 b0, b1, g0, g1, r0, r1;
+    cv::v_mul_expand(b, wb, b0, b1);
+    cv::v_mul_expand(g, wg, g0, g1);
+    cv::v_mul_expand(r, wr, r0, r1);
+    cv::v_uint32 y0 = cv::v_shr<kYShift>(cv::v_add(cv::v_add(b0, g0), cv::v_add(r0, bias)));
+    cv::v_uint32 y1 = cv::v_shr<kYShift>(cv::v_add(cv::v_add(b1, g1), cv::v_add(r1, bias)));
+    return cv::v_pack(y0, y1);
+}
+
+// Widen 8-bit lanes to four float vectors (lane order preserved)
+inline void expandToFloat(const cv::v_uint8& v, cv::v_float32 out[4]) {
+    cv::v_uint16 w0, w1;
+    cv::v_expand(v, w0, w1);
+    cv::v_uint32 d0, d1, d2, d3;
+    cv::v_expand(w0, d0, d1);
+    cv::v_expand(w1, d2, d3);
+    out[0] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d0));
+    out[1] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d1));
+    out[2] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d2));
+    out[3] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d3));
+}
+
+// Round four float vectors (0-255) back to one 8-bit vector
+inline cv::v_uint8 packFloat(const cv::v_float32 in[4]) {
+    cv::v_int16 lo = cv::v_pack(cv::v_round(in[0]), cv::v_round(in[1]));
+    cv::v_int16 hi = cv::v_pack(cv::v_round(in[2]), cv::v_round(in[3]));
+    return cv::v_pack_u(lo, hi);
+}
+#endif
+
+// One HSV pixel as cvtColor computes it; s and v in 0-1, results in 0-1
+inline void hsvToBgrPixel(float h, float s, float v, float& b, float& g, float& r, float hscale) {
+    static const int kSectors[6][3] = {{1, 3, 0}, {1, 0, 2}, {3, 0, 1},
+                                       {0, 2, 1}, {0, 1, 3}, {2, 1, 0}};
+    h *= hscale;
+    float sectorF = floorf(h);
+    h -= sectorF;
+    int sector = static_cast<int>(sectorF) % 6;
+
+    float tab[4];
+    tab[0] = v;
+    tab[1] = v * (1.0f - s);
+    tab[2] = v * (1.0f - s * h);
+    tab[3] = v * (1.0f - s * (1.0f - h));
+    b = tab[kSectors[sector][0]];
+    g = tab[kSectors[sector][1]];
+    r = tab[kSectors[sector][2]];
+}
+
+void grayRows(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+              int width, int rowBegin, int rowEnd, int scn, bool swapBlue) {
+    const int cb = swapBlue ? kR2Y : kB2Y;
+    const int cr = swapBlue ? kB2Y : kR2Y;
+
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const cv::v_uint16 wb = cv::vx_setall_u16(static_cast<ushort>(cb));
+    const cv::v_uint16 wg = cv::vx_setall_u16(static_cast<ushort>(kG2Y));
+    const cv::v_uint16 wr = cv::vx_setall_u16(static_cast<ushort>(cr));
+    const cv::v_uint32 bias = cv::vx_setall_u32(1u << (kYShift - 1));
+#endif
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uchar* s = src + y * srcStep;
+        uchar* d = dst + y * dstStep;
+        int x = 0;
+
+#if CV_SIMD
+        for (; x <= width - lanes; x += lanes) {
+            cv::v_uint8 b, g, r, a;
+            if (scn == 4) {
+                cv::v_load_deinterleave(s + x * 4, b, g, r, a);
+            } else {
+                cv::v_load_deinterleave(s + x * 3, b, g, r);
+            }
+            cv::v_uint16 b0, b1, g0, g1, r0, r1;
+            cv::v_expand(b, b0, b1);
+            cv::v_expand(g, g0, g1);
+            cv::v_expand(r, r0, r1);
+            cv::v_store(d + x, cv::v_pack(lumaOf(b0, g0, r0, wb, wg, wr, bias),
+                                          lumaOf(b1, g1, r1, wb, wg, wr, bias)));
+        }
+#endif
+
+        for (; x < width; ++x) {
+            const uchar* p = s + x * scn;
+            d[x] = static_cast<uchar>((p[0] * cb + p[1] * kG2Y + p[2] * cr +
+                                       (1 << (kYShift - 1))) >> kYShift);
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void hsvToBgrRows(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                  int width, int rowBegin, int rowEnd, int dcn, bool swapBlue, float hscale) {
+    const int bIdx = swapBlue ? 2 : 0;
+
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const cv::v_float32 vScale = cv::vx_setall_f32(hscale);
+    const cv::v_float32 vNorm = cv::vx_setall_f32(1.0f / 255.0f);
+    const cv::v_float32 v255 = cv::vx_setall_f32(255.0f);
+    const cv::v_float32 one = cv::vx_setall_f32(1.0f);
+    const cv::v_float32 six = cv::vx_setall_f32(6.0f);
+    const cv::v_float32 sixth = cv::vx_setall_f32(1.0f / 6.0f);
+    const cv::v_uint8 alpha = cv::vx_setall_u8(255);
+#endif
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uchar* s = src + y * srcStep;
+        uchar* d = dst + y * dstStep;
+        int x = 0;
+
+#if CV_SIMD
+        for (; x <= width - lanes; x += lanes) {
+            cv::v_uint8 h8, s8, v8;
+            cv::v_load_deinterleave(s + x * 3, h8, s8, v8);
+            cv::v_float32 h[4], sat[4], val[4], b[4], g[4], r[4];
+            expandToFloat(h8, h);
+            expandToFloat(s8, sat);
+            expandToFloat(v8, val);
+
+            for (int i = 0; i < 4; ++i) {
+                cv::v_float32 hh = cv::v_mul(h[i], vScale);
+                cv::v_float32 sectorF = cv::v_cvt_f32(cv::v_floor(hh));
+                hh = cv::v_sub(hh, sectorF);
+                // sector mod 6, exact for the small integers involved
+                sectorF = cv::v_sub(sectorF, cv::v_mul(six, cv::v_cvt_f32(cv::v_floor(cv::v_mul(sectorF, sixth)))));
+
+                cv::v_float32 sv = cv::v_mul(sat[i], vNorm);
+                cv::v_float32 vv = cv::v_mul(val[i], vNorm);
+                cv::v_float32 t0 = vv;
+                cv::v_float32 t1 = cv::v_mul(vv, cv::v_sub(one, sv));
+                cv::v_float32 t2 = cv::v_mul(vv, cv::v_sub(one, cv::v_mul(sv, hh)));
+                cv::v_float32 t3 = cv::v_mul(vv, cv::v_sub(one, cv::v_mul(sv, cv::v_sub(one, hh))));
+
+                // Sector table {b, g, r}: 0:{1,3,0} 1:{1,0,2} 2:{3,0,1} 3:{0,2,1} 4:{0,1,3} 5:{2,1,0}
+                cv::v_float32 s0 = cv::v_eq(sectorF, cv::vx_setall_f32(0.0f));
+                cv::v_float32 s1 = cv::v_eq(sectorF, cv::vx_setall_f32(1.0f));
+                cv::v_float32 s2 = cv::v_eq(sectorF, cv::vx_setall_f32(2.0f));
+                cv::v_float32 s3 = cv::v_eq(sectorF, cv::vx_setall_f32(3.0f));
+                cv::v_float32 s4 = cv::v_eq(sectorF, cv::vx_setall_f32(4.0f));
+                b[i] = cv::v_select(s0, t1, cv::v_select(s1, t1, cv::v_select(s2, t3,
+                       cv::v_select(s3, t0, cv::v_select(s4, t0, t2)))));
+                g[i] = cv::v_select(s0, t3, cv::v_select(s1, t0, cv::v_select(s2, t0,
+                       cv::v_select(s3, t2, cv::v_select(s4, t1, t1)))));
+                r[i] = cv::v_select(s0, t0, cv::v_select(s1, t2, cv::v_select(s2, t1,
+                       cv::v_select(s3, t1, cv::v_select(s4, t3, t0)))));
+                b[i] = cv::v_mul(b[i], v255);
+                g[i] = cv::v_mul(g[i], v255);
+                r[i] = cv::v_mul(r[i], v255);
+            }
+
+            cv::v_uint8 c0 = packFloat(swapBlue ? r : b);
+            cv::v_uint8 c1 = packFloat(g);
+            cv::v_uint8 c2 = packFloat(swapBlue ? b : r);
+            if (dcn == 4) {
+                cv::v_store_interleave(d + x * 4, c0, c1, c2, alpha);
+            } else {
+                cv::v_store_interleave(d + x * 3, c0, c1, c2);
+            }
+        }
+#endif
+
+        for (; x < width; ++x) {
+            const uchar* p = s + x * 3;
+            float b, g, r;
+            hsvToBgrPixel(p[0], p[1] * (1.0f / 255.0f), p[2] * (1.0f / 255.0f), b, g, r, hscale);
+            uchar* q = d + x * dcn;
+            q[bIdx] = saturateU8(b * 255.0f);
+            q[1] = saturateU8(g * 255.0f);
+            q[bIdx ^ 2] = saturateU8(r * 255.0f);
+            if (dcn == 4) {
+                q[3] = 255;
+            }
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void areaDownRows(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                  int dstWidth, int rowBegin, int rowEnd, int cn, int fx, int fy) {
+    const int area = fx * fy;
+
+    // 2x2 on one channel: pairwise sums straight from two source rows
+    if (cn == 1 && fx == 2 && fy == 2) {
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            const uchar* s0 = src + (2 * y) * srcStep;
+            const uchar* s1 = s0 + srcStep;
+            uchar* d = dst + y * dstStep;
+            int x = 0;
+#if CV_SIMD
+            const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+            const cv::v_uint16 two = cv::vx_setall_u16(2);
+            for (; x <= dstWidth - lanes; x += lanes) {
+                cv::v_uint8 e0, o0, e1, o1;
+                cv::v_load_deinterleave(s0 + 2 * x, e0, o0);
+                cv::v_load_deinterleave(s1 + 2 * x, e1, o1);
+                cv::v_uint16 a0, a1, b0, b1, c0, c1, d0, d1;
+                cv::v_expand(e0, a0, a1);
+                cv::v_expand(o0, b0, b1);
+                cv::v_expand(e1, c0, c1);
+                cv::v_expand(o1, d0, d1);
+                cv::v_uint16 lo = cv::v_shr<2>(cv::v_add(cv::v_add(a0, b0), cv::v_add(cv::v_add(c0, d0), two)));
+                cv::v_uint16 hi = cv::v_shr<2>(cv::v_add(cv::v_add(a1, b1), cv::v_add(cv::v_add(c1, d1), two)));
+                cv::v_store(d + x, cv::v_pack(lo, hi));
+            }
+#endif
+            for (; x < dstWidth; ++x) {
+                int sum = s0[2 * x] + s0[2 * x + 1] + s1[2 * x] + s1[2 * x + 1];
+                d[x] = static_cast<uchar>((sum + 2) >> 2);
+            }
+        }
+#if CV_SIMD
+        cv::vx_cleanup();
+#endif
+        return;
+    }
+
+    // General factors: sum fy source rows into 16-bit columns (fy * 255 fits for
+    // fy <= 256), then each group of fx columns per channel
+    const int rowBytes = dstWidth * fx * cn;
+    const float scale = 1.0f / static_cast<float>(area);
+    thread_local SumRow sums;
+    ushort* const acc = sums.reserve(static_cast<size_t>(rowBytes));
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uchar* s = src + (y * fy) * srcStep;
+        int x = 0;
+#if CV_SIMD
+        const int lanes16 = cv::VTraits<cv::v_uint16>::vlanes();
+        for (; x <= rowBytes - lanes16; x += lanes16) {
+            cv::v_uint16 v = cv::vx_load_expand(s + x);
+            for (int k = 1; k < fy; ++k) {
+                v = cv::v_add(v, cv::vx_load_expand(s + k * srcStep + x));
+            }
+            cv::v_store(acc + x, v);
+        }
+#endif
+        for (; x < rowBytes; ++x) {
+            int v = 0;
+            for (int k = 0; k < fy; ++k) {
+                v += s[k * srcStep + x];
+            }
+            acc[x] = static_cast<ushort>(v);
+        }
+
+        uchar* d = dst + y * dstStep;
+        for (int dx = 0; dx < dstWidth; ++dx) {
+            const ushort* group = acc + dx * fx * cn;
+            for (int c = 0; c < cn; ++c) {
+                int sum = 0;
+                for (int k = 0; k < fx; ++k) {
+                    sum += group[k * cn + c];
+                }
+                // resize's 2x2 path rounds half up; other factors round half to even
+                d[dx * cn + c] = fx == 2 && fy == 2 ? static_cast<uchar>((sum + 2) >> 2)
+                                                 : saturateU8(sum * scale);
+            }
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void thresholdRows(const uchar* src, size_t srcStep, uchar* dst, size_t dstStep,
+                   int width, int rowBegin, int rowEnd, uchar thresh, uchar maxval, int type) {
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const cv::v_uint8 vThresh = cv::vx_setall_u8(thresh);
+    const cv::v_uint8 vMax = cv::vx_setall_u8(maxval);
+#endif
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uchar* s = src + y * srcStep;
+        uchar* d = dst + y * dstStep;
+        int x = 0;
+
+#if CV_SIMD
+        for (; x <= width - lanes; x += lanes) {
+            cv::v_uint8 v = cv::vx_load(s + x);
+            cv::v_uint8 above = cv::v_gt(v, vThresh);
+            cv::v_uint8 out;
+            switch (type) {
+                case 0: out = cv::v_and(above, vMax); break;               // BINARY
+                case 1: out = cv::v_and(cv::v_not(above), vMax); break;    // BINARY_INV
+                case 2: out = cv::v_min(v, vThresh); break;                // TRUNC
+                case 3: out = cv::v_and(above, v); break;                  // TOZERO
+                default: out = cv::v_and(cv::v_not(above), v); break;      // TOZERO_INV
+            }
+            cv::v_store(d + x, out);
+        }
+#endif
+
+        for (; x < width; ++x) {
+            uchar v = s[x];
+            bool above = v > thresh;
+            switch (type) {
+                case 0: d[x] = above ? maxval : 0; break;
+                case 1: d[x] = above ? 0 : maxval; break;
+                case 2: d[x] = above ? thresh : v; break;
+                case 3: d[x] = above ? v : 0; break;
+                default: d[x] = above ? 0 : v; break;
+            }
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void sobel3Rows(const uchar* src, size_t srcStep, short* dst, size_t dstStep,
+                int width, int height, int rowBegin, int rowEnd, bool dx,
+                int marginLeft, int marginTop, int marginRight, int marginBottom) {
+    // Replicate beyond the margins: clamp to the outermost readable row/column
+    auto rowAt = [&](int y) {
+        y = clampTo(y, -marginTop, height - 1 + marginBottom);
+        return src + static_cast<ptrdiff_t>(y) * static_cast<ptrdiff_t>(srcStep);
+    };
+    const int xMin = -marginLeft;
+    const int xMax = width - 1 + marginRight;
+    auto col = [&](int x) { return clampTo(x, xMin, xMax); };
+
+    // Columns whose neighbours x-1 and x+1 are both readable without clamping
+    const int xBegin = marginLeft > 0 ? 0 : 1;
+    const int xEnd = marginRight > 0 ? width : width - 1;
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uchar* r0 = rowAt(y - 1);
+        const uchar* r1 = rowAt(y);
+        const uchar* r2 = rowAt(y + 1);
+        short* d = reinterpret_cast<short*>(reinterpret_cast<uchar*>(dst) + y * dstStep);
+
+        auto scalar = [&](int x) {
+            int xl = col(x - 1);
+            int xr = col(x + 1);
+            int v = dx ? (r0[xr] - r0[xl]) + 2 * (r1[xr] - r1[xl]) + (r2[xr] - r2[xl])
+                       : (r2[xl] + 2 * r2[x] + r2[xr]) - (r0[xl] + 2 * r0[x] + r0[xr]);
+            d[x] = static_cast<short>(v);
+        };
+
+        int x = 0;
+        for (; x < minOf(xBegin, width); ++x) {
+            scalar(x);
+        }
+
+#if CV_SIMD
+        const int lanes = cv::VTraits<cv::v_int16>::vlanes();
+        for (; x <= xEnd - lanes; x += lanes) {
+            cv::v_int16 l0 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r0 + x - 1));
+            cv::v_int16 c0 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r0 + x));
+            cv::v_int16 h0 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r0 + x + 1));
+            cv::v_int16 l2 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r2 + x - 1));
+            cv::v_int16 c2 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r2 + x));
+            cv::v_int16 h2 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r2 + x + 1));
+            cv::v_int16 out;
+            if (dx) {
+                cv::v_int16 l1 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r1 + x - 1));
+                cv::v_int16 h1 = cv::v_reinterpret_as_s16(cv::vx_load_expand(r1 + x + 1));
+                cv::v_int16 d1 = cv::v_sub(h1, l1);
+                out = cv::v_add(cv::v_add(cv::v_sub(h0, l0), cv::v_sub(h2, l2)), cv::v_add(d1, d1));
+            } else {
+                cv::v_int16 top = cv::v_add(cv::v_add(l0, h0), cv::v_add(c0, c0));
+                cv::v_int16 bottom = cv::v_add(cv::v_add(l2, h2), cv::v_add(c2, c2));
+                out = cv::v_sub(bottom, top);
+            }
+            cv::v_store(d + x, out);
+        }
+#endif
+
+        for (; x < width; ++x) {
+            scalar(x);
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void magnitudeSpan(const float* x, const float* y, float* mag, int len) {
+    int i = 0;
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_float32>::vlanes();
+    for (; i <= len - lanes; i += lanes) {
+        cv::v_float32 vx = cv::vx_load(x + i);
+        cv::v_float32 vy = cv::vx_load(y + i);
+        cv::v_store(mag + i, cv::v_sqrt(cv::v_muladd(vx, vx, cv::v_mul(vy, vy))));
+    }
+    cv::vx_cleanup();
+#endif
+    for (; i < len; ++i) {
+        mag[i] = sqrtf(x[i] * x[i] + y[i] * y[i]);
+    }
+}
+
+void fastAtanSpan(const float* y, const float* x, float* angle, int len, bool degrees) {
+    const float scale = degrees ? 1.0f : static_cast<float>(CV_PI / 180.0);
+    const float eps = static_cast<float>(DBL_EPSILON);
+    int i = 0;
+
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_float32>::vlanes();
+    const cv::v_float32 vEps = cv::vx_setall_f32(eps);
+    const cv::v_float32 p1 = cv::vx_setall_f32(kAtanP1);
+    const cv::v_float32 p3 = cv::vx_setall_f32(kAtanP3);
+    const cv::v_float32 p5 = cv::vx_setall_f32(kAtanP5);
+    const cv::v_float32 p7 = cv::vx_setall_f32(kAtanP7);
+    const cv::v_float32 zero = cv::vx_setzero_f32();
+    const cv::v_float32 k90 = cv::vx_setall_f32(90.0f);
+    const cv::v_float32 k180 = cv::vx_setall_f32(180.0f);
+    const cv::v_float32 k360 = cv::vx_setall_f32(360.0f);
+    const cv::v_float32 vScale = cv::vx_setall_f32(scale);
+    for (; i <= len - lanes; i += lanes) {
+        cv::v_float32 vy = cv::vx_load(y + i);
+        cv::v_float32 vx = cv::vx_load(x + i);
+        cv::v_float32 ax = cv::v_abs(vx);
+        cv::v_float32 ay = cv::v_abs(vy);
+        cv::v_float32 xMajor = cv::v_ge(ax, ay);
+        cv::v_float32 c = cv::v_div(cv::v_min(ax, ay), cv::v_add(cv::v_max(ax, ay), vEps));
+        cv::v_float32 c2 = cv::v_mul(c, c);
+        cv::v_float32 a = cv::v_muladd(cv::v_muladd(cv::v_muladd(p7, c2, p5), c2, p3), c2, p1);
+        a = cv::v_mul(a, c);
+        a = cv::v_select(xMajor, a, cv::v_sub(k90, a));
+        a = cv::v_select(cv::v_lt(vx, zero), cv::v_sub(k180, a), a);
+        a = cv::v_select(cv::v_lt(vy, zero), cv::v_sub(k360, a), a);
+        cv::v_store(angle + i, cv::v_mul(a, vScale));
+    }
+    cv::vx_cleanup();
+#endif
+
+    for (; i < len; ++i) {
+        float ax = fabsf(x[i]);
+        float ay = fabsf(y[i]);
+        float a;
+        if (ax >= ay) {
+            float c = ay / (ax + eps);
+            float c2 = c * c;
+            a = (((kAtanP7 * c2 + kAtanP5) * c2 + kAtanP3) * c2 + kAtanP1) * c;
+        } else {
+            float c = ax / (ay + eps);
+            float c2 = c * c;
+            a = 90.0f - (((kAtanP7 * c2 + kAtanP5) * c2 + kAtanP3) * c2 + kAtanP1) * c;
+        }
+        if (x[i] < 0) {
+            a = 180.0f - a;
+        }
+        if (y[i] < 0) {
+            a = 360.0f - a;
+        }
+        angle[i] = a * scale;
+    }
+}
+
+} // namespace
+
+const Kernels& kernels() {
+    static const Kernels table{VIVID_HAL_ISA, grayRows, hsvToBgrRows, areaDownRows,
+                               thresholdRows, sobel3Rows, magnitudeSpan, fastAtanSpan};
+    return table;
+}
+
+} // namespace VIVID_HAL_NAMESPACE
+
+} // namespace vivid_hal
@@ -0,0 +1,13 @@
+/**
+ * @file vivid_hal_avx2.cpp
+ * @brief AVX2 build of the HAL kernels (see vivid_hal.simd.hpp)
+ */
+
+#define VIVID_HAL_NAMESPACE opt_AVX2
+#define VIVID_HAL_ISA "AVX2"
+#include "vivid_hal.simd.hpp"
+
+// Without 256-bit intrinsics this would silently be a second baseline
+#if !CV_SIMD256
+#error "vivid_hal_avx2.cpp needs 256-bit universal intrinsics; check vivid_opencv_simd_variants in CMakeLists.txt"
+#endif
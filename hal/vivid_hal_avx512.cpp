@@ -0,0 +1,13 @@
+/**
+ * @file vivid_hal_avx512.cpp
+ * @brief AVX-512 (Skylake-X subset) build of the HAL kernels (see vivid_hal.simd.hpp)
+ */
+
+#define VIVID_HAL_NAMESPACE opt_AVX512_SKX
+#define VIVID_HAL_ISA "AVX512_SKX"
+#include "vivid_hal.simd.hpp"
+
+// Without 512-bit intrinsics this would silently be a narrower variant
+#if !CV_SIMD512
+#error "vivid_hal_avx512.cpp needs 512-bit universal intrinsics; check vivid_opencv_simd_variants in CMakeLists.txt"
+#endif
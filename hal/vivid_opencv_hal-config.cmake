@@ -0,0 +1,12 @@
+# Found by OpenCV's configure through OpenCV_HAL=vivid_opencv_hal (see the
+# top-level CMakeLists.txt). OpenCV links OpenCV_HAL_LIBRARIES into
+# opencv_core and includes OpenCV_HAL_HEADERS from its custom_hal.hpp.
+
+if(NOT TARGET vivid_opencv_hal)
+    add_subdirectory("${CMAKE_CURRENT_LIST_DIR}" "${CMAKE_BINARY_DIR}/vivid-opencv-hal")
+endif()
+
+set(OpenCV_HAL_LIBRARIES vivid_opencv_hal)
+set(OpenCV_HAL_HEADERS vivid_hal.hpp)
+set(OpenCV_HAL_INCLUDE_DIRS "${CMAKE_CURRENT_LIST_DIR}")
+set(vivid_opencv_hal_VERSION ${vivid-opencv_VERSION})
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file alloc_stats.h
+ * @brief Heap allocations made by an operator's cooks
+ */
+
+#include <cstdint>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Allocation counters of one operator (see allocStats())
+ *
+ * Counts every cv::Mat buffer and internal scratch container allocated
+ * while the operator cooks, including on its background threads and on
+ * pool workers helping with its parallel loops. A cook's count covers
+ * everything since the previous cook, so background work lands on the
+ * cook that follows it. Temporaries made inside OpenCV calls count too,
+ * so in steady state lastCount is the same every frame rather than 0 for
+ * operators built on them; growth shows a leak or a missing reuse.
+ *
+ * Counting is compiled in unless the addon is built with
+ * VIVID_OPENCV_PROFILING=OFF, in which case every field stays 0.
+ */
+struct AllocStats {
+    uint64_t lastCount = 0;        ///< Allocations since the previous cook
+    uint64_t lastBytes = 0;        ///< Bytes allocated since the previous cook
+    uint64_t totalCount = 0;       ///< Allocations since the last reset
+    uint64_t totalBytes = 0;       ///< Bytes allocated since the last reset
+    uint64_t cooks = 0;            ///< Cooks since the last reset
+    uint64_t allocatingCooks = 0;  ///< Cooks with lastCount > 0
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @file async_stats.h
+ * @brief Counters for operators cooking on a background thread
+ */
+
+#include <cstdint>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Background cook counters (see the `async` param of the operators)
+ *
+ * A submitted frame is either completed or dropped: a frame still waiting
+ * when the next one arrives is replaced, so the worker always processes the
+ * newest frame and the render loop never waits.
+ */
+struct AsyncStats {
+    uint64_t submitted = 0;  ///< Frames handed to the worker
+    uint64_t completed = 0;  ///< Frames the worker finished
+    uint64_t dropped = 0;    ///< Frames replaced before the worker started them
+    int queueDepth = 0;      ///< Frames waiting or in progress right now (0-2)
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * @file blob_events.h
+ * @brief Lock-free blob tracking event queue
+ *
+ * BlobTrack publishes enter/move/leave events into a bounded ring buffer that
+ * other threads (OSC senders, audio callbacks) drain without locking or
+ * polling the operator.
+ */
+
+#include <vivid/opencv/export.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Kind of tracking event
+ */
+enum class BlobEventType : uint8_t {
+    Enter = 0,   ///< A new track was created
+    Move = 1,    ///< A track moved by at least BlobTrack::moveThreshold
+    Leave = 2    ///< A track was retired
+};
+
+/**
+ * @brief One tracking event
+ *
+ * Timestamps are seconds on std::chrono::steady_clock, so consumers can
+ * compare them with their own steady_clock readings.
+ */
+struct BlobEvent {
+    BlobEventType type = BlobEventType::Move;
+    int trackId = 0;         ///< TrackedBlob::id
+    float x = 0.0f;          ///< Center x in input pixels
+    float y = 0.0f;          ///< Center y in input pixels
+    float size = 0.0f;       ///< Blob diameter in pixels
+    double timestamp = 0.0;  ///< Capture time of the frame that produced the event
+    uint64_t frame = 0;      ///< Source frame id of that frame (FrameStamp::frameId)
+};
+
+/**
+ * @brief Bounded multi-producer/multi-consumer event ring
+ *
+ * Each slot carries a sequence number (Vyukov's bounded queue), so pushes and
+ * pops never take a lock and never block. With a single producer - one
+ * BlobTrack - a push completes in a bounded number of steps. A push into a
+ * full queue drops the event and increments overflowCount() instead of
+ * waiting for consumers.
+ *
+ * @par Example
+ * @code
+ * auto events = blobs.eventQueue();   // shared_ptr, safe to hand to another thread
+ * std::thread osc([events] {
+ *     BlobEvent e;
+ *     while (running) {
+ *         while (events->tryPop(e)) { send(e); }
+ *         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+ *     }
+ * });
+ * @endcode
+ */
+class VIVID_OPENCV_API BlobEventQueue {
+public:
+    /// @param capacity Slot count, rounded up to a power of two (minimum 2)
+    explicit BlobEventQueue(size_t capacity = 1024);
+    ~BlobEventQueue();
+
+    BlobEventQueue(const BlobEventQueue&) = delete;
+    BlobEventQueue& operator=(const BlobEventQueue&) = delete;
+
+    /**
+     * @brief Enqueue an event without blocking
+     * @return false if the queue was full (the event is counted as overflow)
+     */
+    bool tryPush(const BlobEvent& event);
+
+    /**
+     * @brief Dequeue the oldest event without blocking
+     * @return false if the queue was empty
+     */
+    bool tryPop(BlobEvent& event);
+
+    /**
+     * @brief Pop every currently queued event into a callback
+     * @return Number of events delivered
+     */
+    template<typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t count = 0;
+        BlobEvent event;
+        while (tryPop(event)) {
+            fn(event);
+            ++count;
+        }
+        return count;
+    }
+
+    /// @brief Events dropped because the queue was full
+    uint64_t overflowCount() const { return m_overflow.load(std::memory_order_relaxed); }
+
+    /// @brief Approximate number of queued events (exact when quiescent)
+    size_t sizeApprox() const;
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        BlobEvent event;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask = 0;
+
+    // Producer and consumer cursors live on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<size_t> m_dequeuePos{0};
+    alignas(64) std::atomic<uint64_t> m_overflow{0};
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,115 @@
+#pragma once
+
+/**
+ * @file blob_grid.h
+ * @brief Uniform-grid spatial index over tracked blobs
+ *
+ * Answers proximity queries ("which blobs are within R of this one",
+ * "which blob is under this point") in time proportional to the number of
+ * blobs near the query instead of the total blob count.
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/blob_types.h>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Cache-friendly uniform grid over blob centers
+ *
+ * build() bins blobs with a counting sort in O(n) and stores positions in
+ * cell order (structure of arrays), so each query scans contiguous memory.
+ * All results are indices into the blob vector passed to build() - for
+ * BlobTrack::grid() that is BlobTrack::blobs().
+ *
+ * Buffers are reused between builds; rebuilding every frame does not
+ * allocate once the blob count stabilizes.
+ */
+class VIVID_OPENCV_API BlobGrid {
+public:
+    /**
+     * @brief Rebuild the index
+     * @param blobs Blobs to index
+     * @param cellSize Grid cell edge in pixels; query radii close to this are cheapest.
+     *        The cell is enlarged automatically if the grid would get much
+     *        larger than the blob count.
+     */
+    void build(const std::vector<TrackedBlob>& blobs, float cellSize);
+
+    /// @brief Number of indexed blobs
+    size_t size() const { return m_index.size(); }
+
+    /**
+     * @brief Blobs whose centers lie within radius of (x, y)
+     * @param out Receives blob indices (cleared first, unordered)
+     */
+    void queryRadius(float x, float y, float radius, std::vector<int>& out) const;
+
+    /**
+     * @brief Blobs within radius of blob `index`, excluding itself
+     * @param out Receives blob indices (cleared first, unordered)
+     */
+    void neighbors(int index, float radius, std::vector<int>& out) const;
+
+    /**
+     * @brief Blob whose center is closest to (x, y)
+     * @return Blob index, or -1 if none lies within maxDistance
+     */
+    int nearest(float x, float y,
+                float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    /**
+     * @brief Blob whose disk (center, size/2) contains (x, y)
+     * @return Blob index with the closest center among those that contain
+     *         the point, or -1 if the point is not over any blob
+     */
+    int blobAt(float x, float y) const;
+
+    /**
+     * @brief All unordered pairs of blobs closer than radius
+     * @param out Receives (i, j) with i < j (cleared first)
+     */
+    void pairsWithin(float radius, std::vector<std::pair<int, int>>& out) const;
+
+    /**
+     * @brief Single-linkage clustering
+     *
+     * Blobs closer than linkDistance end up in the same cluster, transitively.
+     * @param labels Receives a cluster id per blob, numbered 0..count-1 in
+     *        order of each cluster's lowest blob index
+     * @return Number of clusters
+     */
+    int cluster(float linkDistance, std::vector<int>& labels) const;
+
+private:
+    template<typename Fn>
+    void forEachInBox(float minX, float minY, float maxX, float maxY, Fn&& fn) const;
+
+    int cellCoord(float v, float origin, int limit) const;
+
+    // Blob data in cell order
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_radius;
+    std::vector<int> m_index;       // Original blob index per slot
+
+    std::vector<int> m_cellStart;   // Slot range per cell (cols*rows + 1 entries)
+    std::vector<int> m_cellOf;      // Scratch: cell per input blob
+
+    // Scratch for cluster() (mutable: reused across const queries)
+    mutable std::vector<int> m_parent;
+    mutable std::vector<int> m_slotOf;
+
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    float m_cellSize = 1.0f;
+    float m_invCellSize = 1.0f;
+    int m_cols = 0;
+    int m_rows = 0;
+};
+
+} // namespace vivid::opencv
@@ -8,6 +8,13 @@
  */
 
 #include <vivid/opencv/export.h>
+#include <vivid/opencv/async_stats.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
+#include <vivid/opencv/blob_types.h>
+#include <vivid/opencv/blob_events.h>
+#include <vivid/opencv/blob_grid.h>
+#include <vivid/opencv/trajectory.h>
 #include <vivid/effects/texture_operator.h>
 #include <vivid/param.h>
 #include <vivid/operator_registry.h>
@@ -16,11 +23,73 @@
 
 namespace vivid::opencv {
 
+/**
+ * @brief What BlobTrack labels as blob pixels
+ */
+enum class BlobDetectMode : int {
+    Luma = 0,   ///< Grayscale brightness around `threshold` (bright and/or dark blobs)
+    Color = 1,  ///< Pixels inside the hue/saturation/value range
+    Foreground = 2  ///< Pixels that differ from a learned running background
+};
+
 /**
  * @brief Blob detection operator
  *
- * Detects blobs (circular regions) in the input image using OpenCV's SimpleBlobDetector.
+ * Detects blobs (circular regions) in the input image with a multi-threshold
+ * detector that follows OpenCV's SimpleBlobDetector semantics. The detector is
+ * persistent and reconfigured in place, so animating detection params costs the
+ * same as a static configuration.
  * Useful for tracking objects, detecting lights, or finding colored regions.
+ * Detections are associated frame-to-frame into tracks with stable ids.
+ *
+ * Track changes are published as BlobEvent records (enter/move/leave) into a
+ * lock-free BlobEventQueue, so other threads can react without touching the
+ * operator. A full queue drops events and counts them rather than blocking.
+ *
+ * Each track carries a smoothed velocity and acceleration estimated from
+ * capture timestamps. Positions are extrapolated to a presentation time
+ * (capture time + predictAhead, or setTargetTime()) to hide the lag between
+ * capture, cook and display; prediction accuracy is tracked per track and
+ * in aggregate.
+ *
+ * After tracking, a uniform-grid index over the blobs is rebuilt in linear
+ * time (grid()), answering radius, neighbor and nearest-point queries
+ * without O(n^2) scans. With clusterDistance > 0, blobs closer than that
+ * distance are grouped by single linkage (TrackedBlob::cluster).
+ *
+ * Every track keeps its last historyLength positions and capture times in a
+ * fixed-capacity ring buffer. All rings live in one arena allocated when
+ * historyLength changes, so tracking never allocates per frame;
+ * trajectoryAt() returns a zero-copy view. drawTrails renders the history
+ * as a fading polyline in the same pass as the markers.
+ *
+ * In Color mode the input is classified by a fused BGRA->HSV->mask SIMD kernel
+ * (no intermediate HSV image) and the mask feeds the same labeling stage.
+ * Hue is in degrees; a range with hueMin > hueMax wraps through 0, so reds
+ * can be selected with e.g. hueMin=340, hueMax=20.
+ *
+ * Foreground mode keeps a per-pixel running background (exponential moving
+ * mean and variance of luma, updated by a vectorized kernel) and labels only
+ * pixels that deviate from it by more than fgSigma standard deviations and
+ * fgMinDiff gray levels. Static clutter never reaches the labeling stage, so
+ * detection cost follows the moving content rather than the scene. Objects
+ * that stop moving fade into the background after roughly 1/bgLearnRate
+ * frames; resetBackground() relearns from the next frame.
+ *
+ * With sliceCount > 1 the full-frame scan is amortized: each cook scans one
+ * horizontal band (plus sliceOverlap rows of context) and a complete detection
+ * is published every sliceCount cooks. Existing tracks are refined from a
+ * small window around their predicted position on every cook, so per-cook
+ * cost stays bounded on large or cluttered frames. Each band's detections
+ * are matched against tracks back-projected to that band's capture time,
+ * so fast blobs keep their ids even though the bands are up to
+ * sliceCount-1 frames old.
+ *
+ * With async enabled, process() copies the input frame, hands it to a worker
+ * thread and returns immediately with the most recent completed result. The
+ * output and every accessor then describe that result (typically one frame
+ * behind); events are still published as the worker completes each frame.
+ * asyncStats() reports submitted, completed and dropped frames.
  *
  * @note Requires CPU pixel data from input via cpuPixelView().
  * Compatible sources: Webcam, VideoPlayer.
@@ -36,6 +105,29 @@ namespace vivid::opencv {
  * | detectBright | int | 0-1 | 1 | Detect bright blobs |
  * | detectDark | int | 0-1 | 1 | Detect dark blobs |
  * | threshold | float | 0-255 | 128 | Binarization threshold |
+ * | detectMode | int | 0-2 | 0 | 0=Luma, 1=Color (HSV range), 2=Foreground |
+ * | hueMin | float | 0-360 | 0 | Color mode: lower hue bound (degrees) |
+ * | hueMax | float | 0-360 | 30 | Color mode: upper hue bound (degrees) |
+ * | satMin | float | 0-255 | 80 | Color mode: minimum saturation |
+ * | satMax | float | 0-255 | 255 | Color mode: maximum saturation |
+ * | valMin | float | 0-255 | 80 | Color mode: minimum value |
+ * | valMax | float | 0-255 | 255 | Color mode: maximum value |
+ * | bgLearnRate | float | 0.0001-0.5 | 0.01 | Foreground mode: background adaptation per frame |
+ * | fgSigma | float | 1-10 | 2.5 | Foreground mode: deviation in standard deviations |
+ * | fgMinDiff | float | 0-255 | 15 | Foreground mode: minimum luma difference |
+ * | sliceCount | int | 1-16 | 1 | Row bands per full detection (1=whole frame every cook) |
+ * | sliceOverlap | int | 0-256 | 32 | Extra rows scanned above/below each band |
+ * | trackDistance | float | 1-500 | 50 | Max center distance for frame-to-frame matching |
+ * | trackPersistence | int | 0-60 | 5 | Detections a track may miss before removal |
+ * | moveThreshold | float | 0-100 | 1 | Min travel in pixels before a Move event is emitted |
+ * | predictAhead | float | 0-200 | 0 | Prediction lead in ms past the capture time |
+ * | predictSmoothing | float | 0-0.95 | 0.5 | Velocity/acceleration smoothing (0=raw) |
+ * | gridCellSize | float | 8-1024 | 64 | Spatial index cell size in pixels |
+ * | clusterDistance | float | 0-1000 | 0 | Single-linkage distance (0=clustering off) |
+ * | historyLength | int | 0-512 | 32 | Positions kept per track (0=no history) |
+ * | drawTrails | int | 0-1 | 0 | Draw each track's history as a trail |
+ * | async | int | 0-1 | 0 | Cook on a background thread (output lags one frame) |
+ * | threads | int | 0-64 | 0 | Max threads for this operator's cook (0 = whole pool) |
  *
  * @par Example
  * @code
@@ -59,6 +151,29 @@ public:
     Param<int> detectBright{"detectBright", 1, 0, 1};              ///< Detect bright blobs
     Param<int> detectDark{"detectDark", 1, 0, 1};                  ///< Detect dark blobs
     Param<float> threshold{"threshold", 128.0f, 0.0f, 255.0f};     ///< Binarization threshold
+    Param<int> detectMode{"detectMode", 0, 0, 2};                  ///< 0=Luma, 1=Color, 2=Foreground
+    Param<float> hueMin{"hueMin", 0.0f, 0.0f, 360.0f};             ///< Min hue (degrees)
+    Param<float> hueMax{"hueMax", 30.0f, 0.0f, 360.0f};            ///< Max hue (degrees)
+    Param<float> satMin{"satMin", 80.0f, 0.0f, 255.0f};            ///< Min saturation
+    Param<float> satMax{"satMax", 255.0f, 0.0f, 255.0f};           ///< Max saturation
+    Param<float> valMin{"valMin", 80.0f, 0.0f, 255.0f};            ///< Min value
+    Param<float> valMax{"valMax", 255.0f, 0.0f, 255.0f};           ///< Max value
+    Param<float> bgLearnRate{"bgLearnRate", 0.01f, 0.0001f, 0.5f};  ///< Background adaptation rate
+    Param<float> fgSigma{"fgSigma", 2.5f, 1.0f, 10.0f};            ///< Foreground deviation (stddevs)
+    Param<float> fgMinDiff{"fgMinDiff", 15.0f, 0.0f, 255.0f};      ///< Foreground luma floor
+    Param<int> sliceCount{"sliceCount", 1, 1, 16};                 ///< Row bands per full detection
+    Param<int> sliceOverlap{"sliceOverlap", 32, 0, 256};           ///< Band overlap in rows
+    Param<float> trackDistance{"trackDistance", 50.0f, 1.0f, 500.0f}; ///< Max match distance
+    Param<int> trackPersistence{"trackPersistence", 5, 0, 60};     ///< Missed detections before removal
+    Param<float> moveThreshold{"moveThreshold", 1.0f, 0.0f, 100.0f}; ///< Move event distance
+    Param<float> predictAhead{"predictAhead", 0.0f, 0.0f, 200.0f};  ///< Prediction lead (ms)
+    Param<float> predictSmoothing{"predictSmoothing", 0.5f, 0.0f, 0.95f}; ///< Motion smoothing
+    Param<float> gridCellSize{"gridCellSize", 64.0f, 8.0f, 1024.0f}; ///< Spatial index cell size
+    Param<float> clusterDistance{"clusterDistance", 0.0f, 0.0f, 1000.0f}; ///< Cluster link distance
+    Param<int> historyLength{"historyLength", 32, 0, 512};         ///< Positions kept per track
+    Param<int> drawTrails{"drawTrails", 0, 0, 1};                  ///< Draw track trails
+    Param<int> async{"async", 0, 0, 1};                            ///< Background cooking
+    Param<int> threads{"threads", 0, 0, 64};                       ///< Thread budget
 
     /// @}
     // -------------------------------------------------------------------------
@@ -81,6 +196,128 @@ public:
 
     /// @}
 
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /**
+     * @brief Get the blobs currently being tracked
+     * @return Tracks in creation order (includes briefly occluded tracks; see TrackedBlob::missed)
+     */
+    const std::vector<TrackedBlob>& blobs() const;
+
+    /**
+     * @brief Get the number of tracked blobs
+     * @return Track count
+     */
+    size_t blobCount() const;
+
+    /**
+     * @brief Get the queue that receives this operator's tracking events
+     *
+     * The shared_ptr may be copied to consumer threads; the queue outlives
+     * the operator as long as a copy is held.
+     */
+    std::shared_ptr<BlobEventQueue> eventQueue() const;
+
+    /**
+     * @brief Publish into a caller-provided queue (e.g. one shared by several
+     * BlobTrack operators). Passing nullptr disables event publishing.
+     */
+    void setEventQueue(std::shared_ptr<BlobEventQueue> queue);
+
+    /**
+     * @brief Set the capture time of the frame the next cook will see
+     *
+     * Seconds on std::chrono::steady_clock. Applies to the next cook only;
+     * without it the capture time of the input's FrameStamp is used
+     * (see frame_stamp.h).
+     */
+    void setCaptureTime(double seconds);
+
+    /**
+     * @brief Predict positions to an absolute presentation time
+     *
+     * Seconds on std::chrono::steady_clock. Applies to the next cook only
+     * and overrides predictAhead.
+     */
+    void setTargetTime(double seconds);
+
+    /**
+     * @brief Discard the learned background (Foreground mode)
+     *
+     * The next cook reinitializes the model from its frame, e.g. after the
+     * camera moved or the lighting changed.
+     */
+    void resetBackground();
+
+    /**
+     * @brief Aggregate prediction error across all tracks since the last cleanup
+     * @return Error statistics in pixels (see TrackedBlob::error for per-track values)
+     */
+    PredictionStats predictionError() const;
+
+    /**
+     * @brief Spatial index over blobs(), rebuilt every cook
+     *
+     * Query results are indices into blobs(). Valid until the next cook.
+     * @code
+     * std::vector<int> near;
+     * blobs.grid().queryRadius(x, y, 100.0f, near);
+     * int under = blobs.grid().blobAt(mouseX, mouseY);
+     * @endcode
+     */
+    const BlobGrid& grid() const;
+
+    /**
+     * @brief Number of clusters found this cook (0 when clustering is off)
+     */
+    int clusterCount() const;
+
+    /**
+     * @brief Position history of blobs()[index], oldest sample first
+     *
+     * Zero-copy view into the trajectory arena, valid until the next cook.
+     * Empty when historyLength is 0 or the arena's track capacity is exhausted.
+     */
+    TrajectoryView trajectoryAt(size_t index) const;
+
+    /**
+     * @brief Position history of the track with the given id
+     * @return Empty view if no such track exists
+     */
+    TrajectoryView trajectory(int trackId) const;
+
+    /// @brief Background cook counters (all zero unless `async` was enabled)
+    AsyncStats asyncStats() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: cvtColor, mask (color/foreground kernels),
+     * detect, track (association, refinement, prediction), index (grid,
+     * clustering, events), draw, assign, snapshot (async result copy),
+     * process, cookLatency and pipelineLatency (see frame_stamp.h).
+     * "process" is the whole process() call on the chain thread; the
+     * others are timed wherever they ran (worker threads with `async`).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers and internal scratch containers allocated
+     * for this operator on any thread; stageTimings() breaks them down by
+     * stage. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
 private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * @file blob_types.h
+ * @brief Plain data types published by BlobTrack
+ *
+ * These types carry no OpenCV or vivid dependencies so they can be shared
+ * with consumers that only need the tracking results.
+ */
+
+namespace vivid::opencv {
+
+/**
+ * @brief Accuracy of latency-compensated predictions
+ *
+ * Each published prediction is checked once a measurement at or after its
+ * target time arrives: the measured position is interpolated to the target
+ * time and compared with the prediction.
+ */
+struct PredictionStats {
+    float mean = 0.0f;   ///< Mean error in pixels
+    float rms = 0.0f;    ///< Root-mean-square error in pixels
+    float max = 0.0f;    ///< Largest error in pixels
+    int samples = 0;     ///< Predictions evaluated
+};
+
+/**
+ * @brief A blob tracked across frames
+ *
+ * Positions are in input pixel coordinates with the origin at the top-left.
+ * Velocities and accelerations are per second of capture time.
+ */
+struct TrackedBlob {
+    int id = 0;          ///< Stable track identifier (never reused)
+    float x = 0.0f;      ///< Center x in pixels
+    float y = 0.0f;      ///< Center y in pixels
+    float size = 0.0f;   ///< Blob diameter in pixels
+    int age = 0;         ///< Cooks since the track was created
+    int missed = 0;      ///< Consecutive cooks without a matching detection
+    int cluster = -1;    ///< Cluster id from BlobTrack clustering (-1 when disabled)
+
+    double timestamp = 0.0;   ///< Capture time of the last measurement (seconds)
+    float vx = 0.0f;          ///< Estimated velocity x (px/s)
+    float vy = 0.0f;          ///< Estimated velocity y (px/s)
+    float ax = 0.0f;          ///< Estimated acceleration x (px/s^2)
+    float ay = 0.0f;          ///< Estimated acceleration y (px/s^2)
+    float predictedX = 0.0f;  ///< Position extrapolated to the target time
+    float predictedY = 0.0f;  ///< Position extrapolated to the target time
+    PredictionStats error;    ///< How well past predictions matched
+};
+
+} // namespace vivid::opencv
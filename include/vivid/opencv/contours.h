@@ -9,6 +9,9 @@
  */
 
 #include <vivid/opencv/export.h>
+#include <vivid/opencv/async_stats.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
 #include <vivid/effects/texture_operator.h>
 #include <vivid/param.h>
 #include <vivid/operator_registry.h>
@@ -35,6 +38,10 @@ enum class ContourMode : int {
  * Applies Canny edge detection followed by OpenCV's findContours to detect
  * shapes in the input texture. Contours are drawn on a transparent background.
  *
+ * With async = 2 the luma, Canny, findContours and drawing stages run as a
+ * pipeline on four threads, so consecutive frames overlap. Throughput is
+ * bounded by the slowest stage; output lags the input by a few frames.
+ *
  * @note This operator requires CPU pixel data from the input operator via
  * cpuPixelView(). Compatible sources include Webcam and VideoPlayer.
  * Operators that only provide GPU textures will be skipped.
@@ -50,6 +57,8 @@ enum class ContourMode : int {
  * | colorG | float | 0-1 | 1 | Contour color green component |
  * | colorB | float | 0-1 | 0 | Contour color blue component |
  * | colorA | float | 0-1 | 1 | Contour color alpha component |
+ * | async | int | 0-2 | 0 | 0=inline, 1=background thread, 2=pipelined stages |
+ * | threads | int | 0-64 | 0 | Max threads for this operator's cook (0 = whole pool) |
  *
  * @par Example
  * @code
@@ -85,6 +94,8 @@ public:
     Param<float> colorG{"colorG", 1.0f, 0.0f, 1.0f};              ///< Color green
     Param<float> colorB{"colorB", 0.0f, 0.0f, 1.0f};              ///< Color blue
     Param<float> colorA{"colorA", 1.0f, 0.0f, 1.0f};              ///< Color alpha
+    Param<int> async{"async", 0, 0, 2};                            ///< Inline / background / pipelined
+    Param<int> threads{"threads", 0, 0, 64};                       ///< Thread budget
 
     /// @}
     // -------------------------------------------------------------------------
@@ -117,6 +128,33 @@ public:
      */
     size_t contourCount() const;
 
+    /// @brief Background cook counters for the active `async` mode
+    AsyncStats asyncStats() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: cvtColor, Canny, findContours, clear (output
+     * buffer reset), drawContours, process, cookLatency and
+     * pipelineLatency (see frame_stamp.h).
+     * "process" is the whole process() call on the chain thread; the
+     * others are timed wherever they ran (worker threads with `async`).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers and internal scratch containers allocated
+     * for this operator on any thread; stageTimings() breaks them down by
+     * stage. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
     /// @}
 
 private:
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file cpu_dispatch.h
+ * @brief Which instruction-set paths the addon and OpenCV are using
+ *
+ * On x86-64 the addon's SIMD kernels are built for the x86-64 baseline, for
+ * AVX2 and for AVX-512. The bundled OpenCV likewise builds its hot
+ * functions for several instruction sets. Both choose the widest path the
+ * CPU supports when the addon loads, so one release binary runs on older
+ * machines and still uses wide vectors on newer ones. The OpenCV HAL in hal/
+ * (cvtColor, resize, threshold, Sobel and cartToPolar) is built and chosen
+ * the same way. The choices are logged to stderr the first time an operator
+ * initializes.
+ *
+ * To narrow all of them, e.g. when comparing paths, set the OPENCV_CPU_DISABLE
+ * environment variable before starting, e.g. `OPENCV_CPU_DISABLE=AVX512_SKX,AVX2`.
+ *
+ * @par Example
+ * @code
+ * vivid::opencv::CpuDispatch info = vivid::opencv::cpuDispatch();
+ * std::printf("kernels: %s\n", info.kernels.c_str());
+ * @endcode
+ */
+
+#include <vivid/opencv/export.h>
+#include <string>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Instruction-set paths in use on this machine
+ */
+struct CpuDispatch {
+    std::string kernels;                ///< Addon kernel variant in use: "baseline", "AVX2" or "AVX512_SKX"
+    std::vector<std::string> variants;  ///< Kernel variants built into this binary, narrowest first
+    std::string opencv;                 ///< OpenCV's feature line: plain = baseline, `*` = dispatched,
+                                        ///< `?` = built but not supported by this CPU
+    std::string hal;                    ///< OpenCV HAL variant in use, empty if built with VIVID_OPENCV_HAL=OFF
+};
+
+/// Instruction-set paths the addon's kernels and OpenCV use on this CPU
+VIVID_OPENCV_API CpuDispatch cpuDispatch();
+
+} // namespace vivid::opencv
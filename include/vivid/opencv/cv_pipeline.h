@@ -0,0 +1,236 @@
+#pragma once
+
+/**
+ * @file cv_pipeline.h
+ * @brief Multi-stage OpenCV processing in a single operator
+ *
+ * Runs a sequence of image-processing stages inside one cook, keeping the
+ * single-channel intermediates in reused buffers instead of round-tripping
+ * through BGRA between operators.
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Kind of a CVPipeline stage
+ */
+enum class CVStageType : int {
+    Luma = 0,        ///< BGRA input -> 8-bit luma (implicit if the first stage is not Luma)
+    Blur = 1,        ///< Gaussian blur with an odd `size` kernel
+    Threshold = 2,   ///< Binary threshold at `threshold` (`invert` flips it)
+    Morphology = 3,  ///< `morphOp` with a `size` ellipse, `iterations` times
+    Canny = 4,       ///< Edges between `threshold` (low) and `threshold2` (high)
+    Contours = 5,    ///< Outlines of nonzero regions with area in [minArea, maxArea]; image passes through
+    Blobs = 6,       ///< Centroids of nonzero regions with area in [minArea, maxArea]; image passes through
+    Flow = 7         ///< Farneback flow against the previous cook at `scale`; image passes through
+};
+
+/**
+ * @brief Morphology operation for CVStageType::Morphology
+ */
+enum class CVMorphOp : int {
+    Open = 0,
+    Close = 1,
+    Erode = 2,
+    Dilate = 3
+};
+
+/**
+ * @brief One stage of a CVPipeline
+ *
+ * Only the fields relevant to `type` are read; the rest keep their defaults.
+ */
+struct CVStage {
+    CVStageType type = CVStageType::Luma;
+    int size = 5;                        ///< Blur/Morphology kernel size (forced odd)
+    float threshold = 128.0f;            ///< Threshold level / Canny low threshold
+    float threshold2 = 200.0f;           ///< Canny high threshold
+    bool invert = false;                 ///< Threshold: keep pixels below the level
+    CVMorphOp morphOp = CVMorphOp::Open; ///< Morphology operation
+    int iterations = 1;                  ///< Morphology repetitions
+    float minArea = 50.0f;               ///< Contours/Blobs: minimum area in pixels
+    float maxArea = 1.0e6f;              ///< Contours/Blobs: maximum area in pixels
+    float scale = 0.5f;                  ///< Flow: processing scale (0.1-1); 0.5, 0.25 and 0.125 straight after luma use the shared pyramid
+};
+
+/**
+ * @brief A blob center found by a Blobs stage
+ */
+struct CVPipelineBlob {
+    float x = 0.0f;     ///< Center x in input pixels
+    float y = 0.0f;     ///< Center y in input pixels
+    float size = 0.0f;  ///< Diameter in pixels
+};
+
+/**
+ * @brief Configurable OpenCV stage pipeline operator
+ *
+ * Runs a list of stages (luma, blur, threshold, morphology, Canny, contours,
+ * blobs, flow) in one process() call. Image stages ping-pong between two
+ * persistent single-channel buffers; analysis stages (Contours, Blobs,
+ * Flow) record their results and pass the image through unchanged. Only the
+ * final stage is rendered to the output:
+ * - image stages: the single-channel result as gray BGRA
+ * - Contours: contour outlines over the input
+ * - Blobs: circles over the input
+ * - Flow: HSV flow visualization (hue = direction, value = speed)
+ *
+ * Stage graphs can be loaded from JSON, either an array of stages or an
+ * object with a "stages" array. Each stage has a "type" (the CVStageType
+ * name in lower case) and optional fields named like CVStage's members;
+ * "morphOp" is one of "open", "close", "erode", "dilate".
+ *
+ * @code{.json}
+ * { "stages": [
+ *     { "type": "luma" },
+ *     { "type": "blur", "size": 5 },
+ *     { "type": "threshold", "threshold": 200 },
+ *     { "type": "morphology", "morphOp": "open", "size": 3 },
+ *     { "type": "blobs", "minArea": 80 }
+ * ] }
+ * @endcode
+ *
+ * @note Requires CPU pixel data from input via cpuPixelView().
+ * Compatible sources: Webcam, VideoPlayer.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | lineWidth | float | 1-10 | 2 | Outline/marker thickness for Contours and Blobs output |
+ * | sensitivity | float | 0.1-10 | 1 | Flow visualization brightness |
+ * | threads | int | 0-64 | 0 | Max threads for this operator's cook (0 = whole pool) |
+ *
+ * @par Example
+ * @code
+ * auto& pipe = chain.add<vivid::opencv::CVPipeline>("pipe");
+ * pipe.input("cam");
+ * pipe.loadStages("assets/markers.json");
+ *
+ * // in update():
+ * for (const auto& b : pipe.blobs()) { ... }
+ * @endcode
+ *
+ * @par Output
+ * CPU pixel buffer rendered from the final stage
+ */
+class VIVID_OPENCV_API CVPipeline : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<float> lineWidth{"lineWidth", 2.0f, 1.0f, 10.0f};       ///< Overlay thickness
+    Param<float> sensitivity{"sensitivity", 1.0f, 0.1f, 10.0f};   ///< Flow viz gain
+    Param<int> threads{"threads", 0, 0, 64};                      ///< Thread budget
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    CVPipeline();
+    ~CVPipeline() override;
+
+    // -------------------------------------------------------------------------
+    /// @name Stage Configuration
+    /// @{
+
+    /// @brief Replace the stage list
+    void setStages(const std::vector<CVStage>& stages);
+
+    /// @brief Append one stage
+    void addStage(const CVStage& stage);
+
+    /// @brief Current stage list
+    const std::vector<CVStage>& stages() const;
+
+    /**
+     * @brief Replace the stage list from a JSON string
+     * @return false on a parse or validation error (stages are left unchanged; see lastError())
+     */
+    bool setStagesJson(const std::string& json);
+
+    /**
+     * @brief Replace the stage list from a JSON file
+     * @return false if the file cannot be read or parsed (see lastError())
+     */
+    bool loadStages(const std::string& path);
+
+    /// @brief Description of the last JSON error (empty after success)
+    const std::string& lastError() const;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void init(Context& ctx) override;
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "CVPipeline"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /// @brief Contours found by the last Contours stage this cook
+    int contourCount() const;
+
+    /// @brief Blobs found by the last Blobs stage this cook
+    const std::vector<CVPipelineBlob>& blobs() const;
+
+    /// @brief Mean flow speed in input pixels per cook from the last Flow stage
+    float meanFlow() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * One entry per stage type that ran (luma, blur, threshold,
+     * morphology, canny, contours, blobs, flow), then render (drawing the
+     * last stage's result), assign (copy into the output buffer), process,
+     * cookLatency and pipelineLatency (see frame_stamp.h). Stages of the
+     * same type share an entry; "luma" includes the shared grayscale the
+     * pipeline starts from.
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers allocated for this operator, including on
+     * pool workers; stageTimings() breaks them down by stage. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+
+    // CPU pixel output buffer
+    std::vector<uint8_t> m_outputPixels;
+    int m_outputWidth = 0;
+    int m_outputHeight = 0;
+};
+
+} // namespace vivid::opencv
@@ -3,7 +3,10 @@
 // DLL export/import macros for vivid-opencv
 // On Windows, shared libraries require explicit symbol export declarations
 
-#ifdef _WIN32
+#if defined(VIVID_OPENCV_STATIC)
+    // Compiled into the caller (e.g. the test harness)
+    #define VIVID_OPENCV_API
+#elif defined(_WIN32)
     #ifdef vivid_opencv_EXPORTS
         // Building the DLL
         #define VIVID_OPENCV_API __declspec(dllexport)
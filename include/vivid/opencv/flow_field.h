@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file flow_field.h
+ * @brief Dense optical flow source shared by visualization and analysis operators
+ *
+ * Solves Farneback flow once per frame and publishes the field so any
+ * number of FlowViz / FlowStats consumers can read it without re-solving.
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Read-only view of a FlowField's current flow
+ *
+ * Vectors are stored interleaved (dx, dy) as floats in processing-resolution
+ * pixels per frame. Multiply by `toInputX` / `toInputY` to get input pixels.
+ * Valid until the FlowField's next cook.
+ */
+struct FlowFieldView {
+    const float* data = nullptr;  ///< Row-major (dx, dy) pairs; nullptr until two frames were seen
+    int width = 0;                ///< Field width (processing resolution)
+    int height = 0;               ///< Field height (processing resolution)
+    size_t stride = 0;            ///< Floats per row (>= 2 * width)
+    float toInputX = 1.0f;        ///< Input pixels per field pixel, horizontally
+    float toInputY = 1.0f;        ///< Input pixels per field pixel, vertically
+    uint64_t frame = 0;           ///< Flow solves so far (changes when the field updates)
+
+    bool valid() const { return data != nullptr; }
+
+    /// Vector at field coordinates (x, y), in processing-resolution pixels
+    float dx(int x, int y) const { return data[y * stride + 2 * x]; }
+    float dy(int x, int y) const { return data[y * stride + 2 * x + 1]; }
+};
+
+/**
+ * @brief Dense optical flow source operator
+ *
+ * Computes Farneback flow between consecutive frames at reduced resolution
+ * and exposes it through field(). Its image output is the input frame passed
+ * through unchanged (zero-copy), so consumers can draw over it.
+ *
+ * Connect FlowViz and FlowStats operators to it to render or analyze the
+ * field; each one costs only its own rendering or reduction. Use
+ * OpticalFlow instead when a single visualization is all you need.
+ *
+ * @note Requires CPU pixel data from input via cpuPixelView().
+ * Compatible sources: Webcam, VideoPlayer.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | scale | float | 0.05-1.0 | 0.15 | Processing resolution scale |
+ * | pyrScale | float | 0.1-0.9 | 0.5 | Pyramid scale factor |
+ * | levels | int | 1-5 | 1 | Number of pyramid levels |
+ * | winSize | int | 3-25 | 9 | Averaging window size |
+ * | iterations | int | 1-10 | 1 | Iterations per pyramid level |
+ * | polyN | int | 5-7 | 5 | Polynomial expansion neighborhood |
+ * | polySigma | float | 1.0-2.0 | 1.1 | Gaussian sigma for polynomial |
+ * | threads | int | 0-64 | 0 | Max threads for this operator's cook (0 = whole pool) |
+ *
+ * @par Example
+ * @code
+ * auto& field = chain.add<vivid::opencv::FlowField>("field");
+ * field.input("cam");
+ *
+ * auto& colors = chain.add<vivid::opencv::FlowViz>("colors");
+ * colors.input("field");
+ *
+ * auto& arrows = chain.add<vivid::opencv::FlowViz>("arrows");
+ * arrows.input("field");
+ * arrows.vizMode = 1;
+ *
+ * auto& motion = chain.add<vivid::opencv::FlowStats>("motion");
+ * motion.input("field");
+ * @endcode
+ *
+ * @par Output
+ * The input frame, passed through
+ */
+class VIVID_OPENCV_API FlowField : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<float> scale{"scale", 0.15f, 0.05f, 1.0f};        ///< Processing scale
+    Param<float> pyrScale{"pyrScale", 0.5f, 0.1f, 0.9f};    ///< Pyramid scale
+    Param<int> levels{"levels", 1, 1, 5};                    ///< Pyramid levels
+    Param<int> winSize{"winSize", 9, 3, 25};                ///< Window size
+    Param<int> iterations{"iterations", 1, 1, 10};          ///< Iterations
+    Param<int> polyN{"polyN", 5, 5, 7};                     ///< Poly neighborhood
+    Param<float> polySigma{"polySigma", 1.1f, 1.0f, 2.0f};  ///< Poly sigma
+    Param<int> threads{"threads", 0, 0, 64};                ///< Thread budget
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    FlowField();
+    ~FlowField() override;
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void init(Context& ctx) override;
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "FlowField"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /// @brief Current flow field (invalid until two frames have been seen)
+    FlowFieldView field() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: luma (shared grayscale at processing resolution),
+     * calcOpticalFlowFarneback (the solve), storePrev (copy kept for the
+     * next solve), process, cookLatency and pipelineLatency (see
+     * frame_stamp.h).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers allocated for this operator, including on
+     * pool workers helping with the solve; stageTimings() breaks them down
+     * by stage. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,132 @@
+#pragma once
+
+/**
+ * @file flow_stats.h
+ * @brief Motion statistics from a FlowField
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <memory>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Flow analysis operator
+ *
+ * Reduces the flow published by a FlowField input to a few numbers per
+ * frame - mean and peak speed, mean direction and the fraction of the
+ * region that is moving - without re-solving flow. Values are in input
+ * pixels per frame. The region is given in normalized input coordinates.
+ *
+ * @note Input 0 must be a FlowField; any other input leaves the stats at zero.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | motionThreshold | float | 0-50 | 1 | Speed (px/frame) above which a sample counts as moving |
+ * | regionX | float | 0-1 | 0 | Region left edge |
+ * | regionY | float | 0-1 | 0 | Region top edge |
+ * | regionW | float | 0-1 | 1 | Region width |
+ * | regionH | float | 0-1 | 1 | Region height |
+ *
+ * @par Example
+ * @code
+ * auto& motion = chain.add<vivid::opencv::FlowStats>("motion");
+ * motion.input("field");
+ *
+ * // in update():
+ * if (motion.motionFraction() > 0.2f) { ... }
+ * @endcode
+ *
+ * @par Output
+ * The FlowField's frame, passed through
+ */
+class VIVID_OPENCV_API FlowStats : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<float> motionThreshold{"motionThreshold", 1.0f, 0.0f, 50.0f}; ///< Moving speed floor
+    Param<float> regionX{"regionX", 0.0f, 0.0f, 1.0f};      ///< Region left
+    Param<float> regionY{"regionY", 0.0f, 0.0f, 1.0f};      ///< Region top
+    Param<float> regionW{"regionW", 1.0f, 0.0f, 1.0f};      ///< Region width
+    Param<float> regionH{"regionH", 1.0f, 0.0f, 1.0f};      ///< Region height
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    FlowStats();
+    ~FlowStats() override;
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void init(Context& ctx) override;
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "FlowStats"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /// @brief Mean speed over the region (px/frame)
+    float meanMagnitude() const;
+
+    /// @brief Largest speed in the region (px/frame)
+    float maxMagnitude() const;
+
+    /// @brief Mean horizontal motion (px/frame, positive = right)
+    float meanX() const;
+
+    /// @brief Mean vertical motion (px/frame, positive = down)
+    float meanY() const;
+
+    /// @brief Direction of the mean motion in degrees (0 = right, 90 = down)
+    float direction() const;
+
+    /// @brief Fraction of region samples moving faster than motionThreshold (0-1)
+    float motionFraction() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: reduce (the pass over the region), process, cookLatency
+     * and pipelineLatency (see frame_stamp.h).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * The reduction itself allocates nothing, so this should stay at
+     * zero. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file flow_viz.h
+ * @brief Renders a FlowField without re-solving flow
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/optical_flow.h>
+#include <vivid/opencv/stage_timing.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <memory>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Flow visualization operator
+ *
+ * Draws the flow published by a FlowField input using the same modes as
+ * OpticalFlow. Several FlowViz operators can share one FlowField; each costs
+ * only its rendering. Arrows are drawn over the frame the field was solved
+ * from.
+ *
+ * @note Input 0 must be a FlowField; any other input produces no output.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | vizMode | int | 0-2 | 0 | Visualization (0=HSV, 1=Arrows, 2=Magnitude) |
+ * | sensitivity | float | 0.1-10 | 1.0 | Motion sensitivity multiplier |
+ *
+ * @par Example
+ * @code
+ * auto& arrows = chain.add<vivid::opencv::FlowViz>("arrows");
+ * arrows.input("field");
+ * arrows.vizMode = 1;
+ * @endcode
+ */
+class VIVID_OPENCV_API FlowViz : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<int> vizMode{"vizMode", 0, 0, 2};                 ///< Visualization mode
+    Param<float> sensitivity{"sensitivity", 1.0f, 0.1f, 10.0f}; ///< Motion sensitivity
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    FlowViz();
+    ~FlowViz() override;
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void init(Context& ctx) override;
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "FlowViz"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: render (drawing the field), assign (copy into the output
+     * buffer), process, cookLatency and pipelineLatency (see
+     * frame_stamp.h).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers allocated while cooking; stageTimings()
+     * breaks them down by stage. All zero when built with
+     * VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+
+    // CPU pixel output buffer
+    std::vector<uint8_t> m_outputPixels;
+    int m_outputWidth = 0;
+    int m_outputHeight = 0;
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file frame_stamp.h
+ * @brief Frame ids and capture times carried from input to output
+ *
+ * Every operator tags its output with the FrameStamp of the input frame it
+ * was computed from. The frame id and capture time pass through unchanged;
+ * each operator adds when it received the frame and when its result was
+ * published. The stamp of the last operator in a stack therefore gives the
+ * latency of the whole stack. Operators cooking in the background (`async`)
+ * include their queueing and lag.
+ *
+ * Sources outside this module are assumed to show a new frame on every
+ * chain frame (Context::frame()); it gets an id and a capture time the first
+ * time one of our operators reads it. A host that knows better (e.g. a
+ * camera timestamp, or a source slower than the chain) can stamp the
+ * source's frames with stampFrame(); repeating an id marks a repeated frame.
+ * All times are seconds on std::chrono::steady_clock, see stampClock().
+ *
+ * Operators with stage timing also report the latencies as the
+ * "cookLatency" and "pipelineLatency" stages. While tracing (tracing.h),
+ * each publish adds a point to the operator's latency counters.
+ *
+ * @par Example
+ * @code
+ * FrameStamp stamp = vivid::opencv::frameStamp(blobs);
+ * std::printf("frame %llu: %.1f ms since capture\n",
+ *             (unsigned long long)stamp.frameId, stamp.pipelineLatencyMs());
+ * @endcode
+ */
+
+#include <vivid/opencv/export.h>
+#include <cstdint>
+
+namespace vivid {
+class Operator;
+}
+
+namespace vivid::opencv {
+
+/**
+ * @brief Identity and timing of the frame behind an operator's output
+ */
+struct FrameStamp {
+    uint64_t frameId = 0;       ///< Source frame id (0 = nothing published yet)
+    double captureTime = 0.0;   ///< When the source frame was captured
+    double receiveTime = 0.0;   ///< When this operator took the frame
+    double publishTime = 0.0;   ///< When this operator's result became its output
+
+    bool valid() const { return frameId != 0; }
+
+    /// Time this operator took, from receiving the frame to publishing the result
+    double cookLatencyMs() const { return (publishTime - receiveTime) * 1000.0; }
+
+    /// Time from capture to this operator's output, over every stacked operator
+    double pipelineLatencyMs() const { return (publishTime - captureTime) * 1000.0; }
+};
+
+/**
+ * @brief Stamp of the frame behind an operator's current output
+ *
+ * Works for every operator in this module; other operators have a stamp
+ * only if the host set one with stampFrame(). Safe from any thread.
+ */
+VIVID_OPENCV_API FrameStamp frameStamp(const vivid::Operator& op);
+
+/**
+ * @brief Stamp the frame a source operator is outputting now
+ *
+ * Call after the source cooks, once per frame. From then on our operators
+ * read the source's id and capture time from here instead of assigning
+ * their own.
+ */
+VIVID_OPENCV_API void stampFrame(const vivid::Operator& source, uint64_t frameId,
+                                 double captureTime);
+
+/// Current time in the stamp time base (steady_clock seconds)
+VIVID_OPENCV_API double stampClock();
+
+} // namespace vivid::opencv
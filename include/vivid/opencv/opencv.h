@@ -7,7 +7,17 @@
  * This module provides computer vision operators using opencv-mobile:
  * - Contours: Edge detection and contour extraction
  * - OpticalFlow: Dense motion vector calculation
+ * - FlowField / FlowViz / FlowStats: Flow solved once, rendered and analyzed many times
  * - BlobTrack: Blob detection and tracking
+ * - BrightSpot: Brightest-point tracking
+ * - CVPipeline: Multi-stage processing in a single cook
+ * - RawFrameSource / RawFrameRecorder: Memory-mapped replay of recorded frames for profiling
+ *
+ * Parallel loops (OpenCV's and the addon's) run on one module-wide worker
+ * pool; see threading.h to size it or pin it to cores. tracing.h records
+ * stages, pool loops and background cooks as a Chrome/Perfetto trace.
+ * frame_stamp.h reports which frame each output came from and its latency.
+ * cpu_dispatch.h reports the instruction sets the kernels and OpenCV use.
  *
  * Note: Uses opencv-mobile which includes core, imgproc, video, features2d, photo.
  * For face detection and other DNN-based features, use vivid-onnx instead.
@@ -39,7 +49,18 @@
 #include <vivid/opencv/export.h>
 #include <vivid/opencv/contours.h>
 #include <vivid/opencv/optical_flow.h>
+#include <vivid/opencv/flow_field.h>
+#include <vivid/opencv/flow_viz.h>
+#include <vivid/opencv/flow_stats.h>
 #include <vivid/opencv/blob_track.h>
+#include <vivid/opencv/bright_spot.h>
+#include <vivid/opencv/cv_pipeline.h>
+#include <vivid/opencv/raw_frame_source.h>
+#include <vivid/opencv/raw_frame_recorder.h>
+#include <vivid/opencv/threading.h>
+#include <vivid/opencv/tracing.h>
+#include <vivid/opencv/frame_stamp.h>
+#include <vivid/opencv/cpu_dispatch.h>
 
 namespace vivid::opencv {
 
@@ -8,6 +8,9 @@
  */
 
 #include <vivid/opencv/export.h>
+#include <vivid/opencv/async_stats.h>
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/stage_timing.h>
 #include <vivid/effects/texture_operator.h>
 #include <vivid/param.h>
 #include <vivid/operator_registry.h>
@@ -31,6 +34,10 @@ enum class FlowVizMode : int {
  * Calculates motion vectors between consecutive frames using Farneback's algorithm.
  * Outputs a visualization of the flow field.
  *
+ * With async = 2 the luma/resize, solve and visualization stages run as a
+ * pipeline on three threads, so consecutive frames overlap. Throughput is
+ * bounded by the solve; output lags the input by a few frames.
+ *
  * @note Requires CPU pixel data from input via cpuPixelView().
  * Compatible sources: Webcam, VideoPlayer.
  *
@@ -45,6 +52,8 @@ enum class FlowVizMode : int {
  * | polySigma | float | 1.0-2.0 | 1.2 | Gaussian sigma for polynomial |
  * | vizMode | int | 0-2 | 0 | Visualization mode |
  * | sensitivity | float | 0.1-10 | 1.0 | Motion sensitivity multiplier |
+ * | async | int | 0-2 | 0 | 0=inline, 1=background thread, 2=pipelined stages |
+ * | threads | int | 0-64 | 0 | Max threads for this operator's cook (0 = whole pool) |
  *
  * @par Example
  * @code
@@ -68,6 +77,8 @@ public:
     Param<float> polySigma{"polySigma", 1.1f, 1.0f, 2.0f};  ///< Poly sigma
     Param<int> vizMode{"vizMode", 0, 0, 2};                 ///< Visualization mode
     Param<float> sensitivity{"sensitivity", 1.0f, 0.1f, 10.0f}; ///< Motion sensitivity
+    Param<int> async{"async", 0, 0, 2};                     ///< Inline / background / pipelined
+    Param<int> threads{"threads", 0, 0, 64};                ///< Thread budget
 
     /// @}
     // -------------------------------------------------------------------------
@@ -90,6 +101,39 @@ public:
 
     /// @}
 
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /// @brief Background cook counters for the active `async` mode
+    AsyncStats asyncStats() const;
+
+    /**
+     * @brief Time spent in each stage of recent cooks
+     *
+     * Stages: cvtColor, resize, calcOpticalFlowFarneback, render,
+     * assign (copy into the output buffer), process, cookLatency and
+     * pipelineLatency (see frame_stamp.h).
+     * "process" is the whole process() call on the chain thread; the
+     * others are timed wherever they ran (worker threads with `async`).
+     * Empty when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    std::vector<StageTiming> stageTimings() const;
+
+    /**
+     * @brief Heap allocations made by recent cooks
+     *
+     * Counts cv::Mat buffers and internal scratch containers allocated
+     * for this operator on any thread; stageTimings() breaks them down by
+     * stage. All zero when built with VIVID_OPENCV_PROFILING=OFF.
+     */
+    AllocStats allocStats() const;
+
+    /// @brief Clear the stage timing windows and the timing and allocation counters
+    void resetStageTimings();
+
+    /// @}
+
 private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
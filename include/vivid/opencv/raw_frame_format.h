@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file raw_frame_format.h
+ * @brief File format shared by RawFrameRecorder and RawFrameSource
+ *
+ * A 64-byte header followed by tightly packed BGRA frames, all the same
+ * size, back to back:
+ *
+ * | Offset | Size | Field |
+ * |--------|------|-------|
+ * | 0 | 8 | magic "VIVIDRAW" |
+ * | 8 | 4 | version (1) |
+ * | 12 | 4 | headerSize: offset of the first frame (64) |
+ * | 16 | 4 | width in pixels |
+ * | 20 | 4 | height in pixels |
+ * | 24 | 4 | pixelFormat (0 = BGRA, 8 bits per channel) |
+ * | 28 | 4 | flags (0) |
+ * | 32 | 8 | frameCount (0 = unknown, e.g. a recording that was never stopped) |
+ * | 40 | 8 | fps the frames were recorded at (0 = unknown) |
+ * | 48 | 16 | reserved (0) |
+ *
+ * Frame `i` starts at `headerSize + i * width * height * 4`. Integers and
+ * the double are little-endian. Readers trust the file size over
+ * frameCount, so a recording cut short by a crash still plays.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace vivid::opencv {
+
+/// First eight bytes of every raw frame file
+inline constexpr char kRawFrameMagic[8] = {'V', 'I', 'V', 'I', 'D', 'R', 'A', 'W'};
+
+/// Current format version
+inline constexpr uint32_t kRawFrameVersion = 1;
+
+/// RawFrameHeader::pixelFormat for 8-bit BGRA
+inline constexpr uint32_t kRawFrameBGRA8 = 0;
+
+/**
+ * @brief On-disk header of a raw frame file (64 bytes, little-endian)
+ */
+struct RawFrameHeader {
+    char magic[8] = {};           ///< kRawFrameMagic
+    uint32_t version = 0;         ///< kRawFrameVersion
+    uint32_t headerSize = 0;      ///< Offset of the first frame
+    uint32_t width = 0;           ///< Frame width in pixels
+    uint32_t height = 0;          ///< Frame height in pixels
+    uint32_t pixelFormat = 0;     ///< kRawFrameBGRA8
+    uint32_t flags = 0;           ///< Reserved, 0
+    uint64_t frameCount = 0;      ///< Frames in the file (0 = count from the file size)
+    double fps = 0.0;             ///< Recording rate (0 = unknown)
+    uint8_t reserved[16] = {};    ///< Reserved, 0
+
+    /// Bytes per frame
+    size_t frameBytes() const { return static_cast<size_t>(width) * height * 4; }
+
+    /// Whether `magic` is kRawFrameMagic
+    bool hasMagic() const { return std::memcmp(magic, kRawFrameMagic, sizeof(magic)) == 0; }
+};
+
+static_assert(sizeof(RawFrameHeader) == 64, "RawFrameHeader must match the 64-byte file layout");
+
+} // namespace vivid::opencv
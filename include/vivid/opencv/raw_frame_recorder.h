@@ -0,0 +1,115 @@
+#pragma once
+
+/**
+ * @file raw_frame_recorder.h
+ * @brief Records any operator's CPU pixels to a raw BGRA frame file
+ *
+ * The files replay with RawFrameSource, e.g. to profile a stack on frames
+ * captured once from a live camera.
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/raw_frame_format.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <memory>
+#include <string>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Raw frame file recorder
+ *
+ * While recording, every cook appends the input's current CPU pixels to
+ * the file (format in raw_frame_format.h), one frame per new input frame:
+ * a cook that sees the same frame stamp again (see frame_stamp.h) writes
+ * nothing. The input
+ * passes through unchanged and without a copy, so the recorder can sit
+ * anywhere in a chain. The header is finalized by stop(), cleanup() or
+ * destruction; a recording that was never finalized still replays.
+ *
+ * Recording stops with an error if the input changes size or a write
+ * fails. Frames are written on the cook thread, so don't profile a chain
+ * while it records.
+ *
+ * @note Requires CPU pixel data from input via cpuPixelView().
+ * Compatible sources: Webcam, VideoPlayer, and every operator in this module.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | maxFrames | int | 0-1000000 | 0 | Stop after this many frames (0 = no limit) |
+ * | fps | float | 0-240 | 0 | Rate stored in the file (0 = measured from the context clock) |
+ *
+ * @par Example
+ * @code
+ * auto& rec = chain.add<vivid::opencv::RawFrameRecorder>("rec");
+ * rec.input("cam");
+ * rec.maxFrames = 600;
+ * rec.start("capture.vraw");
+ * @endcode
+ *
+ * @par Output
+ * The input's CPU pixels, passed through
+ */
+class VIVID_OPENCV_API RawFrameRecorder : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<int> maxFrames{"maxFrames", 0, 0, 1000000};  ///< Frame limit, 0 = none
+    Param<float> fps{"fps", 0.0f, 0.0f, 240.0f};       ///< Stored rate, 0 = measured
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    RawFrameRecorder();
+    ~RawFrameRecorder() override;
+
+    // -------------------------------------------------------------------------
+    /// @name Recording
+    /// @{
+
+    /**
+     * @brief Create (or truncate) `path` and record from the next cook on
+     * @return false if the file can't be created (see lastError())
+     */
+    bool start(const std::string& path);
+
+    /// @brief Finalize the header and close the file
+    void stop();
+
+    /// @brief Whether frames are being written
+    bool recording() const;
+
+    /// @brief Frames written since start()
+    int framesWritten() const;
+
+    /// @brief Why the last start() failed or recording stopped early (empty if it didn't)
+    const std::string& lastError() const;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void init(Context& ctx) override;
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "RawFrameRecorder"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace vivid::opencv
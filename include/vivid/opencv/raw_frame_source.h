@@ -0,0 +1,143 @@
+#pragma once
+
+/**
+ * @file raw_frame_source.h
+ * @brief Replays a recorded raw BGRA frame file as a CPU pixel source
+ *
+ * Stands in for Webcam or VideoPlayer when profiling, so measurements
+ * contain no decode or capture jitter and every run sees the same frames.
+ */
+
+#include <vivid/opencv/export.h>
+#include <vivid/opencv/raw_frame_format.h>
+#include <vivid/effects/texture_operator.h>
+#include <vivid/param.h>
+#include <vivid/operator_registry.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Memory-mapped raw frame replay
+ *
+ * Maps a file written by RawFrameRecorder (format in raw_frame_format.h)
+ * read-only and serves each frame straight from the mapping:
+ * cpuPixelView() points into the file, so no frame is copied or decoded.
+ *
+ * With `fps` = 0 every cook advances exactly one frame, however long the
+ * chain takes: frame N is always cooked N-th, which makes runs repeatable.
+ * With `fps` > 0 the frame follows the context clock like a camera would,
+ * skipping frames when the chain is slow and repeating them when it is
+ * fast. Each new frame is stamped (frame_stamp.h) when it is served.
+ *
+ * `preload` faults the whole file into memory on open(), so the first pass
+ * doesn't measure page faults. Without it the next frame is prefetched
+ * each cook.
+ *
+ * @note The mapping is released by close() and cleanup(); operators still
+ * cooking a served frame in the background must be stopped first.
+ *
+ * @par Parameters
+ * | Name | Type | Range | Default | Description |
+ * |------|------|-------|---------|-------------|
+ * | fps | float | 0-240 | 0 | Playback rate (0 = one frame per cook) |
+ * | loop | int | 0-1 | 1 | Wrap at the end (0 = hold the last frame) |
+ * | preload | int | 0-1 | 1 | Read the whole file into memory on open |
+ *
+ * @par Example
+ * @code
+ * auto& replay = chain.add<vivid::opencv::RawFrameSource>("replay");
+ * replay.open("assets/train.vraw");
+ *
+ * auto& contours = chain.add<vivid::opencv::Contours>("contours");
+ * contours.input("replay");
+ * @endcode
+ *
+ * @par Output
+ * CPU pixel buffer (BGRA) mapped from the file
+ */
+class VIVID_OPENCV_API RawFrameSource : public vivid::effects::TextureOperator {
+public:
+    // -------------------------------------------------------------------------
+    /// @name Parameters
+    /// @{
+
+    Param<float> fps{"fps", 0.0f, 0.0f, 240.0f};  ///< Playback rate, 0 = one frame per cook
+    Param<int> loop{"loop", 1, 0, 1};             ///< Wrap at the end
+    Param<int> preload{"preload", 1, 0, 1};       ///< Fault the file in on open
+
+    /// @}
+    // -------------------------------------------------------------------------
+
+    RawFrameSource();
+    ~RawFrameSource() override;
+
+    // -------------------------------------------------------------------------
+    /// @name File
+    /// @{
+
+    /**
+     * @brief Map a raw frame file; playback starts at its first frame
+     * @return false if the file can't be mapped or isn't a raw frame file
+     *         (see lastError()); any previous file is closed either way
+     */
+    bool open(const std::string& path);
+
+    /// @brief Unmap the file; the output becomes empty
+    void close();
+
+    /// @brief Whether a file is mapped
+    bool isOpen() const;
+
+    /// @brief Description of the last open() error (empty after success)
+    const std::string& lastError() const;
+
+    /// @brief Serve `frame` on the next cook and continue from there
+    void seek(int frame);
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Operator Interface
+    /// @{
+
+    void process(Context& ctx) override;
+    void cleanup() override;
+    std::string name() const override { return "RawFrameSource"; }
+
+    // CPU pixel output (no GPU texture)
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override;
+
+    /// @}
+
+    // -------------------------------------------------------------------------
+    /// @name Accessors
+    /// @{
+
+    /// @brief Frames in the file (0 when closed)
+    int frameCount() const;
+
+    /// @brief Index of the frame being served (-1 before the first cook)
+    int frameIndex() const;
+
+    /// @brief Frames served since open(), repeats after a loop included
+    uint64_t framesServed() const;
+
+    /// @brief Frame size in pixels (0 when closed)
+    int width() const;
+    int height() const;
+
+    /// @brief Rate stored in the file by the recorder (0 = unknown)
+    double recordedFps() const;
+
+    /// @}
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace vivid::opencv
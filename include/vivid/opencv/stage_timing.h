@@ -0,0 +1,34 @@
+#pragma once
+
+/**
+ * @file stage_timing.h
+ * @brief Per-stage cook times reported by the operators
+ */
+
+#include <cstdint>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Timing of one stage of an operator's cook (see stageTimings())
+ *
+ * Mean and p99 cover a rolling window of the most recent 512-1024 samples;
+ * p99 is resolved to about 10%. Stages that ran on a background thread
+ * (`async`) are timed there, so they can be read while the output lags.
+ * Allocation counts cover the thread running the stage; pool workers
+ * helping with it are counted only in the operator's allocStats().
+ *
+ * Timing is compiled in unless the addon is built with
+ * VIVID_OPENCV_PROFILING=OFF, in which case stageTimings() is empty.
+ */
+struct StageTiming {
+    const char* name = "";    ///< Stage name (static string, e.g. "Canny")
+    double lastMs = 0.0;      ///< Most recent sample
+    double meanMs = 0.0;      ///< Mean over the window
+    double p99Ms = 0.0;       ///< 99th percentile over the window
+    uint64_t samples = 0;     ///< Samples since the last reset
+    uint64_t allocs = 0;      ///< Allocations inside the stage since the last reset
+    uint64_t allocBytes = 0;  ///< Bytes those allocations requested
+};
+
+} // namespace vivid::opencv
@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file threading.h
+ * @brief Module-wide worker pool shared by OpenCV and the addon's kernels
+ *
+ * vivid-opencv installs its own thread pool as OpenCV's parallel_for_
+ * backend, so OpenCV's internal parallel loops and the addon's SIMD kernels
+ * draw from one set of workers instead of competing with each other and
+ * with the render thread.
+ *
+ * The calling thread always takes part in its own parallel loops, and can
+ * finish one alone if every worker is busy, so a cook never waits on queued
+ * work. Loops started on different threads share the workers, so at most
+ * `workers` threads help at once; the rest are the callers themselves. The
+ * render thread and every background or pipeline thread of an `async`
+ * operator is such a caller, so with the default worker count (hardware
+ * threads - 1) each of those threads beyond the first can put one more
+ * thread on the cores. Lower `workers` by their number to stay within the
+ * cores.
+ *
+ * Each heavy operator also has a `threads` param that caps how many threads
+ * (including the calling thread) its cook may use.
+ *
+ * @par Example
+ * @code
+ * vivid::opencv::ThreadPoolConfig config;
+ * config.workers = 3;              // Leave the other cores to the renderer
+ * config.affinity = {2, 3, 4};     // Pin workers to cores 2-4
+ * vivid::opencv::configureThreadPool(config);
+ * @endcode
+ */
+
+#include <vivid/opencv/export.h>
+#include <vector>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Worker pool configuration
+ */
+struct ThreadPoolConfig {
+    /// Worker threads besides the calling thread. -1 = hardware threads - 1
+    /// (or the VIVID_OPENCV_THREADS environment variable, if set), 0 = run
+    /// every parallel loop on the calling thread.
+    int workers = -1;
+
+    /// CPU cores workers are pinned to, assigned round-robin. Empty = no
+    /// pinning. Honored on Linux and Windows; ignored on macOS, which has no
+    /// hard affinity.
+    std::vector<int> affinity;
+};
+
+/**
+ * @brief Replace the pool configuration
+ *
+ * Joins the current workers and starts the new ones. Safe to call while
+ * operators are cooking: loops in flight finish on their calling threads.
+ */
+VIVID_OPENCV_API void configureThreadPool(const ThreadPoolConfig& config);
+
+/**
+ * @brief Current configuration, with `workers` resolved to the actual count
+ */
+VIVID_OPENCV_API ThreadPoolConfig threadPoolConfig();
+
+} // namespace vivid::opencv
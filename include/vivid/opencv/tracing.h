@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file tracing.h
+ * @brief Chrome/Perfetto trace of operator stages and worker threads
+ *
+ * While tracing is on, every timed cook stage (see StageTiming), every
+ * background cook and every thread-pool loop is recorded as a complete
+ * event on the thread that ran it. writeTrace() saves the events as Chrome
+ * trace-event JSON, which chrome://tracing and ui.perfetto.dev open
+ * directly. Threads are named: pool workers, async workers and pipeline
+ * stages show up as such next to the chain thread.
+ *
+ * Events go into a buffer allocated by startTracing(): recording is
+ * lock-free and never allocates, and once the buffer is full further
+ * events are dropped and counted. When tracing is off, each instrumented
+ * scope costs one relaxed atomic load.
+ *
+ * Setting the VIVID_OPENCV_TRACE environment variable to a file path starts
+ * tracing when the addon loads and writes the file when it unloads.
+ *
+ * Each operator publish also adds a point to its "cook latency" and
+ * "pipeline latency" counter tracks (see frame_stamp.h).
+ *
+ * Stage events come from the stage timers, so builds with
+ * VIVID_OPENCV_PROFILING=OFF only record pool loops, background cooks
+ * and latency counters.
+ *
+ * @par Example
+ * @code
+ * vivid::opencv::startTracing();
+ * // ... run the show for a few seconds ...
+ * vivid::opencv::writeTrace("opencv-trace.json");
+ * vivid::opencv::stopTracing();
+ * @endcode
+ */
+
+#include <vivid/opencv/export.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vivid::opencv {
+
+/**
+ * @brief Trace buffer configuration
+ */
+struct TraceConfig {
+    /// Events the buffer holds (56 bytes each)
+    size_t capacity = size_t(1) << 20;
+
+    /// If set, the trace is written here when the addon unloads
+    std::string outputPath;
+};
+
+/**
+ * @brief Trace buffer counters
+ */
+struct TraceStats {
+    uint64_t recorded = 0;  ///< Events in the buffer
+    uint64_t dropped = 0;   ///< Events lost because the buffer was full
+    bool enabled = false;   ///< Tracing is on
+};
+
+/**
+ * @brief Start recording into an empty buffer
+ *
+ * Events recorded before are discarded. The previous buffer is reused when
+ * it holds at least `config.capacity` events and freed otherwise, once the
+ * threads still writing into it are done.
+ */
+VIVID_OPENCV_API void startTracing(const TraceConfig& config = {});
+
+/**
+ * @brief Stop recording; the buffer is kept for writeTrace()
+ */
+VIVID_OPENCV_API void stopTracing();
+
+/**
+ * @brief Write the events recorded so far as Chrome trace-event JSON
+ *
+ * Can be called while tracing is on; events still being written are left out.
+ * @return false if the file can't be written
+ */
+VIVID_OPENCV_API bool writeTrace(const std::string& path);
+
+/**
+ * @brief Events recorded and dropped in the current buffer
+ */
+VIVID_OPENCV_API TraceStats traceStats();
+
+} // namespace vivid::opencv
@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * @file trajectory.h
+ * @brief Zero-copy view of a tracked blob's position history
+ */
+
+namespace vivid::opencv {
+
+/**
+ * @brief Read-only view of one track's trajectory ring buffer
+ *
+ * Points into BlobTrack's preallocated history arena (structure of arrays),
+ * so no data is copied. Samples are ordered oldest to newest through the
+ * accessors; for bulk processing the ring is exposed as at most two
+ * contiguous segments of the raw arrays.
+ *
+ * A view is valid until the next cook of the operator that produced it.
+ *
+ * @code
+ * auto trail = blobs.trajectoryAt(i);
+ * for (int k = 0; k < trail.count; ++k) {
+ *     draw(trail.x(k), trail.y(k));
+ * }
+ * @endcode
+ */
+struct TrajectoryView {
+    const float* xs = nullptr;      ///< Ring storage for x (capacity entries)
+    const float* ys = nullptr;      ///< Ring storage for y (capacity entries)
+    const double* times = nullptr;  ///< Ring storage for capture times in seconds
+    int capacity = 0;               ///< Ring length (BlobTrack::historyLength)
+    int start = 0;                  ///< Ring index of the oldest sample
+    int count = 0;                  ///< Valid samples (<= capacity)
+
+    bool empty() const { return count == 0; }
+
+    /// Ring index of the i-th oldest sample
+    int slot(int i) const { return (start + i) % capacity; }
+
+    float x(int i) const { return xs[slot(i)]; }
+    float y(int i) const { return ys[slot(i)]; }
+    double time(int i) const { return times[slot(i)]; }
+
+    /// Samples in the first contiguous segment, starting at ring index `start`
+    int firstSegment() const { return count < capacity - start ? count : capacity - start; }
+
+    /// Samples in the second segment, starting at ring index 0
+    int secondSegment() const { return count - firstSegment(); }
+};
+
+} // namespace vivid::opencv
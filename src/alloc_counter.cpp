@@ -0,0 +1,62 @@
+/**
+ * @file alloc_counter.cpp
+ * @brief Counting wrapper around OpenCV's default Mat allocator
+ */
+
+#include "alloc_counter.h"
+
+#if VIVID_OPENCV_PROFILING
+
+#include <opencv2/core.hpp>
+#include <mutex>
+
+namespace vivid::opencv::detail {
+
+namespace {
+
+// Counts buffers, then leaves them entirely to the wrapped allocator: the
+// UMatData it returns still names that allocator, so release, map and
+// unmap never come back through here
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    explicit CountingMatAllocator(cv::MatAllocator* inner) : m_inner(inner) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        cv::UMatData* u = m_inner->allocate(dims, sizes, type, data, step, flags, usage);
+        if (u && !data) {
+            countAllocation(u->size);  // Wrapping user memory isn't an allocation
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        return m_inner->allocate(u, flags, usage);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        m_inner->deallocate(u);
+    }
+
+    cv::BufferPoolController* getBufferPoolController(const char* id) const override {
+        return m_inner->getBufferPoolController(id);
+    }
+
+private:
+    cv::MatAllocator* m_inner;
+};
+
+} // namespace
+
+void installAllocCounter() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        // Leaked: static Mats elsewhere may be created during shutdown
+        auto* allocator = new CountingMatAllocator(cv::Mat::getDefaultAllocator());
+        cv::Mat::setDefaultAllocator(allocator);
+    });
+}
+
+} // namespace vivid::opencv::detail
+
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file alloc_counter.h
+ * @brief Allocation accounting for cooks (internal)
+ *
+ * installAllocCounter() wraps OpenCV's default cv::MatAllocator with one
+ * that counts, and the module's own scratch containers use
+ * CountingAllocator. A counted allocation is added to the calling thread's
+ * running totals and to the AllocCounter of the innermost AllocScope on
+ * that thread. Stage scopes (stage_timer.h) open one for their operator,
+ * and pool workers adopt the scope of the loop they help with. With
+ * VIVID_OPENCV_PROFILING=0 nothing is counted and CountedVector is a plain
+ * std::vector.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef VIVID_OPENCV_PROFILING
+#define VIVID_OPENCV_PROFILING 0
+#endif
+
+namespace vivid::opencv::detail {
+
+#if VIVID_OPENCV_PROFILING
+
+/// Allocations attributed to one operator, from any thread
+struct AllocCounter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+/// Allocations counted on one thread since it started
+struct ThreadAllocs {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+inline thread_local ThreadAllocs t_threadAllocs;
+inline thread_local AllocCounter* t_allocSink = nullptr;
+
+inline void countAllocation(size_t bytes) {
+    t_threadAllocs.count++;
+    t_threadAllocs.bytes += bytes;
+    if (AllocCounter* sink = t_allocSink) {
+        sink->count.fetch_add(1, std::memory_order_relaxed);
+        sink->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+/// Counter allocations on this thread currently go to (nullptr = none)
+inline AllocCounter* currentAllocSink() {
+    return t_allocSink;
+}
+
+/// Sends this thread's allocations to `counter` for a scope; scopes nest
+class AllocScope {
+public:
+    explicit AllocScope(AllocCounter* counter) : m_previous(t_allocSink) { t_allocSink = counter; }
+    ~AllocScope() { t_allocSink = m_previous; }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocCounter* m_previous;
+};
+
+/// std::allocator that counts each allocation
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        countAllocation(n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+/**
+ * @brief Make the counting allocator OpenCV's default
+ *
+ * Idempotent; operators call it from init(). Mats allocated before keep
+ * their allocator, so nothing changes for buffers already alive.
+ */
+void installAllocCounter();
+
+#else
+
+struct AllocCounter {};
+
+inline AllocCounter* currentAllocSink() {
+    return nullptr;
+}
+
+class AllocScope {
+public:
+    explicit AllocScope(AllocCounter*) {}
+};
+
+template <typename T>
+using CountedVector = std::vector<T>;
+
+inline void installAllocCounter() {}
+
+#endif
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,238 @@
+#pragma once
+
+/**
+ * @file async_cook.h
+ * @brief Background cooking with triple-buffered results (internal)
+ */
+
+#include <vivid/opencv/async_stats.h>
+#include "alloc_counter.h"
+#include "trace.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief A copy of an input frame owned by the async machinery
+ *
+ * Input buffers belong to the upstream operator and may change on its next
+ * cook, so frames are copied ("pinned") before being handed to the worker.
+ */
+struct PinnedFrame {
+    CountedVector<uint8_t> pixels;  ///< Tightly packed BGRA
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Lock-free triple buffer handing results from one worker to the chain thread
+ *
+ * The worker fills back() and calls publish(); the chain thread calls
+ * takeFresh(). Neither side ever waits for the other.
+ */
+template <typename Result>
+class ResultBuffer {
+public:
+    /// Slot the worker writes the next result into
+    Result& back() { return m_slots[m_back]; }
+
+    /// Make back() the newest result; the previous ready slot becomes back()
+    void publish() {
+        int previous = m_ready.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+    }
+
+    /**
+     * @brief Swap in the newest published result, if there is one
+     * @return The new front Result, or nullptr when nothing was published
+     *         since the last call. The front Result belongs to the chain thread
+     *         until the next takeFresh() (its buffers may be swapped out).
+     */
+    Result* takeFresh() {
+        if ((m_ready.load(std::memory_order_acquire) & kFresh) == 0) {
+            return nullptr;
+        }
+        int previous = m_ready.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & kIndexMask;
+        return &m_slots[m_front];
+    }
+
+    /// Forget any unread result (only while no worker is running; slots keep their buffers)
+    void reset() {
+        m_front = 0;
+        m_back = 2;
+        m_ready.store(1, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kFresh = 4;      // Set on m_ready when it holds an unread result
+    static constexpr int kIndexMask = 3;
+
+    // Front (chain thread), ready (shared), back (worker)
+    Result m_slots[3];
+    int m_front = 0;
+    int m_back = 2;
+    std::atomic<int> m_ready{1};
+};
+
+/**
+ * @brief Runs an operator's cook on a worker thread
+ *
+ * The operator sets its cook once with configure(); the chain thread then
+ * calls submit() with each frame and a snapshot of the params. The worker
+ * cooks the newest frame into a back Result and publishes it through a
+ * ResultBuffer. takeFresh() hands the chain thread the most recent
+ * completed Result without ever blocking on the worker, at the cost of
+ * (at least) one frame of latency.
+ *
+ * At most one frame waits while another cooks; a newer submit replaces the
+ * waiting frame and counts it as dropped. Frames and Settings are copied
+ * into fixed pending/working slots, so steady-state submits don't allocate.
+ *
+ * While the worker is running, it owns whatever state the job touches;
+ * call stop() before touching that state from the chain thread. stop() also
+ * discards any result not yet taken, so a restarted worker never hands out
+ * one cooked before the stop.
+ */
+template <typename Result, typename Settings>
+class AsyncCooker {
+public:
+    using Job = std::function<void(const PinnedFrame&, const Settings&, Result&)>;
+
+    AsyncCooker() = default;
+    AsyncCooker(const AsyncCooker&) = delete;
+    AsyncCooker& operator=(const AsyncCooker&) = delete;
+    ~AsyncCooker() { stop(); }
+
+    bool running() const { return m_thread.joinable(); }
+
+    /// Set the cook run for every frame (before the first submit; not while running)
+    void configure(Job job) {
+        stop();
+        m_job = std::move(job);
+    }
+
+    bool configured() const { return static_cast<bool>(m_job); }
+
+    /// Operator name used for the worker thread and its events in traces (a literal)
+    void setName(const char* name) { m_name = name; }
+
+    /// Pin a BGRA frame (tightly packed rows) and queue it with a copy of `settings`
+    void submit(const uint8_t* bgra, int width, int height, const Settings& settings) {
+        if (!running()) {
+            m_stopping = false;
+            m_thread = std::thread([this] { run(); });
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hasPending) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        size_t bytes = static_cast<size_t>(width) * height * 4;
+        m_pendingFrame.pixels.resize(bytes);  // Reuses capacity after the first frames
+        std::memcpy(m_pendingFrame.pixels.data(), bgra, bytes);
+        m_pendingFrame.width = width;
+        m_pendingFrame.height = height;
+        m_pendingSettings = settings;
+        m_hasPending = true;
+        m_submitted.fetch_add(1, std::memory_order_relaxed);
+        updateDepth();
+        m_wake.notify_one();
+    }
+
+    /// Newest completed result not yet taken (see ResultBuffer::takeFresh)
+    Result* takeFresh() { return m_results.takeFresh(); }
+
+    /// Finish the running job, drop the waiting one and join the worker
+    void stop() {
+        if (!running()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            if (m_hasPending) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                m_hasPending = false;
+            }
+            updateDepth();
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        m_results.reset();
+    }
+
+    AsyncStats stats() const {
+        AsyncStats stats;
+        stats.submitted = m_submitted.load(std::memory_order_relaxed);
+        stats.completed = m_completed.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped.load(std::memory_order_relaxed);
+        stats.queueDepth = m_depth.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    void run() {
+        setTraceThreadName(std::string(m_name) + " async");
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_hasPending || m_stopping; });
+                if (m_stopping) {
+                    return;
+                }
+                std::swap(m_workFrame, m_pendingFrame);
+                std::swap(m_workSettings, m_pendingSettings);
+                m_hasPending = false;
+                m_busy = true;
+                updateDepth();
+            }
+
+            {
+                TraceScope scope("cook", m_name);
+                m_job(m_workFrame, m_workSettings, m_results.back());
+            }
+            m_results.publish();
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+            updateDepth();
+        }
+    }
+
+    // Caller holds m_mutex
+    void updateDepth() {
+        m_depth.store((m_hasPending ? 1 : 0) + (m_busy ? 1 : 0), std::memory_order_relaxed);
+    }
+
+    ResultBuffer<Result> m_results;
+    const char* m_name = "operator";
+
+    Job m_job;
+    PinnedFrame m_pendingFrame;
+    PinnedFrame m_workFrame;
+    Settings m_pendingSettings;
+    Settings m_workSettings;
+    bool m_hasPending = false;
+    bool m_busy = false;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_completed{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<int> m_depth{0};
+};
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,213 @@
+/**
+ * @file blob_detector.cpp
+ * @brief Persistent multi-threshold blob detector
+ */
+
+#include "blob_detector.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace vivid::opencv::detail {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+template <typename T>
+void hashField(uint64_t& h, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char b : bytes) {
+        h = (h ^ b) * kFnvPrime;
+    }
+}
+
+} // namespace
+
+uint64_t BlobDetectorParams::hash() const {
+    uint64_t h = kFnvOffset;
+    hashField(h, minThreshold);
+    hashField(h, maxThreshold);
+    hashField(h, thresholdStep);
+    hashField(h, minRepeatability);
+    hashField(h, minDistBetweenBlobs);
+    hashField(h, filterByColor);
+    hashField(h, blobColor);
+    hashField(h, filterByArea);
+    hashField(h, minArea);
+    hashField(h, maxArea);
+    hashField(h, filterByCircularity);
+    hashField(h, minCircularity);
+    hashField(h, filterByInertia);
+    hashField(h, minInertiaRatio);
+    hashField(h, filterByConvexity);
+    hashField(h, minConvexity);
+    return h;
+}
+
+void BlobDetector::configure(const BlobDetectorParams& params) {
+    m_params = params;
+    m_params.thresholdStep = std::max(m_params.thresholdStep, 1.0f);
+    m_params.minRepeatability = std::max(m_params.minRepeatability, 1);
+}
+
+void BlobDetector::findBlobs(const cv::Mat& binary, CountedVector<Center>& centers) {
+    centers.clear();
+    cv::findContours(binary, m_contours, cv::RETR_LIST, cv::CHAIN_APPROX_NONE);
+
+    const BlobDetectorParams& p = m_params;
+    for (const auto& contour : m_contours) {
+        Center center;
+        center.confidence = 1.0;
+        cv::Moments moms = cv::moments(contour);
+
+        if (p.filterByArea) {
+            double area = moms.m00;
+            if (area < p.minArea || area >= p.maxArea) {
+                continue;
+            }
+        }
+
+        if (p.filterByCircularity) {
+            double area = moms.m00;
+            double perimeter = cv::arcLength(contour, true);
+            double ratio = 4 * CV_PI * area / (perimeter * perimeter);
+            if (ratio < p.minCircularity) {
+                continue;
+            }
+        }
+
+        if (p.filterByInertia) {
+            double denominator = std::sqrt(std::pow(2 * moms.mu11, 2) + std::pow(moms.mu20 - moms.mu02, 2));
+            double ratio = 1.0;
+            if (denominator > 1e-2) {
+                double cosmin = (moms.mu20 - moms.mu02) / denominator;
+                double sinmin = 2 * moms.mu11 / denominator;
+                double imin = 0.5 * (moms.mu20 + moms.mu02) - 0.5 * (moms.mu20 - moms.mu02) * cosmin - moms.mu11 * sinmin;
+                double imax = 0.5 * (moms.mu20 + moms.mu02) + 0.5 * (moms.mu20 - moms.mu02) * cosmin + moms.mu11 * sinmin;
+                ratio = imin / imax;
+            }
+            if (ratio < p.minInertiaRatio) {
+                continue;
+            }
+            center.confidence = ratio * ratio;
+        }
+
+        if (p.filterByConvexity) {
+            cv::convexHull(contour, m_hull);
+            double area = cv::contourArea(contour);
+            double hullArea = cv::contourArea(m_hull);
+            if (std::fabs(hullArea) < DBL_EPSILON) {
+                continue;
+            }
+            if (area / hullArea < p.minConvexity) {
+                continue;
+            }
+        }
+
+        if (moms.m00 == 0.0) {
+            continue;
+        }
+        center.location = cv::Point2d(moms.m10 / moms.m00, moms.m01 / moms.m00);
+
+        if (p.filterByColor) {
+            int cy = cvRound(center.location.y);
+            int cx = cvRound(center.location.x);
+            if (binary.at<uchar>(cy, cx) != p.blobColor) {
+                continue;
+            }
+        }
+
+        // Radius = median distance from the center to the contour
+        m_dists.clear();
+        for (const cv::Point& pt : contour) {
+            double dx = center.location.x - pt.x;
+            double dy = center.location.y - pt.y;
+            m_dists.push_back(std::sqrt(dx * dx + dy * dy));
+        }
+        std::sort(m_dists.begin(), m_dists.end());
+        size_t n = m_dists.size();
+        center.radius = (m_dists[(n - 1) / 2] + m_dists[n / 2]) / 2.0;
+
+        centers.push_back(center);
+    }
+}
+
+void BlobDetector::detect(const cv::Mat& gray, std::vector<cv::KeyPoint>& keypoints) {
+    keypoints.clear();
+    m_groupCount = 0;
+    if (gray.empty()) {
+        return;
+    }
+
+    const BlobDetectorParams& p = m_params;
+    for (float thresh = p.minThreshold; thresh < p.maxThreshold; thresh += p.thresholdStep) {
+        cv::threshold(gray, m_binary, thresh, 255, cv::THRESH_BINARY);
+        findBlobs(m_binary, m_current);
+
+        // Join each center to the group whose median center it lies within,
+        // keeping groups sorted by radius; otherwise start a new group
+        const size_t existing = m_groupCount;
+        for (const Center& cur : m_current) {
+            bool isNew = true;
+            for (size_t g = 0; g < existing; ++g) {
+                CountedVector<Center>& group = m_groups[g];
+                const Center& median = group[group.size() / 2];
+                double dist = cv::norm(median.location - cur.location);
+                isNew = dist >= p.minDistBetweenBlobs && dist >= median.radius && dist >= cur.radius;
+                if (!isNew) {
+                    group.push_back(cur);
+                    size_t k = group.size() - 1;
+                    while (k > 0 && cur.radius < group[k - 1].radius) {
+                        group[k] = group[k - 1];
+                        --k;
+                    }
+                    group[k] = cur;
+                    break;
+                }
+            }
+            if (isNew) {
+                // Reuse a previously grown group vector when one is available
+                if (m_groupCount == m_groups.size()) {
+                    m_groups.emplace_back();
+                }
+                CountedVector<Center>& group = m_groups[m_groupCount++];
+                group.clear();
+                group.push_back(cur);
+            }
+        }
+    }
+
+    for (size_t g = 0; g < m_groupCount; ++g) {
+        const CountedVector<Center>& group = m_groups[g];
+        if (group.size() < static_cast<size_t>(p.minRepeatability)) {
+            continue;
+        }
+        cv::Point2d sum(0, 0);
+        double normalizer = 0;
+        for (const Center& c : group) {
+            sum += c.confidence * c.location;
+            normalizer += c.confidence;
+        }
+        sum *= (1.0 / normalizer);
+        keypoints.emplace_back(cv::Point2f(static_cast<float>(sum.x), static_cast<float>(sum.y)),
+                               static_cast<float>(group[group.size() / 2].radius) * 2.0f);
+    }
+}
+
+void BlobDetector::clear() {
+    m_binary.release();
+    m_contours.clear();
+    m_contours.shrink_to_fit();
+    m_hull.clear();
+    m_dists.clear();
+    m_current.clear();
+    m_groups.clear();
+    m_groupCount = 0;
+}
+
+} // namespace vivid::opencv::detail
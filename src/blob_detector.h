@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file blob_detector.h
+ * @brief Persistent multi-threshold blob detector (internal)
+ */
+
+#include "alloc_counter.h"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Detection settings, mirroring cv::SimpleBlobDetector::Params
+ *
+ * A plain value type: building one per cook is free, and hash() gives a
+ * cheap change test so the detector is only reconfigured when a field
+ * actually changed.
+ */
+struct BlobDetectorParams {
+    float minThreshold = 50.0f;
+    float maxThreshold = 220.0f;
+    float thresholdStep = 10.0f;
+    int minRepeatability = 2;
+    float minDistBetweenBlobs = 10.0f;
+
+    bool filterByColor = true;
+    uint8_t blobColor = 0;
+
+    bool filterByArea = true;
+    float minArea = 25.0f;
+    float maxArea = 5000.0f;
+
+    bool filterByCircularity = false;
+    float minCircularity = 0.8f;
+
+    bool filterByInertia = true;
+    float minInertiaRatio = 0.1f;
+
+    bool filterByConvexity = true;
+    float minConvexity = 0.95f;
+
+    /// FNV-1a over every field (not the raw struct, which has padding)
+    uint64_t hash() const;
+};
+
+/**
+ * @brief Blob detector with the semantics of cv::SimpleBlobDetector
+ *
+ * The image is binarized at every threshold in [minThreshold, maxThreshold),
+ * contours are filtered by area, circularity, inertia and convexity, and
+ * centers found at minRepeatability or more thresholds are merged into one
+ * keypoint. Unlike SimpleBlobDetector the instance is long-lived:
+ * configure() only copies the params, and the binary image, contour,
+ * hull and grouping buffers are reused across detect() calls, so
+ * animating params does not allocate.
+ */
+class BlobDetector {
+public:
+    void configure(const BlobDetectorParams& params);
+    const BlobDetectorParams& params() const { return m_params; }
+
+    /// Detect blobs in an 8-bit single-channel image (appends nothing; clears first)
+    void detect(const cv::Mat& gray, std::vector<cv::KeyPoint>& keypoints);
+
+    /// Release scratch memory
+    void clear();
+
+private:
+    struct Center {
+        cv::Point2d location;
+        double radius;
+        double confidence;
+    };
+
+    void findBlobs(const cv::Mat& binary, CountedVector<Center>& centers);
+
+    BlobDetectorParams m_params;
+
+    // Scratch reused across detect() calls
+    cv::Mat m_binary;
+    std::vector<std::vector<cv::Point>> m_contours;
+    std::vector<cv::Point> m_hull;
+    CountedVector<double> m_dists;
+    CountedVector<Center> m_current;
+    CountedVector<CountedVector<Center>> m_groups;  // Only the first m_groupCount are live
+    size_t m_groupCount = 0;
+};
+
+} // namespace vivid::opencv::detail
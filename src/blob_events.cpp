@@ -0,0 +1,75 @@
+/**
+ * @file blob_events.cpp
+ * @brief Lock-free blob tracking event queue
+ */
+
+#include <vivid/opencv/blob_events.h>
+
+namespace vivid::opencv {
+
+BlobEventQueue::BlobEventQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+BlobEventQueue::~BlobEventQueue() = default;
+
+bool BlobEventQueue::tryPush(const BlobEvent& event) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[pos & m_mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // Slot is free for this position - claim it
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.event = event;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Consumers have not freed this slot yet: full
+            m_overflow.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer claimed it; retry at the new head
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BlobEventQueue::tryPop(BlobEvent& event) {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[pos & m_mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                event = slot.event;
+                // Hand the slot back to producers one lap later
+                slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // Empty
+        } else {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t BlobEventQueue::sizeApprox() const {
+    size_t head = m_dequeuePos.load(std::memory_order_relaxed);
+    size_t tail = m_enqueuePos.load(std::memory_order_relaxed);
+    return tail >= head ? tail - head : 0;
+}
+
+} // namespace vivid::opencv
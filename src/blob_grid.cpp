@@ -0,0 +1,293 @@
+/**
+ * @file blob_grid.cpp
+ * @brief Uniform-grid spatial index over tracked blobs
+ */
+
+#include <vivid/opencv/blob_grid.h>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv {
+
+namespace {
+
+// Keep the grid within a small multiple of the blob count so sparse scenes
+// do not pay for scanning empty cells
+constexpr size_t kMaxCellsPerBlob = 4;
+constexpr size_t kMinCells = 64;
+
+int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];  // Path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+} // namespace
+
+void BlobGrid::build(const std::vector<TrackedBlob>& blobs, float cellSize) {
+    const int n = static_cast<int>(blobs.size());
+    m_x.resize(n);
+    m_y.resize(n);
+    m_radius.resize(n);
+    m_index.resize(n);
+    m_cellOf.resize(n);
+
+    if (n == 0) {
+        m_cols = 0;
+        m_rows = 0;
+        m_cellStart.assign(1, 0);
+        return;
+    }
+
+    float minX = blobs[0].x, maxX = blobs[0].x;
+    float minY = blobs[0].y, maxY = blobs[0].y;
+    for (const TrackedBlob& b : blobs) {
+        minX = std::min(minX, b.x);
+        maxX = std::max(maxX, b.x);
+        minY = std::min(minY, b.y);
+        maxY = std::max(maxY, b.y);
+    }
+
+    // Size the grid, growing the cell if it would be too sparse
+    float cell = std::max(cellSize, 1.0f);
+    size_t maxCells = std::max(kMinCells, kMaxCellsPerBlob * static_cast<size_t>(n));
+    for (;;) {
+        m_cols = static_cast<int>((maxX - minX) / cell) + 1;
+        m_rows = static_cast<int>((maxY - minY) / cell) + 1;
+        if (static_cast<size_t>(m_cols) * static_cast<size_t>(m_rows) <= maxCells) {
+            break;
+        }
+        cell *= 2.0f;
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_cellSize = cell;
+    m_invCellSize = 1.0f / cell;
+
+    // Counting sort by cell: count, prefix-sum, scatter
+    const int cellCount = m_cols * m_rows;
+    m_cellStart.assign(cellCount + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        int cx = cellCoord(blobs[i].x, m_originX, m_cols);
+        int cy = cellCoord(blobs[i].y, m_originY, m_rows);
+        m_cellOf[i] = cy * m_cols + cx;
+        m_cellStart[m_cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cellCount; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+
+    // Scatter using the start offsets as cursors, then restore them
+    for (int i = 0; i < n; ++i) {
+        int slot = m_cellStart[m_cellOf[i]]++;
+        m_x[slot] = blobs[i].x;
+        m_y[slot] = blobs[i].y;
+        m_radius[slot] = blobs[i].size * 0.5f;
+        m_index[slot] = i;
+    }
+    for (int c = cellCount; c > 0; --c) {
+        m_cellStart[c] = m_cellStart[c - 1];
+    }
+    m_cellStart[0] = 0;
+}
+
+int BlobGrid::cellCoord(float v, float origin, int limit) const {
+    int c = static_cast<int>(std::floor((v - origin) * m_invCellSize));
+    return std::clamp(c, 0, limit - 1);
+}
+
+template<typename Fn>
+void BlobGrid::forEachInBox(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+    if (m_index.empty()) {
+        return;
+    }
+    int cx0 = cellCoord(minX, m_originX, m_cols);
+    int cx1 = cellCoord(maxX, m_originX, m_cols);
+    int cy0 = cellCoord(minY, m_originY, m_rows);
+    int cy1 = cellCoord(maxY, m_originY, m_rows);
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        // Cells in a row are adjacent, so a row span is one contiguous slot range
+        int begin = m_cellStart[cy * m_cols + cx0];
+        int end = m_cellStart[cy * m_cols + cx1 + 1];
+        for (int slot = begin; slot < end; ++slot) {
+            fn(slot);
+        }
+    }
+}
+
+void BlobGrid::queryRadius(float x, float y, float radius, std::vector<int>& out) const {
+    out.clear();
+    const float r2 = radius * radius;
+    forEachInBox(x - radius, y - radius, x + radius, y + radius, [&](int slot) {
+        float dx = m_x[slot] - x;
+        float dy = m_y[slot] - y;
+        if (dx * dx + dy * dy <= r2) {
+            out.push_back(m_index[slot]);
+        }
+    });
+}
+
+void BlobGrid::neighbors(int index, float radius, std::vector<int>& out) const {
+    out.clear();
+    if (index < 0 || index >= static_cast<int>(m_index.size())) {
+        return;
+    }
+
+    // Locate the blob's slot within its cell
+    int cell = m_cellOf[index];
+    int slot = m_cellStart[cell];
+    while (m_index[slot] != index) {
+        ++slot;
+    }
+
+    queryRadius(m_x[slot], m_y[slot], radius, out);
+    out.erase(std::remove(out.begin(), out.end(), index), out.end());
+}
+
+int BlobGrid::nearest(float x, float y, float maxDistance) const {
+    if (m_index.empty()) {
+        return -1;
+    }
+
+    int best = -1;
+    float bestDist2 = maxDistance * maxDistance;
+
+    // Search square rings of cells outward from the query cell; stop once
+    // the ring is farther away than the best match found so far
+    int qx = cellCoord(x, m_originX, m_cols);
+    int qy = cellCoord(y, m_originY, m_rows);
+    int maxRing = std::max(m_cols, m_rows);
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        // Every cell in this ring is at least (ring - 1) cells from the query
+        float ringDist = (ring - 1) * m_cellSize;
+        if (ringDist > 0.0f && ringDist * ringDist > bestDist2) {
+            break;
+        }
+
+        for (int cy = qy - ring; cy <= qy + ring; ++cy) {
+            if (cy < 0 || cy >= m_rows) {
+                continue;
+            }
+            bool edgeRow = (cy == qy - ring || cy == qy + ring);
+            for (int cx = qx - ring; cx <= qx + ring; cx += edgeRow ? 1 : 2 * ring) {
+                if (cx >= 0 && cx < m_cols) {
+                    int cell = cy * m_cols + cx;
+                    for (int slot = m_cellStart[cell]; slot < m_cellStart[cell + 1]; ++slot) {
+                        float dx = m_x[slot] - x;
+                        float dy = m_y[slot] - y;
+                        float d2 = dx * dx + dy * dy;
+                        if (d2 <= bestDist2) {
+                            bestDist2 = d2;
+                            best = m_index[slot];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+int BlobGrid::blobAt(float x, float y) const {
+    if (m_index.empty()) {
+        return -1;
+    }
+
+    float maxRadius = 0.0f;
+    for (float r : m_radius) {
+        maxRadius = std::max(maxRadius, r);
+    }
+
+    int best = -1;
+    float bestDist2 = std::numeric_limits<float>::infinity();
+    forEachInBox(x - maxRadius, y - maxRadius, x + maxRadius, y + maxRadius, [&](int slot) {
+        float dx = m_x[slot] - x;
+        float dy = m_y[slot] - y;
+        float d2 = dx * dx + dy * dy;
+        if (d2 <= m_radius[slot] * m_radius[slot] && d2 < bestDist2) {
+            bestDist2 = d2;
+            best = m_index[slot];
+        }
+    });
+    return best;
+}
+
+void BlobGrid::pairsWithin(float radius, std::vector<std::pair<int, int>>& out) const {
+    out.clear();
+    const float r2 = radius * radius;
+    const int n = static_cast<int>(m_index.size());
+
+    for (int slot = 0; slot < n; ++slot) {
+        const float x = m_x[slot];
+        const float y = m_y[slot];
+        const int self = m_index[slot];
+        forEachInBox(x - radius, y - radius, x + radius, y + radius, [&](int other) {
+            // Each pair is visited from both ends; keep the one with the lower index first
+            int otherIndex = m_index[other];
+            if (otherIndex <= self) {
+                return;
+            }
+            float dx = m_x[other] - x;
+            float dy = m_y[other] - y;
+            if (dx * dx + dy * dy <= r2) {
+                out.emplace_back(self, otherIndex);
+            }
+        });
+    }
+}
+
+int BlobGrid::cluster(float linkDistance, std::vector<int>& labels) const {
+    const int n = static_cast<int>(m_index.size());
+    labels.assign(n, -1);
+    if (n == 0) {
+        return 0;
+    }
+
+    // Union-find over original blob indices
+    m_parent.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_parent[i] = i;
+    }
+
+    const float r2 = linkDistance * linkDistance;
+    for (int slot = 0; slot < n; ++slot) {
+        const float x = m_x[slot];
+        const float y = m_y[slot];
+        const int self = m_index[slot];
+        forEachInBox(x - linkDistance, y - linkDistance, x + linkDistance, y + linkDistance,
+                     [&](int other) {
+            int otherIndex = m_index[other];
+            if (otherIndex <= self) {
+                return;
+            }
+            float dx = m_x[other] - x;
+            float dy = m_y[other] - y;
+            if (dx * dx + dy * dy <= r2) {
+                int a = findRoot(m_parent, self);
+                int b = findRoot(m_parent, otherIndex);
+                if (a != b) {
+                    // Lower index becomes the root so labels follow blob order
+                    m_parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        });
+    }
+
+    // Number clusters in order of their lowest blob index
+    int count = 0;
+    m_slotOf.assign(n, -1);
+    for (int i = 0; i < n; ++i) {
+        int root = findRoot(m_parent, i);
+        if (m_slotOf[root] < 0) {
+            m_slotOf[root] = count++;
+        }
+        labels[i] = m_slotOf[root];
+    }
+    return count;
+}
+
+} // namespace vivid::opencv
@@ -6,27 +6,176 @@
 #include <vivid/opencv/blob_track.h>
 #include <vivid/context.h>
 #include <vivid/chain.h>
+#include "async_cook.h"
+#include "blob_detector.h"
+#include "blob_tracker.h"
+#include "frame_cache.h"
+#include "kernels.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
-#include <opencv2/features2d.hpp>
+#include <algorithm>
 #include <cmath>
+#include <unordered_map>
 
 namespace vivid::opencv {
 
+namespace {
+
+// Stages timed by BlobTrack::Impl::profile (same order as its names)
+enum BlobStage : int {
+    StageCvtColor,
+    StageMask,
+    StageDetect,
+    StageTrack,
+    StageIndex,
+    StageDraw,
+    StageAssign,
+    StageSnapshot,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
 // PIMPL - hides OpenCV types from header
 struct BlobTrack::Impl {
-    cv::Ptr<cv::SimpleBlobDetector> detector;
-    std::vector<cv::KeyPoint> keypoints;
-
-    // Cached detector params to detect when we need to recreate
-    float lastMinArea = -1;
-    float lastMaxArea = -1;
-    float lastMinCircularity = -1;
-    float lastMinConvexity = -1;
-    float lastMinInertia = -1;
-    int lastDetectBright = -1;
-    int lastDetectDark = -1;
-    float lastThreshold = -1;
+    // Param snapshot taken on the chain thread
+    struct Settings {
+        detail::BlobDetectorParams detector;
+        int mode = 0;
+        bool colorMode = false;
+        bool foregroundMode = false;
+        kernels::HsvRange range;
+        kernels::BackgroundParams background;
+        bool resetBackground = false;
+        float threshold = 128.0f;
+        bool bright = true;
+        bool dark = false;
+        float minArea = 0.0f;
+        float maxArea = 0.0f;
+        int slices = 1;
+        int overlap = 0;
+        float maxDistance = 50.0f;
+        int persistence = 5;
+        double captureTime = 0.0;
+        double targetTime = 0.0;
+        float smoothing = 0.5f;
+        int historyLength = 0;
+        float gridCellSize = 64.0f;
+        float clusterDistance = 0.0f;
+        float moveThreshold = 1.0f;
+        bool drawTrails = false;
+        std::shared_ptr<BlobEventQueue> events;
+        int threads = 0;
+        FrameStamp stamp;  // Input frame this cook works on
+        const Operator* input = nullptr;  // Its source and FrameCache key, for pinned copies
+        uint64_t frameKey = 0;
+    };
+
+    // Completed background cook: the output plus a copy of what the accessors expose
+    struct Result {
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        std::vector<TrackedBlob> tracks;
+        BlobGrid grid;
+        int clusterCount = 0;
+        PredictionStats predictionError;
+        FrameStamp stamp;
+
+        // Trajectories flattened oldest-first; track i owns [trailStart[i], trailStart[i + 1])
+        std::vector<float> trailX;
+        std::vector<float> trailY;
+        std::vector<double> trailTime;
+        std::vector<size_t> trailStart;
+
+        TrajectoryView trajectory(size_t index) const {
+            TrajectoryView view;
+            size_t first = trailStart[index];
+            view.xs = trailX.data() + first;
+            view.ys = trailY.data() + first;
+            view.times = trailTime.data() + first;
+            view.capacity = static_cast<int>(trailStart[index + 1] - first);
+            view.count = view.capacity;
+            return view;
+        }
+    };
+
+    detail::BlobDetector detector;
+    std::vector<cv::KeyPoint> keypoints;   // Last complete detection
+    std::vector<double> keypointTimes;     // Capture time of each (sliced detection)
+    detail::BlobTracker tracker;
+
+    // Time-sliced detection state
+    std::vector<cv::KeyPoint> pending;     // Detections gathered from bands so far
+    std::vector<double> pendingTimes;      // Capture time of the band each came from
+    std::vector<cv::KeyPoint> bandKeypoints;
+    int sliceIndex = 0;
+    int lastSliceCount = -1;
+    int lastWidth = 0;
+    int lastHeight = 0;
+    cv::Mat roiMask;                       // Scratch for per-track refinement
+    cv::Mat colorMask;                     // Fused HSV in-range output (Color mode)
+
+    // Drawing scratch, reused across cooks
+    cv::Mat output;                        // BGRA copy of the input, drawn over
+    cv::Mat contourBinary;                 // Thresholded luma for contour outlines
+    std::vector<std::vector<cv::Point>> contours;
+
+    // Running background model (Foreground mode)
+    cv::Mat bgMean;                        // CV_32F per-pixel mean luma
+    cv::Mat bgVar;                         // CV_32F per-pixel luma variance
+    cv::Mat fgMask;
+    bool bgValid = false;
+
+    // Latency compensation: per-cook overrides (negative = unset)
+    double captureTimeOverride = -1.0;
+    double targetTimeOverride = -1.0;
+
+    // Spatial index and clustering
+    BlobGrid grid;
+    std::vector<int> clusterLabels;
+    int clusterCount = 0;
+
+    // Event publishing
+    std::shared_ptr<BlobEventQueue> events = std::make_shared<BlobEventQueue>();
+    std::unordered_map<int, cv::Point2f> lastEmitted;  // Position at each track's last event
+
+    // Hash of the params the detector was last configured with (0 = never)
+    uint64_t detectorHash = 0;
+    int lastDetectMode = -1;
+
+    // Background cooking
+    Result published;                      // Accessor state while async is on
+    bool asyncActive = false;
+    bool backgroundResetRequested = false; // Set by resetBackground(), consumed by the next snapshot
+
+    // Detect, track and draw one frame into `pixels` (BGRA, size of `input`).
+    // `luma` is the frame's grayscale, unused (may be empty) in Color mode.
+    void cook(const Settings& s, const cv::Mat& input, const cv::Mat& luma,
+              std::vector<uint8_t>& pixels);
+
+    // Copy the accessor-visible state into `result`
+    void snapshot(Result& result) const;
+
+    // Stamp `owner`'s output with the frame it came from
+    void publishStamp(const Operator* owner, const FrameStamp& stamp) {
+        profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                              detail::FrameStamps::instance().publish(owner, "BlobTrack", stamp));
+    }
+
+    mutable detail::StageProfile profile{"BlobTrack", {"cvtColor", "mask", "detect", "track",
+                                                       "index", "draw", "assign", "snapshot",
+                                                       "process", "cookLatency",
+                                                       "pipelineLatency"}};
+
+    // Declared last: the worker is joined before the state above is destroyed
+    detail::AsyncCooker<Result, Settings> cooker;
 };
 
 BlobTrack::BlobTrack() : m_impl(std::make_unique<Impl>()) {
@@ -38,19 +187,205 @@ BlobTrack::BlobTrack() : m_impl(std::make_unique<Impl>()) {
     registerParam(detectBright);
     registerParam(detectDark);
     registerParam(threshold);
+    registerParam(detectMode);
+    registerParam(hueMin);
+    registerParam(hueMax);
+    registerParam(satMin);
+    registerParam(satMax);
+    registerParam(valMin);
+    registerParam(valMax);
+    registerParam(bgLearnRate);
+    registerParam(fgSigma);
+    registerParam(fgMinDiff);
+    registerParam(sliceCount);
+    registerParam(sliceOverlap);
+    registerParam(trackDistance);
+    registerParam(trackPersistence);
+    registerParam(moveThreshold);
+    registerParam(predictAhead);
+    registerParam(predictSmoothing);
+    registerParam(gridCellSize);
+    registerParam(clusterDistance);
+    registerParam(historyLength);
+    registerParam(drawTrails);
+    registerParam(async);
+    registerParam(threads);
+
+    m_impl->cooker.setName("BlobTrack");
 }
 
 BlobTrack::~BlobTrack() = default;
 
+namespace {
+
+// Add band detections to the pending set. A band owns the blobs whose centers
+// fall inside its core rows; the overlap only provides context so blobs that
+// straddle a band boundary are still seen whole. Near-duplicates from
+// adjacent bands are collapsed to the larger (less clipped) keypoint.
+// `pendingTimes` keeps the capture time of each pending keypoint.
+void mergeBand(std::vector<cv::KeyPoint>& pending, std::vector<double>& pendingTimes,
+               const std::vector<cv::KeyPoint>& band, double time,
+               float offsetY, float coreTop, float coreBottom) {
+    for (cv::KeyPoint kp : band) {
+        kp.pt.y += offsetY;
+        if (kp.pt.y < coreTop || kp.pt.y >= coreBottom) {
+            continue;
+        }
+
+        bool merged = false;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            cv::KeyPoint& existing = pending[i];
+            float dx = existing.pt.x - kp.pt.x;
+            float dy = existing.pt.y - kp.pt.y;
+            float r = std::max(existing.size, kp.size) * 0.5f;
+            if (dx * dx + dy * dy < r * r) {
+                if (kp.size > existing.size) {
+                    existing = kp;
+                    pendingTimes[i] = time;
+                }
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            pending.push_back(kp);
+            pendingTimes.push_back(time);
+        }
+    }
+}
+
+// Margin around a blob's radius searched by refineTracks(). Small enough that
+// a neighbouring blob a few pixels away stays outside the window and can't
+// pull the centroid over.
+constexpr float kRefineMargin = 8.0f;
+
+// Re-center each live track on the thresholded mass in a small window around
+// its predicted position. Cost scales with the number of tracks, not the frame.
+void refineTracks(detail::BlobTracker& tracker, const cv::Mat& gray, cv::Mat& scratch,
+                  float thresh, bool bright, bool dark, double timestamp) {
+    const cv::Rect frame(0, 0, gray.cols, gray.rows);
+
+    for (size_t i = 0; i < tracker.tracks().size(); ++i) {
+        const TrackedBlob& track = tracker.tracks()[i];
+        float r = std::max(track.size * 0.5f + kRefineMargin, 8.0f);
+        float t = static_cast<float>(std::clamp(timestamp - track.timestamp, 0.0, 0.25));
+        float cx = track.x + track.vx * t;
+        float cy = track.y + track.vy * t;
+        cv::Rect window(static_cast<int>(cx - r), static_cast<int>(cy - r),
+                        static_cast<int>(2 * r) + 1, static_cast<int>(2 * r) + 1);
+        window &= frame;
+        if (window.empty()) {
+            tracker.miss(i);
+            continue;
+        }
+
+        // When both polarities are enabled, follow whichever the track center shows
+        bool trackBright = bright;
+        if (bright && dark) {
+            int px = std::clamp(static_cast<int>(track.x), 0, gray.cols - 1);
+            int py = std::clamp(static_cast<int>(track.y), 0, gray.rows - 1);
+            trackBright = gray.at<uint8_t>(py, px) >= thresh;
+        }
+
+        // Windows vary in size; threshold into a view of one buffer that only grows
+        if (scratch.total() < static_cast<size_t>(window.area())) {
+            scratch.create(1, window.area(), CV_8UC1);
+        }
+        cv::Mat binary(window.size(), CV_8UC1, scratch.data);
+        cv::threshold(gray(window), binary, thresh, 255,
+                      trackBright ? cv::THRESH_BINARY : cv::THRESH_BINARY_INV);
+        cv::Moments m = cv::moments(binary, true);
+        if (m.m00 <= 0.0) {
+            tracker.miss(i);
+            continue;
+        }
+
+        tracker.observe(i,
+                        window.x + static_cast<float>(m.m10 / m.m00),
+                        window.y + static_cast<float>(m.m01 / m.m00),
+                        2.0f * std::sqrt(static_cast<float>(m.m00) / static_cast<float>(CV_PI)),
+                        timestamp);
+    }
+}
+
+// Emit enter/move/leave events for the changes made by this cook's tracking step
+void publishEvents(BlobEventQueue& queue, const detail::BlobTracker& tracker,
+                   std::unordered_map<int, cv::Point2f>& lastEmitted,
+                   float moveThreshold, double timestamp, uint64_t frame) {
+    auto emit = [&](BlobEventType type, const TrackedBlob& track) {
+        BlobEvent event;
+        event.type = type;
+        event.trackId = track.id;
+        event.x = track.x;
+        event.y = track.y;
+        event.size = track.size;
+        event.timestamp = timestamp;
+        event.frame = frame;
+        queue.tryPush(event);  // Overflow is counted by the queue
+    };
+
+    for (const TrackedBlob& track : tracker.removed()) {
+        emit(BlobEventType::Leave, track);
+        lastEmitted.erase(track.id);
+    }
+
+    const float moveThreshold2 = moveThreshold * moveThreshold;
+    for (const TrackedBlob& track : tracker.tracks()) {
+        if (track.age == 0) {
+            emit(BlobEventType::Enter, track);
+            lastEmitted[track.id] = cv::Point2f(track.x, track.y);
+            continue;
+        }
+        if (track.missed > 0) {
+            continue;
+        }
+        auto it = lastEmitted.find(track.id);
+        if (it == lastEmitted.end()) {
+            continue;
+        }
+        float dx = track.x - it->second.x;
+        float dy = track.y - it->second.y;
+        if (dx * dx + dy * dy >= moveThreshold2) {
+            emit(BlobEventType::Move, track);
+            it->second = cv::Point2f(track.x, track.y);
+        }
+    }
+}
+
+} // namespace
+
 void BlobTrack::cleanup() {
+    m_impl->cooker.stop();
+    m_impl->asyncActive = false;
+    m_impl->published = Impl::Result{};
+    m_impl->backgroundResetRequested = false;
     m_outputPixels.clear();
     m_outputWidth = 0;
     m_outputHeight = 0;
-    m_impl->detector.release();
+    m_impl->detector.clear();
+    detail::FrameCache::instance().release(this);
+    detail::FrameStamps::instance().release(this);
+    m_impl->detectorHash = 0;
     m_impl->keypoints.clear();
+    m_impl->colorMask.release();
+    m_impl->bgMean.release();
+    m_impl->bgVar.release();
+    m_impl->fgMask.release();
+    m_impl->bgValid = false;
+    m_impl->tracker.reset();
+    m_impl->lastEmitted.clear();
+    m_impl->grid.build({}, 1.0f);
+    m_impl->clusterCount = 0;
+    m_impl->pending.clear();
+    m_impl->pendingTimes.clear();
+    m_impl->keypointTimes.clear();
+    m_impl->sliceIndex = 0;
 }
 
 void BlobTrack::init(Context& ctx) {
+    detail::ensureThreadPool();
+    kernels::initDispatch();
+    detail::installAllocCounter();
     matchInputResolution(0);
 }
 
@@ -61,6 +396,258 @@ Operator::CpuPixelView BlobTrack::cpuPixelView() const {
     return {m_outputPixels.data(), m_outputWidth, m_outputHeight, 4, 0};
 }
 
+void BlobTrack::Impl::cook(const Settings& s, const cv::Mat& input, const cv::Mat& luma,
+                           std::vector<uint8_t>& pixels) {
+    const int width = input.cols;
+    const int height = input.rows;
+    const bool maskMode = s.colorMode || s.foregroundMode;
+    VIVID_OPENCV_STAGE_CLOCK(clock, profile);
+
+    // Reconfigure the persistent detector in place only when something changed
+    uint64_t paramsHash = s.detector.hash();
+    if (paramsHash != detectorHash) {
+        detector.configure(s.detector);
+        detectorHash = paramsHash;
+    }
+
+    if (lastDetectMode != s.mode || s.resetBackground) {
+        bgValid = false;  // Don't resume from a stale background
+        lastDetectMode = s.mode;
+    }
+
+    // Single-channel image fed to the labeling stage
+    cv::Mat gray;
+    float thresh = s.threshold;
+    bool bright = s.bright;
+    bool dark = s.dark;
+
+    if (s.colorMode) {
+        // Fused BGRA -> HSV -> in-range mask, no intermediate HSV image
+        colorMask.create(height, width, CV_8UC1);
+        kernels::bgraToHsvMask(input.data, input.step, colorMask.data, colorMask.step,
+                               width, height, s.range);
+        gray = colorMask;
+    } else if (s.foregroundMode) {
+        // (Re)learn from this frame when the model is unset or the size changed
+        if (!bgValid || bgMean.rows != height || bgMean.cols != width) {
+            luma.convertTo(bgMean, CV_32F);
+            bgVar.create(height, width, CV_32F);
+            bgVar.setTo(cv::Scalar(0));
+            bgValid = true;
+        }
+
+        fgMask.create(height, width, CV_8UC1);
+        kernels::updateBackground(luma.data, luma.step,
+                                  bgMean.ptr<float>(), bgVar.ptr<float>(),
+                                  fgMask.data, fgMask.step,
+                                  width, height, s.background);
+
+        // Remove single-pixel noise before labeling
+        cv::morphologyEx(fgMask, fgMask, cv::MORPH_OPEN, cv::Mat());
+        gray = fgMask;
+    } else {
+        gray = luma;
+    }
+    if (maskMode) {
+        VIVID_OPENCV_STAGE_LAP(clock, StageMask);
+    }
+
+    if (maskMode) {
+        // Downstream stages see a bright-on-black binary image
+        thresh = 127.0f;
+        bright = true;
+        dark = false;
+    }
+
+    tracker.setSmoothing(s.smoothing);
+    tracker.setHistoryLength(s.historyLength);
+
+    // Restart the slice cycle when its geometry changes
+    const int slices = s.slices;
+    if (slices != lastSliceCount || width != lastWidth || height != lastHeight) {
+        pending.clear();
+        pendingTimes.clear();
+        sliceIndex = 0;
+        lastSliceCount = slices;
+        lastWidth = width;
+        lastHeight = height;
+    }
+
+    if (slices == 1) {
+        // Detect blobs over the whole frame
+        keypoints.clear();
+        detector.detect(gray, keypoints);
+        VIVID_OPENCV_STAGE_LAP(clock, StageDetect);
+        tracker.update(keypoints, s.maxDistance, s.persistence, s.captureTime);
+    } else {
+        // Scan one band (plus overlap) and keep existing tracks current
+        int bandHeight = (height + slices - 1) / slices;
+        int coreTop = std::min(height, sliceIndex * bandHeight);
+        int coreBottom = std::min(height, coreTop + bandHeight);
+        int top = std::max(0, coreTop - s.overlap);
+        int bottom = std::min(height, coreBottom + s.overlap);
+
+        if (bottom - top >= 2) {
+            bandKeypoints.clear();
+            detector.detect(gray.rowRange(top, bottom), bandKeypoints);
+            mergeBand(pending, pendingTimes, bandKeypoints, s.captureTime, static_cast<float>(top),
+                      static_cast<float>(coreTop), static_cast<float>(coreBottom));
+        }
+        VIVID_OPENCV_STAGE_LAP(clock, StageDetect);
+
+        // Existing tracks are measured on this frame every cook
+        refineTracks(tracker, gray, roiMask, thresh, bright, dark, s.captureTime);
+
+        if (++sliceIndex >= slices) {
+            // Full cycle done - publish the complete detection. Band results
+            // are up to a cycle old: each is matched against its track
+            // back-projected to the band's capture time, and only updates
+            // tracks refineTracks lost since (it already counted this cook's
+            // misses). Otherwise the detection only drives births and retirements.
+            keypoints.swap(pending);
+            keypointTimes.swap(pendingTimes);
+            pending.clear();
+            pendingTimes.clear();
+            sliceIndex = 0;
+            tracker.update(keypoints, keypointTimes, s.maxDistance, s.persistence);
+        } else {
+            tracker.age();
+        }
+    }
+
+    // Extrapolate every track to the presentation time
+    tracker.predict(s.targetTime);
+    bool predicting = s.targetTime > s.captureTime;
+    VIVID_OPENCV_STAGE_LAP(clock, StageTrack);
+
+    // Rebuild the spatial index and (optionally) cluster nearby blobs
+    auto& tracks = tracker.tracks();
+    grid.build(tracks, s.gridCellSize);
+    if (s.clusterDistance > 0.0f) {
+        clusterCount = grid.cluster(s.clusterDistance, clusterLabels);
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            tracks[i].cluster = clusterLabels[i];
+        }
+    } else {
+        clusterCount = 0;
+        for (TrackedBlob& track : tracks) {
+            track.cluster = -1;
+        }
+    }
+
+    // Publish tracking changes to other threads
+    if (s.events) {
+        publishEvents(*s.events, tracker, lastEmitted, s.moveThreshold,
+                      s.captureTime, s.stamp.frameId);
+    }
+    VIVID_OPENCV_STAGE_LAP(clock, StageIndex);
+
+    // Create output with visualization
+    input.copyTo(output);
+
+    // Contour outlines need a full-frame pass, so they are only drawn when
+    // the whole frame is scanned every cook
+    if (slices == 1) {
+        // Threshold image to find contours
+        const cv::Mat* binary = &contourBinary;
+        if (maskMode) {
+            binary = &gray;  // Mask is already binary
+        } else if (bright && !dark) {
+            cv::threshold(gray, contourBinary, thresh, 255, cv::THRESH_BINARY);
+        } else if (!bright && dark) {
+            cv::threshold(gray, contourBinary, thresh, 255, cv::THRESH_BINARY_INV);
+        } else {
+            // For both, use regular threshold
+            cv::threshold(gray, contourBinary, thresh, 255, cv::THRESH_BINARY);
+        }
+
+        // Find contours for visualization
+        cv::findContours(*binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+        // Draw contours that match detected blob locations
+        for (size_t i = 0; i < contours.size(); ++i) {
+            double area = cv::contourArea(contours[i]);
+            if (area >= s.minArea && area <= s.maxArea) {
+                // Draw the contour outline
+                cv::drawContours(output, contours, static_cast<int>(i),
+                                 cv::Scalar(0, 255, 0, 255), 2, cv::LINE_AA);
+            }
+        }
+    }
+
+    // Draw markers (and trails) for tracks seen this cook
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const TrackedBlob& track = tracks[i];
+        if (track.missed > 0) {
+            continue;
+        }
+        int x = static_cast<int>(track.x);
+        int y = static_cast<int>(track.y);
+        int radius = static_cast<int>(track.size / 2);
+
+        // Trail fades in from the oldest sample (orange); plain 8-connected
+        // segments keep this cheap for long histories
+        if (s.drawTrails) {
+            TrajectoryView trail = tracker.trajectory(i);
+            for (int k = 1; k < trail.count; ++k) {
+                double alpha = 255.0 * k / trail.count;
+                cv::line(output,
+                         cv::Point(static_cast<int>(trail.x(k - 1)), static_cast<int>(trail.y(k - 1))),
+                         cv::Point(static_cast<int>(trail.x(k)), static_cast<int>(trail.y(k))),
+                         cv::Scalar(0, 128, 255, alpha), 2, cv::LINE_8);
+            }
+        }
+
+        // Draw bounding circle (yellow)
+        cv::circle(output, cv::Point(x, y), radius, cv::Scalar(0, 255, 255, 200), 2, cv::LINE_AA);
+
+        // Draw center crosshair (magenta)
+        int cross = 8;
+        cv::line(output, cv::Point(x - cross, y), cv::Point(x + cross, y),
+                 cv::Scalar(255, 0, 255, 255), 2, cv::LINE_AA);
+        cv::line(output, cv::Point(x, y - cross), cv::Point(x, y + cross),
+                 cv::Scalar(255, 0, 255, 255), 2, cv::LINE_AA);
+
+        // Lead line to the predicted position (cyan)
+        if (predicting) {
+            cv::Point predicted(static_cast<int>(track.predictedX), static_cast<int>(track.predictedY));
+            cv::line(output, cv::Point(x, y), predicted, cv::Scalar(255, 255, 0, 255), 2, cv::LINE_AA);
+            cv::circle(output, predicted, 4, cv::Scalar(255, 255, 0, 255), cv::FILLED, cv::LINE_AA);
+        }
+    }
+
+    VIVID_OPENCV_STAGE_LAP(clock, StageDraw);
+
+    // Store output in CPU pixel buffer (BGRA format)
+    size_t dataSize = output.total() * output.elemSize();
+    pixels.assign(output.data, output.data + dataSize);
+    VIVID_OPENCV_STAGE_LAP(clock, StageAssign);
+}
+
+void BlobTrack::Impl::snapshot(Result& result) const {
+    VIVID_OPENCV_STAGE_SCOPE(profile, StageSnapshot);
+    const auto& tracks = tracker.tracks();
+    result.tracks = tracks;  // Reuses the slot's capacity once warmed up
+    result.grid = grid;
+    result.clusterCount = clusterCount;
+    result.predictionError = tracker.predictionError();
+
+    result.trailX.clear();
+    result.trailY.clear();
+    result.trailTime.clear();
+    result.trailStart.clear();
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        result.trailStart.push_back(result.trailX.size());
+        TrajectoryView trail = tracker.trajectory(i);
+        for (int k = 0; k < trail.count; ++k) {
+            result.trailX.push_back(trail.x(k));
+            result.trailY.push_back(trail.y(k));
+            result.trailTime.push_back(trail.time(k));
+        }
+    }
+    result.trailStart.push_back(result.trailX.size());
+}
+
 void BlobTrack::process(Context& ctx) {
     if (!needsCook()) {
         return;
@@ -86,133 +673,251 @@ void BlobTrack::process(Context& ctx) {
         return;
     }
 
-    // Check if detector params changed - recreate detector if needed
-    bool paramsChanged =
-        m_impl->lastMinArea != static_cast<float>(minArea) ||
-        m_impl->lastMaxArea != static_cast<float>(maxArea) ||
-        m_impl->lastMinCircularity != static_cast<float>(minCircularity) ||
-        m_impl->lastMinConvexity != static_cast<float>(minConvexity) ||
-        m_impl->lastMinInertia != static_cast<float>(minInertia) ||
-        m_impl->lastDetectBright != static_cast<int>(detectBright) ||
-        m_impl->lastDetectDark != static_cast<int>(detectDark) ||
-        m_impl->lastThreshold != static_cast<float>(threshold);
-
-    if (!m_impl->detector || paramsChanged) {
-        cv::SimpleBlobDetector::Params params;
-
-        // Threshold parameters
+    // Cap the threads OpenCV and our kernels may use for this cook
+    detail::ThreadBudget budget(static_cast<int>(threads));
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+
+    Impl::Settings s;
+    s.mode = static_cast<int>(detectMode);
+    s.colorMode = s.mode == static_cast<int>(BlobDetectMode::Color);
+    s.foregroundMode = s.mode == static_cast<int>(BlobDetectMode::Foreground);
+    bool maskMode = s.colorMode || s.foregroundMode;  // Detection runs on a binary mask
+
+    // Build detector params from the current param values (plain struct, no allocation)
+    detail::BlobDetectorParams& params = s.detector;
+
+    // Threshold parameters
+    if (maskMode) {
+        // The mask is already binary; two levels satisfy minRepeatability
+        params.minThreshold = 100;
+        params.maxThreshold = 160;
+        params.thresholdStep = 30;
+    } else {
         params.minThreshold = static_cast<float>(threshold) - 50;
         params.maxThreshold = static_cast<float>(threshold) + 50;
         params.thresholdStep = 10;
+    }
 
-        // Area filter
-        params.filterByArea = true;
-        params.minArea = static_cast<float>(minArea);
-        params.maxArea = static_cast<float>(maxArea);
-
-        // Circularity filter
-        params.filterByCircularity = static_cast<float>(minCircularity) > 0.01f;
-        params.minCircularity = static_cast<float>(minCircularity);
-
-        // Convexity filter
-        params.filterByConvexity = static_cast<float>(minConvexity) > 0.01f;
-        params.minConvexity = static_cast<float>(minConvexity);
-
-        // Inertia filter (elongation)
-        params.filterByInertia = static_cast<float>(minInertia) > 0.01f;
-        params.minInertiaRatio = static_cast<float>(minInertia);
-
-        // Color filter
-        params.filterByColor = true;
-        if (static_cast<int>(detectBright) && !static_cast<int>(detectDark)) {
-            params.blobColor = 255;  // Bright blobs only
-        } else if (!static_cast<int>(detectBright) && static_cast<int>(detectDark)) {
-            params.blobColor = 0;    // Dark blobs only
-        } else {
-            params.filterByColor = false;  // Both
-        }
+    // Area filter
+    params.filterByArea = true;
+    params.minArea = static_cast<float>(minArea);
+    params.maxArea = static_cast<float>(maxArea);
+
+    // Circularity filter
+    params.filterByCircularity = static_cast<float>(minCircularity) > 0.01f;
+    params.minCircularity = static_cast<float>(minCircularity);
+
+    // Convexity filter
+    params.filterByConvexity = static_cast<float>(minConvexity) > 0.01f;
+    params.minConvexity = static_cast<float>(minConvexity);
+
+    // Inertia filter (elongation)
+    params.filterByInertia = static_cast<float>(minInertia) > 0.01f;
+    params.minInertiaRatio = static_cast<float>(minInertia);
+
+    // Color filter
+    params.filterByColor = true;
+    if (maskMode) {
+        params.blobColor = 255;  // Mask marks in-range / foreground pixels
+    } else if (static_cast<int>(detectBright) && !static_cast<int>(detectDark)) {
+        params.blobColor = 255;  // Bright blobs only
+    } else if (!static_cast<int>(detectBright) && static_cast<int>(detectDark)) {
+        params.blobColor = 0;    // Dark blobs only
+    } else {
+        params.filterByColor = false;  // Both
+    }
 
-        m_impl->detector = cv::SimpleBlobDetector::create(params);
+    s.range.hueMin = static_cast<float>(hueMin);
+    s.range.hueMax = static_cast<float>(hueMax);
+    s.range.satMin = cv::saturate_cast<uint8_t>(static_cast<float>(satMin));
+    s.range.satMax = cv::saturate_cast<uint8_t>(static_cast<float>(satMax));
+    s.range.valMin = cv::saturate_cast<uint8_t>(static_cast<float>(valMin));
+    s.range.valMax = cv::saturate_cast<uint8_t>(static_cast<float>(valMax));
+
+    s.background.learnRate = static_cast<float>(bgLearnRate);
+    s.background.sigma = static_cast<float>(fgSigma);
+    s.background.minDiff = static_cast<float>(fgMinDiff);
+    s.resetBackground = m_impl->backgroundResetRequested;
+    m_impl->backgroundResetRequested = false;
+
+    s.threshold = static_cast<float>(threshold);
+    s.bright = static_cast<int>(detectBright) != 0;
+    s.dark = static_cast<int>(detectDark) != 0;
+    s.minArea = static_cast<float>(minArea);
+    s.maxArea = static_cast<float>(maxArea);
+    s.slices = std::max(1, static_cast<int>(sliceCount));
+    s.overlap = std::max(0, static_cast<int>(sliceOverlap));
+    s.maxDistance = static_cast<float>(trackDistance);
+    s.persistence = static_cast<int>(trackPersistence);
+
+    // Capture time of this frame, and the time positions are predicted to
+    detail::ReceivedFrame received = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+    s.stamp = received.stamp;
+    s.input = inputOp;
+    s.frameKey = received.key;
+    s.captureTime = m_impl->captureTimeOverride >= 0.0
+        ? m_impl->captureTimeOverride : s.stamp.captureTime;
+    s.targetTime = m_impl->targetTimeOverride >= 0.0
+        ? m_impl->targetTimeOverride
+        : s.captureTime + static_cast<float>(predictAhead) * 0.001;
+    m_impl->captureTimeOverride = -1.0;
+    m_impl->targetTimeOverride = -1.0;
+
+    s.smoothing = static_cast<float>(predictSmoothing);
+    s.historyLength = static_cast<int>(historyLength);
+    s.gridCellSize = static_cast<float>(gridCellSize);
+    s.clusterDistance = static_cast<float>(clusterDistance);
+    s.moveThreshold = static_cast<float>(moveThreshold);
+    s.drawTrails = static_cast<int>(drawTrails) != 0;
+    s.events = m_impl->events;
+
+    s.threads = static_cast<int>(threads);
+
+    Impl* impl = m_impl.get();
+
+    if (static_cast<int>(async) != 0) {
+        // Hand the frame to the worker and publish whatever finished last
+        impl->asyncActive = true;
+        if (!impl->cooker.configured()) {
+            impl->cooker.configure(
+                [this, impl](const detail::PinnedFrame& frame, const Impl::Settings& s,
+                             Impl::Result& result) {
+                    detail::ThreadBudget budget(s.threads);
+                    cv::Mat input(frame.height, frame.width, CV_8UC4,
+                                  const_cast<uint8_t*>(frame.pixels.data()));
+                    // The pinned copy holds the same pixels as the source frame, so its
+                    // luma is shared with operators reading that frame inline
+                    std::shared_ptr<detail::CachedFrame> cachedFrame;
+                    cv::Mat luma;
+                    if (!s.colorMode) {
+                        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageCvtColor);
+                        cachedFrame = detail::FrameCache::instance().acquire(
+                            s.input, this, s.frameKey, frame.pixels.data(), frame.width,
+                            frame.height, static_cast<size_t>(frame.width) * 4);
+                        luma = cachedFrame->luma();
+                    }
+                    impl->cook(s, input, luma, result.pixels);
+                    result.width = frame.width;
+                    result.height = frame.height;
+                    result.stamp = s.stamp;
+                    impl->snapshot(result);
+                });
+        }
+        impl->cooker.submit(cpuView.data, width, height, s);
+
+        if (Impl::Result* result = impl->cooker.takeFresh()) {
+            m_outputPixels.swap(result->pixels);
+            m_outputWidth = result->width;
+            m_outputHeight = result->height;
+            std::swap(impl->published, *result);
+            impl->publishStamp(this, impl->published.stamp);
+        }
+        didCook();
+        return;
+    }
 
-        // Cache params
-        m_impl->lastMinArea = static_cast<float>(minArea);
-        m_impl->lastMaxArea = static_cast<float>(maxArea);
-        m_impl->lastMinCircularity = static_cast<float>(minCircularity);
-        m_impl->lastMinConvexity = static_cast<float>(minConvexity);
-        m_impl->lastMinInertia = static_cast<float>(minInertia);
-        m_impl->lastDetectBright = static_cast<int>(detectBright);
-        m_impl->lastDetectDark = static_cast<int>(detectDark);
-        m_impl->lastThreshold = static_cast<float>(threshold);
+    if (impl->asyncActive) {
+        impl->cooker.stop();
+        impl->asyncActive = false;
     }
 
     // Create cv::Mat from CPU pixels (zero-copy)
     cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(cpuView.data));
 
-    // Convert to grayscale for blob detection
-    cv::Mat gray;
-    cv::cvtColor(input, gray, cv::COLOR_BGRA2GRAY);
+    // Grayscale shared with other operators reading the same input this frame
+    std::shared_ptr<detail::CachedFrame> cachedFrame;  // Keeps shared luma alive for this cook
+    cv::Mat luma;
+    if (!s.colorMode) {
+        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageCvtColor);
+        cachedFrame = detail::FrameCache::instance().acquire(
+            inputOp, this, received.key, cpuView.data, width, height, static_cast<size_t>(width) * 4);
+        luma = cachedFrame->luma();
+    }
 
-    // Detect blobs
-    m_impl->keypoints.clear();
-    m_impl->detector->detect(gray, m_impl->keypoints);
+    impl->cook(s, input, luma, m_outputPixels);
+    m_outputWidth = width;
+    m_outputHeight = height;
+    impl->publishStamp(this, s.stamp);
 
-    // Create output with visualization
-    cv::Mat output;
-    input.copyTo(output);
+    didCook();
+}
 
-    // Threshold image to find contours
-    cv::Mat binary;
-    float thresh = static_cast<float>(threshold);
-    if (static_cast<int>(detectBright) && !static_cast<int>(detectDark)) {
-        cv::threshold(gray, binary, thresh, 255, cv::THRESH_BINARY);
-    } else if (!static_cast<int>(detectBright) && static_cast<int>(detectDark)) {
-        cv::threshold(gray, binary, thresh, 255, cv::THRESH_BINARY_INV);
-    } else {
-        // For both, use regular threshold
-        cv::threshold(gray, binary, thresh, 255, cv::THRESH_BINARY);
-    }
+const std::vector<TrackedBlob>& BlobTrack::blobs() const {
+    return m_impl->asyncActive ? m_impl->published.tracks : m_impl->tracker.tracks();
+}
 
-    // Find contours for visualization
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+size_t BlobTrack::blobCount() const {
+    return blobs().size();
+}
 
-    // Draw contours that match detected blob locations
-    float minA = static_cast<float>(minArea);
-    float maxA = static_cast<float>(maxArea);
+std::shared_ptr<BlobEventQueue> BlobTrack::eventQueue() const {
+    return m_impl->events;
+}
 
-    for (const auto& contour : contours) {
-        double area = cv::contourArea(contour);
-        if (area >= minA && area <= maxA) {
-            // Draw the contour outline
-            cv::drawContours(output, std::vector<std::vector<cv::Point>>{contour}, 0,
-                           cv::Scalar(0, 255, 0, 255), 2, cv::LINE_AA);
+void BlobTrack::setEventQueue(std::shared_ptr<BlobEventQueue> queue) {
+    m_impl->events = std::move(queue);
+}
+
+void BlobTrack::resetBackground() {
+    m_impl->backgroundResetRequested = true;
+}
+
+void BlobTrack::setCaptureTime(double seconds) {
+    m_impl->captureTimeOverride = seconds;
+}
+
+void BlobTrack::setTargetTime(double seconds) {
+    m_impl->targetTimeOverride = seconds;
+}
+
+TrajectoryView BlobTrack::trajectoryAt(size_t index) const {
+    if (index >= blobs().size()) {
+        return TrajectoryView{};
+    }
+    if (m_impl->asyncActive) {
+        return m_impl->published.trajectory(index);
+    }
+    return m_impl->tracker.trajectory(index);
+}
+
+TrajectoryView BlobTrack::trajectory(int trackId) const {
+    const auto& tracks = blobs();
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        if (tracks[i].id == trackId) {
+            return trajectoryAt(i);
         }
     }
+    return TrajectoryView{};
+}
 
-    // Draw blob centers from keypoints
-    for (const auto& kp : m_impl->keypoints) {
-        int x = static_cast<int>(kp.pt.x);
-        int y = static_cast<int>(kp.pt.y);
-        int radius = static_cast<int>(kp.size / 2);
+PredictionStats BlobTrack::predictionError() const {
+    return m_impl->asyncActive ? m_impl->published.predictionError
+                               : m_impl->tracker.predictionError();
+}
 
-        // Draw bounding circle (yellow)
-        cv::circle(output, cv::Point(x, y), radius, cv::Scalar(0, 255, 255, 200), 2, cv::LINE_AA);
+const BlobGrid& BlobTrack::grid() const {
+    return m_impl->asyncActive ? m_impl->published.grid : m_impl->grid;
+}
 
-        // Draw center crosshair (magenta)
-        int cross = 8;
-        cv::line(output, cv::Point(x - cross, y), cv::Point(x + cross, y),
-                 cv::Scalar(255, 0, 255, 255), 2, cv::LINE_AA);
-        cv::line(output, cv::Point(x, y - cross), cv::Point(x, y + cross),
-                 cv::Scalar(255, 0, 255, 255), 2, cv::LINE_AA);
-    }
+int BlobTrack::clusterCount() const {
+    return m_impl->asyncActive ? m_impl->published.clusterCount : m_impl->clusterCount;
+}
 
-    // Store output in CPU pixel buffer (BGRA format)
-    m_outputWidth = width;
-    m_outputHeight = height;
-    size_t dataSize = output.total() * output.elemSize();
-    m_outputPixels.assign(output.data, output.data + dataSize);
+AsyncStats BlobTrack::asyncStats() const {
+    return m_impl->cooker.stats();
+}
 
-    didCook();
+std::vector<StageTiming> BlobTrack::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats BlobTrack::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void BlobTrack::resetStageTimings() {
+    m_impl->profile.reset();
 }
 
 } // namespace vivid::opencv
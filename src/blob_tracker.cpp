@@ -0,0 +1,250 @@
+/**
+ * @file blob_tracker.cpp
+ * @brief Frame-to-frame blob association
+ */
+
+#include "blob_tracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv::detail {
+
+namespace {
+
+// Longest extrapolation we trust; beyond this the quadratic model diverges
+constexpr double kMaxHorizon = 0.25;
+
+inline void extrapolate(const TrackedBlob& track, double time, float& x, float& y) {
+    float dt = static_cast<float>(std::clamp(time - track.timestamp, 0.0, kMaxHorizon));
+    x = track.x + track.vx * dt + 0.5f * track.ax * dt * dt;
+    y = track.y + track.vy * dt + 0.5f * track.ay * dt * dt;
+}
+
+// Where the track was at `time`: linear back-projection for times before its
+// last measurement (acceleration is too noisy to run backwards), else extrapolate()
+inline void positionAt(const TrackedBlob& track, double time, float& x, float& y) {
+    if (time >= track.timestamp) {
+        extrapolate(track, time, x, y);
+        return;
+    }
+    float dt = static_cast<float>(std::max(time - track.timestamp, -kMaxHorizon));
+    x = track.x + track.vx * dt;
+    y = track.y + track.vy * dt;
+}
+
+} // namespace
+
+void BlobTracker::update(const std::vector<cv::KeyPoint>& detections,
+                         float maxDistance, int persistence, double timestamp) {
+    associate(detections, nullptr, timestamp, maxDistance, persistence, false);
+}
+
+void BlobTracker::update(const std::vector<cv::KeyPoint>& detections,
+                         const std::vector<double>& times, float maxDistance, int persistence) {
+    associate(detections, times.data(), 0.0, maxDistance, persistence, true);
+}
+
+void BlobTracker::associate(const std::vector<cv::KeyPoint>& detections, const double* times,
+                            double timestamp, float maxDistance, int persistence, bool refined) {
+    const size_t trackCount = m_tracks.size();
+    const size_t detectionCount = detections.size();
+    const float maxDist2 = maxDistance * maxDistance;
+    auto timeOf = [&](size_t d) { return times ? times[d] : timestamp; };
+
+    // Collect every plausible pairing, then take them closest-first
+    m_candidates.clear();
+    for (size_t t = 0; t < trackCount; ++t) {
+        float tx = 0.0f;
+        float ty = 0.0f;
+        if (!times) {
+            extrapolate(m_tracks[t], timestamp, tx, ty);
+        }
+        for (size_t d = 0; d < detectionCount; ++d) {
+            if (times) {
+                positionAt(m_tracks[t], times[d], tx, ty);
+            }
+            float dx = detections[d].pt.x - tx;
+            float dy = detections[d].pt.y - ty;
+            float dist2 = dx * dx + dy * dy;
+            if (dist2 <= maxDist2) {
+                m_candidates.push_back({dist2, static_cast<int>(t), static_cast<int>(d)});
+            }
+        }
+    }
+    std::sort(m_candidates.begin(), m_candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.dist2 < b.dist2; });
+
+    m_trackMatched.assign(trackCount, 0);
+    m_detectionMatched.assign(detectionCount, 0);
+
+    for (const Candidate& c : m_candidates) {
+        if (m_trackMatched[c.track] || m_detectionMatched[c.detection]) {
+            continue;
+        }
+        m_trackMatched[c.track] = 1;
+        m_detectionMatched[c.detection] = 1;
+
+        // Refined tracks keep a measurement newer than the detection
+        double when = timeOf(static_cast<size_t>(c.detection));
+        if (!refined || when > m_tracks[c.track].timestamp) {
+            const cv::KeyPoint& kp = detections[c.detection];
+            observe(static_cast<size_t>(c.track), kp.pt.x, kp.pt.y, kp.size, when);
+        }
+    }
+
+    // Exactly one miss per update for tracks nobody saw on this frame
+    for (size_t t = 0; t < trackCount; ++t) {
+        if (!m_trackMatched[t] && !refined) {
+            m_tracks[t].missed++;
+        }
+        m_tracks[t].age++;
+    }
+
+    // Retire stale tracks (stable compaction keeps ids sorted by creation)
+    m_removed.clear();
+    size_t kept = 0;
+    for (size_t t = 0; t < trackCount; ++t) {
+        if (m_tracks[t].missed > persistence) {
+            m_removed.push_back(m_tracks[t]);
+            m_history.release(m_motion[t].historySlot);
+            continue;
+        }
+        if (kept != t) {
+            m_tracks[kept] = m_tracks[t];
+            m_motion[kept] = m_motion[t];
+        }
+        ++kept;
+    }
+    m_tracks.resize(kept);
+    m_motion.resize(kept);
+
+    // Spawn tracks for detections nobody claimed
+    for (size_t d = 0; d < detectionCount; ++d) {
+        if (m_detectionMatched[d]) {
+            continue;
+        }
+        TrackedBlob track;
+        track.id = m_nextId++;
+        track.x = detections[d].pt.x;
+        track.y = detections[d].pt.y;
+        track.size = detections[d].size;
+        track.timestamp = timeOf(d);
+        track.predictedX = track.x;
+        track.predictedY = track.y;
+        m_tracks.push_back(track);
+
+        Motion motion;
+        motion.samples = 1;
+        motion.historySlot = m_history.acquire();
+        m_history.push(motion.historySlot, track.x, track.y, track.timestamp);
+        m_motion.push_back(motion);
+    }
+}
+
+void BlobTracker::observe(size_t index, float x, float y, float size, double timestamp) {
+    TrackedBlob& track = m_tracks[index];
+    Motion& motion = m_motion[index];
+
+    double dt = timestamp - track.timestamp;
+
+    // Score the outstanding prediction once its target time has been reached,
+    // interpolating the measured path to the exact target time
+    if (motion.pendingTarget >= 0.0 && timestamp >= motion.pendingTarget && dt > 0.0) {
+        float f = static_cast<float>((motion.pendingTarget - track.timestamp) / dt);
+        f = std::clamp(f, 0.0f, 1.0f);
+        float mx = track.x + (x - track.x) * f;
+        float my = track.y + (y - track.y) * f;
+        float error = std::hypot(mx - motion.pendingX, my - motion.pendingY);
+        accumulate(track.error, motion.meanSquare, error);
+        accumulate(m_error, m_errorMeanSquare, error);
+        motion.pendingTarget = -1.0;
+    }
+
+    if (dt > 1e-6) {
+        float invDt = static_cast<float>(1.0 / dt);
+        float rawVx = (x - track.x) * invDt;
+        float rawVy = (y - track.y) * invDt;
+        float k = m_smoothing;
+
+        if (motion.samples >= 2) {
+            float rawAx = (rawVx - track.vx) * invDt;
+            float rawAy = (rawVy - track.vy) * invDt;
+            track.ax = k * track.ax + (1.0f - k) * rawAx;
+            track.ay = k * track.ay + (1.0f - k) * rawAy;
+            track.vx = k * track.vx + (1.0f - k) * rawVx;
+            track.vy = k * track.vy + (1.0f - k) * rawVy;
+        } else {
+            // Second sample: first velocity estimate, no acceleration yet
+            track.vx = rawVx;
+            track.vy = rawVy;
+        }
+        motion.samples++;
+    }
+
+    track.x = x;
+    track.y = y;
+    track.size = size;
+    track.timestamp = timestamp;
+    track.missed = 0;
+
+    m_history.push(motion.historySlot, x, y, timestamp);
+}
+
+void BlobTracker::setHistoryLength(int length) {
+    if (length == m_history.length()) {
+        return;
+    }
+    m_history.configure(length > 0 ? kHistorySlots : 0, length);
+    for (size_t i = 0; i < m_tracks.size(); ++i) {
+        Motion& motion = m_motion[i];
+        motion.historySlot = m_history.acquire();
+        m_history.push(motion.historySlot, m_tracks[i].x, m_tracks[i].y, m_tracks[i].timestamp);
+    }
+}
+
+void BlobTracker::age() {
+    m_removed.clear();
+    for (TrackedBlob& track : m_tracks) {
+        track.age++;
+    }
+}
+
+void BlobTracker::predict(double targetTime) {
+    for (size_t i = 0; i < m_tracks.size(); ++i) {
+        TrackedBlob& track = m_tracks[i];
+        extrapolate(track, targetTime, track.predictedX, track.predictedY);
+
+        // One prediction in flight per track; it is scored when a measurement
+        // at or past its target time arrives
+        Motion& motion = m_motion[i];
+        if (motion.pendingTarget < 0.0 && motion.samples >= 3 && targetTime > track.timestamp) {
+            motion.pendingTarget = targetTime;
+            motion.pendingX = track.predictedX;
+            motion.pendingY = track.predictedY;
+        }
+    }
+}
+
+void BlobTracker::accumulate(PredictionStats& stats, double& meanSquare, float error) {
+    stats.samples++;
+    float n = static_cast<float>(stats.samples);
+    stats.mean += (error - stats.mean) / n;
+    meanSquare += (static_cast<double>(error) * error - meanSquare) / n;
+    stats.rms = static_cast<float>(std::sqrt(meanSquare));
+    stats.max = std::max(stats.max, error);
+}
+
+void BlobTracker::reset() {
+    for (const Motion& motion : m_motion) {
+        m_history.release(motion.historySlot);
+    }
+    m_tracks.clear();
+    m_motion.clear();
+    m_removed.clear();
+    m_candidates.clear();
+    m_error = PredictionStats{};
+    m_errorMeanSquare = 0.0;
+    m_nextId = 1;
+}
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * @file blob_tracker.h
+ * @brief Frame-to-frame blob association (internal)
+ */
+
+#include "alloc_counter.h"
+#include "trajectory_arena.h"
+#include <vivid/opencv/blob_types.h>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Greedy nearest-neighbour blob tracker with motion estimation
+ *
+ * Matches detections to tracks in order of increasing distance from each
+ * track's position extrapolated (or, for detections older than the track's
+ * last measurement, back-projected) to the detection time, spawns tracks for
+ * unmatched detections and retires tracks that stay unmatched for more
+ * than `persistence` updates. Every measurement also updates a smoothed
+ * velocity/acceleration estimate used for latency-compensated prediction
+ * and is appended to the track's trajectory ring buffer.
+ * Scratch buffers are kept between updates so steady-state tracking does
+ * not allocate.
+ */
+class BlobTracker {
+public:
+    /**
+     * @brief Associate a complete detection set with the current tracks
+     * @param detections Blob keypoints in image coordinates
+     * @param maxDistance Largest center distance accepted as a match
+     * @param persistence Updates a track may go unmatched before removal
+     * @param timestamp Capture time of the frame the detections came from
+     */
+    void update(const std::vector<cv::KeyPoint>& detections, float maxDistance,
+                int persistence, double timestamp);
+
+    /**
+     * @brief Associate detections gathered over several frames (sliced detection)
+     *
+     * Every track was already observed or missed on the newest frame. Each
+     * detection is gated against its track back-projected to the
+     * detection's own capture time, so fast blobs still match detections
+     * a few frames old. A match only updates a track whose last
+     * measurement is older than the detection; unmatched tracks aren't
+     * charged a second miss, and unmatched detections start tracks at
+     * their capture time.
+     * @param times Capture time of each detection
+     */
+    void update(const std::vector<cv::KeyPoint>& detections, const std::vector<double>& times,
+                float maxDistance, int persistence);
+
+    /// Record a measurement for one track without re-association
+    void observe(size_t index, float x, float y, float size, double timestamp);
+
+    /// Record that a track was not seen this cook
+    void miss(size_t index) { m_tracks[index].missed++; }
+
+    /// Advance track ages without re-association (between complete detections)
+    void age();
+
+    /**
+     * @brief Extrapolate every track to a target time
+     *
+     * Fills TrackedBlob::predictedX/Y and queues the prediction for error
+     * evaluation against later measurements.
+     */
+    void predict(double targetTime);
+
+    /**
+     * @brief Resize the trajectory arena
+     *
+     * A change reallocates the arena and clears every history; existing
+     * tracks are given fresh rings. 0 disables history.
+     */
+    void setHistoryLength(int length);
+
+    /// Position history of the track at `index` (empty view if it has none)
+    TrajectoryView trajectory(size_t index) const {
+        return m_history.view(m_motion[index].historySlot);
+    }
+
+    /// Blend factor for velocity/acceleration updates (0 = raw, 0.95 = heavy)
+    void setSmoothing(float smoothing) { m_smoothing = smoothing; }
+
+    std::vector<TrackedBlob>& tracks() { return m_tracks; }
+    const std::vector<TrackedBlob>& tracks() const { return m_tracks; }
+
+    /// Tracks retired by the most recent update() (empty after age())
+    const std::vector<TrackedBlob>& removed() const { return m_removed; }
+
+    /// Prediction error over every evaluated prediction since reset()
+    const PredictionStats& predictionError() const { return m_error; }
+
+    void reset();
+
+private:
+    struct Candidate {
+        float dist2;
+        int track;
+        int detection;
+    };
+
+    // Internal per-track state, kept index-aligned with m_tracks
+    struct Motion {
+        int samples = 0;               // Measurements seen
+        double pendingTarget = -1.0;   // Target time of the unevaluated prediction
+        float pendingX = 0.0f;
+        float pendingY = 0.0f;
+        double meanSquare = 0.0;       // Running mean of squared error
+        int historySlot = -1;          // Ring in m_history, -1 if none
+    };
+
+    // Tracks that can hold history at once; later tracks go without
+    static constexpr int kHistorySlots = 512;
+
+    // Shared by both update()s; `times` is null when every detection was taken at `timestamp`
+    void associate(const std::vector<cv::KeyPoint>& detections, const double* times,
+                   double timestamp, float maxDistance, int persistence, bool refined);
+
+    static void accumulate(PredictionStats& stats, double& meanSquare, float error);
+
+    std::vector<TrackedBlob> m_tracks;
+    CountedVector<Motion> m_motion;
+    TrajectoryArena m_history;
+    std::vector<TrackedBlob> m_removed;
+    CountedVector<Candidate> m_candidates;
+    CountedVector<char> m_trackMatched;
+    CountedVector<char> m_detectionMatched;
+    PredictionStats m_error;
+    double m_errorMeanSquare = 0.0;
+    float m_smoothing = 0.5f;
+    int m_nextId = 1;
+};
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,268 @@
+/**
+ * @file bright_spot.cpp
+ * @brief Brightest-point tracker implementation
+ */
+
+#include <vivid/opencv/bright_spot.h>
+#include <vivid/context.h>
+#include <vivid/chain.h>
+#include "kernels.h"
+#include "pixel_luma.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "trace.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv {
+
+namespace {
+
+// Stages timed by BrightSpot::Impl::profile (same order as its names)
+enum BrightSpotStage : int {
+    StageSearch,
+    StageRefine,
+    StageDraw,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
+// PIMPL - hides OpenCV types from header
+struct BrightSpot::Impl {
+    bool found = false;
+    float x = 0.0f;
+    float y = 0.0f;
+    float vx = 0.0f;          // Per-cook motion, used to center the search window
+    float vy = 0.0f;
+    float brightness = 0.0f;
+    cv::Rect markerRect;      // Output area touched by the last marker
+
+    detail::StageProfile profile{"BrightSpot", {"search", "refine", "draw", "process",
+                                                "cookLatency", "pipelineLatency"}};
+};
+
+BrightSpot::BrightSpot() : m_impl(std::make_unique<Impl>()) {
+    registerParam(minBrightness);
+    registerParam(decimation);
+    registerParam(refineRadius);
+    registerParam(searchRadius);
+}
+
+BrightSpot::~BrightSpot() = default;
+
+void BrightSpot::cleanup() {
+    m_outputPixels.clear();
+    m_outputWidth = 0;
+    m_outputHeight = 0;
+    m_impl->found = false;
+    m_impl->x = 0.0f;
+    m_impl->y = 0.0f;
+    m_impl->vx = 0.0f;
+    m_impl->vy = 0.0f;
+    m_impl->brightness = 0.0f;
+    m_impl->markerRect = cv::Rect();
+    detail::FrameStamps::instance().release(this);
+}
+
+void BrightSpot::init(Context& ctx) {
+    kernels::initDispatch();
+    detail::installAllocCounter();
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView BrightSpot::cpuPixelView() const {
+    if (m_outputPixels.empty() || m_outputWidth <= 0 || m_outputHeight <= 0) {
+        return {};
+    }
+    return {m_outputPixels.data(), m_outputWidth, m_outputHeight, 4, 0};
+}
+
+namespace {
+
+// Luma-weighted centroid around (px, py). Weights are luma above half the
+// peak so the surrounding glow does not drag the estimate.
+void refineCentroid(const uint8_t* src, size_t step, int width, int height,
+                    int px, int py, int peak, int radius, float& outX, float& outY) {
+    int floor = peak / 2;
+    int x0 = std::max(0, px - radius);
+    int x1 = std::min(width - 1, px + radius);
+    int y0 = std::max(0, py - radius);
+    int y1 = std::min(height - 1, py + radius);
+
+    double sum = 0.0;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    for (int y = y0; y <= y1; ++y) {
+        const uint8_t* row = src + y * step;
+        for (int x = x0; x <= x1; ++x) {
+            int w = kernels::pixelLuma(row + x * 4) - floor;
+            if (w > 0) {
+                sum += w;
+                sumX += static_cast<double>(w) * x;
+                sumY += static_cast<double>(w) * y;
+            }
+        }
+    }
+
+    if (sum > 0.0) {
+        outX = static_cast<float>(sumX / sum);
+        outY = static_cast<float>(sumY / sum);
+    } else {
+        outX = static_cast<float>(px);
+        outY = static_cast<float>(py);
+    }
+}
+
+} // namespace
+
+void BrightSpot::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    Operator* inputOp = getInput(0);
+    if (!inputOp) {
+        didCook();
+        return;
+    }
+
+    auto cpuView = inputOp->cpuPixelView();
+    if (!cpuView.valid()) {
+        didCook();
+        return;
+    }
+
+    int width = cpuView.width;
+    int height = cpuView.height;
+
+    if (width < 16 || height < 16) {
+        didCook();
+        return;
+    }
+
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+
+    const uint8_t* src = cpuView.data;
+    const size_t step = static_cast<size_t>(width) * 4;
+    FrameStamp stamp = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame()).stamp;
+    const int minLuma = static_cast<int>(static_cast<float>(minBrightness));
+
+    // Track: search a window around the predicted position at full density
+    VIVID_OPENCV_STAGE_CLOCK(clock, m_impl->profile);
+    kernels::LumaPeak peak;
+    if (m_impl->found) {
+        int r = static_cast<int>(searchRadius);
+        int cx = static_cast<int>(m_impl->x + m_impl->vx);
+        int cy = static_cast<int>(m_impl->y + m_impl->vy);
+        int x0 = std::clamp(cx - r, 0, width);
+        int x1 = std::clamp(cx + r + 1, 0, width);
+        int y0 = std::clamp(cy - r, 0, height);
+        int y1 = std::clamp(cy + r + 1, 0, height);
+        if (x1 > x0 && y1 > y0) {
+            peak = kernels::findMaxLuma(src, step, x0, y0, x1, y1, 1);
+        }
+    }
+
+    // Acquire (or re-acquire): decimated search over the whole frame
+    if (peak.value < minLuma) {
+        peak = kernels::findMaxLuma(src, step, 0, 0, width, height,
+                                    static_cast<int>(decimation));
+    }
+
+    VIVID_OPENCV_STAGE_LAP(clock, StageSearch);
+
+    bool wasFound = m_impl->found;
+    m_impl->found = peak.value >= minLuma;
+    m_impl->brightness = static_cast<float>(std::max(peak.value, 0));
+
+    if (m_impl->found) {
+        float nx, ny;
+        refineCentroid(src, step, width, height, peak.x, peak.y, peak.value,
+                       static_cast<int>(refineRadius), nx, ny);
+        m_impl->vx = wasFound ? nx - m_impl->x : 0.0f;
+        m_impl->vy = wasFound ? ny - m_impl->y : 0.0f;
+        m_impl->x = nx;
+        m_impl->y = ny;
+    } else {
+        m_impl->vx = 0.0f;
+        m_impl->vy = 0.0f;
+    }
+    VIVID_OPENCV_STAGE_LAP(clock, StageRefine);
+
+    // Overlay output: only the area under the previous marker is cleared,
+    // so the cook never touches the whole frame once the buffer exists
+    size_t dataSize = static_cast<size_t>(width) * height * 4;
+    if (m_outputWidth != width || m_outputHeight != height || m_outputPixels.size() != dataSize) {
+        m_outputPixels.assign(dataSize, 0);
+        m_outputWidth = width;
+        m_outputHeight = height;
+        m_impl->markerRect = cv::Rect();
+    }
+    cv::Mat output(height, width, CV_8UC4, m_outputPixels.data());
+
+    if (!m_impl->markerRect.empty()) {
+        output(m_impl->markerRect).setTo(cv::Scalar(0, 0, 0, 0));
+        m_impl->markerRect = cv::Rect();
+    }
+
+    if (m_impl->found) {
+        int x = static_cast<int>(std::lround(m_impl->x));
+        int y = static_cast<int>(std::lround(m_impl->y));
+        int radius = 12;
+        int pad = radius + 4;  // Covers line width and anti-aliasing
+
+        cv::circle(output, cv::Point(x, y), radius, cv::Scalar(0, 255, 255, 255), 2, cv::LINE_AA);
+        cv::line(output, cv::Point(x - radius, y), cv::Point(x + radius, y),
+                 cv::Scalar(255, 0, 255, 255), 1, cv::LINE_AA);
+        cv::line(output, cv::Point(x, y - radius), cv::Point(x, y + radius),
+                 cv::Scalar(255, 0, 255, 255), 1, cv::LINE_AA);
+
+        m_impl->markerRect = cv::Rect(x - pad, y - pad, 2 * pad + 1, 2 * pad + 1) &
+                             cv::Rect(0, 0, width, height);
+    }
+
+    VIVID_OPENCV_STAGE_LAP(clock, StageDraw);
+
+    m_impl->profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                                  detail::FrameStamps::instance().publish(this, "BrightSpot", stamp));
+    didCook();
+}
+
+bool BrightSpot::found() const {
+    return m_impl->found;
+}
+
+float BrightSpot::x() const {
+    return m_impl->x;
+}
+
+float BrightSpot::y() const {
+    return m_impl->y;
+}
+
+float BrightSpot::brightness() const {
+    return m_impl->brightness;
+}
+
+std::vector<StageTiming> BrightSpot::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats BrightSpot::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void BrightSpot::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVBrightSpot = vivid::opencv::BrightSpot;
+REGISTER_OPERATOR(OpenCVBrightSpot, "OpenCV", "Brightest-point tracking with sub-pixel refinement", true);
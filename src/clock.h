@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * @file clock.h
+ * @brief Module-wide timestamp source (internal)
+ */
+
+#include <chrono>
+
+namespace vivid::opencv::detail {
+
+/// Seconds on std::chrono::steady_clock - the time base of all module timestamps
+inline double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace vivid::opencv::detail
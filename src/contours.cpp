@@ -8,15 +8,142 @@
 #include <vivid/chain.h>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#include "async_cook.h"
+#include "frame_cache.h"
+#include "kernels.h"
+#include "stage_pipeline.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "thread_pool.h"
+#include "trace.h"
 
 namespace vivid::opencv {
 
+namespace {
+
+// Stages timed by Contours::Impl::profile (same order as its names)
+enum ContourStage : int {
+    StageCvtColor,
+    StageCanny,
+    StageFindContours,
+    StageClear,
+    StageDrawContours,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
 // PIMPL implementation - hides OpenCV types from header
 struct Contours::Impl {
+    // Param snapshot taken on the chain thread
+    struct Settings {
+        double threshold1 = 100.0;
+        double threshold2 = 200.0;
+        int cvMode = cv::RETR_EXTERNAL;
+        cv::Scalar color;
+        int thickness = 1;
+        int threads = 0;
+        FrameStamp stamp;       // Input frame this cook works on
+        const Operator* input = nullptr;  // Its source and FrameCache key, for pinned copies
+        uint64_t frameKey = 0;
+    };
+
+    // Completed background cook
+    struct Result {
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        size_t contourCount = 0;
+        FrameStamp stamp;
+    };
+
+    // One frame in flight through the pipelined stages
+    struct StageFrame {
+        detail::PinnedFrame input;
+        Settings settings;
+        std::shared_ptr<detail::CachedFrame> cached;  // Holds `gray` until Canny has run
+        cv::Mat gray;
+        cv::Mat edges;
+        std::vector<std::vector<cv::Point>> contours;
+    };
+
     std::vector<std::vector<cv::Point>> contours;
-    cv::Mat lastInput;
+    cv::Mat edges;
+
+    size_t publishedCount = 0;  // contourCount() while cooking in the background
+    int activeMode = 0;         // Cook mode in effect (the async param value)
+
+    // Draw the contours of `gray` into `pixels` (BGRA, size of `gray`)
+    void cook(const Settings& s, const cv::Mat& gray, std::vector<uint8_t>& pixels);
+
+    // Stamp `owner`'s output with the frame it came from
+    void publishStamp(const Operator* owner, const FrameStamp& stamp) {
+        profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                              detail::FrameStamps::instance().publish(owner, "Contours", stamp));
+    }
+
+    // Swap a completed background result into the operator's output
+    void publish(const Operator* owner, Result* result, std::vector<uint8_t>& pixels,
+                 int& width, int& height) {
+        if (!result) {
+            return;
+        }
+        pixels.swap(result->pixels);
+        width = result->width;
+        height = result->height;
+        publishedCount = result->contourCount;
+        publishStamp(owner, result->stamp);
+    }
+
+    // Stop whichever background mode is running
+    void stopBackground() {
+        cooker.stop();
+        pipeline.stop();
+        activeMode = 0;
+    }
+
+    detail::StageProfile profile{"Contours", {"cvtColor", "Canny", "findContours", "clear",
+                                              "drawContours", "process", "cookLatency",
+                                              "pipelineLatency"}};
+
+    // Declared last: the workers are joined before the state above is destroyed
+    detail::AsyncCooker<Result, Settings> cooker;
+    detail::StagePipeline<StageFrame, Result> pipeline;
 };
 
+namespace {
+
+// Render contours on a transparent background straight into the output buffer
+void drawInto(const std::vector<std::vector<cv::Point>>& contours, const cv::Scalar& color,
+              int thickness, int width, int height, std::vector<uint8_t>& pixels,
+              detail::StageProfile& profile) {
+    VIVID_OPENCV_STAGE_CLOCK(clock, profile);
+    pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    VIVID_OPENCV_STAGE_LAP(clock, StageClear);
+    cv::Mat output(height, width, CV_8UC4, pixels.data());
+    cv::drawContours(output, contours, -1, color, thickness);
+    VIVID_OPENCV_STAGE_LAP(clock, StageDrawContours);
+}
+
+} // namespace
+
+void Contours::Impl::cook(const Settings& s, const cv::Mat& gray, std::vector<uint8_t>& pixels) {
+    VIVID_OPENCV_STAGE_CLOCK(clock, profile);
+
+    // Apply Canny edge detection
+    cv::Canny(gray, edges, s.threshold1, s.threshold2);
+    VIVID_OPENCV_STAGE_LAP(clock, StageCanny);
+
+    // Find contours
+    contours.clear();
+    cv::findContours(edges, contours, s.cvMode, cv::CHAIN_APPROX_SIMPLE);
+    VIVID_OPENCV_STAGE_LAP(clock, StageFindContours);
+
+    drawInto(contours, s.color, s.thickness, gray.cols, gray.rows, pixels, profile);
+}
+
 Contours::Contours() : m_impl(std::make_unique<Impl>()) {
     registerParam(threshold1);
     registerParam(threshold2);
@@ -26,17 +153,28 @@ Contours::Contours() : m_impl(std::make_unique<Impl>()) {
     registerParam(colorG);
     registerParam(colorB);
     registerParam(colorA);
+    registerParam(async);
+    registerParam(threads);
+
+    m_impl->cooker.setName("Contours");
+    m_impl->pipeline.setName("Contours");
 }
 
 Contours::~Contours() = default;
 
 void Contours::cleanup() {
+    m_impl->stopBackground();
     m_outputPixels.clear();
     m_outputWidth = 0;
     m_outputHeight = 0;
+    detail::FrameCache::instance().release(this);
+    detail::FrameStamps::instance().release(this);
 }
 
 void Contours::init(Context& ctx) {
+    detail::ensureThreadPool();
+    kernels::initDispatch();
+    detail::installAllocCounter();
     // Try to match input resolution
     matchInputResolution(0);
 }
@@ -79,58 +217,148 @@ void Contours::process(Context& ctx) {
         return;
     }
 
-    // Create cv::Mat from CPU pixel data (BGRA format from VideoPlayer/Webcam) - zero-copy
-    cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(cpuView.data));
+    // Cap the threads OpenCV and our kernels may use for this cook
+    detail::ThreadBudget budget(static_cast<int>(threads));
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
 
-    // Convert to grayscale
-    cv::Mat gray;
-    cv::cvtColor(input, gray, cv::COLOR_BGRA2GRAY);
-
-    // Apply Canny edge detection
-    cv::Mat edges;
-    cv::Canny(gray, edges,
-              static_cast<double>(threshold1),
-              static_cast<double>(threshold2));
-
-    // Find contours
-    m_impl->contours.clear();
-    int cvMode = cv::RETR_EXTERNAL;
+    Impl::Settings s;
+    s.threshold1 = static_cast<double>(threshold1);
+    s.threshold2 = static_cast<double>(threshold2);
     switch (static_cast<int>(mode)) {
-        case 0: cvMode = cv::RETR_EXTERNAL; break;
-        case 1: cvMode = cv::RETR_LIST; break;
-        case 2: cvMode = cv::RETR_CCOMP; break;
-        case 3: cvMode = cv::RETR_TREE; break;
+        case 0: s.cvMode = cv::RETR_EXTERNAL; break;
+        case 1: s.cvMode = cv::RETR_LIST; break;
+        case 2: s.cvMode = cv::RETR_CCOMP; break;
+        case 3: s.cvMode = cv::RETR_TREE; break;
     }
-    cv::findContours(edges, m_impl->contours, cvMode, cv::CHAIN_APPROX_SIMPLE);
 
-    // Create output image with transparent background
-    cv::Mat output(height, width, CV_8UC4, cv::Scalar(0, 0, 0, 0));
-
-    // Draw contours
     // OpenCV uses BGR, but our Mat is BGRA, and color params are RGB
-    cv::Scalar color(
+    s.color = cv::Scalar(
         static_cast<int>(static_cast<float>(colorB) * 255),  // B
         static_cast<int>(static_cast<float>(colorG) * 255),  // G
         static_cast<int>(static_cast<float>(colorR) * 255),  // R
         static_cast<int>(static_cast<float>(colorA) * 255)   // A
     );
 
-    int thickness = static_cast<int>(static_cast<float>(lineWidth));
-    if (thickness < 1) thickness = 1;
+    s.thickness = static_cast<int>(static_cast<float>(lineWidth));
+    if (s.thickness < 1) s.thickness = 1;
+
+    s.threads = static_cast<int>(threads);
+    detail::ReceivedFrame received = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+    s.stamp = received.stamp;
+    s.input = inputOp;
+    s.frameKey = received.key;
+
+    Impl* impl = m_impl.get();
+    int cookMode = static_cast<int>(async);
+    if (cookMode != impl->activeMode) {
+        impl->stopBackground();
+        impl->activeMode = cookMode;
+    }
 
-    cv::drawContours(output, m_impl->contours, -1, color, thickness);
+    if (cookMode == 1) {
+        // Hand the frame to the worker and publish whatever finished last
+        if (!impl->cooker.configured()) {
+            impl->cooker.configure(
+                [this, impl](const detail::PinnedFrame& frame, const Impl::Settings& s,
+                             Impl::Result& result) {
+                    detail::ThreadBudget budget(s.threads);
+                    VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+                    // The pinned copy holds the same pixels as the source frame, so its
+                    // luma is shared with operators reading that frame inline
+                    auto cached = detail::FrameCache::instance().acquire(
+                        s.input, this, s.frameKey, frame.pixels.data(), frame.width, frame.height,
+                        static_cast<size_t>(frame.width) * 4);
+                    VIVID_OPENCV_STAGE_LAP(clock, StageCvtColor);
+                    impl->cook(s, cached->luma(), result.pixels);
+                    result.width = frame.width;
+                    result.height = frame.height;
+                    result.contourCount = impl->contours.size();
+                    result.stamp = s.stamp;
+                });
+        }
+        impl->cooker.submit(cpuView.data, width, height, s);
+        impl->publish(this, impl->cooker.takeFresh(), m_outputPixels, m_outputWidth, m_outputHeight);
+        didCook();
+        return;
+    }
 
-    // Store output in CPU pixel buffer
+    if (cookMode == 2) {
+        // Luma, Canny, findContours and drawing each run on their own thread
+        if (!impl->pipeline.configured()) {
+            impl->pipeline.configure(
+                {
+                    [this, impl](Impl::StageFrame& f) {
+                        detail::ThreadBudget budget(f.settings.threads);
+                        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageCvtColor);
+                        f.cached = detail::FrameCache::instance().acquire(
+                            f.settings.input, this, f.settings.frameKey, f.input.pixels.data(),
+                            f.input.width, f.input.height, static_cast<size_t>(f.input.width) * 4);
+                        f.gray = f.cached->luma();
+                    },
+                    [impl](Impl::StageFrame& f) {
+                        detail::ThreadBudget budget(f.settings.threads);
+                        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageCanny);
+                        cv::Canny(f.gray, f.edges, f.settings.threshold1, f.settings.threshold2);
+                        f.gray.release();
+                        f.cached.reset();  // Lets the cache recycle the frame
+                    },
+                    [impl](Impl::StageFrame& f) {
+                        detail::ThreadBudget budget(f.settings.threads);
+                        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageFindContours);
+                        f.contours.clear();
+                        cv::findContours(f.edges, f.contours, f.settings.cvMode, cv::CHAIN_APPROX_SIMPLE);
+                    },
+                },
+                [impl](Impl::StageFrame& f, Impl::Result& result) {
+                    detail::ThreadBudget budget(f.settings.threads);
+                    drawInto(f.contours, f.settings.color, f.settings.thickness,
+                             f.input.width, f.input.height, result.pixels, impl->profile);
+                    result.width = f.input.width;
+                    result.height = f.input.height;
+                    result.contourCount = f.contours.size();
+                    result.stamp = f.settings.stamp;
+                });
+        }
+        impl->pipeline.submit(cpuView.data, width, height,
+                              [&s](Impl::StageFrame& f) { f.settings = s; });
+        impl->publish(this, impl->pipeline.takeFresh(), m_outputPixels, m_outputWidth, m_outputHeight);
+        didCook();
+        return;
+    }
+
+    // Grayscale shared with other operators reading the same input this frame
+    VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+    auto frame = detail::FrameCache::instance().acquire(
+        inputOp, this, received.key, cpuView.data, width, height, static_cast<size_t>(width) * 4);
+    VIVID_OPENCV_STAGE_LAP(clock, StageCvtColor);
+
+    impl->cook(s, frame->luma(), m_outputPixels);
     m_outputWidth = width;
     m_outputHeight = height;
-    size_t dataSize = output.total() * output.elemSize();
-    m_outputPixels.assign(output.data, output.data + dataSize);
+    impl->publishStamp(this, s.stamp);
 
     didCook();
 }
 
 size_t Contours::contourCount() const {
-    return m_impl->contours.size();
+    return m_impl->activeMode != 0 ? m_impl->publishedCount : m_impl->contours.size();
+}
+
+AsyncStats Contours::asyncStats() const {
+    return m_impl->activeMode == 2 ? m_impl->pipeline.stats() : m_impl->cooker.stats();
+}
+
+std::vector<StageTiming> Contours::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats Contours::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void Contours::resetStageTimings() {
+    m_impl->profile.reset();
 }
 
 } // namespace vivid::opencv
@@ -0,0 +1,501 @@
+/**
+ * @file cv_pipeline.cpp
+ * @brief Multi-stage OpenCV pipeline operator implementation
+ */
+
+#include <vivid/opencv/cv_pipeline.h>
+#include <vivid/context.h>
+#include <vivid/chain.h>
+#include "frame_cache.h"
+#include "kernels.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace vivid::opencv {
+
+namespace {
+
+struct StageName {
+    const char* name;
+    CVStageType type;
+};
+
+constexpr StageName kStageNames[] = {
+    {"luma", CVStageType::Luma},
+    {"blur", CVStageType::Blur},
+    {"threshold", CVStageType::Threshold},
+    {"morphology", CVStageType::Morphology},
+    {"canny", CVStageType::Canny},
+    {"contours", CVStageType::Contours},
+    {"blobs", CVStageType::Blobs},
+    {"flow", CVStageType::Flow},
+};
+
+struct MorphName {
+    const char* name;
+    CVMorphOp op;
+};
+
+constexpr MorphName kMorphNames[] = {
+    {"open", CVMorphOp::Open},
+    {"close", CVMorphOp::Close},
+    {"erode", CVMorphOp::Erode},
+    {"dilate", CVMorphOp::Dilate},
+};
+
+// Parse one stage object; throws std::runtime_error with a readable message
+CVStage parseStage(const nlohmann::json& j, size_t index) {
+    if (!j.is_object() || !j.contains("type") || !j["type"].is_string()) {
+        throw std::runtime_error("stage " + std::to_string(index) + ": missing \"type\"");
+    }
+
+    CVStage stage;
+    std::string type = j["type"].get<std::string>();
+    auto it = std::find_if(std::begin(kStageNames), std::end(kStageNames),
+                           [&](const StageName& n) { return type == n.name; });
+    if (it == std::end(kStageNames)) {
+        throw std::runtime_error("stage " + std::to_string(index) + ": unknown type \"" + type + "\"");
+    }
+    stage.type = it->type;
+
+    stage.size = j.value("size", stage.size);
+    stage.threshold = j.value("threshold", stage.threshold);
+    stage.threshold2 = j.value("threshold2", stage.threshold2);
+    stage.invert = j.value("invert", stage.invert);
+    stage.iterations = j.value("iterations", stage.iterations);
+    stage.minArea = j.value("minArea", stage.minArea);
+    stage.maxArea = j.value("maxArea", stage.maxArea);
+    stage.scale = j.value("scale", stage.scale);
+
+    if (j.contains("morphOp")) {
+        std::string op = j["morphOp"].get<std::string>();
+        auto m = std::find_if(std::begin(kMorphNames), std::end(kMorphNames),
+                              [&](const MorphName& n) { return op == n.name; });
+        if (m == std::end(kMorphNames)) {
+            throw std::runtime_error("stage " + std::to_string(index) + ": unknown morphOp \"" + op + "\"");
+        }
+        stage.morphOp = m->op;
+    }
+    return stage;
+}
+
+// Stages timed by CVPipeline::Impl::profile (same order as its names). The
+// first eight are the stage types, indexed by CVStageType.
+enum PipelineStage : int {
+    StageRender = 8,
+    StageAssign,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+static_assert(StageRender == static_cast<int>(CVStageType::Flow) + 1, "stage types come first");
+
+// Pyramid level at `scale` (1 = half size), or 0 if `scale` isn't a power of one half
+int pyramidLevel(float scale) {
+    for (int level = 1; level <= 3; ++level) {
+        if (std::abs(scale - 1.0f / static_cast<float>(1 << level)) < 1e-4f) {
+            return level;
+        }
+    }
+    return 0;
+}
+
+// Clamp user-provided values into ranges OpenCV accepts
+CVStage sanitize(CVStage stage) {
+    stage.size = std::clamp(stage.size | 1, 1, 31);
+    stage.iterations = std::clamp(stage.iterations, 1, 16);
+    stage.scale = std::clamp(stage.scale, 0.1f, 1.0f);
+    stage.minArea = std::max(0.0f, stage.minArea);
+    stage.maxArea = std::max(stage.minArea, stage.maxArea);
+    return stage;
+}
+
+} // namespace
+
+// PIMPL - hides OpenCV types from header
+struct CVPipeline::Impl {
+    std::vector<CVStage> stages;
+    std::string lastError;
+
+    // Ping-pong buffers for single-channel intermediates
+    cv::Mat buffers[2];
+
+    // Analysis results (from the last stage of each kind)
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<std::vector<cv::Point>> keptContours;
+    std::vector<CVPipelineBlob> blobs;
+    cv::Mat morphKernel;
+    int morphKernelSize = -1;
+
+    // Flow state, one slot per stage index (only Flow stages use theirs)
+    struct FlowState {
+        cv::Mat prev;
+        cv::Mat flow;
+        cv::Mat small;
+        float scale = 0.0f;
+    };
+    std::vector<FlowState> flowStates;
+    float meanFlow = 0.0f;
+
+    detail::StageProfile profile{"CVPipeline", {"luma", "blur", "threshold", "morphology", "canny",
+                                                "contours", "blobs", "flow", "render", "assign",
+                                                "process", "cookLatency", "pipelineLatency"}};
+};
+
+CVPipeline::CVPipeline() : m_impl(std::make_unique<Impl>()) {
+    registerParam(lineWidth);
+    registerParam(sensitivity);
+    registerParam(threads);
+}
+
+CVPipeline::~CVPipeline() = default;
+
+void CVPipeline::setStages(const std::vector<CVStage>& stages) {
+    m_impl->stages.clear();
+    for (const CVStage& stage : stages) {
+        m_impl->stages.push_back(sanitize(stage));
+    }
+    m_impl->flowStates.clear();
+    m_impl->flowStates.resize(m_impl->stages.size());
+}
+
+void CVPipeline::addStage(const CVStage& stage) {
+    m_impl->stages.push_back(sanitize(stage));
+    m_impl->flowStates.resize(m_impl->stages.size());
+}
+
+const std::vector<CVStage>& CVPipeline::stages() const {
+    return m_impl->stages;
+}
+
+bool CVPipeline::setStagesJson(const std::string& json) {
+    try {
+        nlohmann::json root = nlohmann::json::parse(json);
+        const nlohmann::json& list = root.is_object() ? root.at("stages") : root;
+        if (!list.is_array()) {
+            throw std::runtime_error("expected an array of stages");
+        }
+
+        std::vector<CVStage> parsed;
+        for (size_t i = 0; i < list.size(); ++i) {
+            parsed.push_back(parseStage(list[i], i));
+        }
+        setStages(parsed);
+        m_impl->lastError.clear();
+        return true;
+    } catch (const std::exception& e) {
+        m_impl->lastError = e.what();
+        return false;
+    }
+}
+
+bool CVPipeline::loadStages(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        m_impl->lastError = "cannot open " + path;
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return setStagesJson(contents.str());
+}
+
+const std::string& CVPipeline::lastError() const {
+    return m_impl->lastError;
+}
+
+void CVPipeline::cleanup() {
+    m_outputPixels.clear();
+    m_outputWidth = 0;
+    m_outputHeight = 0;
+    m_impl->buffers[0].release();
+    m_impl->buffers[1].release();
+    m_impl->contours.clear();
+    m_impl->keptContours.clear();
+    m_impl->blobs.clear();
+    m_impl->flowStates.assign(m_impl->stages.size(), Impl::FlowState{});
+    m_impl->meanFlow = 0.0f;
+    detail::FrameCache::instance().release(this);
+    detail::FrameStamps::instance().release(this);
+}
+
+void CVPipeline::init(Context& ctx) {
+    detail::ensureThreadPool();
+    kernels::initDispatch();
+    detail::installAllocCounter();
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView CVPipeline::cpuPixelView() const {
+    if (m_outputPixels.empty() || m_outputWidth <= 0 || m_outputHeight <= 0) {
+        return {};
+    }
+    return {m_outputPixels.data(), m_outputWidth, m_outputHeight, 4, 0};
+}
+
+void CVPipeline::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    Operator* inputOp = getInput(0);
+    if (!inputOp) {
+        didCook();
+        return;
+    }
+
+    auto cpuView = inputOp->cpuPixelView();
+    if (!cpuView.valid()) {
+        didCook();
+        return;
+    }
+
+    int width = cpuView.width;
+    int height = cpuView.height;
+
+    if (width < 16 || height < 16) {
+        didCook();
+        return;
+    }
+
+    // Cap the threads OpenCV and our kernels may use for this cook
+    detail::ThreadBudget budget(static_cast<int>(threads));
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+    detail::ReceivedFrame received = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+    const FrameStamp& stamp = received.stamp;
+
+    cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(cpuView.data));
+
+    // Every pipeline starts from luma, shared with other operators on this input
+    VIVID_OPENCV_STAGE_CLOCK(clock, m_impl->profile);
+    auto cachedFrame = detail::FrameCache::instance().acquire(
+        inputOp, this, received.key, cpuView.data, width, height, static_cast<size_t>(width) * 4);
+    cv::Mat current = cachedFrame->luma();
+    VIVID_OPENCV_STAGE_LAP(clock, static_cast<int>(CVStageType::Luma));
+    int next = 0;  // Buffer the next image stage writes to
+
+    auto target = [&]() -> cv::Mat& {
+        cv::Mat& dst = m_impl->buffers[next];
+        next ^= 1;
+        return dst;
+    };
+
+    float sens = static_cast<float>(sensitivity);
+    CVStageType last = m_impl->stages.empty() ? CVStageType::Luma : m_impl->stages.back().type;
+    cv::Mat flowViz;  // Only built when a Flow stage is last
+
+    for (size_t i = 0; i < m_impl->stages.size(); ++i) {
+        const CVStage& stage = m_impl->stages[i];
+        bool isLast = i + 1 == m_impl->stages.size();
+
+        switch (stage.type) {
+            case CVStageType::Luma:
+                current = cachedFrame->luma();
+                break;
+
+            case CVStageType::Blur: {
+                cv::Mat& dst = target();
+                cv::GaussianBlur(current, dst, cv::Size(stage.size, stage.size), 0);
+                current = dst;
+                break;
+            }
+
+            case CVStageType::Threshold: {
+                cv::Mat& dst = target();
+                cv::threshold(current, dst, stage.threshold, 255,
+                              stage.invert ? cv::THRESH_BINARY_INV : cv::THRESH_BINARY);
+                current = dst;
+                break;
+            }
+
+            case CVStageType::Morphology: {
+                if (m_impl->morphKernelSize != stage.size) {
+                    m_impl->morphKernel = cv::getStructuringElement(
+                        cv::MORPH_ELLIPSE, cv::Size(stage.size, stage.size));
+                    m_impl->morphKernelSize = stage.size;
+                }
+                int op = cv::MORPH_OPEN;
+                switch (stage.morphOp) {
+                    case CVMorphOp::Open: op = cv::MORPH_OPEN; break;
+                    case CVMorphOp::Close: op = cv::MORPH_CLOSE; break;
+                    case CVMorphOp::Erode: op = cv::MORPH_ERODE; break;
+                    case CVMorphOp::Dilate: op = cv::MORPH_DILATE; break;
+                }
+                cv::Mat& dst = target();
+                cv::morphologyEx(current, dst, op, m_impl->morphKernel, cv::Point(-1, -1),
+                                 stage.iterations);
+                current = dst;
+                break;
+            }
+
+            case CVStageType::Canny: {
+                cv::Mat& dst = target();
+                cv::Canny(current, dst, stage.threshold, stage.threshold2);
+                current = dst;
+                break;
+            }
+
+            case CVStageType::Contours:
+            case CVStageType::Blobs: {
+                // Nonzero pixels are foreground; findContours leaves the image intact
+                cv::findContours(current, m_impl->contours, cv::RETR_EXTERNAL,
+                                 cv::CHAIN_APPROX_SIMPLE);
+                bool blobs = stage.type == CVStageType::Blobs;
+                if (blobs) {
+                    m_impl->blobs.clear();
+                } else {
+                    m_impl->keptContours.clear();
+                }
+                for (auto& contour : m_impl->contours) {
+                    cv::Moments m = cv::moments(contour);
+                    if (m.m00 < stage.minArea || m.m00 > stage.maxArea || m.m00 <= 0.0) {
+                        continue;
+                    }
+                    if (blobs) {
+                        CVPipelineBlob blob;
+                        blob.x = static_cast<float>(m.m10 / m.m00);
+                        blob.y = static_cast<float>(m.m01 / m.m00);
+                        blob.size = static_cast<float>(2.0 * std::sqrt(m.m00 / CV_PI));
+                        m_impl->blobs.push_back(blob);
+                    } else {
+                        m_impl->keptContours.push_back(std::move(contour));
+                    }
+                }
+                break;
+            }
+
+            case CVStageType::Flow: {
+                Impl::FlowState& state = m_impl->flowStates[i];
+                int level = pyramidLevel(stage.scale);
+                cv::Mat small;
+                if (level > 0 && current.data == cachedFrame->luma().data &&
+                    std::min(current.cols, current.rows) >> level >= 16) {
+                    // Straight from luma at a power-of-two scale: the shared pyramid
+                    small = cachedFrame->pyramid(level);
+                } else {
+                    int procWidth = std::max(16, static_cast<int>(current.cols * stage.scale));
+                    int procHeight = std::max(16, static_cast<int>(current.rows * stage.scale));
+                    cv::resize(current, state.small, cv::Size(procWidth, procHeight), 0, 0,
+                               cv::INTER_AREA);
+                    small = state.small;
+                }
+                int procWidth = small.cols;
+                int procHeight = small.rows;
+
+                m_impl->meanFlow = 0.0f;
+                if (!state.prev.empty() && state.prev.size() == small.size()) {
+                    cv::calcOpticalFlowFarneback(state.prev, small, state.flow,
+                                                 0.5, 3, 15, 3, 5, 1.2, 0);
+
+                    cv::Mat channels[2], magnitude, angle;
+                    cv::split(state.flow, channels);
+                    cv::cartToPolar(channels[0], channels[1], magnitude, angle, true);
+                    m_impl->meanFlow = static_cast<float>(cv::mean(magnitude)[0]) / stage.scale;
+
+                    if (isLast) {
+                        // HSV visualization at processing resolution
+                        cv::Mat hue, val, hsv, bgr;
+                        angle.convertTo(hue, CV_8U, 0.5);
+                        magnitude.convertTo(val, CV_8U, 10.0 * sens);
+                        cv::Mat sat(procHeight, procWidth, CV_8U, cv::Scalar(255));
+                        cv::Mat hsvChannels[3] = {hue, sat, val};
+                        cv::merge(hsvChannels, 3, hsv);
+                        cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+                        cv::cvtColor(bgr, flowViz, cv::COLOR_BGR2BGRA);
+                    }
+                }
+                if (small.data == state.small.data) {
+                    std::swap(state.prev, state.small);
+                } else {
+                    small.copyTo(state.prev);  // The pyramid level is only valid this cook
+                }
+                break;
+            }
+        }
+        VIVID_OPENCV_STAGE_LAP(clock, static_cast<int>(stage.type));
+    }
+
+    // Render only the final stage
+    cv::Mat output;
+    int thickness = std::max(1, static_cast<int>(static_cast<float>(lineWidth)));
+    switch (last) {
+        case CVStageType::Contours:
+            input.copyTo(output);
+            cv::drawContours(output, m_impl->keptContours, -1, cv::Scalar(0, 255, 0, 255),
+                             thickness, cv::LINE_AA);
+            break;
+
+        case CVStageType::Blobs:
+            input.copyTo(output);
+            for (const CVPipelineBlob& blob : m_impl->blobs) {
+                cv::circle(output, cv::Point(static_cast<int>(blob.x), static_cast<int>(blob.y)),
+                           std::max(2, static_cast<int>(blob.size / 2)),
+                           cv::Scalar(0, 255, 255, 255), thickness, cv::LINE_AA);
+            }
+            break;
+
+        case CVStageType::Flow:
+            if (flowViz.empty()) {
+                output = cv::Mat(height, width, CV_8UC4, cv::Scalar(0, 0, 0, 255));
+            } else {
+                cv::resize(flowViz, output, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
+            }
+            break;
+
+        default:
+            cv::cvtColor(current, output, cv::COLOR_GRAY2BGRA);
+            break;
+    }
+    VIVID_OPENCV_STAGE_LAP(clock, StageRender);
+
+    // Store output in CPU pixel buffer (BGRA format)
+    m_outputWidth = width;
+    m_outputHeight = height;
+    size_t dataSize = output.total() * output.elemSize();
+    m_outputPixels.assign(output.data, output.data + dataSize);
+    VIVID_OPENCV_STAGE_LAP(clock, StageAssign);
+
+    m_impl->profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                                  detail::FrameStamps::instance().publish(this, "CVPipeline", stamp));
+    didCook();
+}
+
+int CVPipeline::contourCount() const {
+    return static_cast<int>(m_impl->keptContours.size());
+}
+
+const std::vector<CVPipelineBlob>& CVPipeline::blobs() const {
+    return m_impl->blobs;
+}
+
+float CVPipeline::meanFlow() const {
+    return m_impl->meanFlow;
+}
+
+std::vector<StageTiming> CVPipeline::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats CVPipeline::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void CVPipeline::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVCVPipeline = vivid::opencv::CVPipeline;
+REGISTER_OPERATOR(OpenCVCVPipeline, "OpenCV", "Multi-stage OpenCV pipeline in a single cook", true);
@@ -0,0 +1,106 @@
+/**
+ * @file flow_common.cpp
+ * @brief Dense flow solving and visualization shared by the flow operators
+ */
+
+#include "flow_common.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv::detail {
+
+void computeFlow(const cv::Mat& prev, const cv::Mat& next, cv::Mat& flow,
+                 const FlowSettings& settings) {
+    cv::calcOpticalFlowFarneback(
+        prev, next, flow,
+        settings.pyrScale,
+        settings.levels,
+        settings.winSize,
+        settings.iterations,
+        settings.polyN,
+        settings.polySigma,
+        0  // flags
+    );
+}
+
+void renderFlow(const cv::Mat& flow, FlowVizMode mode, float sensitivity,
+                const cv::Mat& background, cv::Mat& output) {
+    const int width = background.cols;
+    const int height = background.rows;
+    const int procWidth = flow.cols;
+    const int procHeight = flow.rows;
+
+    if (mode == FlowVizMode::Arrows) {
+        // Arrow field overlay - draw at FULL resolution for quality
+        background.copyTo(output);
+
+        // Upsample flow to full resolution
+        cv::Mat flowFull;
+        cv::resize(flow, flowFull, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
+        float flowScale = static_cast<float>(width) / procWidth;  // Scale vectors to full res
+
+        // Draw arrows at regular grid spacing
+        int step = 20;  // Pixel spacing between arrows
+        for (int y = step / 2; y < height; y += step) {
+            for (int x = step / 2; x < width; x += step) {
+                const cv::Vec2f& f = flowFull.at<cv::Vec2f>(y, x);
+                float fx = f[0] * flowScale * sensitivity;
+                float fy = f[1] * flowScale * sensitivity;
+                float mag = std::sqrt(fx * fx + fy * fy);
+
+                // Only draw if there's significant motion
+                if (mag > 1.0f) {
+                    cv::Point2f start(static_cast<float>(x), static_cast<float>(y));
+                    cv::Point2f end(x + fx * 2, y + fy * 2);
+                    // Color based on magnitude (green to red)
+                    int green = static_cast<int>(std::max(0.0f, 255.0f - mag * 5));
+                    int red = static_cast<int>(std::min(255.0f, mag * 10));
+                    cv::arrowedLine(output, start, end, cv::Scalar(0, green, red, 255), 2, cv::LINE_AA, 0, 0.3);
+                }
+            }
+        }
+        return;
+    }
+
+    // Do all other visualization at REDUCED resolution, then upsample
+    cv::Mat flowChannels[2];
+    cv::split(flow, flowChannels);
+    flowChannels[0] *= sensitivity;
+    flowChannels[1] *= sensitivity;
+
+    cv::Mat magnitude, angle;
+    cv::cartToPolar(flowChannels[0], flowChannels[1], magnitude, angle, true);
+
+    cv::Mat smallOutput;
+    if (mode == FlowVizMode::Color) {
+        // HSV color wheel visualization
+        cv::Mat hue, sat, val;
+        angle.convertTo(hue, CV_8U, 0.5);
+        sat = cv::Mat(procHeight, procWidth, CV_8U, cv::Scalar(255));
+        magnitude.convertTo(val, CV_8U, 10.0);
+
+        std::vector<cv::Mat> hsvChannels = {hue, sat, val};
+        cv::Mat hsv;
+        cv::merge(hsvChannels, hsv);
+
+        cv::Mat rgb;
+        cv::cvtColor(hsv, rgb, cv::COLOR_HSV2BGR);
+        cv::cvtColor(rgb, smallOutput, cv::COLOR_BGR2BGRA);
+    } else {
+        // Magnitude only (grayscale)
+        cv::Mat gray8;
+        magnitude.convertTo(gray8, CV_8U, 10.0);
+        cv::cvtColor(gray8, smallOutput, cv::COLOR_GRAY2BGRA);
+    }
+
+    // Upsample final visualization to full resolution
+    if (smallOutput.size() != background.size()) {
+        cv::resize(smallOutput, output, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
+    } else {
+        smallOutput.copyTo(output);
+    }
+}
+
+} // namespace vivid::opencv::detail
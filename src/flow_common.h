@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file flow_common.h
+ * @brief Dense flow solving and visualization shared by the flow operators (internal)
+ */
+
+#include <vivid/opencv/optical_flow.h>
+#include <opencv2/core.hpp>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Farneback settings (see cv::calcOpticalFlowFarneback)
+ */
+struct FlowSettings {
+    double pyrScale = 0.5;
+    int levels = 1;
+    int winSize = 9;
+    int iterations = 1;
+    int polyN = 5;
+    double polySigma = 1.1;
+};
+
+/// Solve dense flow from `prev` to `next` (8-bit gray, same size) into `flow` (CV_32FC2)
+void computeFlow(const cv::Mat& prev, const cv::Mat& next, cv::Mat& flow,
+                 const FlowSettings& settings);
+
+/**
+ * @brief Render a flow field as BGRA at the output resolution
+ * @param flow CV_32FC2 flow at processing resolution
+ * @param mode Visualization mode
+ * @param sensitivity Gain applied to the vectors before rendering
+ * @param background Full-resolution BGRA frame (drawn under Arrows)
+ * @param output Receives a BGRA image the size of `background`
+ *
+ * Color and Magnitude are rendered at processing resolution and upsampled;
+ * Arrows are drawn at full resolution over the background.
+ */
+void renderFlow(const cv::Mat& flow, FlowVizMode mode, float sensitivity,
+                const cv::Mat& background, cv::Mat& output);
+
+} // namespace vivid::opencv::detail
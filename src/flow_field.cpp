@@ -0,0 +1,198 @@
+/**
+ * @file flow_field.cpp
+ * @brief Dense optical flow source operator implementation
+ */
+
+#include <vivid/opencv/flow_field.h>
+#include <vivid/context.h>
+#include <vivid/chain.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "flow_common.h"
+#include "frame_cache.h"
+#include "kernels.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace vivid::opencv {
+
+namespace {
+
+// Stages timed by FlowField::Impl::profile (same order as its names)
+enum FlowFieldStage : int {
+    StageLuma,
+    StageSolve,
+    StageStorePrev,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
+// PIMPL - hides OpenCV types from header
+struct FlowField::Impl {
+    cv::Mat prevGray;      // Previous frame (grayscale, processing resolution)
+    cv::Mat flow;          // Flow field (2-channel float)
+    bool hasPrevFrame = false;
+    bool hasFlow = false;
+    uint64_t solves = 0;
+
+    // Passed-through input frame
+    CpuPixelView passthrough;
+    float toInputX = 1.0f;
+    float toInputY = 1.0f;
+
+    detail::StageProfile profile{"FlowField", {"luma", "calcOpticalFlowFarneback", "storePrev",
+                                               "process", "cookLatency", "pipelineLatency"}};
+};
+
+FlowField::FlowField() : m_impl(std::make_unique<Impl>()) {
+    registerParam(scale);
+    registerParam(pyrScale);
+    registerParam(levels);
+    registerParam(winSize);
+    registerParam(iterations);
+    registerParam(polyN);
+    registerParam(polySigma);
+    registerParam(threads);
+}
+
+FlowField::~FlowField() = default;
+
+void FlowField::cleanup() {
+    m_impl->prevGray.release();
+    m_impl->flow.release();
+    m_impl->hasPrevFrame = false;
+    m_impl->hasFlow = false;
+    m_impl->passthrough = {};
+    detail::FrameCache::instance().release(this);
+    detail::FrameStamps::instance().release(this);
+}
+
+void FlowField::init(Context& ctx) {
+    detail::ensureThreadPool();
+    kernels::initDispatch();
+    detail::installAllocCounter();
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView FlowField::cpuPixelView() const {
+    return m_impl->passthrough;
+}
+
+void FlowField::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    Operator* inputOp = getInput(0);
+    if (!inputOp) {
+        m_impl->passthrough = {};
+        didCook();
+        return;
+    }
+
+    auto cpuView = inputOp->cpuPixelView();
+    if (!cpuView.valid()) {
+        m_impl->passthrough = {};
+        didCook();
+        return;
+    }
+
+    int width = cpuView.width;
+    int height = cpuView.height;
+
+    if (width < 16 || height < 16) {
+        m_impl->passthrough = {};
+        didCook();
+        return;
+    }
+
+    // Cap the threads OpenCV and our kernels may use for this cook
+    detail::ThreadBudget budget(static_cast<int>(threads));
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+
+    // The input frame is our image output (zero-copy)
+    m_impl->passthrough = cpuView;
+    detail::ReceivedFrame received = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+    const FrameStamp& stamp = received.stamp;
+
+    // Downsample for faster processing
+    float s = std::clamp(static_cast<float>(scale), 0.1f, 1.0f);
+    int procWidth = std::max(16, static_cast<int>(width * s));
+    int procHeight = std::max(16, static_cast<int>(height * s));
+
+    // Grayscale at processing resolution, shared with other operators
+    // reading the same input this frame
+    VIVID_OPENCV_STAGE_CLOCK(clock, m_impl->profile);
+    auto frame = detail::FrameCache::instance().acquire(
+        inputOp, this, received.key, cpuView.data, width, height, static_cast<size_t>(width) * 4);
+    cv::Mat gray = s < 0.99f ? frame->scaled(cv::Size(procWidth, procHeight)) : frame->luma();
+    VIVID_OPENCV_STAGE_LAP(clock, StageLuma);
+
+    if (m_impl->hasPrevFrame && m_impl->prevGray.size() == gray.size()) {
+        detail::FlowSettings settings;
+        settings.pyrScale = static_cast<double>(pyrScale);
+        settings.levels = static_cast<int>(levels);
+        settings.winSize = static_cast<int>(winSize);
+        settings.iterations = static_cast<int>(iterations);
+        settings.polyN = static_cast<int>(polyN);
+        settings.polySigma = static_cast<double>(polySigma);
+        detail::computeFlow(m_impl->prevGray, gray, m_impl->flow, settings);
+        VIVID_OPENCV_STAGE_LAP(clock, StageSolve);
+
+        m_impl->hasFlow = true;
+        m_impl->solves++;
+        m_impl->toInputX = static_cast<float>(width) / gray.cols;
+        m_impl->toInputY = static_cast<float>(height) / gray.rows;
+    } else {
+        // Resolution changed or first frame: no field until the next solve
+        m_impl->hasFlow = false;
+    }
+
+    // Store current frame for next iteration (at processing resolution)
+    gray.copyTo(m_impl->prevGray);
+    m_impl->hasPrevFrame = true;
+    VIVID_OPENCV_STAGE_LAP(clock, StageStorePrev);
+
+    m_impl->profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                                  detail::FrameStamps::instance().publish(this, "FlowField", stamp));
+    didCook();
+}
+
+FlowFieldView FlowField::field() const {
+    FlowFieldView view;
+    if (!m_impl->hasFlow || m_impl->flow.empty()) {
+        return view;
+    }
+    view.data = m_impl->flow.ptr<float>();
+    view.width = m_impl->flow.cols;
+    view.height = m_impl->flow.rows;
+    view.stride = m_impl->flow.step / sizeof(float);
+    view.toInputX = m_impl->toInputX;
+    view.toInputY = m_impl->toInputY;
+    view.frame = m_impl->solves;
+    return view;
+}
+
+std::vector<StageTiming> FlowField::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats FlowField::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void FlowField::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVFlowField = vivid::opencv::FlowField;
+REGISTER_OPERATOR(OpenCVFlowField, "OpenCV", "Dense optical flow field shared by flow consumers", true);
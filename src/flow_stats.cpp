@@ -0,0 +1,197 @@
+/**
+ * @file flow_stats.cpp
+ * @brief Flow analysis operator implementation
+ */
+
+#include <vivid/opencv/flow_stats.h>
+#include <vivid/opencv/flow_field.h>
+#include <vivid/context.h>
+#include <vivid/chain.h>
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv {
+
+namespace {
+
+// Stages timed by FlowStats::Impl::profile (same order as its names)
+enum FlowStatsStage : int {
+    StageReduce,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
+struct FlowStats::Impl {
+    CpuPixelView passthrough;
+    float meanMagnitude = 0.0f;
+    float maxMagnitude = 0.0f;
+    float meanX = 0.0f;
+    float meanY = 0.0f;
+    float motionFraction = 0.0f;
+
+    void clear() {
+        meanMagnitude = 0.0f;
+        maxMagnitude = 0.0f;
+        meanX = 0.0f;
+        meanY = 0.0f;
+        motionFraction = 0.0f;
+    }
+
+    detail::StageProfile profile{"FlowStats", {"reduce", "process", "cookLatency",
+                                               "pipelineLatency"}};
+};
+
+FlowStats::FlowStats() : m_impl(std::make_unique<Impl>()) {
+    registerParam(motionThreshold);
+    registerParam(regionX);
+    registerParam(regionY);
+    registerParam(regionW);
+    registerParam(regionH);
+}
+
+FlowStats::~FlowStats() = default;
+
+void FlowStats::cleanup() {
+    m_impl->passthrough = {};
+    m_impl->clear();
+    detail::FrameStamps::instance().release(this);
+}
+
+void FlowStats::init(Context& ctx) {
+    detail::installAllocCounter();
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView FlowStats::cpuPixelView() const {
+    return m_impl->passthrough;
+}
+
+void FlowStats::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    auto* source = dynamic_cast<FlowField*>(getInput(0));
+    if (!source) {
+        m_impl->passthrough = {};
+        m_impl->clear();
+        didCook();
+        return;
+    }
+
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+
+    m_impl->passthrough = source->cpuPixelView();
+    const CpuPixelView& view = m_impl->passthrough;
+    FrameStamp stamp;
+    if (view.valid()) {
+        stamp = detail::FrameStamps::instance().receive(source, this, ctx.frame()).stamp;
+    }
+
+    FlowFieldView field = source->field();
+    if (!field.valid()) {
+        m_impl->clear();
+        didCook();
+        return;
+    }
+
+    // Region in field samples (at least one sample)
+    VIVID_OPENCV_STAGE_CLOCK(clock, m_impl->profile);
+    float rx = std::clamp(static_cast<float>(regionX), 0.0f, 1.0f);
+    float ry = std::clamp(static_cast<float>(regionY), 0.0f, 1.0f);
+    float rw = std::clamp(static_cast<float>(regionW), 0.0f, 1.0f - rx);
+    float rh = std::clamp(static_cast<float>(regionH), 0.0f, 1.0f - ry);
+    int x0 = std::min(field.width - 1, static_cast<int>(rx * field.width));
+    int y0 = std::min(field.height - 1, static_cast<int>(ry * field.height));
+    int x1 = std::max(x0 + 1, static_cast<int>((rx + rw) * field.width));
+    int y1 = std::max(y0 + 1, static_cast<int>((ry + rh) * field.height));
+
+    // Reduce in input pixels; compare squared speeds to avoid a sqrt per sample
+    const float sx = field.toInputX;
+    const float sy = field.toInputY;
+    const float threshold = static_cast<float>(motionThreshold);
+    const float threshold2 = threshold * threshold;
+
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumMag = 0.0;
+    float max2 = 0.0f;
+    int moving = 0;
+
+    for (int y = y0; y < y1; ++y) {
+        const float* row = field.data + y * field.stride;
+        for (int x = x0; x < x1; ++x) {
+            float dx = row[2 * x] * sx;
+            float dy = row[2 * x + 1] * sy;
+            float mag2 = dx * dx + dy * dy;
+            sumX += dx;
+            sumY += dy;
+            sumMag += std::sqrt(mag2);
+            max2 = std::max(max2, mag2);
+            moving += mag2 > threshold2 ? 1 : 0;
+        }
+    }
+
+    double count = static_cast<double>(x1 - x0) * (y1 - y0);
+    m_impl->meanX = static_cast<float>(sumX / count);
+    m_impl->meanY = static_cast<float>(sumY / count);
+    m_impl->meanMagnitude = static_cast<float>(sumMag / count);
+    m_impl->maxMagnitude = std::sqrt(max2);
+    m_impl->motionFraction = static_cast<float>(moving / count);
+    VIVID_OPENCV_STAGE_LAP(clock, StageReduce);
+
+    if (stamp.valid()) {
+        m_impl->profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                                      detail::FrameStamps::instance().publish(this, "FlowStats", stamp));
+    }
+    didCook();
+}
+
+float FlowStats::meanMagnitude() const {
+    return m_impl->meanMagnitude;
+}
+
+float FlowStats::maxMagnitude() const {
+    return m_impl->maxMagnitude;
+}
+
+float FlowStats::meanX() const {
+    return m_impl->meanX;
+}
+
+float FlowStats::meanY() const {
+    return m_impl->meanY;
+}
+
+float FlowStats::direction() const {
+    float degrees = std::atan2(m_impl->meanY, m_impl->meanX) * 57.2957795f;
+    return degrees < 0.0f ? degrees + 360.0f : degrees;
+}
+
+float FlowStats::motionFraction() const {
+    return m_impl->motionFraction;
+}
+
+std::vector<StageTiming> FlowStats::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats FlowStats::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void FlowStats::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVFlowStats = vivid::opencv::FlowStats;
+REGISTER_OPERATOR(OpenCVFlowStats, "OpenCV", "Motion statistics from a flow field", true);
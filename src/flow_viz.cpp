@@ -0,0 +1,128 @@
+/**
+ * @file flow_viz.cpp
+ * @brief Flow visualization operator implementation
+ */
+
+#include <vivid/opencv/flow_viz.h>
+#include <vivid/opencv/flow_field.h>
+#include <vivid/context.h>
+#include <vivid/chain.h>
+#include <opencv2/core.hpp>
+#include "flow_common.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "trace.h"
+
+namespace vivid::opencv {
+
+namespace {
+
+// Stages timed by FlowViz::Impl::profile (same order as its names)
+enum FlowVizStage : int {
+    StageRender,
+    StageAssign,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
+struct FlowViz::Impl {
+    detail::StageProfile profile{"FlowViz", {"render", "assign", "process", "cookLatency",
+                                             "pipelineLatency"}};
+};
+
+FlowViz::FlowViz() : m_impl(std::make_unique<Impl>()) {
+    registerParam(vizMode);
+    registerParam(sensitivity);
+}
+
+FlowViz::~FlowViz() = default;
+
+void FlowViz::cleanup() {
+    m_outputPixels.clear();
+    m_outputWidth = 0;
+    m_outputHeight = 0;
+    detail::FrameStamps::instance().release(this);
+}
+
+void FlowViz::init(Context& ctx) {
+    detail::installAllocCounter();
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView FlowViz::cpuPixelView() const {
+    if (m_outputPixels.empty() || m_outputWidth <= 0 || m_outputHeight <= 0) {
+        return {};
+    }
+    return {m_outputPixels.data(), m_outputWidth, m_outputHeight, 4, 0};
+}
+
+void FlowViz::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    auto* source = dynamic_cast<FlowField*>(getInput(0));
+    if (!source) {
+        didCook();
+        return;
+    }
+
+    auto frameView = source->cpuPixelView();
+    if (!frameView.valid()) {
+        didCook();
+        return;
+    }
+
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
+
+    int width = frameView.width;
+    int height = frameView.height;
+    FrameStamp stamp = detail::FrameStamps::instance().receive(source, this, ctx.frame()).stamp;
+    cv::Mat background(height, width, CV_8UC4, const_cast<uint8_t*>(frameView.data));
+
+    VIVID_OPENCV_STAGE_CLOCK(clock, m_impl->profile);
+    cv::Mat output;
+    FlowFieldView field = source->field();
+    if (field.valid()) {
+        // Wrap the published field (zero-copy)
+        cv::Mat flow(field.height, field.width, CV_32FC2,
+                     const_cast<float*>(field.data), field.stride * sizeof(float));
+        detail::renderFlow(flow, static_cast<FlowVizMode>(static_cast<int>(vizMode)),
+                           static_cast<float>(sensitivity), background, output);
+    } else {
+        output = cv::Mat(height, width, CV_8UC4, cv::Scalar(0, 0, 0, 255));
+    }
+    VIVID_OPENCV_STAGE_LAP(clock, StageRender);
+
+    // Store output in CPU pixel buffer (BGRA format)
+    m_outputWidth = width;
+    m_outputHeight = height;
+    size_t dataSize = output.total() * output.elemSize();
+    m_outputPixels.assign(output.data, output.data + dataSize);
+    VIVID_OPENCV_STAGE_LAP(clock, StageAssign);
+
+    m_impl->profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                                  detail::FrameStamps::instance().publish(this, "FlowViz", stamp));
+    didCook();
+}
+
+std::vector<StageTiming> FlowViz::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats FlowViz::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void FlowViz::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVFlowViz = vivid::opencv::FlowViz;
+REGISTER_OPERATOR(OpenCVFlowViz, "OpenCV", "Flow field visualization (HSV, arrows, magnitude)", true);
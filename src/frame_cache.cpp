@@ -0,0 +1,140 @@
+/**
+ * @file frame_cache.cpp
+ * @brief Per-frame preprocessing shared by operators on the same input
+ */
+
+#include "frame_cache.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+namespace vivid::opencv::detail {
+
+void CachedFrame::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = false;
+    // Lazy views are rebuilt on demand into the previous frame's buffers
+    m_scaledCount = 0;
+    m_levelCount = 0;
+}
+
+void CachedFrame::compute(const uint8_t* bgra, int width, int height, size_t step) {
+    auto publish = [this] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready = true;
+        m_computed.notify_all();
+    };
+
+    cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(bgra), step);
+    try {
+        cv::cvtColor(input, m_luma, cv::COLOR_BGRA2GRAY);  // Reuses m_luma when recycled
+    } catch (...) {
+        m_luma.release();  // Waiters must not block forever; they see an empty frame
+        publish();
+        throw;
+    }
+    publish();
+}
+
+void CachedFrame::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_computed.wait(lock, [this] { return m_ready; });
+}
+
+cv::Mat CachedFrame::scaled(cv::Size size) {
+    if (size == m_luma.size()) {
+        return m_luma;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_scaledCount; ++i) {
+        if (m_scaled[i].size() == size) {
+            return m_scaled[i];
+        }
+    }
+    if (m_scaledCount == m_scaled.size()) {
+        m_scaled.emplace_back();
+    }
+    cv::Mat& dst = m_scaled[m_scaledCount++];
+    cv::resize(m_luma, dst, size, 0, 0, cv::INTER_AREA);
+    return dst;
+}
+
+cv::Mat CachedFrame::pyramid(int level) {
+    if (level <= 0) {
+        return m_luma;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (static_cast<int>(m_levelCount) < level) {
+        const cv::Mat& prev = m_levelCount == 0 ? m_luma : m_levels[m_levelCount - 1];
+        if (prev.cols < 2 || prev.rows < 2) {
+            break;  // Coarsest level reached
+        }
+        if (m_levelCount == m_levels.size()) {
+            m_levels.emplace_back();
+        }
+        cv::pyrDown(prev, m_levels[m_levelCount]);
+        ++m_levelCount;
+    }
+    return m_levelCount == 0 ? m_luma : m_levels[std::min<size_t>(level, m_levelCount) - 1];
+}
+
+FrameCache& FrameCache::instance() {
+    static FrameCache cache;
+    return cache;
+}
+
+std::shared_ptr<CachedFrame> FrameCache::acquire(const void* source, const void* consumer,
+                                                 uint64_t key, const uint8_t* bgra, int width,
+                                                 int height, size_t step) {
+    std::shared_ptr<CachedFrame> frame;
+    bool claimed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_entries[source];
+        entry.consumers.insert(consumer);
+
+        if (entry.current.frame && entry.current.key == key) {
+            frame = entry.current.frame;
+        } else if (entry.previous.frame && entry.previous.key == key) {
+            frame = entry.previous.frame;
+        } else {
+            // A newer frame demotes the current one; an older one (a consumer
+            // cooking behind) only replaces the previous
+            Slot* slot = &entry.previous;
+            if (key > entry.current.key) {
+                std::swap(entry.current, entry.previous);
+                slot = &entry.current;
+            }
+            // Recycle the evicted frame's buffers if nobody holds it
+            if (!slot->frame || slot->frame.use_count() > 1) {
+                slot->frame = std::make_shared<CachedFrame>();
+            }
+            slot->frame->reset();
+            slot->key = key;
+            frame = slot->frame;
+            claimed = true;
+        }
+    }
+
+    // Convert outside the cache lock; consumers of other inputs never wait
+    if (claimed) {
+        m_conversions.fetch_add(1, std::memory_order_relaxed);
+        frame->compute(bgra, width, height, step);
+    } else {
+        frame->wait();
+    }
+    return frame;
+}
+
+void FrameCache::release(const void* consumer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        it->second.consumers.erase(consumer);
+        if (it->second.consumers.empty()) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file frame_cache.h
+ * @brief Per-frame preprocessing shared by operators on the same input (internal)
+ */
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Derived images of one input frame
+ *
+ * Luma is computed once, by the first consumer to ask for the frame, while
+ * later consumers wait for it; scaled copies and pyramid levels are
+ * computed on first request and then shared. All
+ * returned Mats are read-only views that stay valid only while the
+ * shared_ptr from FrameCache::acquire() is held; consumers must copy
+ * anything they keep or modify. Safe to use from several threads.
+ */
+class CachedFrame {
+public:
+    /// Full-resolution 8-bit luma (COLOR_BGRA2GRAY)
+    const cv::Mat& luma() const { return m_luma; }
+
+    /// Luma resized to `size` with INTER_AREA (returns luma() at full size)
+    cv::Mat scaled(cv::Size size);
+
+    /// Gaussian pyramid level (0 = luma, each level half the previous)
+    cv::Mat pyramid(int level);
+
+private:
+    friend class FrameCache;
+
+    // Forget the previous frame before the entry is handed out for a new one
+    void reset();
+
+    // Convert the frame and wake the consumers waiting for it
+    void compute(const uint8_t* bgra, int width, int height, size_t step);
+
+    // Block until compute() has finished on the claiming thread
+    void wait();
+
+    cv::Mat m_luma;
+    std::mutex m_mutex;                       // Guards readiness and the lazily built views
+    std::condition_variable m_computed;
+    bool m_ready = false;
+    std::deque<cv::Mat> m_scaled;             // Deque: growth never moves entries
+    std::deque<cv::Mat> m_levels;             // m_levels[i] = pyramid level i + 1
+    size_t m_scaledCount = 0;                 // Entries valid for the current frame
+    size_t m_levelCount = 0;
+};
+
+/**
+ * @brief Module-wide cache of CachedFrame entries keyed by input operator
+ *
+ * Frames are identified by the key FrameStamps hands out with each received
+ * frame (ReceivedFrame::key), which changes whenever the source's output
+ * changes - never by looking at the pixels, so a source that rewrites its
+ * buffer in place can't be served stale luma. Each input keeps its newest
+ * frame and the one before, so a consumer cooking a frame behind (an async
+ * worker) still shares work without evicting the current frame. Entries
+ * are recycled in place when no consumer still holds them, so a steady
+ * stream of frames does not allocate.
+ *
+ * The conversion runs outside the cache lock: the first consumer of a key
+ * claims the entry and converts it, others reading the same frame wait for
+ * that entry only.
+ *
+ * @code
+ * auto frame = detail::FrameCache::instance().acquire(inputOp, this, received.key, data, w, h, w * 4);
+ * const cv::Mat& gray = frame->luma();
+ * @endcode
+ */
+class FrameCache {
+public:
+    static FrameCache& instance();
+
+    /**
+     * @brief Get the cached frame for `source`, computing it if this is a new frame
+     * @param source Input operator the pixels came from
+     * @param consumer Operator making the request
+     * @param key The frame's ReceivedFrame::key
+     */
+    std::shared_ptr<CachedFrame> acquire(const void* source, const void* consumer, uint64_t key,
+                                         const uint8_t* bgra, int width, int height,
+                                         size_t step);
+
+    /// Forget a consumer (call from cleanup); drops inputs nobody reads any more
+    void release(const void* consumer);
+
+    /// Luma conversions run so far, across all inputs (one per distinct frame)
+    uint64_t conversions() const { return m_conversions.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::shared_ptr<CachedFrame> frame;
+        uint64_t key = 0;
+    };
+
+    struct Entry {
+        Slot current;                               // Newest key requested
+        Slot previous;                              // An older key still being cooked
+        std::unordered_set<const void*> consumers;  // Every consumer ever served
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<const void*, Entry> m_entries;
+    std::atomic<uint64_t> m_conversions{0};
+};
+
+} // namespace vivid::opencv::detail
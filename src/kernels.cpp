@@ -0,0 +1,151 @@
+/**
+ * @file kernels.cpp
+ * @brief Vectorized pixel kernels shared by the OpenCV operators
+ *
+ * The row kernels live in kernels.simd.hpp. This file builds the baseline
+ * variant and chooses between it and the wider variants CMake built
+ * (VIVID_OPENCV_KERNELS_AVX2, VIVID_OPENCV_KERNELS_AVX512_SKX).
+ */
+
+#define VIVID_OPENCV_KERNELS_NAMESPACE cpu_baseline
+#define VIVID_OPENCV_KERNELS_ISA "baseline"
+#include "kernels.simd.hpp"
+
+#include <vivid/opencv/cpu_dispatch.h>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <string>
+
+#ifdef VIVID_OPENCV_WITH_HAL
+namespace vivid_hal {
+const char* isa();  // hal/vivid_hal.hpp, linked into opencv_core
+}
+#endif
+
+namespace vivid::opencv::kernels {
+
+#ifdef VIVID_OPENCV_KERNELS_AVX2
+namespace opt_AVX2 {
+const RowKernels& rowKernels();
+}
+#endif
+#ifdef VIVID_OPENCV_KERNELS_AVX512_SKX
+namespace opt_AVX512_SKX {
+const RowKernels& rowKernels();
+}
+#endif
+
+namespace {
+
+const char* const kVariants[] = {
+    "baseline",
+#ifdef VIVID_OPENCV_KERNELS_AVX2
+    "AVX2",
+#endif
+#ifdef VIVID_OPENCV_KERNELS_AVX512_SKX
+    "AVX512_SKX",
+#endif
+};
+
+// Widest variant the CPU runs. cv::checkHardwareSupport() reads CPUID once
+// and honours OPENCV_CPU_DISABLE, so one setting narrows OpenCV and us alike.
+const RowKernels& selectKernels() {
+#ifdef VIVID_OPENCV_KERNELS_AVX512_SKX
+    if (cv::checkHardwareSupport(CV_CPU_AVX512_SKX)) {
+        return opt_AVX512_SKX::rowKernels();
+    }
+#endif
+#ifdef VIVID_OPENCV_KERNELS_AVX2
+    if (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3)) {
+        return opt_AVX2::rowKernels();
+    }
+#endif
+    return cpu_baseline::rowKernels();
+}
+
+const RowKernels& active() {
+    static const RowKernels& kernels = selectKernels();
+    return kernels;
+}
+
+} // namespace
+
+void initDispatch() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        CpuDispatch info = cpuDispatch();
+        std::string built;
+        for (const std::string& variant : info.variants) {
+            built += built.empty() ? variant : " " + variant;
+        }
+        std::fprintf(stderr, "[vivid-opencv] SIMD kernels: %s (built: %s)\n",
+                     info.kernels.c_str(), built.c_str());
+        std::fprintf(stderr, "[vivid-opencv] OpenCV CPU features: %s\n", info.opencv.c_str());
+        std::fprintf(stderr, "[vivid-opencv] OpenCV HAL: %s\n",
+                     info.hal.empty() ? "off" : info.hal.c_str());
+    });
+}
+
+LumaPeak findMaxLuma(const uint8_t* src, size_t srcStep,
+                     int x0, int y0, int x1, int y1, int rowStride) {
+    LumaPeak peak;
+    rowStride = std::max(1, rowStride);
+    auto maxLuma = active().maxLuma;
+
+    for (int y = y0; y < y1; y += rowStride) {
+        const uint8_t* row = src + y * srcStep;
+        int rowBest = maxLuma(row, x0, x1);
+        if (rowBest <= peak.value) {
+            continue;
+        }
+
+        // New maximum: locate its column with a scalar rescan of this row only
+        for (int x = x0; x < x1; ++x) {
+            if (pixelLuma(row + x * 4) == rowBest) {
+                peak.x = x;
+                peak.y = y;
+                peak.value = rowBest;
+                break;
+            }
+        }
+    }
+    return peak;
+}
+
+void bgraToHsvMask(const uint8_t* src, size_t srcStep,
+                   uint8_t* dst, size_t dstStep,
+                   int width, int height, const HsvRange& range) {
+    auto hsvMask = active().hsvMask;
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        hsvMask(src, srcStep, dst, dstStep, width, rows.start, rows.end, range);
+    });
+}
+
+void updateBackground(const uint8_t* gray, size_t grayStep,
+                      float* mean, float* var,
+                      uint8_t* mask, size_t maskStep,
+                      int width, int height, const BackgroundParams& params) {
+    auto background = active().background;
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        background(gray, grayStep, mean, var, mask, maskStep, width,
+                   rows.start, rows.end, params);
+    });
+}
+
+} // namespace vivid::opencv::kernels
+
+namespace vivid::opencv {
+
+CpuDispatch cpuDispatch() {
+    CpuDispatch info;
+    info.kernels = kernels::active().isa;
+    info.variants.assign(std::begin(kernels::kVariants), std::end(kernels::kVariants));
+    info.opencv = cv::getCPUFeaturesLine();
+#ifdef VIVID_OPENCV_WITH_HAL
+    info.hal = vivid_hal::isa();
+#endif
+    return info;
+}
+
+} // namespace vivid::opencv
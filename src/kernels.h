@@ -0,0 +1,99 @@
+#pragma once
+
+/**
+ * @file kernels.h
+ * @brief Vectorized pixel kernels shared by the OpenCV operators (internal)
+ *
+ * Kernels are written with OpenCV's universal intrinsics so they map to
+ * SSE/AVX on x86 and NEON on ARM, with a scalar tail for the last pixels of
+ * each row. On x86-64 they are built for the baseline, AVX2 and AVX-512 and
+ * the widest variant the CPU supports is used (see kernels.simd.hpp).
+ * All kernels read BGRA input as served by cpuPixelView().
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vivid::opencv::kernels {
+
+/**
+ * @brief Choose the kernel variant for this CPU and log it, once
+ *
+ * Kernels choose on first use anyway; operators call this from init() so
+ * the choice is made, and reported on stderr, when the addon starts.
+ */
+void initDispatch();
+
+/**
+ * @brief Inclusive HSV range for color masking
+ *
+ * Hue is in degrees [0, 360). When hueMin > hueMax the range wraps through
+ * 0 (e.g. 340..20 selects reds on both sides of the seam).
+ */
+struct HsvRange {
+    float hueMin = 0.0f;
+    float hueMax = 360.0f;
+    uint8_t satMin = 0;
+    uint8_t satMax = 255;
+    uint8_t valMin = 0;
+    uint8_t valMax = 255;
+};
+
+/**
+ * @brief Fused BGRA -> HSV -> in-range mask
+ *
+ * Writes 255 where the pixel's hue, saturation and value all fall inside
+ * the range and 0 elsewhere. No intermediate HSV image is produced.
+ * Rows are split across OpenCV's parallel_for_ workers.
+ */
+void bgraToHsvMask(const uint8_t* src, size_t srcStep,
+                   uint8_t* dst, size_t dstStep,
+                   int width, int height, const HsvRange& range);
+
+/**
+ * @brief Running background model settings for updateBackground()
+ */
+struct BackgroundParams {
+    float learnRate = 0.01f;  ///< EMA weight of the new frame (0-1)
+    float sigma = 2.5f;       ///< Foreground when |x - mean| > sigma * stddev
+    float minDiff = 15.0f;    ///< ...and |x - mean| > minDiff (noise floor, gray levels)
+};
+
+/**
+ * @brief Classify foreground against a per-pixel background and update it
+ *
+ * The model is an exponential moving average of each pixel's mean and
+ * variance, stored as two float planes of `width` floats per row. Every
+ * pixel's mean learns at learnRate; the variance only learns from
+ * background pixels so passing objects do not desensitize the model.
+ * Writes 255 to `mask` for foreground pixels and 0 elsewhere.
+ * Rows are split across OpenCV's parallel_for_ workers.
+ */
+void updateBackground(const uint8_t* gray, size_t grayStep,
+                      float* mean, float* var,
+                      uint8_t* mask, size_t maskStep,
+                      int width, int height, const BackgroundParams& params);
+
+/**
+ * @brief Result of a max-luma search
+ */
+struct LumaPeak {
+    int x = -1;       ///< Column of the brightest sample (-1 if none)
+    int y = -1;       ///< Row of the brightest sample (-1 if none)
+    int value = -1;   ///< Luma of the brightest sample (0-255)
+};
+
+/**
+ * @brief Find the brightest pixel inside a rectangle of a BGRA image
+ *
+ * Luma is pixelLuma() (pixel_luma.h): (29*B + 150*G + 77*R + 128) >> 8.
+ * Only every `rowStride`-th row is visited; each visited row is reduced at
+ * full SIMD width and only rows that beat the running maximum are rescanned
+ * to locate the column. Columns are never skipped: a visited row is fetched
+ * whole either way, and the contiguous vector loads are what keep the
+ * search at memory speed. Ties keep the first (top-left) sample.
+ */
+LumaPeak findMaxLuma(const uint8_t* src, size_t srcStep,
+                     int x0, int y0, int x1, int y1, int rowStride);
+
+} // namespace vivid::opencv::kernels
@@ -0,0 +1,320 @@
+/**
+ * @file kernels.simd.hpp
+ * @brief Row kernels compiled once per instruction set (internal)
+ *
+ * Included once by kernels.cpp for the baseline build, and by
+ * kernels_avx2.cpp and kernels_avx512.cpp, which CMake compiles with wider
+ * instruction sets so OpenCV's universal intrinsics become 256 and 512 bits
+ * wide. The includer names the variant's namespace and ISA first.
+ * kernels.cpp chooses one at load.
+ *
+ * The variant namespace alone doesn't keep wide instructions out of the
+ * baseline: any inline function or template with external linkage that
+ * this file uses (std::max, helpers in kernels.h, ...) is emitted by every
+ * variant and the linker keeps one copy of it, possibly the AVX-512 one.
+ * Everything the kernels call therefore has internal linkage (the anonymous
+ * namespace below, pixel_luma.h), is a C function, or is one of OpenCV's
+ * intrinsics. Those share one namespace across variants, so CMake compiles
+ * the variant objects optimized, where they always inline, and the
+ * simd_symbols tests fail if a variant object defines anything outside its
+ * own namespace.
+ */
+
+#include "kernels.h"
+#include "pixel_luma.h"
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+#if !defined(VIVID_OPENCV_KERNELS_NAMESPACE) || !defined(VIVID_OPENCV_KERNELS_ISA)
+#error "Define VIVID_OPENCV_KERNELS_NAMESPACE and VIVID_OPENCV_KERNELS_ISA before including kernels.simd.hpp"
+#endif
+
+namespace vivid::opencv::kernels {
+
+/// The row kernels of one variant; the public kernels split rows and call these
+struct RowKernels {
+    const char* isa;
+    void (*hsvMask)(const uint8_t* src, size_t srcStep, uint8_t* dst, size_t dstStep,
+                    int width, int rowBegin, int rowEnd, const HsvRange& range);
+    void (*background)(const uint8_t* gray, size_t grayStep, float* mean, float* var,
+                       uint8_t* mask, size_t maskStep, int width, int rowBegin, int rowEnd,
+                       const BackgroundParams& params);
+    int (*maxLuma)(const uint8_t* row, int x0, int x1);  ///< Max luma across [x0, x1)
+};
+
+namespace VIVID_OPENCV_KERNELS_NAMESPACE {
+
+namespace {
+
+// Local copies of std::max and std::min (see the file comment)
+inline int maxOf(int a, int b) { return a > b ? a : b; }
+inline int minOf(int a, int b) { return a < b ? a : b; }
+inline float maxOf(float a, float b) { return a > b ? a : b; }
+
+// Scalar reference for one pixel; also handles the tail of each row
+inline uint8_t hsvInRange(int b, int g, int r, const HsvRange& range) {
+    int vmax = maxOf(maxOf(b, g), r);
+    int vmin = minOf(minOf(b, g), r);
+    int delta = vmax - vmin;
+
+    if (vmax < range.valMin || vmax > range.valMax) {
+        return 0;
+    }
+
+    // s = 255 * delta / vmax, compared without dividing
+    if (delta * 255 < range.satMin * vmax || delta * 255 > range.satMax * vmax) {
+        return 0;
+    }
+
+    float hue = 0.0f;
+    if (delta > 0) {
+        if (vmax == r) {
+            hue = 60.0f * static_cast<float>(g - b) / static_cast<float>(delta);
+        } else if (vmax == g) {
+            hue = 120.0f + 60.0f * static_cast<float>(b - r) / static_cast<float>(delta);
+        } else {
+            hue = 240.0f + 60.0f * static_cast<float>(r - g) / static_cast<float>(delta);
+        }
+        if (hue < 0.0f) {
+            hue += 360.0f;
+        }
+    }
+
+    bool hueOk = range.hueMin <= range.hueMax
+        ? (hue >= range.hueMin && hue <= range.hueMax)
+        : (hue >= range.hueMin || hue <= range.hueMax);
+    return hueOk ? 255 : 0;
+}
+
+#if CV_SIMD
+// Widen 8-bit lanes to four float vectors (lane order preserved)
+inline void expandToFloat(const cv::v_uint8& v, cv::v_float32 out[4]) {
+    cv::v_uint16 w0, w1;
+    cv::v_expand(v, w0, w1);
+    cv::v_uint32 d0, d1, d2, d3;
+    cv::v_expand(w0, d0, d1);
+    cv::v_expand(w1, d2, d3);
+    out[0] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d0));
+    out[1] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d1));
+    out[2] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d2));
+    out[3] = cv::v_cvt_f32(cv::v_reinterpret_as_s32(d3));
+}
+
+// Narrow four 32-bit lane masks back to one 8-bit mask
+inline cv::v_uint8 packMask(const cv::v_uint32 m[4]) {
+    return cv::v_pack(cv::v_pack(m[0], m[1]), cv::v_pack(m[2], m[3]));
+}
+#endif
+
+void hsvMaskRows(const uint8_t* src, size_t srcStep, uint8_t* dst, size_t dstStep,
+                 int width, int rowBegin, int rowEnd, const HsvRange& range) {
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const cv::v_uint8 valMin = cv::vx_setall_u8(range.valMin);
+    const cv::v_uint8 valMax = cv::vx_setall_u8(range.valMax);
+    const cv::v_uint16 k255 = cv::vx_setall_u16(255);
+    const cv::v_uint16 satMin = cv::vx_setall_u16(range.satMin);
+    const cv::v_uint16 satMax = cv::vx_setall_u16(range.satMax);
+    const cv::v_float32 hueMin = cv::vx_setall_f32(range.hueMin);
+    const cv::v_float32 hueMax = cv::vx_setall_f32(range.hueMax);
+    const cv::v_float32 k0 = cv::vx_setzero_f32();
+    const cv::v_float32 k1 = cv::vx_setall_f32(1.0f);
+    const cv::v_float32 k60 = cv::vx_setall_f32(60.0f);
+    const cv::v_float32 k120 = cv::vx_setall_f32(120.0f);
+    const cv::v_float32 k240 = cv::vx_setall_f32(240.0f);
+    const cv::v_float32 k360 = cv::vx_setall_f32(360.0f);
+    const bool hueWraps = range.hueMin > range.hueMax;
+#endif
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uint8_t* s = src + y * srcStep;
+        uint8_t* d = dst + y * dstStep;
+        int x = 0;
+
+#if CV_SIMD
+        for (; x <= width - lanes; x += lanes) {
+            cv::v_uint8 b, g, r, a;
+            cv::v_load_deinterleave(s + x * 4, b, g, r, a);
+
+            cv::v_uint8 vmax = cv::v_max(cv::v_max(b, g), r);
+            cv::v_uint8 vmin = cv::v_min(cv::v_min(b, g), r);
+            cv::v_uint8 delta = cv::v_sub(vmax, vmin);
+
+            // Value test directly on 8-bit lanes
+            cv::v_uint8 mask = cv::v_and(cv::v_ge(vmax, valMin), cv::v_le(vmax, valMax));
+
+            // Saturation test as 255*delta vs sat*vmax in 16-bit (max 65025, no overflow)
+            cv::v_uint16 d0, d1, m0, m1;
+            cv::v_expand(delta, d0, d1);
+            cv::v_expand(vmax, m0, m1);
+            d0 = cv::v_mul(d0, k255);
+            d1 = cv::v_mul(d1, k255);
+            cv::v_uint16 sat0 = cv::v_and(cv::v_ge(d0, cv::v_mul(m0, satMin)),
+                                          cv::v_le(d0, cv::v_mul(m0, satMax)));
+            cv::v_uint16 sat1 = cv::v_and(cv::v_ge(d1, cv::v_mul(m1, satMin)),
+                                          cv::v_le(d1, cv::v_mul(m1, satMax)));
+            mask = cv::v_and(mask, cv::v_pack(sat0, sat1));
+
+            // Skip the float hue math when nothing in the block survived
+            if (!cv::v_check_any(mask)) {
+                cv::v_store(d + x, mask);
+                continue;
+            }
+
+            // Hue in float lanes
+            cv::v_float32 fb[4], fg[4], fr[4], fmax[4], fdelta[4];
+            cv::v_uint32 hueOk[4];
+            expandToFloat(b, fb);
+            expandToFloat(g, fg);
+            expandToFloat(r, fr);
+            expandToFloat(vmax, fmax);
+            expandToFloat(delta, fdelta);
+
+            for (int i = 0; i < 4; ++i) {
+                // Nested selects give red priority over green, matching the scalar path
+                cv::v_float32 isR = cv::v_eq(fmax[i], fr[i]);
+                cv::v_float32 isG = cv::v_eq(fmax[i], fg[i]);
+                cv::v_float32 num = cv::v_select(isR, cv::v_sub(fg[i], fb[i]),
+                                    cv::v_select(isG, cv::v_sub(fb[i], fr[i]),
+                                                      cv::v_sub(fr[i], fg[i])));
+                cv::v_float32 base = cv::v_select(isR, k0, cv::v_select(isG, k120, k240));
+                // delta == 0 implies num == 0, so clamping the divisor yields hue 0
+                cv::v_float32 hue = cv::v_add(base, cv::v_div(cv::v_mul(k60, num),
+                                                              cv::v_max(fdelta[i], k1)));
+                hue = cv::v_select(cv::v_lt(hue, k0), cv::v_add(hue, k360), hue);
+
+                cv::v_uint32 aboveMin = cv::v_reinterpret_as_u32(cv::v_ge(hue, hueMin));
+                cv::v_uint32 belowMax = cv::v_reinterpret_as_u32(cv::v_le(hue, hueMax));
+                hueOk[i] = hueWraps ? cv::v_or(aboveMin, belowMax) : cv::v_and(aboveMin, belowMax);
+            }
+
+            cv::v_store(d + x, cv::v_and(mask, packMask(hueOk)));
+        }
+#endif
+
+        for (; x < width; ++x) {
+            d[x] = hsvInRange(s[x * 4 + 0], s[x * 4 + 1], s[x * 4 + 2], range);
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+void backgroundRows(const uint8_t* gray, size_t grayStep, float* mean, float* var,
+                    uint8_t* mask, size_t maskStep, int width, int rowBegin, int rowEnd,
+                    const BackgroundParams& params) {
+    const float alpha = params.learnRate;
+    const float sigma2 = params.sigma * params.sigma;
+    const float floor2 = params.minDiff * params.minDiff;
+
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const int flanes = cv::VTraits<cv::v_float32>::vlanes();
+    const cv::v_float32 vAlpha = cv::vx_setall_f32(alpha);
+    const cv::v_float32 vSigma2 = cv::vx_setall_f32(sigma2);
+    const cv::v_float32 vFloor2 = cv::vx_setall_f32(floor2);
+#endif
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const uint8_t* g = gray + y * grayStep;
+        float* m = mean + static_cast<size_t>(y) * width;
+        float* v = var + static_cast<size_t>(y) * width;
+        uint8_t* d = mask + y * maskStep;
+        int x = 0;
+
+#if CV_SIMD
+        for (; x <= width - lanes; x += lanes) {
+            cv::v_float32 px[4];
+            cv::v_uint32 fg[4];
+            expandToFloat(cv::vx_load(g + x), px);
+
+            for (int i = 0; i < 4; ++i) {
+                float* mp = m + x + i * flanes;
+                float* vp = v + x + i * flanes;
+                cv::v_float32 vm = cv::vx_load(mp);
+                cv::v_float32 vv = cv::vx_load(vp);
+
+                cv::v_float32 diff = cv::v_sub(px[i], vm);
+                cv::v_float32 diff2 = cv::v_mul(diff, diff);
+                cv::v_float32 limit = cv::v_max(cv::v_mul(vSigma2, vv), vFloor2);
+                cv::v_float32 isFg = cv::v_gt(diff2, limit);
+                fg[i] = cv::v_reinterpret_as_u32(isFg);
+
+                cv::v_store(mp, cv::v_muladd(vAlpha, diff, vm));
+                cv::v_float32 learned = cv::v_muladd(vAlpha, cv::v_sub(diff2, vv), vv);
+                cv::v_store(vp, cv::v_select(isFg, vv, learned));
+            }
+
+            cv::v_store(d + x, packMask(fg));
+        }
+#endif
+
+        for (; x < width; ++x) {
+            float diff = static_cast<float>(g[x]) - m[x];
+            float diff2 = diff * diff;
+            bool isFg = diff2 > maxOf(sigma2 * v[x], floor2);
+            d[x] = isFg ? 255 : 0;
+            m[x] += alpha * diff;
+            if (!isFg) {
+                v[x] += alpha * (diff2 - v[x]);
+            }
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+// Maximum luma across [x0, x1) of one row
+int rowMaxLuma(const uint8_t* row, int x0, int x1) {
+    int x = x0;
+    int best = 0;
+
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    if (x1 - x0 >= lanes) {
+        const cv::v_uint16 wb = cv::vx_setall_u16(29);
+        const cv::v_uint16 wg = cv::vx_setall_u16(150);
+        const cv::v_uint16 wr = cv::vx_setall_u16(77);
+        const cv::v_uint16 bias = cv::vx_setall_u16(128);
+        cv::v_uint8 vbest = cv::vx_setzero_u8();
+
+        for (; x <= x1 - lanes; x += lanes) {
+            cv::v_uint8 b, g, r, a;
+            cv::v_load_deinterleave(row + x * 4, b, g, r, a);
+
+            cv::v_uint16 b0, b1, g0, g1, r0, r1;
+            cv::v_expand(b, b0, b1);
+            cv::v_expand(g, g0, g1);
+            cv::v_expand(r, r0, r1);
+
+            // Weights sum to 256, so 255*256+128 still fits in 16 bits
+            cv::v_uint16 l0 = cv::v_add(cv::v_add(cv::v_mul(b0, wb), cv::v_mul(g0, wg)),
+                                        cv::v_add(cv::v_mul(r0, wr), bias));
+            cv::v_uint16 l1 = cv::v_add(cv::v_add(cv::v_mul(b1, wb), cv::v_mul(g1, wg)),
+                                        cv::v_add(cv::v_mul(r1, wr), bias));
+            cv::v_uint8 luma = cv::v_pack(cv::v_shr<8>(l0), cv::v_shr<8>(l1));
+            vbest = cv::v_max(vbest, luma);
+        }
+        best = cv::v_reduce_max(vbest);
+        cv::vx_cleanup();
+    }
+#endif
+
+    for (; x < x1; ++x) {
+        best = maxOf(best, pixelLuma(row + x * 4));
+    }
+    return best;
+}
+
+} // namespace
+
+const RowKernels& rowKernels() {
+    static const RowKernels kernels{VIVID_OPENCV_KERNELS_ISA, hsvMaskRows, backgroundRows, rowMaxLuma};
+    return kernels;
+}
+
+} // namespace VIVID_OPENCV_KERNELS_NAMESPACE
+
+} // namespace vivid::opencv::kernels
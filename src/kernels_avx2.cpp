@@ -0,0 +1,13 @@
+/**
+ * @file kernels_avx2.cpp
+ * @brief AVX2 build of the pixel kernels (see kernels.simd.hpp)
+ */
+
+#define VIVID_OPENCV_KERNELS_NAMESPACE opt_AVX2
+#define VIVID_OPENCV_KERNELS_ISA "AVX2"
+#include "kernels.simd.hpp"
+
+// Without 256-bit intrinsics this would silently be a second baseline
+#if !CV_SIMD256
+#error "kernels_avx2.cpp needs 256-bit universal intrinsics; check its flags in CMakeLists.txt"
+#endif
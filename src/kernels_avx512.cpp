@@ -0,0 +1,13 @@
+/**
+ * @file kernels_avx512.cpp
+ * @brief AVX-512 (Skylake-X subset) build of the pixel kernels (see kernels.simd.hpp)
+ */
+
+#define VIVID_OPENCV_KERNELS_NAMESPACE opt_AVX512_SKX
+#define VIVID_OPENCV_KERNELS_ISA "AVX512_SKX"
+#include "kernels.simd.hpp"
+
+// Without 512-bit intrinsics this would silently be a narrower variant
+#if !CV_SIMD512
+#error "kernels_avx512.cpp needs 512-bit universal intrinsics; check its flags in CMakeLists.txt"
+#endif
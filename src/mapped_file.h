@@ -0,0 +1,55 @@
+#pragma once
+
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory mapping of a whole file (internal)
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief A file mapped read-only into the address space
+ *
+ * Pages are loaded by the OS on first access; prefetch() and touch()
+ * control when that happens.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map `path`, unmapping any previous file
+     * @return false with `error` set if it can't be opened, is empty or can't be mapped
+     */
+    bool open(const std::string& path, std::string& error);
+
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    /// Ask the OS to start reading [offset, offset + length) in the background
+    void prefetch(size_t offset, size_t length) const;
+
+    /// Read one byte per page so the whole file is resident before timing starts
+    void touch() const;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // namespace vivid::opencv::detail
@@ -8,18 +8,143 @@
 #include <vivid/chain.h>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
-#include <opencv2/video/tracking.hpp>
-#include <cmath>
+#include "async_cook.h"
+#include "flow_common.h"
+#include "frame_cache.h"
+#include "kernels.h"
+#include "stage_pipeline.h"
+#include "stage_timer.h"
+#include "stamp_registry.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
 
 namespace vivid::opencv {
 
+namespace {
+
+// Stages timed by OpticalFlow::Impl::profile (same order as its names)
+enum FlowStage : int {
+    StageCvtColor,
+    StageResize,
+    StageFarneback,
+    StageRender,
+    StageAssign,
+    StageProcess,
+    StageCookLatency,
+    StagePipelineLatency
+};
+
+} // namespace
+
 // PIMPL - hides OpenCV types from header
 struct OpticalFlow::Impl {
+    // Param snapshot taken on the chain thread
+    struct Settings {
+        detail::FlowSettings flow;
+        FlowVizMode vizMode = FlowVizMode::Color;
+        float sensitivity = 1.0f;
+        cv::Size procSize;
+        int threads = 0;
+        FrameStamp stamp;  // Input frame this cook works on
+        const Operator* input = nullptr;  // Its source and FrameCache key, for pinned copies
+        uint64_t frameKey = 0;
+    };
+
+    // Completed background cook
+    struct Result {
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        FrameStamp stamp;
+    };
+
     cv::Mat prevGray;      // Previous frame (grayscale)
     cv::Mat flow;          // Flow field (2-channel float)
+    cv::Mat output;        // Visualization at full resolution
     bool hasPrevFrame = false;
+
+    // One frame in flight through the pipelined stages
+    struct StageFrame {
+        detail::PinnedFrame input;
+        Settings settings;
+        std::shared_ptr<detail::CachedFrame> cached;  // Holds `scaled` until the solve
+        cv::Mat scaled;    // Luma at processing resolution
+        cv::Mat flow;
+        bool hasFlow = false;
+    };
+
+    int activeMode = 0;    // Cook mode in effect (the async param value)
+
+    // Previous frame for the pipelined solve stage (touched only by its thread)
+    cv::Mat stagePrevGray;
+    bool stageHasPrev = false;
+
+    // Solve against the previous frame and render into `pixels` (BGRA, size of `input`)
+    void cook(const Settings& s, const cv::Mat& input, const cv::Mat& gray,
+              std::vector<uint8_t>& pixels);
+
+    // Stamp `owner`'s output with the frame it came from
+    void publishStamp(const Operator* owner, const FrameStamp& stamp) {
+        profile.recordLatency(StageCookLatency, StagePipelineLatency,
+                              detail::FrameStamps::instance().publish(owner, "OpticalFlow", stamp));
+    }
+
+    // Swap a completed background result into the operator's output
+    void publish(const Operator* owner, Result* result, std::vector<uint8_t>& pixels,
+                 int& width, int& height) {
+        if (!result) {
+            return;
+        }
+        pixels.swap(result->pixels);
+        width = result->width;
+        height = result->height;
+        publishStamp(owner, result->stamp);
+    }
+
+    // Stop whichever background mode is running
+    void stopBackground() {
+        cooker.stop();
+        pipeline.stop();
+        stageHasPrev = false;
+        activeMode = 0;
+    }
+
+    detail::StageProfile profile{"OpticalFlow", {"cvtColor", "resize", "calcOpticalFlowFarneback",
+                                                 "render", "assign", "process", "cookLatency",
+                                                 "pipelineLatency"}};
+
+    // Declared last: the workers are joined before the state above is destroyed
+    detail::AsyncCooker<Result, Settings> cooker;
+    detail::StagePipeline<StageFrame, Result> pipeline;
 };
 
+void OpticalFlow::Impl::cook(const Settings& s, const cv::Mat& input, const cv::Mat& gray,
+                             std::vector<uint8_t>& pixels) {
+    VIVID_OPENCV_STAGE_CLOCK(clock, profile);
+
+    // Create output image at full resolution
+    output.create(input.rows, input.cols, CV_8UC4);
+    output.setTo(cv::Scalar(0, 0, 0, 255));
+
+    if (hasPrevFrame && prevGray.size() == gray.size()) {
+        // Calculate optical flow using Farneback at reduced resolution
+        detail::computeFlow(prevGray, gray, flow, s.flow);
+        VIVID_OPENCV_STAGE_LAP(clock, StageFarneback);
+        detail::renderFlow(flow, s.vizMode, s.sensitivity, input, output);
+    }
+    VIVID_OPENCV_STAGE_LAP(clock, StageRender);
+
+    // Store current frame for next iteration (at processing resolution)
+    gray.copyTo(prevGray);
+    hasPrevFrame = true;
+
+    // Store output in CPU pixel buffer (BGRA format)
+    size_t dataSize = output.total() * output.elemSize();
+    pixels.assign(output.data, output.data + dataSize);
+    VIVID_OPENCV_STAGE_LAP(clock, StageAssign);
+}
+
 OpticalFlow::OpticalFlow() : m_impl(std::make_unique<Impl>()) {
     registerParam(scale);
     registerParam(pyrScale);
@@ -30,20 +155,31 @@ OpticalFlow::OpticalFlow() : m_impl(std::make_unique<Impl>()) {
     registerParam(polySigma);
     registerParam(vizMode);
     registerParam(sensitivity);
+    registerParam(async);
+    registerParam(threads);
+
+    m_impl->cooker.setName("OpticalFlow");
+    m_impl->pipeline.setName("OpticalFlow");
 }
 
 OpticalFlow::~OpticalFlow() = default;
 
 void OpticalFlow::cleanup() {
+    m_impl->stopBackground();
     m_outputPixels.clear();
     m_outputWidth = 0;
     m_outputHeight = 0;
     m_impl->prevGray.release();
     m_impl->flow.release();
     m_impl->hasPrevFrame = false;
+    detail::FrameCache::instance().release(this);
+    detail::FrameStamps::instance().release(this);
 }
 
 void OpticalFlow::init(Context& ctx) {
+    detail::ensureThreadPool();
+    kernels::initDispatch();
+    detail::installAllocCounter();
     matchInputResolution(0);
 }
 
@@ -80,135 +216,163 @@ void OpticalFlow::process(Context& ctx) {
         return;
     }
 
-    // Create cv::Mat from CPU pixels (BGRA) - zero-copy wrapper
-    cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(cpuView.data));
+    // Cap the threads OpenCV and our kernels may use for this cook
+    detail::ThreadBudget budget(static_cast<int>(threads));
+    VIVID_OPENCV_COOK_SCOPE(m_impl->profile, StageProcess);
+    detail::nameTraceThread("chain");
 
     // Downsample for faster processing
-    float s = std::clamp(static_cast<float>(scale), 0.1f, 1.0f);
-    int procWidth = static_cast<int>(width * s);
-    int procHeight = static_cast<int>(height * s);
+    float scaleFactor = std::clamp(static_cast<float>(scale), 0.1f, 1.0f);
+    int procWidth = static_cast<int>(width * scaleFactor);
+    int procHeight = static_cast<int>(height * scaleFactor);
     if (procWidth < 16) procWidth = 16;
     if (procHeight < 16) procHeight = 16;
 
-    cv::Mat small;
-    if (s < 0.99f) {
-        cv::resize(input, small, cv::Size(procWidth, procHeight), 0, 0, cv::INTER_AREA);
-    } else {
-        small = input;
+    Impl::Settings s;
+    s.flow.pyrScale = static_cast<double>(pyrScale);
+    s.flow.levels = static_cast<int>(levels);
+    s.flow.winSize = static_cast<int>(winSize);
+    s.flow.iterations = static_cast<int>(iterations);
+    s.flow.polyN = static_cast<int>(polyN);
+    s.flow.polySigma = static_cast<double>(polySigma);
+    s.vizMode = static_cast<FlowVizMode>(static_cast<int>(vizMode));
+    s.sensitivity = static_cast<float>(sensitivity);
+    s.procSize = scaleFactor < 0.99f ? cv::Size(procWidth, procHeight) : cv::Size(width, height);
+
+    s.threads = static_cast<int>(threads);
+    detail::ReceivedFrame received = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+    s.stamp = received.stamp;
+    s.input = inputOp;
+    s.frameKey = received.key;
+
+    Impl* impl = m_impl.get();
+    int cookMode = static_cast<int>(async);
+    if (cookMode != impl->activeMode) {
+        impl->stopBackground();
+        impl->activeMode = cookMode;
     }
 
-    // Convert to grayscale
-    cv::Mat gray;
-    cv::cvtColor(small, gray, cv::COLOR_BGRA2GRAY);
-
-    // Create output image at full resolution
-    cv::Mat output(height, width, CV_8UC4, cv::Scalar(0, 0, 0, 255));
-
-    if (m_impl->hasPrevFrame && m_impl->prevGray.size() == gray.size()) {
-        // Calculate optical flow using Farneback at reduced resolution
-        cv::calcOpticalFlowFarneback(
-            m_impl->prevGray, gray, m_impl->flow,
-            static_cast<double>(pyrScale),
-            static_cast<int>(levels),
-            static_cast<int>(winSize),
-            static_cast<int>(iterations),
-            static_cast<int>(polyN),
-            static_cast<double>(polySigma),
-            0  // flags
-        );
-
-        float sens = static_cast<float>(sensitivity);
-        int mode = static_cast<int>(vizMode);
-
-        // Do all visualization at REDUCED resolution, then upsample final result
-        cv::Mat flowChannels[2];
-        cv::split(m_impl->flow, flowChannels);
-        flowChannels[0] *= sens;
-        flowChannels[1] *= sens;
-
-        cv::Mat magnitude, angle;
-        cv::cartToPolar(flowChannels[0], flowChannels[1], magnitude, angle, true);
-
-        cv::Mat smallOutput;
-
-        if (mode == 0) {
-            // HSV color wheel visualization at reduced resolution
-            cv::Mat hue, sat, val;
-            angle.convertTo(hue, CV_8U, 0.5);
-            sat = cv::Mat(procHeight, procWidth, CV_8U, cv::Scalar(255));
-            magnitude.convertTo(val, CV_8U, 10.0);
-
-            std::vector<cv::Mat> hsvChannels = {hue, sat, val};
-            cv::Mat hsv;
-            cv::merge(hsvChannels, hsv);
-
-            cv::Mat rgb;
-            cv::cvtColor(hsv, rgb, cv::COLOR_HSV2BGR);
-            cv::cvtColor(rgb, smallOutput, cv::COLOR_BGR2BGRA);
-
-        } else if (mode == 1) {
-            // Arrow field overlay - draw at FULL resolution for quality
-            // Use input image as background, upsample flow, draw arrows
-            input.copyTo(output);  // Full-res background
-
-            // Upsample flow to full resolution
-            cv::Mat flowFull;
-            cv::resize(m_impl->flow, flowFull, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
-            float flowScale = 1.0f / s;  // Scale flow vectors to match full res
-
-            // Draw arrows at regular grid spacing
-            int step = 20;  // Pixel spacing between arrows
-            for (int y = step / 2; y < height; y += step) {
-                for (int x = step / 2; x < width; x += step) {
-                    const cv::Vec2f& f = flowFull.at<cv::Vec2f>(y, x);
-                    float fx = f[0] * flowScale * sens;
-                    float fy = f[1] * flowScale * sens;
-                    float mag = std::sqrt(fx * fx + fy * fy);
-
-                    // Only draw if there's significant motion
-                    if (mag > 1.0f) {
-                        cv::Point2f start(static_cast<float>(x), static_cast<float>(y));
-                        cv::Point2f end(x + fx * 2, y + fy * 2);
-                        // Color based on magnitude (green to red)
-                        int green = static_cast<int>(std::max(0.0f, 255.0f - mag * 5));
-                        int red = static_cast<int>(std::min(255.0f, mag * 10));
-                        cv::arrowedLine(output, start, end, cv::Scalar(0, green, red, 255), 2, cv::LINE_AA, 0, 0.3);
-                    }
-                }
-            }
-            // Skip the upsample step since we drew at full res
-            smallOutput = cv::Mat();  // Mark as handled
-
-        } else {
-            // Magnitude only (grayscale) at reduced resolution
-            cv::Mat gray8;
-            magnitude.convertTo(gray8, CV_8U, 10.0);
-            cv::cvtColor(gray8, smallOutput, cv::COLOR_GRAY2BGRA);
+    if (cookMode == 1) {
+        // Hand the frame to the worker and publish whatever finished last
+        if (!impl->cooker.configured()) {
+            impl->cooker.configure(
+                [this, impl](const detail::PinnedFrame& frame, const Impl::Settings& s,
+                             Impl::Result& result) {
+                    detail::ThreadBudget budget(s.threads);
+                    VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+                    cv::Mat input(frame.height, frame.width, CV_8UC4,
+                                  const_cast<uint8_t*>(frame.pixels.data()));
+                    // The pinned copy holds the same pixels as the source frame, so its
+                    // luma is shared with operators reading that frame inline
+                    auto cached = detail::FrameCache::instance().acquire(
+                        s.input, this, s.frameKey, frame.pixels.data(), frame.width, frame.height,
+                        static_cast<size_t>(frame.width) * 4);
+                    VIVID_OPENCV_STAGE_LAP(clock, StageCvtColor);
+                    cv::Mat gray = s.procSize != input.size() ? cached->scaled(s.procSize)
+                                                              : cached->luma();
+                    VIVID_OPENCV_STAGE_LAP(clock, StageResize);
+                    impl->cook(s, input, gray, result.pixels);
+                    result.width = frame.width;
+                    result.height = frame.height;
+                    result.stamp = s.stamp;
+                });
         }
+        impl->cooker.submit(cpuView.data, width, height, s);
+        impl->publish(this, impl->cooker.takeFresh(), m_outputPixels, m_outputWidth, m_outputHeight);
+        didCook();
+        return;
+    }
 
-        // Upsample final visualization to full resolution (skip if already at full res)
-        if (!smallOutput.empty()) {
-            if (s < 0.99f) {
-                cv::resize(smallOutput, output, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
-            } else {
-                smallOutput.copyTo(output);
-            }
+    if (cookMode == 2) {
+        // Luma + resize, the Farneback solve and visualization each run on their own thread
+        if (!impl->pipeline.configured()) {
+            impl->pipeline.configure(
+                {
+                    [this, impl](Impl::StageFrame& f) {
+                        detail::ThreadBudget budget(f.settings.threads);
+                        VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+                        f.cached = detail::FrameCache::instance().acquire(
+                            f.settings.input, this, f.settings.frameKey, f.input.pixels.data(),
+                            f.input.width, f.input.height, static_cast<size_t>(f.input.width) * 4);
+                        VIVID_OPENCV_STAGE_LAP(clock, StageCvtColor);
+                        const cv::Size full(f.input.width, f.input.height);
+                        f.scaled = f.settings.procSize != full ? f.cached->scaled(f.settings.procSize)
+                                                               : f.cached->luma();
+                        VIVID_OPENCV_STAGE_LAP(clock, StageResize);
+                    },
+                    [impl](Impl::StageFrame& f) {
+                        detail::ThreadBudget budget(f.settings.threads);
+                        VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageFarneback);
+                        f.hasFlow = impl->stageHasPrev && impl->stagePrevGray.size() == f.scaled.size();
+                        if (f.hasFlow) {
+                            detail::computeFlow(impl->stagePrevGray, f.scaled, f.flow, f.settings.flow);
+                        }
+                        f.scaled.copyTo(impl->stagePrevGray);
+                        impl->stageHasPrev = true;
+                        f.scaled.release();
+                        f.cached.reset();  // Lets the cache recycle the frame
+                    },
+                },
+                [impl](Impl::StageFrame& f, Impl::Result& result) {
+                    detail::ThreadBudget budget(f.settings.threads);
+                    VIVID_OPENCV_STAGE_SCOPE(impl->profile, StageRender);
+                    cv::Mat input(f.input.height, f.input.width, CV_8UC4, f.input.pixels.data());
+                    result.pixels.resize(f.input.pixels.size());
+                    cv::Mat output(f.input.height, f.input.width, CV_8UC4, result.pixels.data());
+                    if (f.hasFlow) {
+                        detail::renderFlow(f.flow, f.settings.vizMode, f.settings.sensitivity,
+                                           input, output);
+                    } else {
+                        output.setTo(cv::Scalar(0, 0, 0, 255));
+                    }
+                    result.width = f.input.width;
+                    result.height = f.input.height;
+                    result.stamp = f.settings.stamp;
+                });
         }
+        impl->pipeline.submit(cpuView.data, width, height,
+                              [&s](Impl::StageFrame& f) { f.settings = s; });
+        impl->publish(this, impl->pipeline.takeFresh(), m_outputPixels, m_outputWidth, m_outputHeight);
+        didCook();
+        return;
     }
 
-    // Store current frame for next iteration (at processing resolution)
-    gray.copyTo(m_impl->prevGray);
-    m_impl->hasPrevFrame = true;
+    // Create cv::Mat from CPU pixels (BGRA) - zero-copy wrapper
+    cv::Mat input(height, width, CV_8UC4, const_cast<uint8_t*>(cpuView.data));
 
-    // Store output in CPU pixel buffer (BGRA format)
+    // Grayscale at processing resolution, shared with other operators
+    // reading the same input this frame
+    VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+    auto frame = detail::FrameCache::instance().acquire(
+        inputOp, this, received.key, cpuView.data, width, height, static_cast<size_t>(width) * 4);
+    VIVID_OPENCV_STAGE_LAP(clock, StageCvtColor);
+    cv::Mat gray = s.procSize != input.size() ? frame->scaled(s.procSize) : frame->luma();
+    VIVID_OPENCV_STAGE_LAP(clock, StageResize);
+
+    impl->cook(s, input, gray, m_outputPixels);
     m_outputWidth = width;
     m_outputHeight = height;
-    size_t dataSize = output.total() * output.elemSize();
-    m_outputPixels.assign(output.data, output.data + dataSize);
+    impl->publishStamp(this, s.stamp);
 
     didCook();
 }
 
+AsyncStats OpticalFlow::asyncStats() const {
+    return m_impl->activeMode == 2 ? m_impl->pipeline.stats() : m_impl->cooker.stats();
+}
+
+std::vector<StageTiming> OpticalFlow::stageTimings() const {
+    return m_impl->profile.timings();
+}
+
+AllocStats OpticalFlow::allocStats() const {
+    return m_impl->profile.allocStats();
+}
+
+void OpticalFlow::resetStageTimings() {
+    m_impl->profile.reset();
+}
+
 } // namespace vivid::opencv
 
 using OpenCVOpticalFlow = vivid::opencv::OpticalFlow;
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * @file pixel_luma.h
+ * @brief Integer luma of one BGRA pixel (internal)
+ *
+ * The single definition used by findMaxLuma's variants, its column search
+ * and BrightSpot's centroid. `static` keeps every includer's copy local, so
+ * the AVX2/AVX-512 kernel objects (kernels.simd.hpp) can include it without
+ * the linker sharing a wide copy with baseline callers.
+ */
+
+#include <cstdint>
+
+namespace vivid::opencv::kernels {
+
+/// Rec.601 approximation, rounded: (29*B + 150*G + 77*R + 128) >> 8
+static inline int pixelLuma(const uint8_t* bgra) {
+    return (29 * bgra[0] + 150 * bgra[1] + 77 * bgra[2] + 128) >> 8;
+}
+
+} // namespace vivid::opencv::kernels
@@ -0,0 +1,193 @@
+/**
+ * @file raw_frame_recorder.cpp
+ * @brief Raw frame file recorder implementation
+ */
+
+#include <vivid/opencv/raw_frame_recorder.h>
+#include <vivid/context.h>
+#include "stamp_registry.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace vivid::opencv {
+
+struct RawFrameRecorder::Impl {
+    std::FILE* file = nullptr;
+    std::string path;
+    std::string lastError;
+    RawFrameHeader header;
+    int frames = 0;
+    uint64_t lastFrameId = 0;   // Stamp of the last frame written
+    double firstTime = 0.0;     // Context time of the first and last frame
+    double lastTime = 0.0;
+    CpuPixelView view;          // The input's, passed through
+
+    // Rewrite the header in place; frames keep appending at the end
+    bool writeHeader() {
+        return std::fseek(file, 0, SEEK_SET) == 0 &&
+               std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+               std::fseek(file, 0, SEEK_END) == 0;
+    }
+};
+
+RawFrameRecorder::RawFrameRecorder() : m_impl(std::make_unique<Impl>()) {
+    registerParam(maxFrames);
+    registerParam(fps);
+}
+
+RawFrameRecorder::~RawFrameRecorder() {
+    stop();
+}
+
+bool RawFrameRecorder::start(const std::string& path) {
+    stop();
+    Impl& s = *m_impl;
+
+    s.file = std::fopen(path.c_str(), "wb");
+    if (!s.file) {
+        s.lastError = "cannot create " + path;
+        return false;
+    }
+    s.path = path;
+    s.header = RawFrameHeader{};
+    std::memcpy(s.header.magic, kRawFrameMagic, sizeof(s.header.magic));
+    s.header.version = kRawFrameVersion;
+    s.header.headerSize = sizeof(RawFrameHeader);
+    s.header.pixelFormat = kRawFrameBGRA8;
+    s.frames = 0;
+    s.lastFrameId = 0;
+
+    // Frame size is filled in by the first frame
+    if (!s.writeHeader()) {
+        std::fclose(s.file);
+        s.file = nullptr;
+        s.lastError = "cannot write " + path;
+        return false;
+    }
+    s.lastError.clear();
+    return true;
+}
+
+void RawFrameRecorder::stop() {
+    Impl& s = *m_impl;
+    if (!s.file) {
+        return;
+    }
+    if (s.frames > 0) {
+        s.header.frameCount = static_cast<uint64_t>(s.frames);
+        float rate = static_cast<float>(fps);
+        if (rate > 0.0f) {
+            s.header.fps = rate;
+        } else if (s.frames > 1 && s.lastTime > s.firstTime) {
+            s.header.fps = (s.frames - 1) / (s.lastTime - s.firstTime);
+        }
+        if (!s.writeHeader() && s.lastError.empty()) {
+            s.lastError = "cannot finalize " + s.path;
+        }
+    }
+    std::fclose(s.file);
+    s.file = nullptr;
+}
+
+bool RawFrameRecorder::recording() const {
+    return m_impl->file != nullptr;
+}
+
+int RawFrameRecorder::framesWritten() const {
+    return m_impl->frames;
+}
+
+const std::string& RawFrameRecorder::lastError() const {
+    return m_impl->lastError;
+}
+
+void RawFrameRecorder::cleanup() {
+    stop();
+    m_impl->view = {};
+    detail::FrameStamps::instance().release(this);
+}
+
+void RawFrameRecorder::init(Context& ctx) {
+    matchInputResolution(0);
+}
+
+Operator::CpuPixelView RawFrameRecorder::cpuPixelView() const {
+    return m_impl->view;
+}
+
+void RawFrameRecorder::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    Impl& s = *m_impl;
+    Operator* inputOp = getInput(0);
+    auto cpuView = inputOp ? inputOp->cpuPixelView() : CpuPixelView{};
+    if (!cpuView.valid() || cpuView.channels != 4) {
+        s.view = {};
+        didCook();
+        return;
+    }
+
+    const int width = cpuView.width;
+    const int height = cpuView.height;
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t step = cpuView.stride > 0 ? static_cast<size_t>(cpuView.stride) : rowBytes;
+    FrameStamp stamp = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame()).stamp;
+    s.view = cpuView;
+
+    // A source holding its frame (or a chain cooking faster than it) shows
+    // the same stamp again; write each frame once
+    const bool repeated = stamp.valid() && stamp.frameId == s.lastFrameId;
+
+    if (s.file && !repeated) {
+        if (s.frames == 0) {
+            s.header.width = static_cast<uint32_t>(width);
+            s.header.height = static_cast<uint32_t>(height);
+            s.firstTime = ctx.time();
+            if (!s.writeHeader()) {
+                s.lastError = "cannot write " + s.path;
+                stop();
+            }
+        } else if (s.header.width != static_cast<uint32_t>(width) ||
+                   s.header.height != static_cast<uint32_t>(height)) {
+            s.lastError = "input changed size from " + std::to_string(s.header.width) + "x" +
+                          std::to_string(s.header.height) + " to " + std::to_string(width) +
+                          "x" + std::to_string(height);
+            stop();
+        }
+    }
+
+    if (s.file && !repeated) {
+        bool written = true;
+        if (step == rowBytes) {
+            written = std::fwrite(cpuView.data, rowBytes * height, 1, s.file) == 1;
+        } else {
+            for (int y = 0; y < height && written; ++y) {
+                written = std::fwrite(cpuView.data + y * step, rowBytes, 1, s.file) == 1;
+            }
+        }
+        if (written) {
+            s.frames++;
+            s.lastFrameId = stamp.frameId;
+            s.lastTime = ctx.time();
+            int limit = static_cast<int>(maxFrames);
+            if (limit > 0 && s.frames >= limit) {
+                stop();
+            }
+        } else {
+            // The partial frame is ignored on replay
+            s.lastError = "write failed after " + std::to_string(s.frames) + " frames";
+            stop();
+        }
+    }
+
+    detail::FrameStamps::instance().publish(this, "RawFrameRecorder", stamp);
+    didCook();
+}
+
+} // namespace vivid::opencv
+
+using OpenCVRawFrameRecorder = vivid::opencv::RawFrameRecorder;
+REGISTER_OPERATOR(OpenCVRawFrameRecorder, "OpenCV", "Records CPU pixels to a raw BGRA frame file", true);
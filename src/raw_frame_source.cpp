@@ -0,0 +1,224 @@
+/**
+ * @file raw_frame_source.cpp
+ * @brief Memory-mapped raw frame replay implementation
+ */
+
+#include <vivid/opencv/raw_frame_source.h>
+#include <vivid/context.h>
+#include "clock.h"
+#include "mapped_file.h"
+#include "stamp_registry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace vivid::opencv {
+
+struct RawFrameSource::Impl {
+    detail::MappedFile file;
+    RawFrameHeader header;
+    std::string lastError;
+    int count = 0;              // Whole frames in the file
+    size_t frameBytes = 0;
+
+    // Playback positions count frames from open() without wrapping
+    int64_t position = -1;      // Last one served
+    int64_t seekTo = -1;        // Pending seek()
+    bool clockRunning = false;  // Fixed rate: `clockBase` was served at `clockStart`
+    double clockStart = 0.0;
+    int64_t clockBase = 0;
+
+    int index = -1;             // Frame being served
+    uint64_t served = 0;        // Doubles as the stamp frame id
+    CpuPixelView view;
+
+    size_t offset(int i) const { return header.headerSize + frameBytes * static_cast<size_t>(i); }
+
+    // Playback position -> frame in the file
+    int wrap(int64_t position, bool looping) const {
+        if (looping) {
+            return static_cast<int>(position % count);
+        }
+        return static_cast<int>(std::min<int64_t>(position, count - 1));
+    }
+};
+
+RawFrameSource::RawFrameSource() : m_impl(std::make_unique<Impl>()) {
+    registerParam(fps);
+    registerParam(loop);
+    registerParam(preload);
+}
+
+RawFrameSource::~RawFrameSource() = default;
+
+bool RawFrameSource::open(const std::string& path) {
+    close();
+    Impl& s = *m_impl;
+
+    if (!s.file.open(path, s.lastError)) {
+        return false;
+    }
+
+    auto fail = [&](const std::string& error) {
+        s.file.close();
+        s.lastError = path + ": " + error;
+        return false;
+    };
+
+    if (s.file.size() < sizeof(RawFrameHeader)) {
+        return fail("too small for a raw frame header");
+    }
+    std::memcpy(&s.header, s.file.data(), sizeof(RawFrameHeader));
+    const RawFrameHeader& h = s.header;
+    if (!h.hasMagic()) {
+        return fail("not a raw frame file (bad magic)");
+    }
+    if (h.version != kRawFrameVersion) {
+        return fail("unsupported version " + std::to_string(h.version));
+    }
+    if (h.pixelFormat != kRawFrameBGRA8) {
+        return fail("unsupported pixel format " + std::to_string(h.pixelFormat));
+    }
+    if (h.width == 0 || h.height == 0 || h.width > 16384 || h.height > 16384) {
+        return fail("bad frame size " + std::to_string(h.width) + "x" + std::to_string(h.height));
+    }
+    if (h.headerSize < sizeof(RawFrameHeader) || h.headerSize > s.file.size()) {
+        return fail("bad header size " + std::to_string(h.headerSize));
+    }
+
+    // The file size wins: an unfinished recording has frameCount 0, a
+    // truncated copy fewer frames than it claims
+    s.frameBytes = h.frameBytes();
+    uint64_t available = (s.file.size() - h.headerSize) / s.frameBytes;
+    uint64_t count = h.frameCount > 0 ? std::min<uint64_t>(h.frameCount, available) : available;
+    if (count == 0) {
+        return fail("holds no whole frame");
+    }
+    s.count = static_cast<int>(std::min<uint64_t>(count, std::numeric_limits<int>::max()));
+
+    if (static_cast<int>(preload) != 0) {
+        s.file.touch();
+    } else {
+        s.file.prefetch(h.headerSize, s.frameBytes);
+    }
+    s.lastError.clear();
+    return true;
+}
+
+void RawFrameSource::close() {
+    Impl& s = *m_impl;
+    s.file.close();
+    s.header = RawFrameHeader{};
+    s.count = 0;
+    s.frameBytes = 0;
+    s.position = -1;
+    s.seekTo = -1;
+    s.clockRunning = false;
+    s.index = -1;
+    s.served = 0;
+    s.view = {};
+}
+
+bool RawFrameSource::isOpen() const {
+    return m_impl->file.isOpen();
+}
+
+const std::string& RawFrameSource::lastError() const {
+    return m_impl->lastError;
+}
+
+void RawFrameSource::seek(int frame) {
+    Impl& s = *m_impl;
+    s.seekTo = std::max(0, frame);
+}
+
+void RawFrameSource::cleanup() {
+    close();
+    detail::FrameStamps::instance().release(this);
+}
+
+Operator::CpuPixelView RawFrameSource::cpuPixelView() const {
+    return m_impl->view;
+}
+
+void RawFrameSource::process(Context& ctx) {
+    if (!needsCook()) {
+        return;
+    }
+
+    Impl& s = *m_impl;
+    if (s.count == 0) {
+        didCook();
+        return;
+    }
+
+    const bool looping = static_cast<int>(loop) != 0;
+    const float rate = static_cast<float>(fps);
+    const bool seeked = s.seekTo >= 0;
+    const int64_t following = seeked ? s.seekTo : s.position + 1;
+    int64_t position;
+    if (rate > 0.0f) {
+        // Follow the context clock from where playback (re)started
+        if (!s.clockRunning || seeked) {
+            s.clockBase = following;
+            s.clockStart = ctx.time();
+            s.clockRunning = true;
+        }
+        // The epsilon stops accumulated tick rounding from landing a frame late
+        double elapsed = std::max(0.0, ctx.time() - s.clockStart);
+        position = s.clockBase + static_cast<int64_t>(std::floor(elapsed * rate + 1e-6));
+    } else {
+        // One frame per cook, however long the cook takes
+        position = following;
+        s.clockRunning = false;
+    }
+    s.position = position;
+    s.seekTo = -1;
+
+    // A seek serves (and stamps) its frame even if it's the one already shown
+    int index = s.wrap(position, looping);
+    if (index != s.index || seeked) {
+        s.index = index;
+        s.view = {s.file.data() + s.offset(index), static_cast<int>(s.header.width),
+                  static_cast<int>(s.header.height), 4, 0};
+        s.served++;
+        detail::FrameStamps::instance().stamp(this, s.served, detail::nowSeconds());
+
+        if (static_cast<int>(preload) == 0) {
+            s.file.prefetch(s.offset(s.wrap(position + 1, looping)), s.frameBytes);
+        }
+    }
+
+    didCook();
+}
+
+int RawFrameSource::frameCount() const {
+    return m_impl->count;
+}
+
+int RawFrameSource::frameIndex() const {
+    return m_impl->index;
+}
+
+uint64_t RawFrameSource::framesServed() const {
+    return m_impl->served;
+}
+
+int RawFrameSource::width() const {
+    return static_cast<int>(m_impl->header.width);
+}
+
+int RawFrameSource::height() const {
+    return static_cast<int>(m_impl->header.height);
+}
+
+double RawFrameSource::recordedFps() const {
+    return m_impl->header.fps;
+}
+
+} // namespace vivid::opencv
+
+using OpenCVRawFrameSource = vivid::opencv::RawFrameSource;
+REGISTER_OPERATOR(OpenCVRawFrameSource, "OpenCV", "Memory-mapped replay of recorded raw BGRA frames", true);
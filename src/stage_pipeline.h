@@ -0,0 +1,239 @@
+#pragma once
+
+/**
+ * @file stage_pipeline.h
+ * @brief Software pipeline running an operator's stages on separate threads (internal)
+ */
+
+#include "async_cook.h"
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Runs a fixed sequence of stages as a software pipeline
+ *
+ * Each stage has its own thread. Frames move through the stages in order
+ * via bounded FIFO hand-off queues, so stage N of frame t+1 runs while
+ * stage N+1 of frame t does. With enough cores, throughput approaches that
+ * of the slowest stage rather than the sum of all stages. Latency is
+ * still the sum, plus queueing.
+ *
+ * Frames live in a fixed pool of `Frame` slots (stage count + 1), each
+ * owning its pinned input and every intermediate buffer, so steady-state
+ * hand-off never allocates. When the pool is exhausted, submit() replaces
+ * the newest frame still waiting for the first stage; if every slot has
+ * started, the submitted frame is dropped. Either way the drop is counted.
+ *
+ * The last stage fills a Result that is published through a ResultBuffer.
+ *
+ * A stage may keep state across frames (e.g. the previous frame for flow):
+ * only that stage's thread touches it while the pipeline is running.
+ *
+ * Frame must provide a `PinnedFrame input` member.
+ */
+template <typename Frame, typename Result>
+class StagePipeline {
+public:
+    using Stage = std::function<void(Frame&)>;
+    using Finish = std::function<void(Frame&, Result&)>;
+
+    StagePipeline() = default;
+    StagePipeline(const StagePipeline&) = delete;
+    StagePipeline& operator=(const StagePipeline&) = delete;
+    ~StagePipeline() { stop(); }
+
+    /// Set the stages (before the first submit; not while running)
+    void configure(std::vector<Stage> stages, Finish finish) {
+        stop();
+        m_stages = std::move(stages);
+        m_finish = std::move(finish);
+
+        size_t stageCount = m_stages.size() + 1;
+        m_frames = std::vector<Frame>(stageCount + 1);
+        m_queues.assign(stageCount, Ring{});
+        for (Ring& ring : m_queues) {
+            ring.slots.assign(m_frames.size(), 0);
+        }
+        m_free.slots.assign(m_frames.size(), 0);
+        m_wake = std::vector<std::condition_variable>(stageCount);
+        resetSlots();
+    }
+
+    bool configured() const { return !m_frames.empty(); }
+
+    /// Operator name used for the stage threads in traces (a literal)
+    void setName(const char* name) { m_name = name; }
+    bool running() const { return !m_threads.empty(); }
+
+    /**
+     * @brief Pin a BGRA frame (tightly packed rows) and feed it to the first stage
+     * @param fill Called on the calling thread with the frame slot before it
+     *        enters the pipeline, to store the param snapshot for this frame
+     */
+    template <typename Fill>
+    void submit(const uint8_t* bgra, int width, int height, Fill&& fill) {
+        if (!running()) {
+            start();
+        }
+
+        int slot = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_submitted++;
+            if (!m_free.empty()) {
+                slot = m_free.popFront();
+            } else if (!m_queues[0].empty()) {
+                slot = m_queues[0].popBack();  // Newest frame not yet started
+                m_dropped++;
+            } else {
+                m_dropped++;  // Every slot is in flight
+                return;
+            }
+        }
+
+        // The slot is owned by this thread until it is queued
+        Frame& frame = m_frames[slot];
+        size_t bytes = static_cast<size_t>(width) * height * 4;
+        frame.input.pixels.resize(bytes);
+        std::memcpy(frame.input.pixels.data(), bgra, bytes);
+        frame.input.width = width;
+        frame.input.height = height;
+        fill(frame);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queues[0].pushBack(slot);
+        }
+        m_wake[0].notify_one();
+    }
+
+    /// Newest completed result not yet taken (see ResultBuffer::takeFresh)
+    Result* takeFresh() { return m_results.takeFresh(); }
+
+    /// Finish the running stages, discard frames still in flight and join the threads
+    void stop() {
+        if (!running()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        for (auto& wake : m_wake) {
+            wake.notify_all();
+        }
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+        m_threads.clear();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dropped += m_frames.size() - m_free.count;  // Discarded in flight
+        resetSlots();
+        m_results.reset();  // A result not taken before the stop is stale after it
+    }
+
+    AsyncStats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        AsyncStats stats;
+        stats.submitted = m_submitted;
+        stats.completed = m_completed;
+        stats.dropped = m_dropped;
+        stats.queueDepth = static_cast<int>(m_frames.size() - m_free.count);
+        return stats;
+    }
+
+private:
+    // Fixed-capacity FIFO of slot indices (capacity = frame pool size)
+    struct Ring {
+        std::vector<int> slots;
+        size_t head = 0;
+        size_t count = 0;
+
+        bool empty() const { return count == 0; }
+        void pushBack(int slot) { slots[(head + count++) % slots.size()] = slot; }
+        int popFront() {
+            int slot = slots[head];
+            head = (head + 1) % slots.size();
+            count--;
+            return slot;
+        }
+        int popBack() { return slots[(head + --count) % slots.size()]; }
+    };
+
+    void resetSlots() {
+        for (Ring& ring : m_queues) {
+            ring.head = 0;
+            ring.count = 0;
+        }
+        m_free.head = 0;
+        m_free.count = 0;
+        for (size_t i = 0; i < m_frames.size(); ++i) {
+            m_free.pushBack(static_cast<int>(i));
+        }
+    }
+
+    void start() {
+        m_stopping = false;
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            m_threads.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    void run(size_t stage) {
+        const bool last = stage + 1 == m_queues.size();
+        setTraceThreadName(std::string(m_name) + (last ? " finish" : " stage " + std::to_string(stage)));
+        for (;;) {
+            int slot;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake[stage].wait(lock, [&] { return !m_queues[stage].empty() || m_stopping; });
+                if (m_stopping) {
+                    return;
+                }
+                slot = m_queues[stage].popFront();
+            }
+
+            Frame& frame = m_frames[slot];
+            if (!last) {
+                m_stages[stage](frame);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_queues[stage + 1].pushBack(slot);
+                }
+                m_wake[stage + 1].notify_one();
+            } else {
+                m_finish(frame, m_results.back());
+                m_results.publish();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completed++;
+                m_free.pushBack(slot);
+            }
+        }
+    }
+
+    std::vector<Stage> m_stages;
+    Finish m_finish;
+    std::vector<Frame> m_frames;
+    std::vector<Ring> m_queues;                  // m_queues[i] feeds stage i
+    Ring m_free;
+    std::vector<std::condition_variable> m_wake; // One per stage
+    std::vector<std::thread> m_threads;
+    ResultBuffer<Result> m_results;
+    const char* m_name = "operator";
+
+    mutable std::mutex m_mutex;
+    bool m_stopping = false;
+    uint64_t m_submitted = 0;
+    uint64_t m_completed = 0;
+    uint64_t m_dropped = 0;
+};
+
+} // namespace vivid::opencv::detail
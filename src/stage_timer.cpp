@@ -0,0 +1,162 @@
+/**
+ * @file stage_timer.cpp
+ * @brief Per-stage cook timing with lock-free rolling histograms
+ */
+
+#include "stage_timer.h"
+
+#if VIVID_OPENCV_PROFILING
+
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv::detail {
+
+int StageHistogram::bucketOf(uint64_t ns) {
+    if (ns < (uint64_t(1) << kMinShift)) {
+        return 0;
+    }
+    int msb = 63;
+    while (!(ns >> msb)) {
+        msb--;
+    }
+    // Octave from the top bit, eighth-octave from the next three
+    int sub = static_cast<int>((ns >> (msb - 3)) & (kSubBuckets - 1));
+    int bucket = 1 + (msb - kMinShift) * kSubBuckets + sub;
+    return std::min(bucket, kBuckets - 1);
+}
+
+double StageHistogram::bucketMidNs(int bucket) {
+    if (bucket == 0) {
+        return (uint64_t(1) << kMinShift) * 0.5;
+    }
+    int octave = (bucket - 1) / kSubBuckets;
+    int sub = (bucket - 1) % kSubBuckets;
+    double base = std::ldexp(1.0, octave + kMinShift);
+    return base * (1.0 + (sub + 0.5) / kSubBuckets);
+}
+
+void StageHistogram::record(uint64_t ns) {
+    m_lastNs.store(ns, std::memory_order_relaxed);
+    m_total.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t current = m_current.load(std::memory_order_relaxed);
+    Half& half = m_halves[current];
+    half.counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    half.sumNs.fetch_add(ns, std::memory_order_relaxed);
+
+    // The writer that fills the half recycles the other one
+    if (half.samples.fetch_add(1, std::memory_order_relaxed) + 1 == kWindow) {
+        Half& next = m_halves[current ^ 1];
+        for (auto& count : next.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        next.sumNs.store(0, std::memory_order_relaxed);
+        next.samples.store(0, std::memory_order_relaxed);
+        m_current.store(current ^ 1, std::memory_order_relaxed);
+    }
+}
+
+StageTiming StageHistogram::summary(const char* name) const {
+    StageTiming timing;
+    timing.name = name;
+    timing.samples = m_total.load(std::memory_order_relaxed);
+    timing.lastMs = m_lastNs.load(std::memory_order_relaxed) * 1e-6;
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t samples = 0;
+    double sumNs = 0.0;
+    for (const Half& half : m_halves) {
+        for (int i = 0; i < kBuckets; ++i) {
+            counts[i] += half.counts[i].load(std::memory_order_relaxed);
+        }
+        sumNs += static_cast<double>(half.sumNs.load(std::memory_order_relaxed));
+    }
+    for (uint64_t count : counts) {
+        samples += count;
+    }
+    if (samples == 0) {
+        return timing;
+    }
+
+    timing.meanMs = sumNs / samples * 1e-6;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(0.99 * samples));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            timing.p99Ms = bucketMidNs(i) * 1e-6;
+            break;
+        }
+    }
+    return timing;
+}
+
+void StageHistogram::reset() {
+    for (Half& half : m_halves) {
+        for (auto& count : half.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        half.sumNs.store(0, std::memory_order_relaxed);
+        half.samples.store(0, std::memory_order_relaxed);
+    }
+    m_current.store(0, std::memory_order_relaxed);
+    m_lastNs.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+}
+
+StageProfile::StageProfile(const char* category, std::initializer_list<const char*> names)
+    : m_category(category), m_names(names), m_stages(new StageHistogram[names.size()]),
+      m_stageAllocs(new AllocCounter[names.size()]) {}
+
+void StageProfile::endCook() {
+    uint64_t count = m_allocs.count.load(std::memory_order_relaxed);
+    uint64_t bytes = m_allocs.bytes.load(std::memory_order_relaxed);
+    m_cooks.lastCount = count - m_cookStartCount;
+    m_cooks.lastBytes = bytes - m_cookStartBytes;
+    m_cooks.cooks++;
+    if (m_cooks.lastCount > 0) {
+        m_cooks.allocatingCooks++;
+    }
+    m_cookStartCount = count;
+    m_cookStartBytes = bytes;
+}
+
+std::vector<StageTiming> StageProfile::timings() const {
+    std::vector<StageTiming> timings;
+    timings.reserve(m_names.size());
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        StageTiming timing = m_stages[i].summary(m_names[i]);
+        timing.allocs = m_stageAllocs[i].count.load(std::memory_order_relaxed);
+        timing.allocBytes = m_stageAllocs[i].bytes.load(std::memory_order_relaxed);
+        if (timing.samples > 0) {
+            timings.push_back(timing);
+        }
+    }
+    return timings;
+}
+
+AllocStats StageProfile::allocStats() const {
+    AllocStats stats = m_cooks;
+    stats.totalCount = m_allocs.count.load(std::memory_order_relaxed);
+    stats.totalBytes = m_allocs.bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StageProfile::reset() {
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        m_stages[i].reset();
+        m_stageAllocs[i].count.store(0, std::memory_order_relaxed);
+        m_stageAllocs[i].bytes.store(0, std::memory_order_relaxed);
+    }
+    // Background threads may add in between; the next cook absorbs the difference
+    m_cookStartCount = 0;
+    m_cookStartBytes = 0;
+    m_allocs.count.store(0, std::memory_order_relaxed);
+    m_allocs.bytes.store(0, std::memory_order_relaxed);
+    m_cooks = {};
+}
+
+} // namespace vivid::opencv::detail
+
+#endif
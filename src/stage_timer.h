@@ -0,0 +1,238 @@
+#pragma once
+
+/**
+ * @file stage_timer.h
+ * @brief Per-stage cook timing with lock-free rolling histograms (internal)
+ *
+ * Operators keep a StageProfile with one histogram per stage and mark stages
+ * with the macros below. While tracing is on (tracing.h), each timed stage is
+ * also recorded as a trace event. Timed regions also count allocations
+ * (alloc_counter.h): per stage on the thread running it, and per cook across
+ * every thread working for the operator. With VIVID_OPENCV_PROFILING=0 the
+ * macros expand to nothing and StageProfile is empty, so timing costs nothing.
+ *
+ * @code
+ * VIVID_OPENCV_COOK_SCOPE(impl->profile, StageProcess);   // Rest of process(); ends the cook
+ *
+ * VIVID_OPENCV_STAGE_CLOCK(clock, impl->profile);
+ * cv::Canny(gray, edges, t1, t2);
+ * VIVID_OPENCV_STAGE_LAP(clock, StageCanny);               // Since the clock or last lap
+ * cv::findContours(edges, contours, mode, method);
+ * VIVID_OPENCV_STAGE_LAP(clock, StageFindContours);
+ * @endcode
+ */
+
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/frame_stamp.h>
+#include <vivid/opencv/stage_timing.h>
+#include "alloc_counter.h"
+#include "trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#ifndef VIVID_OPENCV_PROFILING
+#define VIVID_OPENCV_PROFILING 0
+#endif
+
+namespace vivid::opencv::detail {
+
+#if VIVID_OPENCV_PROFILING
+
+/**
+ * @brief Log-bucketed histogram of recent durations
+ *
+ * Buckets are eighth-octaves from 256 ns to ~17 s. Samples go into one of
+ * two halves; when the current half holds kWindow samples the other is
+ * cleared and becomes current, so reads cover the last kWindow..2*kWindow
+ * samples. record() is wait-free. Reads are not atomic snapshots, which only
+ * matters for the one sample racing them.
+ */
+class StageHistogram {
+public:
+    static constexpr uint32_t kWindow = 512;
+
+    void record(uint64_t ns);
+    StageTiming summary(const char* name) const;
+    void reset();
+
+private:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kMinShift = 8;   // Bucket 0 holds everything under 2^8 ns
+    static constexpr int kOctaves = 26;
+    static constexpr int kBuckets = 1 + kOctaves * kSubBuckets;
+
+    static int bucketOf(uint64_t ns);
+    static double bucketMidNs(int bucket);
+
+    struct Half {
+        std::array<std::atomic<uint32_t>, kBuckets> counts{};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint32_t> samples{0};
+    };
+
+    Half m_halves[2];
+    std::atomic<uint32_t> m_current{0};
+    std::atomic<uint64_t> m_lastNs{0};
+    std::atomic<uint64_t> m_total{0};
+};
+
+using StageClockType = std::chrono::steady_clock;
+
+inline uint64_t clockNs(StageClockType::time_point time) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+/**
+ * @brief Histograms and allocation counts for an operator's named stages
+ *
+ * Stage indices are positions in the name list. `category` (the operator
+ * name) labels the stages in traces. All names must be string literals.
+ */
+class StageProfile {
+public:
+    StageProfile(const char* category, std::initializer_list<const char*> names);
+
+    /// Record a stage that ran from `start` to `end` and made the allocations
+    /// counted on this thread since `allocStart`
+    void record(int stage, StageClockType::time_point start, StageClockType::time_point end,
+                const ThreadAllocs& allocStart) {
+        uint64_t startNs = clockNs(start);
+        uint64_t endNs = clockNs(end);
+        m_stages[stage].record(endNs - startNs);
+        if (uint64_t count = t_threadAllocs.count - allocStart.count) {
+            m_stageAllocs[stage].count.fetch_add(count, std::memory_order_relaxed);
+            m_stageAllocs[stage].bytes.fetch_add(t_threadAllocs.bytes - allocStart.bytes,
+                                                 std::memory_order_relaxed);
+        }
+        if (tracing()) {
+            traceComplete(m_names[stage], m_category, startNs, endNs);
+        }
+    }
+
+    /// Record a published stamp's cook and pipeline latency as two stages (histograms only)
+    void recordLatency(int cookStage, int pipelineStage, const FrameStamp& stamp) {
+        m_stages[cookStage].record(secondsToNs(stamp.publishTime - stamp.receiveTime));
+        m_stages[pipelineStage].record(secondsToNs(stamp.publishTime - stamp.captureTime));
+    }
+
+    /// Counter for every allocation made on behalf of this operator
+    AllocCounter* allocs() { return &m_allocs; }
+
+    /// Close the current cook's allocation count (chain thread)
+    void endCook();
+
+    /// One entry per stage that has samples, in declaration order
+    std::vector<StageTiming> timings() const;
+
+    AllocStats allocStats() const;
+
+    void reset();
+
+private:
+    static uint64_t secondsToNs(double seconds) {
+        return seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e9) : 0;
+    }
+
+    const char* m_category;
+    std::vector<const char*> m_names;
+    std::unique_ptr<StageHistogram[]> m_stages;
+    std::unique_ptr<AllocCounter[]> m_stageAllocs;
+
+    AllocCounter m_allocs;
+    AllocStats m_cooks;                // Per-cook counters (chain thread)
+    uint64_t m_cookStartCount = 0;     // m_allocs when the current cook began
+    uint64_t m_cookStartBytes = 0;
+};
+
+/// Records the time until the end of the enclosing scope
+class StageScope {
+public:
+    StageScope(StageProfile& profile, int stage)
+        : m_profile(profile), m_stage(stage), m_allocScope(profile.allocs()),
+          m_allocStart(t_threadAllocs), m_start(StageClockType::now()) {}
+    ~StageScope() { m_profile.record(m_stage, m_start, StageClockType::now(), m_allocStart); }
+
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    StageProfile& m_profile;
+    int m_stage;
+    AllocScope m_allocScope;
+    ThreadAllocs m_allocStart;
+    StageClockType::time_point m_start;
+};
+
+/// Times a whole process() call as `stage`, then ends the cook
+class CookScope {
+public:
+    CookScope(StageProfile& profile, int stage) : m_profile(profile), m_scope(profile, stage) {}
+    ~CookScope() { m_profile.endCook(); }
+
+    CookScope(const CookScope&) = delete;
+    CookScope& operator=(const CookScope&) = delete;
+
+private:
+    StageProfile& m_profile;
+    StageScope m_scope;
+};
+
+/// Records the time between consecutive laps
+class StageClock {
+public:
+    explicit StageClock(StageProfile& profile)
+        : m_profile(profile), m_allocScope(profile.allocs()), m_lastAllocs(t_threadAllocs),
+          m_last(StageClockType::now()) {}
+
+    StageClock(const StageClock&) = delete;
+    StageClock& operator=(const StageClock&) = delete;
+
+    void lap(int stage) {
+        StageClockType::time_point now = StageClockType::now();
+        m_profile.record(stage, m_last, now, m_lastAllocs);
+        m_last = now;
+        m_lastAllocs = t_threadAllocs;
+    }
+
+private:
+    StageProfile& m_profile;
+    AllocScope m_allocScope;
+    ThreadAllocs m_lastAllocs;
+    StageClockType::time_point m_last;
+};
+
+#define VIVID_OPENCV_STAGE_CONCAT_(a, b) a##b
+#define VIVID_OPENCV_STAGE_CONCAT(a, b) VIVID_OPENCV_STAGE_CONCAT_(a, b)
+#define VIVID_OPENCV_STAGE_SCOPE(profile, stage) \
+    ::vivid::opencv::detail::StageScope VIVID_OPENCV_STAGE_CONCAT(stageScope_, __LINE__)(profile, stage)
+#define VIVID_OPENCV_COOK_SCOPE(profile, stage) \
+    ::vivid::opencv::detail::CookScope VIVID_OPENCV_STAGE_CONCAT(cookScope_, __LINE__)(profile, stage)
+#define VIVID_OPENCV_STAGE_CLOCK(clock, profile) ::vivid::opencv::detail::StageClock clock(profile)
+#define VIVID_OPENCV_STAGE_LAP(clock, stage) clock.lap(stage)
+
+#else
+
+class StageProfile {
+public:
+    StageProfile(const char*, std::initializer_list<const char*>) {}
+    void recordLatency(int, int, const FrameStamp&) {}
+    std::vector<StageTiming> timings() const { return {}; }
+    AllocStats allocStats() const { return {}; }
+    void reset() {}
+};
+
+// Still name the profile so captures and parameters used only for timing stay "used"
+#define VIVID_OPENCV_STAGE_SCOPE(profile, stage) ((void)(profile))
+#define VIVID_OPENCV_COOK_SCOPE(profile, stage) ((void)(profile))
+#define VIVID_OPENCV_STAGE_CLOCK(clock, profile) ((void)(profile))
+#define VIVID_OPENCV_STAGE_LAP(clock, stage) ((void)0)
+
+#endif
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,109 @@
+/**
+ * @file stamp_registry.cpp
+ * @brief Module-wide registry of output frame stamps
+ */
+
+#include "stamp_registry.h"
+#include "clock.h"
+#include "trace.h"
+
+namespace vivid::opencv::detail {
+
+FrameStamps& FrameStamps::instance() {
+    static FrameStamps stamps;
+    return stamps;
+}
+
+ReceivedFrame FrameStamps::receive(const Operator* source, const void* consumer,
+                                   uint64_t chainFrame) {
+    double now = nowSeconds();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[source];
+    if (!entry.published) {
+        if (entry.stamp.frameId == 0 || entry.chainFrame != chainFrame ||
+            entry.consumed.count(consumer) > 0) {
+            entry.stamp = {};
+            entry.stamp.frameId = m_nextId++;
+            entry.stamp.captureTime = now;
+            entry.stamp.publishTime = now;
+            entry.key = m_nextKey++;
+            entry.chainFrame = chainFrame;
+            entry.consumed.clear();
+        }
+        entry.consumed.insert(consumer);
+    }
+
+    ReceivedFrame frame;
+    frame.stamp = entry.stamp;
+    frame.stamp.receiveTime = now;
+    frame.stamp.publishTime = 0.0;
+    frame.key = entry.key;
+    return frame;
+}
+
+FrameStamp FrameStamps::publish(const Operator* op, const char* name, FrameStamp stamp) {
+    stamp.publishTime = nowSeconds();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_entries[op];
+        entry.stamp = stamp;
+        entry.key = m_nextKey++;
+        entry.published = true;
+        entry.consumed.clear();
+    }
+    if (tracing()) {
+        uint64_t ns = traceNowNs();
+        traceCounter(name, "cook latency", "ms", ns, stamp.cookLatencyMs());
+        traceCounter(name, "pipeline latency", "ms", ns, stamp.pipelineLatencyMs());
+    }
+    return stamp;
+}
+
+void FrameStamps::stamp(const Operator* source, uint64_t frameId, double captureTime) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[source];
+    // A new id means new pixels; restamping the frame on display keeps its cached data
+    if (!entry.published || entry.stamp.frameId != frameId) {
+        entry.key = m_nextKey++;
+    }
+    entry.stamp = {};
+    entry.stamp.frameId = frameId;
+    entry.stamp.captureTime = captureTime;
+    entry.stamp.receiveTime = captureTime;
+    entry.stamp.publishTime = captureTime;
+    entry.published = true;
+    entry.consumed.clear();
+}
+
+FrameStamp FrameStamps::current(const Operator* op) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(op);
+    return it != m_entries.end() ? it->second.stamp : FrameStamp{};
+}
+
+void FrameStamps::release(const Operator* op) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(op);
+    for (auto& [source, entry] : m_entries) {
+        entry.consumed.erase(op);
+    }
+}
+
+} // namespace vivid::opencv::detail
+
+namespace vivid::opencv {
+
+FrameStamp frameStamp(const vivid::Operator& op) {
+    return detail::FrameStamps::instance().current(&op);
+}
+
+void stampFrame(const vivid::Operator& source, uint64_t frameId, double captureTime) {
+    detail::FrameStamps::instance().stamp(&source, frameId, captureTime);
+}
+
+double stampClock() {
+    return detail::nowSeconds();
+}
+
+} // namespace vivid::opencv
@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ * @file stamp_registry.h
+ * @brief Module-wide registry of output frame stamps (internal)
+ */
+
+#include <vivid/opencv/frame_stamp.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief A source frame as taken by one consumer
+ */
+struct ReceivedFrame {
+    FrameStamp stamp;
+    uint64_t key = 0;  ///< Changes whenever the source's output does; keys FrameCache
+};
+
+/**
+ * @brief Current FrameStamp per operator output
+ *
+ * Our operators publish a stamp whenever their output changes; hosts may
+ * stamp their own sources. Any other source is assumed to show a new frame
+ * on every chain frame (or when the same consumer reads it again), which
+ * gets the next id, captured at that moment. Every change of a source's
+ * output also gets a new cache key, so derived data is never served for
+ * pixels it was not computed from.
+ *
+ * @code
+ * detail::ReceivedFrame frame = detail::FrameStamps::instance().receive(inputOp, this, ctx.frame());
+ * // ... cook, possibly on another thread ...
+ * detail::FrameStamps::instance().publish(this, "Contours", frame.stamp);
+ * @endcode
+ */
+class FrameStamps {
+public:
+    static FrameStamps& instance();
+
+    /**
+     * @brief Stamp of the frame `consumer` is about to cook from `source`, received now
+     * @param chainFrame The context's frame counter (Context::frame())
+     */
+    ReceivedFrame receive(const Operator* source, const void* consumer, uint64_t chainFrame);
+
+    /**
+     * @brief Make `stamp` the stamp of `op`'s output, published now
+     * @param name Operator name for trace counters (a literal)
+     * @return The stamp with publishTime set
+     */
+    FrameStamp publish(const Operator* op, const char* name, FrameStamp stamp);
+
+    /// Host-provided stamp for a source outside the module
+    void stamp(const Operator* source, uint64_t frameId, double captureTime);
+
+    FrameStamp current(const Operator* op);
+
+    /// Forget an operator (call from cleanup), as a source and as a consumer
+    void release(const Operator* op);
+
+private:
+    struct Entry {
+        FrameStamp stamp;
+        uint64_t key = 0;
+        uint64_t chainFrame = 0;                   // Chain frame the inferred stamp was taken on
+        bool published = false;                    // Stamped by its owner; never inferred
+        std::unordered_set<const void*> consumed;  // Consumers served this frame (inferred only)
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<const Operator*, Entry> m_entries;
+    uint64_t m_nextId = 1;
+    uint64_t m_nextKey = 1;
+};
+
+} // namespace vivid::opencv::detail
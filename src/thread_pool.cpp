@@ -0,0 +1,339 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Module-wide worker pool and OpenCV parallel backend
+ */
+
+#include "thread_pool.h"
+#include "alloc_counter.h"
+#include "trace.h"
+#include <opencv2/core.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace vivid::opencv::detail {
+
+namespace {
+
+thread_local int t_budget = 0;         // Innermost ThreadBudget (0 = none)
+thread_local int t_index = 0;          // 1..workers on pool threads
+thread_local bool t_inLoop = false;    // Inside a pool loop body
+
+std::atomic<int> g_workerCount{0};
+std::mutex g_configMutex;              // Serializes configure()
+
+int defaultWorkers() {
+    if (const char* env = std::getenv("VIVID_OPENCV_THREADS")) {
+        int threads = std::atoi(env);
+        if (threads > 0) {
+            return threads - 1;
+        }
+    }
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(0, hardware - 1);  // Leave a core for the calling thread
+}
+
+void pinToCore(std::thread& thread, int core) {
+#if defined(_WIN32)
+    if (core >= 0 && core < 64) {
+        SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << core);
+    }
+#elif defined(__linux__)
+    if (core >= 0 && core < CPU_SETSIZE) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+    }
+#else
+    // macOS only offers affinity hints; leave scheduling to the kernel
+    (void)thread;
+    (void)core;
+#endif
+}
+
+// Routes OpenCV's parallel_for_ (and cv::setNumThreads) to the pool
+class PoolBackend : public cv::parallel::ParallelForAPI {
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body, void* data) override {
+        ThreadPool::instance().run(tasks, body, data, t_budget);
+    }
+
+    int getThreadNum() const override {
+        return ThreadPool::currentIndex();
+    }
+
+    int getNumThreads() const override {
+        return ThreadPool::instance().threadsForCaller();
+    }
+
+    int setNumThreads(int threads) override {
+        ThreadPool& pool = ThreadPool::instance();
+        int previous = pool.workers() + 1;
+        pool.configure(threads <= 0 ? -1 : threads - 1, pool.affinity());
+        return previous;
+    }
+
+    const char* getName() const override {
+        return "vivid-opencv";
+    }
+};
+
+} // namespace
+
+struct ThreadPool::Job {
+    Body body = nullptr;
+    void* data = nullptr;
+    int tasks = 0;
+    int chunk = 1;
+    std::atomic<int> next{0};
+    int helpersWanted = 0;
+    int helpers = 0;                   // Workers that joined (under m_mutex)
+    int active = 0;                    // Workers still inside (under m_mutex)
+    std::exception_ptr error;          // First exception from a helper (under m_mutex)
+    AllocCounter* allocSink = nullptr; // Caller's allocation counter, adopted by helpers
+
+    bool exhausted() const { return next.load(std::memory_order_relaxed) >= tasks; }
+
+    // Claim and run chunks until none are left
+    void drain() {
+        for (;;) {
+            int begin = next.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= tasks) {
+                return;
+            }
+            body(begin, std::min(begin + chunk, tasks), data);
+        }
+    }
+};
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() {
+    start(defaultWorkers(), {});
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+void ThreadPool::configure(int workers, const std::vector<int>& affinity) {
+    std::lock_guard<std::mutex> config(g_configMutex);
+    stop();
+    start(workers < 0 ? defaultWorkers() : workers, affinity);
+}
+
+int ThreadPool::workers() const {
+    return g_workerCount.load(std::memory_order_relaxed);
+}
+
+std::vector<int> ThreadPool::affinity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_affinity;
+}
+
+int ThreadPool::currentIndex() {
+    return t_index;
+}
+
+int ThreadPool::threadsForCaller() const {
+    if (t_inLoop) {
+        return 1;  // Nested loops run serially
+    }
+    int threads = workers() + 1;
+    if (t_budget > 0) {
+        threads = std::min(threads, t_budget);
+    }
+    return threads;
+}
+
+void ThreadPool::start(int workers, const std::vector<int>& affinity) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = false;
+        m_affinity = affinity;
+    }
+    m_threads.reserve(workers);
+    for (int i = 0; i < workers; ++i) {
+        m_threads.emplace_back([this, i] { workerLoop(i + 1); });
+        if (!affinity.empty()) {
+            pinToCore(m_threads.back(), affinity[i % affinity.size()]);
+        }
+    }
+    g_workerCount.store(workers, std::memory_order_relaxed);
+}
+
+void ThreadPool::stop() {
+    g_workerCount.store(0, std::memory_order_relaxed);  // New loops stop recruiting helpers
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+void ThreadPool::run(int tasks, Body body, void* data, int maxThreads) {
+    if (tasks <= 0) {
+        return;
+    }
+
+    int threads = workers() + 1;
+    if (maxThreads > 0) {
+        threads = std::min(threads, maxThreads);
+    }
+    threads = std::min(threads, tasks);
+    if (threads <= 1 || t_inLoop) {
+        body(0, tasks, data);
+        return;
+    }
+
+    Job job;
+    job.body = body;
+    job.data = data;
+    job.tasks = tasks;
+    job.chunk = std::max(1, tasks / (threads * 4));  // A few chunks per thread for balance
+    job.helpersWanted = threads - 1;
+    job.allocSink = currentAllocSink();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    if (job.helpersWanted == 1) {
+        m_wake.notify_one();
+    } else {
+        m_wake.notify_all();
+    }
+
+    // The caller works too, and can finish the whole loop alone
+    std::exception_ptr error;
+    t_inLoop = true;
+    try {
+        TraceScope scope("parallel_for", "pool");
+        job.drain();
+    } catch (...) {
+        error = std::current_exception();
+        job.next.store(tasks, std::memory_order_relaxed);  // Stop handing out chunks
+    }
+    t_inLoop = false;
+
+    // Retire the job and wait only for chunks helpers already claimed
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.erase(std::remove(m_jobs.begin(), m_jobs.end(), &job), m_jobs.end());
+    m_helpersDone.wait(lock, [&] { return job.active == 0; });
+    if (!error) {
+        error = job.error;
+    }
+    lock.unlock();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop(int index) {
+    t_index = index;
+    setTraceThreadName("pool worker " + std::to_string(index));
+
+    auto findJob = [this]() -> Job* {
+        for (Job* job : m_jobs) {
+            if (!job->exhausted()) {
+                return job;
+            }
+        }
+        return nullptr;
+    };
+
+    for (;;) {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || (job = findJob()) != nullptr; });
+            if (m_stopping) {
+                return;
+            }
+            job->active++;
+            if (++job->helpers >= job->helpersWanted) {
+                m_jobs.erase(std::remove(m_jobs.begin(), m_jobs.end(), job), m_jobs.end());
+            }
+        }
+
+        t_inLoop = true;
+        try {
+            TraceScope scope("parallel_for", "pool");
+            AllocScope allocs(job->allocSink);
+            job->drain();
+        } catch (...) {
+            job->next.store(job->tasks, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!job->error) {
+                job->error = std::current_exception();
+            }
+        }
+        t_inLoop = false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--job->active == 0) {
+            m_helpersDone.notify_all();
+        }
+    }
+}
+
+ThreadBudget::ThreadBudget(int threads) : m_previous(t_budget) {
+    if (threads > 0) {
+        t_budget = threads;
+    }
+}
+
+ThreadBudget::~ThreadBudget() {
+    t_budget = m_previous;
+}
+
+int ThreadBudget::current() {
+    return t_budget;
+}
+
+void ensureThreadPool() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        ThreadPool::instance();
+        // Keep our worker count: don't push OpenCV's default into the pool
+        cv::parallel::setParallelForBackend(std::make_shared<PoolBackend>(), false);
+    });
+}
+
+} // namespace vivid::opencv::detail
+
+namespace vivid::opencv {
+
+void configureThreadPool(const ThreadPoolConfig& config) {
+    detail::ensureThreadPool();
+    detail::ThreadPool::instance().configure(config.workers, config.affinity);
+}
+
+ThreadPoolConfig threadPoolConfig() {
+    detail::ensureThreadPool();
+    ThreadPoolConfig config;
+    config.workers = detail::ThreadPool::instance().workers();
+    config.affinity = detail::ThreadPool::instance().affinity();
+    return config;
+}
+
+} // namespace vivid::opencv
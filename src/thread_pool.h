@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file thread_pool.h
+ * @brief Module-wide worker pool and OpenCV parallel backend (internal)
+ */
+
+#include <vivid/opencv/threading.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Fork-join pool for parallel loops
+ *
+ * A loop is split into chunks claimed from an atomic counter. The calling
+ * thread claims chunks too and never waits for a worker to start: if every
+ * worker is busy it simply runs the whole loop itself. It only waits for
+ * chunks a worker has already claimed. Loops started from inside a loop
+ * body run serially on that thread.
+ */
+class ThreadPool {
+public:
+    using Body = void (*)(int begin, int end, void* data);
+
+    static ThreadPool& instance();
+
+    /// Restart with `workers` threads (< 0 = default) pinned per `affinity`
+    void configure(int workers, const std::vector<int>& affinity);
+
+    /// Worker threads (not counting callers)
+    int workers() const;
+
+    /// Cores workers are pinned to (empty = none)
+    std::vector<int> affinity() const;
+
+    /**
+     * @brief Run `body` over [0, tasks) in chunks
+     * @param maxThreads Threads allowed for this loop, including the caller
+     *        (<= 0 = no limit beyond the pool size)
+     */
+    void run(int tasks, Body body, void* data, int maxThreads);
+
+    /// Threads a loop started on this thread may use (see ThreadBudget)
+    int threadsForCaller() const;
+
+    /// Index of the calling thread: 1..workers for pool workers, 0 otherwise
+    static int currentIndex();
+
+    ~ThreadPool();
+
+private:
+    struct Job;
+
+    ThreadPool();
+    void start(int workers, const std::vector<int>& affinity);
+    void stop();
+    void workerLoop(int index);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;        // Workers wait for jobs
+    std::condition_variable m_helpersDone; // Callers wait for helpers to leave their job
+    std::vector<Job*> m_jobs;              // Jobs still accepting helpers
+    std::vector<std::thread> m_threads;
+    std::vector<int> m_affinity;
+    bool m_stopping = false;
+};
+
+/**
+ * @brief Caps the threads parallel loops on this thread may use, for a scope
+ *
+ * Operators open one around their cook with their `threads` param
+ * (0 = no cap). Budgets nest; the innermost wins.
+ */
+class ThreadBudget {
+public:
+    explicit ThreadBudget(int threads);
+    ~ThreadBudget();
+
+    ThreadBudget(const ThreadBudget&) = delete;
+    ThreadBudget& operator=(const ThreadBudget&) = delete;
+
+    /// Budget in effect on this thread (0 = none)
+    static int current();
+
+private:
+    int m_previous;
+};
+
+/**
+ * @brief Start the pool and install it as OpenCV's parallel_for_ backend
+ *
+ * Idempotent and cheap after the first call; operators call it from init().
+ */
+void ensureThreadPool();
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,307 @@
+/**
+ * @file trace.cpp
+ * @brief Lock-free trace-event recording and Chrome trace JSON output
+ */
+
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vivid::opencv::detail {
+
+std::atomic<bool> g_tracing{false};
+
+namespace {
+
+enum TraceKind : uint32_t {
+    KindPending,                       // Slot claimed, still being written
+    KindComplete,                      // "X": name/category over [startNs, startNs + durationNs]
+    KindCounter                        // "C": counter "name category" = value (in unit) at startNs
+};
+
+struct TraceEvent {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+    double value = 0.0;
+    const char* unit = nullptr;        // Counters only
+    uint32_t tid = 0;
+    std::atomic<uint32_t> kind{KindPending};  // Set last, with release
+};
+
+struct TraceBuffer {
+    explicit TraceBuffer(size_t size) : events(new TraceEvent[size]), size(size) { reset(size); }
+
+    // Empty the buffer and use its first `slots` events; only while no writer can reach it
+    void reset(size_t slots) {
+        uint64_t used = std::min<uint64_t>(next.load(std::memory_order_relaxed), size);
+        for (uint64_t i = 0; i < used; ++i) {
+            events[i].kind.store(KindPending, std::memory_order_relaxed);
+        }
+        capacity = slots;
+        originNs = traceNowNs();
+        next.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<TraceEvent[]> events;
+    size_t size;                       // Events allocated
+    size_t capacity = 0;               // Events this trace may use (<= size)
+    uint64_t originNs = 0;             // Trace time zero
+    std::atomic<uint64_t> next{0};     // Next slot to claim
+    std::atomic<uint64_t> dropped{0};
+};
+
+// Swapped out by startTracing(), which then waits for g_writers to drain
+// before it reuses or frees the old buffer
+std::atomic<TraceBuffer*> g_buffer{nullptr};
+
+// Threads between loading g_buffer and finishing their event
+std::atomic<uint32_t> g_writers{0};
+
+std::atomic<uint32_t> g_nextTid{0};
+thread_local uint32_t t_tid = 0;
+thread_local bool t_named = false;
+
+struct Registry {
+    std::mutex bufferMutex;            // Held while g_buffer is replaced or read out
+    std::mutex mutex;
+    std::map<uint32_t, std::string> threadNames;
+    std::string outputPath;            // Written at unload
+};
+
+// Leaked on purpose so it outlives every thread that might name itself
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+uint32_t currentTid() {
+    if (t_tid == 0) {
+        t_tid = g_nextTid.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return t_tid;
+}
+
+void writeJsonString(FILE* out, const char* text) {
+    std::fputc('"', out);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', out);
+        }
+        if (static_cast<unsigned char>(*c) >= 0x20) {
+            std::fputc(*c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+// Starts tracing from VIVID_OPENCV_TRACE at load and writes the file at unload
+struct AutoTrace {
+    AutoTrace() {
+        if (const char* path = std::getenv("VIVID_OPENCV_TRACE")) {
+            if (*path) {
+                TraceConfig config;
+                config.outputPath = path;
+                startTracing(config);
+            }
+        }
+    }
+
+    ~AutoTrace() {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            path = registry().outputPath;
+        }
+        if (!path.empty()) {
+            writeTrace(path);
+        }
+    }
+};
+
+AutoTrace g_autoTrace;
+
+} // namespace
+
+namespace {
+
+// Claim the next slot of the current buffer; nullptr if off or full.
+// A claimed slot must be finished with commitEvent().
+TraceEvent* claimEvent() {
+    if (!tracing()) {
+        return nullptr;
+    }
+    // Counted before the buffer is loaded, so startTracing() sees every
+    // writer that might still hold the buffer it swapped out
+    g_writers.fetch_add(1, std::memory_order_seq_cst);
+    if (TraceBuffer* buffer = g_buffer.load(std::memory_order_seq_cst)) {
+        uint64_t slot = buffer->next.fetch_add(1, std::memory_order_relaxed);
+        if (slot < buffer->capacity) {
+            return &buffer->events[slot];
+        }
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    g_writers.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+}
+
+void commitEvent(TraceEvent* event, TraceKind kind) {
+    event->kind.store(kind, std::memory_order_release);
+    g_writers.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace
+
+void traceComplete(const char* name, const char* category, uint64_t startNs, uint64_t endNs) {
+    if (TraceEvent* event = claimEvent()) {
+        event->name = name;
+        event->category = category;
+        event->startNs = startNs;
+        event->durationNs = endNs > startNs ? endNs - startNs : 0;
+        event->tid = currentTid();
+        commitEvent(event, KindComplete);
+    }
+}
+
+void traceCounter(const char* name, const char* series, const char* unit, uint64_t ns,
+                  double value) {
+    if (TraceEvent* event = claimEvent()) {
+        event->name = name;
+        event->category = series;
+        event->startNs = ns;
+        event->value = value;
+        event->unit = unit;
+        event->tid = currentTid();
+        commitEvent(event, KindCounter);
+    }
+}
+
+void setTraceThreadName(std::string name) {
+    uint32_t tid = currentTid();
+    t_named = true;
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().threadNames[tid] = std::move(name);
+}
+
+void nameTraceThread(const char* name) {
+    if (!t_named) {
+        setTraceThreadName(name);
+    }
+}
+
+} // namespace vivid::opencv::detail
+
+namespace vivid::opencv {
+
+void startTracing(const TraceConfig& config) {
+    using namespace detail;
+    std::lock_guard<std::mutex> bufferLock(registry().bufferMutex);
+    const size_t capacity = std::max<size_t>(config.capacity, 1);
+
+    // Take the old buffer out of reach, then wait for the events still being
+    // written into it (a few stores each) before reusing or freeing it
+    TraceBuffer* buffer = g_buffer.exchange(nullptr, std::memory_order_seq_cst);
+    while (g_writers.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    if (buffer && buffer->size >= capacity) {
+        buffer->reset(capacity);
+    } else {
+        delete buffer;
+        buffer = new TraceBuffer(capacity);
+    }
+    g_buffer.store(buffer, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        if (!config.outputPath.empty()) {
+            registry().outputPath = config.outputPath;
+        }
+    }
+    g_tracing.store(true, std::memory_order_relaxed);
+}
+
+void stopTracing() {
+    detail::g_tracing.store(false, std::memory_order_relaxed);
+}
+
+bool writeTrace(const std::string& path) {
+    using namespace detail;
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        return false;
+    }
+
+    std::fprintf(out, "{\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+                      "\"args\":{\"name\":\"vivid-opencv\"}}");
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (const auto& [tid, name] : registry().threadNames) {
+            std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", tid);
+            writeJsonString(out, name.c_str());
+            std::fprintf(out, "}}");
+        }
+    }
+
+    std::lock_guard<std::mutex> bufferLock(registry().bufferMutex);
+    if (TraceBuffer* buffer = g_buffer.load(std::memory_order_acquire)) {
+        uint64_t count = std::min<uint64_t>(buffer->next.load(std::memory_order_relaxed), buffer->capacity);
+        for (uint64_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            uint32_t kind = event.kind.load(std::memory_order_acquire);
+            if (kind == KindPending) {
+                continue;  // Claimed but still being written
+            }
+            if (kind == KindCounter) {
+                // JSON has no NaN or infinity; such samples would void the whole file
+                if (event.startNs < buffer->originNs || !std::isfinite(event.value)) {
+                    continue;
+                }
+                std::fprintf(out, ",\n{\"name\":");
+                writeJsonString(out, (std::string(event.name) + " " + event.category).c_str());
+                std::fprintf(out, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{",
+                             (event.startNs - buffer->originNs) * 1e-3, event.tid);
+                writeJsonString(out, event.unit ? event.unit : "value");
+                std::fprintf(out, ":%.3f}}", event.value);
+                continue;
+            }
+            // Scopes that began just before startTracing() are clipped to time zero
+            uint64_t start = std::max(event.startNs, buffer->originNs);
+            uint64_t end = std::max(event.startNs + event.durationNs, start);
+            std::fprintf(out, ",\n{\"name\":");
+            writeJsonString(out, event.name);
+            std::fprintf(out, ",\"cat\":");
+            writeJsonString(out, event.category);
+            std::fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                         (start - buffer->originNs) * 1e-3, (end - start) * 1e-3, event.tid);
+        }
+    }
+
+    std::fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    bool ok = std::ferror(out) == 0;
+    return std::fclose(out) == 0 && ok;
+}
+
+TraceStats traceStats() {
+    using namespace detail;
+    TraceStats stats;
+    stats.enabled = tracing();
+    std::lock_guard<std::mutex> bufferLock(registry().bufferMutex);
+    if (TraceBuffer* buffer = g_buffer.load(std::memory_order_acquire)) {
+        stats.recorded = std::min<uint64_t>(buffer->next.load(std::memory_order_relaxed), buffer->capacity);
+        stats.dropped = buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+} // namespace vivid::opencv
@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file trace.h
+ * @brief Lock-free trace-event recording (internal)
+ */
+
+#include <vivid/opencv/tracing.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace vivid::opencv::detail {
+
+extern std::atomic<bool> g_tracing;
+
+/// Tracing is on (one relaxed load; check before taking timestamps)
+inline bool tracing() {
+    return g_tracing.load(std::memory_order_relaxed);
+}
+
+/// steady_clock time in nanoseconds, the time base of trace events
+inline uint64_t traceNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Record a complete event on the calling thread
+ *
+ * `name` and `category` must be string literals (or otherwise outlive the
+ * trace); only the pointers are stored. No-op when tracing is off.
+ */
+void traceComplete(const char* name, const char* category, uint64_t startNs, uint64_t endNs);
+
+/**
+ * @brief Record a counter sample, shown as the track "<name> <series>"
+ *
+ * `unit` labels the value (e.g. "ms"). Same lifetime rules as
+ * traceComplete(). No-op when tracing is off.
+ */
+void traceCounter(const char* name, const char* series, const char* unit, uint64_t ns,
+                  double value);
+
+/// Name the calling thread in traces (call once, at thread start)
+void setTraceThreadName(std::string name);
+
+/// Name the calling thread unless it already has a name; cheap after the first call
+void nameTraceThread(const char* name);
+
+/**
+ * @brief Records its own lifetime as a complete event
+ *
+ * A scope that begins while tracing is off isn't recorded, even if tracing
+ * starts before it ends.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : m_name(name), m_category(category), m_startNs(tracing() ? traceNowNs() : 0) {}
+
+    ~TraceScope() {
+        if (m_startNs != 0) {
+            traceComplete(m_name, m_category, m_startNs, traceNowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_startNs;
+};
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,85 @@
+/**
+ * @file trajectory_arena.cpp
+ * @brief Preallocated per-track position history
+ */
+
+#include "trajectory_arena.h"
+#include <cstddef>
+
+namespace vivid::opencv::detail {
+
+void TrajectoryArena::configure(int slots, int length) {
+    if (slots <= 0 || length <= 0) {
+        slots = 0;
+        length = 0;
+    }
+    size_t samples = static_cast<size_t>(slots) * static_cast<size_t>(length);
+    m_x.assign(samples, 0.0f);
+    m_y.assign(samples, 0.0f);
+    m_time.assign(samples, 0.0);
+    m_start.assign(slots, 0);
+    m_count.assign(slots, 0);
+    m_length = length;
+
+    // Free list as a stack; lowest slots are handed out first
+    m_free.clear();
+    m_free.reserve(slots);
+    for (int s = slots - 1; s >= 0; --s) {
+        m_free.push_back(s);
+    }
+}
+
+int TrajectoryArena::acquire() {
+    if (m_free.empty()) {
+        return -1;
+    }
+    int slot = m_free.back();
+    m_free.pop_back();
+    m_start[slot] = 0;
+    m_count[slot] = 0;
+    return slot;
+}
+
+void TrajectoryArena::release(int slot) {
+    if (slot >= 0 && slot < static_cast<int>(m_count.size())) {
+        m_free.push_back(slot);  // Capacity reserved in configure()
+    }
+}
+
+void TrajectoryArena::push(int slot, float x, float y, double time) {
+    if (slot < 0 || m_length == 0) {
+        return;
+    }
+    size_t base = static_cast<size_t>(slot) * m_length;
+    int& start = m_start[slot];
+    int& count = m_count[slot];
+
+    int write;
+    if (count < m_length) {
+        write = (start + count) % m_length;
+        ++count;
+    } else {
+        write = start;  // Overwrite the oldest
+        start = (start + 1) % m_length;
+    }
+    m_x[base + write] = x;
+    m_y[base + write] = y;
+    m_time[base + write] = time;
+}
+
+TrajectoryView TrajectoryArena::view(int slot) const {
+    TrajectoryView view;
+    if (slot < 0 || m_length == 0) {
+        return view;
+    }
+    size_t base = static_cast<size_t>(slot) * m_length;
+    view.xs = m_x.data() + base;
+    view.ys = m_y.data() + base;
+    view.times = m_time.data() + base;
+    view.capacity = m_length;
+    view.start = m_start[slot];
+    view.count = m_count[slot];
+    return view;
+}
+
+} // namespace vivid::opencv::detail
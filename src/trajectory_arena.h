@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * @file trajectory_arena.h
+ * @brief Preallocated per-track position history (internal)
+ */
+
+#include <vivid/opencv/trajectory.h>
+#include "alloc_counter.h"
+
+namespace vivid::opencv::detail {
+
+/**
+ * @brief Fixed-capacity ring buffers for many tracks in one SoA arena
+ *
+ * All storage is allocated by configure(); acquiring, releasing and
+ * appending never allocate. Tracks beyond the slot capacity simply get no
+ * history (acquire() returns -1).
+ */
+class TrajectoryArena {
+public:
+    /// (Re)allocate for `slots` tracks of `length` samples; drops all history
+    void configure(int slots, int length);
+
+    int length() const { return m_length; }
+
+    /// Claim an empty ring; -1 if the arena is full or disabled
+    int acquire();
+
+    /// Return a ring to the free list
+    void release(int slot);
+
+    /// Append a sample, overwriting the oldest once the ring is full
+    void push(int slot, float x, float y, double time);
+
+    TrajectoryView view(int slot) const;
+
+private:
+    CountedVector<float> m_x;
+    CountedVector<float> m_y;
+    CountedVector<double> m_time;
+    CountedVector<int> m_start;
+    CountedVector<int> m_count;
+    CountedVector<int> m_free;
+    int m_length = 0;
+};
+
+} // namespace vivid::opencv::detail
@@ -0,0 +1,531 @@
+/**
+ * @file bench_flow.cpp
+ * @brief Optical flow speed/accuracy sweep with its Pareto front
+ *
+ * Cooks FlowField (the Farneback solve OpticalFlow also runs) over a grid of
+ * scale, levels, winSize and iterations, and OpenCV's DIS flow at its presets
+ * for comparison, on textures with known motion (harness/flow_sequence.h):
+ * translated, rotated and warped. Every configuration gets its mean endpoint
+ * error against the ground truth and its time per frame; the ones no other
+ * configuration beats on both are the Pareto front. Writes one JSON document
+ * and prints the front to stderr.
+ *
+ * Usage:
+ *   bench_flow [--frames N] [--warmup N] [--size WxH] [--speed PX]
+ *              [--motions translate,rotate,warp] [--filter TEXT] [--out FILE]
+ *
+ * Errors are in input pixels. `--speed` is the motion per frame at the
+ * input size (see FlowSequence); `zeroFlowEpe` per motion is the error of
+ * reporting no motion at all, the bar every configuration has to clear.
+ *
+ * DIS isn't an OpticalFlow option; it runs here on the same grayscale,
+ * INTER_AREA-downscaled frames to show whether it would be worth adding.
+ */
+
+#include "harness/flow_sequence.h"
+#include "harness/harness.h"
+#include "harness/process_stats.h"
+#include <vivid/opencv/cpu_dispatch.h>
+#include <vivid/opencv/flow_field.h>
+#include <vivid/opencv/threading.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace vivid::opencv;
+using harness::FlowMotion;
+using harness::FlowSequence;
+using harness::FlowSequenceConfig;
+using harness::Harness;
+
+namespace {
+
+struct Candidate {
+    std::string algorithm;  // "farneback" or "dis"
+    std::string config;     // Unique per algorithm
+    float scale = 0.15f;
+    int levels = 0;         // Farneback
+    int winSize = 0;
+    int iterations = 0;
+    int preset = -1;        // DIS
+    bool isDefault = false; // OpticalFlow / FlowField defaults
+};
+
+std::string formatScale(float scale) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "s%.2g", scale);
+    return text;
+}
+
+std::vector<Candidate> candidates() {
+    const float scales[] = {0.1f, 0.15f, 0.25f, 0.35f, 0.5f};
+    std::vector<Candidate> list;
+    FlowField defaults;
+    for (float scale : scales) {
+        for (int levels : {1, 2, 3}) {
+            for (int winSize : {9, 15}) {
+                for (int iterations : {1, 3}) {
+                    Candidate c;
+                    c.algorithm = "farneback";
+                    c.config = formatScale(scale) + "_l" + std::to_string(levels) + "_w" +
+                               std::to_string(winSize) + "_i" + std::to_string(iterations);
+                    c.scale = scale;
+                    c.levels = levels;
+                    c.winSize = winSize;
+                    c.iterations = iterations;
+                    c.isDefault = scale == static_cast<float>(defaults.scale) &&
+                                  levels == static_cast<int>(defaults.levels) &&
+                                  winSize == static_cast<int>(defaults.winSize) &&
+                                  iterations == static_cast<int>(defaults.iterations);
+                    list.push_back(c);
+                }
+            }
+        }
+    }
+    const std::pair<const char*, int> presets[] = {
+        {"ultrafast", cv::DISOpticalFlow::PRESET_ULTRAFAST},
+        {"fast", cv::DISOpticalFlow::PRESET_FAST},
+        {"medium", cv::DISOpticalFlow::PRESET_MEDIUM},
+    };
+    for (float scale : scales) {
+        for (const auto& [name, preset] : presets) {
+            Candidate c;
+            c.algorithm = "dis";
+            c.config = formatScale(scale) + "_" + name;
+            c.scale = scale;
+            c.preset = preset;
+            list.push_back(c);
+        }
+    }
+    return list;
+}
+
+// One configuration under test: cook() is timed, field() is the flow from
+// the previous frame to the one just cooked
+class Solver {
+public:
+    virtual ~Solver() = default;
+    virtual void cook(const uint8_t* bgra) = 0;
+    virtual FlowFieldView field() const = 0;
+};
+
+class FarnebackSolver : public Solver {
+public:
+    FarnebackSolver(const Candidate& c, int width, int height) : m_harness(sceneSize(width, height)) {
+        m_flow.scale = c.scale;
+        m_flow.levels = c.levels;
+        m_flow.winSize = c.winSize;
+        m_flow.iterations = c.iterations;
+        m_harness.attach(m_flow);
+    }
+
+    void cook(const uint8_t* bgra) override {
+        const harness::SceneConfig& size = m_harness.scene().config();
+        m_harness.source().setFrameView(bgra, size.width, size.height);
+        m_harness.cook();
+    }
+
+    FlowFieldView field() const override { return m_flow.field(); }
+
+private:
+    static harness::SceneConfig sceneSize(int width, int height) {
+        harness::SceneConfig config;
+        config.width = width;
+        config.height = height;
+        return config;
+    }
+
+    FlowField m_flow;  // Outlives the harness, which cleans it up
+    Harness m_harness;
+};
+
+class DisSolver : public Solver {
+public:
+    DisSolver(const Candidate& c, int width, int height)
+        : m_dis(cv::DISOpticalFlow::create(c.preset)), m_width(width), m_height(height) {
+        // The processing size FlowField would use
+        float s = std::clamp(c.scale, 0.1f, 1.0f);
+        m_size = s < 0.99f ? cv::Size(std::max(16, static_cast<int>(width * s)),
+                                      std::max(16, static_cast<int>(height * s)))
+                           : cv::Size(width, height);
+    }
+
+    void cook(const uint8_t* bgra) override {
+        cv::Mat frame(m_height, m_width, CV_8UC4, const_cast<uint8_t*>(bgra));
+        cv::cvtColor(frame, m_gray, cv::COLOR_BGRA2GRAY);
+        if (m_size != m_gray.size()) {
+            cv::resize(m_gray, m_next, m_size, 0.0, 0.0, cv::INTER_AREA);
+        } else {
+            m_gray.copyTo(m_next);
+        }
+        if (!m_prev.empty()) {
+            m_dis->calc(m_prev, m_next, m_flow);
+        }
+        std::swap(m_prev, m_next);
+    }
+
+    FlowFieldView field() const override {
+        FlowFieldView view;
+        if (m_flow.empty()) {
+            return view;
+        }
+        view.data = m_flow.ptr<float>();
+        view.width = m_flow.cols;
+        view.height = m_flow.rows;
+        view.stride = m_flow.step / sizeof(float);
+        view.toInputX = static_cast<float>(m_width) / m_flow.cols;
+        view.toInputY = static_cast<float>(m_height) / m_flow.rows;
+        return view;
+    }
+
+private:
+    cv::Ptr<cv::DISOpticalFlow> m_dis;
+    int m_width;
+    int m_height;
+    cv::Size m_size;
+    cv::Mat m_gray, m_prev, m_next, m_flow;
+};
+
+struct MotionType {
+    const char* name;
+    FlowMotion motion;
+};
+
+const MotionType kMotions[] = {
+    {"translate", FlowMotion::Translate},
+    {"rotate", FlowMotion::Rotate},
+    {"warp", FlowMotion::Warp},
+};
+
+struct Options {
+    int frames = 20;
+    int warmup = 3;
+    int width = 1280;
+    int height = 720;
+    float speed = 4.0f;
+    std::vector<std::string> motions = {"translate", "rotate", "warp"};
+    std::string filter;
+    std::string out;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool contains(const std::vector<std::string>& list, const char* name) {
+    return std::find(list.begin(), list.end(), name) != list.end();
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return false;
+        }
+        if (arg == "--frames") {
+            options.frames = std::max(1, std::atoi(value));
+        } else if (arg == "--warmup") {
+            options.warmup = std::max(0, std::atoi(value));
+        } else if (arg == "--size") {
+            if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2 ||
+                options.width < 64 || options.height < 64) {
+                std::fprintf(stderr, "--size expects WxH (at least 64x64), got %s\n", value);
+                return false;
+            }
+        } else if (arg == "--speed") {
+            options.speed = static_cast<float>(std::atof(value));
+        } else if (arg == "--motions") {
+            options.motions = splitList(value);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--out") {
+            options.out = value;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+struct MotionResult {
+    std::string motion;
+    harness::FlowError error;  // Averaged over the timed frames
+    double meanMs = 0.0;
+};
+
+struct Result {
+    Candidate candidate;
+    std::vector<MotionResult> motions;
+    harness::FrameTimeStats times;  // Every timed frame of every motion
+    double epe = 0.0;               // Mean over motions
+    double outliers = 0.0;
+    bool pareto = false;
+};
+
+// Cook the sequence's frames; the first `warmup` (at least one, which has
+// nothing to solve against) are untimed
+MotionResult runMotion(Solver& solver, const FlowSequence& sequence,
+                       const std::vector<std::vector<uint8_t>>& frames, int warmup,
+                       std::vector<double>& seconds) {
+    MotionResult result;
+    double totalSeconds = 0.0;
+    int measured = 0;
+    for (int i = 0; i < static_cast<int>(frames.size()); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        solver.cook(frames[i].data());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i < warmup) {
+            continue;
+        }
+        seconds.push_back(elapsed.count());
+        totalSeconds += elapsed.count();
+        harness::FlowError error = harness::endpointError(solver.field(), sequence, i - 1);
+        result.error.mean += error.mean;
+        result.error.outliers += error.outliers;
+        result.error.samples += error.samples;
+        measured++;
+    }
+    if (measured > 0) {
+        result.error.mean /= measured;
+        result.error.outliers /= measured;
+        result.meanMs = totalSeconds * 1000.0 / measured;
+    }
+    return result;
+}
+
+// Mean error of reporting zero flow, sampled on a 4 px grid inside the margin
+double zeroFlowError(const FlowSequence& sequence, int frames) {
+    const FlowSequenceConfig& config = sequence.config();
+    const float margin = sequence.margin();
+    double sum = 0.0;
+    int samples = 0;
+    for (int t = 0; t + 1 < frames; ++t) {
+        for (float y = margin; y <= config.height - 1 - margin; y += 4.0f) {
+            for (float x = margin; x <= config.width - 1 - margin; x += 4.0f) {
+                harness::FlowVector truth = sequence.flow(x, y, t);
+                sum += std::sqrt(truth.dx * truth.dx + truth.dy * truth.dy);
+                samples++;
+            }
+        }
+    }
+    return samples > 0 ? sum / samples : 0.0;
+}
+
+// Keep the results no other result beats on both time and error
+void markPareto(std::vector<Result>& results) {
+    std::vector<Result*> order;
+    for (Result& r : results) {
+        order.push_back(&r);
+    }
+    std::sort(order.begin(), order.end(), [](const Result* a, const Result* b) {
+        return a->times.meanMs != b->times.meanMs ? a->times.meanMs < b->times.meanMs
+                                                  : a->epe < b->epe;
+    });
+    double best = 1e30;
+    for (Result* r : order) {
+        if (r->epe < best) {
+            r->pareto = true;
+            best = r->epe;
+        }
+    }
+}
+
+// The Pareto front, fastest first
+std::vector<const Result*> paretoFront(const std::vector<Result>& results) {
+    std::vector<const Result*> front;
+    for (const Result& r : results) {
+        if (r.pareto) {
+            front.push_back(&r);
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const Result* a, const Result* b) {
+        return a->times.meanMs < b->times.meanMs;
+    });
+    return front;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string caseName(const Candidate& c) {
+    return c.algorithm + "/" + c.config;
+}
+
+void writeJson(FILE* out, const Options& options,
+               const std::vector<std::pair<std::string, double>>& zeroFlow,
+               const std::vector<Result>& results) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"vivid-opencv optical flow accuracy\",\n");
+    std::fprintf(out, "  \"opencv\": %s,\n", jsonString(cv::getVersionString()).c_str());
+    std::fprintf(out, "  \"threads\": %d,\n", cv::getNumThreads());
+    std::fprintf(out, "  \"kernels\": %s,\n", jsonString(cpuDispatch().kernels).c_str());
+    std::fprintf(out, "  \"hal\": %s,\n", jsonString(cpuDispatch().hal).c_str());
+    std::fprintf(out, "  \"width\": %d, \"height\": %d,\n", options.width, options.height);
+    std::fprintf(out, "  \"speed\": %.2f,\n", options.speed);
+    std::fprintf(out, "  \"frames\": %d,\n", options.frames);
+    std::fprintf(out, "  \"warmup\": %d,\n", options.warmup);
+    std::fprintf(out, "  \"motions\": [");
+    for (size_t i = 0; i < zeroFlow.size(); ++i) {
+        std::fprintf(out, "%s\n    {\"motion\": %s, \"zeroFlowEpe\": %.4f}", i == 0 ? "" : ",",
+                     jsonString(zeroFlow[i].first).c_str(), zeroFlow[i].second);
+    }
+    std::fprintf(out, "\n  ],\n");
+    std::fprintf(out, "  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const Candidate& c = r.candidate;
+        std::fprintf(out, "%s\n    {", i == 0 ? "" : ",");
+        std::fprintf(out, "\"algorithm\": %s, ", jsonString(c.algorithm).c_str());
+        std::fprintf(out, "\"config\": %s, ", jsonString(c.config).c_str());
+        std::fprintf(out, "\"scale\": %.2f, ", c.scale);
+        if (c.algorithm == "dis") {
+            std::fprintf(out, "\"preset\": %d, ", c.preset);
+        } else {
+            std::fprintf(out, "\"levels\": %d, \"winSize\": %d, \"iterations\": %d, ",
+                         c.levels, c.winSize, c.iterations);
+        }
+        std::fprintf(out, "\"default\": %s, ", c.isDefault ? "true" : "false");
+        std::fprintf(out, "\"meanMs\": %.3f, ", r.times.meanMs);
+        std::fprintf(out, "\"p50Ms\": %.3f, ", r.times.p50Ms);
+        std::fprintf(out, "\"p99Ms\": %.3f, ", r.times.p99Ms);
+        std::fprintf(out, "\"epe\": %.4f, ", r.epe);
+        std::fprintf(out, "\"outliers\": %.4f, ", r.outliers);
+        std::fprintf(out, "\"byMotion\": {");
+        for (size_t m = 0; m < r.motions.size(); ++m) {
+            const MotionResult& motion = r.motions[m];
+            std::fprintf(out, "%s%s: {\"epe\": %.4f, \"outliers\": %.4f, \"meanMs\": %.3f}",
+                         m == 0 ? "" : ", ", jsonString(motion.motion).c_str(),
+                         motion.error.mean, motion.error.outliers, motion.meanMs);
+        }
+        std::fprintf(out, "}, ");
+        std::fprintf(out, "\"pareto\": %s}", r.pareto ? "true" : "false");
+    }
+    std::fprintf(out, "\n  ],\n");
+
+    std::vector<const Result*> front = paretoFront(results);
+    std::fprintf(out, "  \"pareto\": [");
+    for (size_t i = 0; i < front.size(); ++i) {
+        std::fprintf(out, "%s%s", i == 0 ? "" : ", ", jsonString(caseName(front[i]->candidate)).c_str());
+    }
+    std::fprintf(out, "]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    // Every solver, DIS included, runs on the module's pool
+    threadPoolConfig();
+
+    std::vector<Candidate> selected;
+    for (const Candidate& c : candidates()) {
+        if (options.filter.empty() || caseName(c).find(options.filter) != std::string::npos) {
+            selected.push_back(c);
+        }
+    }
+
+    std::vector<Result> results(selected.size());
+    std::vector<std::vector<double>> seconds(selected.size());
+    std::vector<std::pair<std::string, double>> zeroFlow;
+    const int warmup = std::max(1, options.warmup);
+    for (const MotionType& type : kMotions) {
+        if (!contains(options.motions, type.name)) {
+            continue;
+        }
+        FlowSequenceConfig config;
+        config.width = options.width;
+        config.height = options.height;
+        config.motion = type.motion;
+        config.speed = options.speed;
+        FlowSequence sequence(config);
+
+        // Rendered once; every candidate cooks the same frames
+        std::vector<std::vector<uint8_t>> frames;
+        for (int t = 0; t < warmup + options.frames; ++t) {
+            frames.push_back(sequence.render(t));
+        }
+        zeroFlow.emplace_back(type.name, zeroFlowError(sequence, static_cast<int>(frames.size())));
+
+        for (size_t i = 0; i < selected.size(); ++i) {
+            const Candidate& c = selected[i];
+            std::fprintf(stderr, "%s %s\n", caseName(c).c_str(), type.name);
+            std::unique_ptr<Solver> solver;
+            if (c.algorithm == "dis") {
+                solver = std::make_unique<DisSolver>(c, options.width, options.height);
+            } else {
+                solver = std::make_unique<FarnebackSolver>(c, options.width, options.height);
+            }
+            MotionResult motion = runMotion(*solver, sequence, frames, warmup, seconds[i]);
+            motion.motion = type.name;
+            results[i].motions.push_back(motion);
+        }
+    }
+    if (zeroFlow.empty()) {
+        std::fprintf(stderr, "no motions selected\n");
+        return 2;
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result& r = results[i];
+        r.candidate = selected[i];
+        r.times = harness::summarize(std::move(seconds[i]));
+        for (const MotionResult& motion : r.motions) {
+            r.epe += motion.error.mean / r.motions.size();
+            r.outliers += motion.error.outliers / r.motions.size();
+        }
+    }
+    markPareto(results);
+
+    FILE* out = stdout;
+    if (!options.out.empty()) {
+        out = std::fopen(options.out.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "can't write %s\n", options.out.c_str());
+            return 2;
+        }
+    }
+    writeJson(out, options, zeroFlow, results);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    std::fprintf(stderr, "\nPareto front (time per frame vs endpoint error):\n");
+    for (const Result* r : paretoFront(results)) {
+        std::fprintf(stderr, "  %-28s %8.3f ms  EPE %.3f px%s\n", caseName(r->candidate).c_str(),
+                     r->times.meanMs, r->epe, r->candidate.isDefault ? "  (default)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file bench_operators.cpp
+ * @brief End-to-end benchmark of Contours, OpticalFlow and BlobTrack
+ *
+ * Cooks every operator preset on synthetic scenes at 720p, 1080p and 4K, and
+ * optionally on decoded video frames (see harness/raw_frames.h), then writes
+ * one JSON document with fps, ns/pixel, p50/p99 frame time and peak RSS per
+ * case. Keys and case order are fixed so results diff cleanly between builds.
+ *
+ * Usage:
+ *   bench_operators [--frames N] [--warmup N] [--resolutions 720p,1080p,4k]
+ *                   [--scenes discs,shapes,noise] [--filter TEXT]
+ *                   [--raw FILE [--raw-size WxH]] [--out FILE] [--fail-on-alloc]
+ *
+ * --raw-size is only needed for headerless dumps; RawFrameRecorder files
+ * store their frame size.
+ *
+ * Operators cook inline (async = 0), so frame time is the full cook cost.
+ * Each case also reports how many timed frames allocated (allocStats()), and
+ * the cases that did are listed on stderr; with --fail-on-alloc the run exits
+ * with status 1 if any did.
+ */
+
+#include "harness/harness.h"
+#include "harness/process_stats.h"
+#include "harness/raw_frames.h"
+#include <vivid/opencv/blob_track.h>
+#include <vivid/opencv/contours.h>
+#include <vivid/opencv/cpu_dispatch.h>
+#include <vivid/opencv/optical_flow.h>
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vivid::opencv;
+using harness::Harness;
+using harness::SceneConfig;
+using harness::SceneKind;
+
+namespace {
+
+struct Preset {
+    const char* op;
+    const char* name;
+    std::function<std::unique_ptr<vivid::Operator>()> make;
+    std::function<AllocStats(const vivid::Operator&)> allocs;
+};
+
+template <typename Op, typename Configure>
+Preset preset(const char* op, const char* name, Configure configure) {
+    return {op, name,
+        [configure] {
+            auto instance = std::make_unique<Op>();
+            configure(*instance);
+            return std::unique_ptr<vivid::Operator>(std::move(instance));
+        },
+        [](const vivid::Operator& instance) {
+            return static_cast<const Op&>(instance).allocStats();
+        }};
+}
+
+std::vector<Preset> presets() {
+    return {
+        preset<Contours>("contours", "default", [](Contours&) {}),
+        preset<Contours>("contours", "tree", [](Contours& c) { c.mode = 3; }),
+        preset<OpticalFlow>("optical_flow", "default", [](OpticalFlow&) {}),
+        preset<OpticalFlow>("optical_flow", "quality", [](OpticalFlow& f) {
+            f.scale = 0.5f;
+            f.levels = 3;
+            f.winSize = 15;
+            f.iterations = 3;
+        }),
+        preset<BlobTrack>("blob_track", "luma", [](BlobTrack& b) { b.detectDark = 0; }),
+        preset<BlobTrack>("blob_track", "sliced", [](BlobTrack& b) {
+            b.detectDark = 0;
+            b.sliceCount = 4;
+        }),
+        preset<BlobTrack>("blob_track", "foreground", [](BlobTrack& b) { b.detectMode = 2; }),
+    };
+}
+
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+const Resolution kResolutions[] = {
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4k", 3840, 2160},
+};
+
+struct SceneType {
+    const char* name;
+    SceneKind kind;
+};
+
+const SceneType kScenes[] = {
+    {"discs", SceneKind::Discs},
+    {"shapes", SceneKind::Shapes},
+    {"noise", SceneKind::Noise},
+};
+
+struct Options {
+    int frames = 120;
+    int warmup = 10;
+    std::vector<std::string> resolutions = {"720p", "1080p", "4k"};
+    std::vector<std::string> scenes = {"discs", "shapes", "noise"};
+    std::string filter;
+    std::string rawPath;
+    int rawWidth = 0;
+    int rawHeight = 0;
+    std::string out;
+    bool failOnAlloc = false;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool contains(const std::vector<std::string>& list, const char* name) {
+    for (const std::string& item : list) {
+        if (item == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fail-on-alloc") {
+            options.failOnAlloc = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return false;
+        }
+        if (arg == "--frames") {
+            options.frames = std::max(1, std::atoi(value));
+        } else if (arg == "--warmup") {
+            options.warmup = std::max(0, std::atoi(value));
+        } else if (arg == "--resolutions") {
+            options.resolutions = splitList(value);
+        } else if (arg == "--scenes") {
+            options.scenes = splitList(value);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--raw") {
+            options.rawPath = value;
+        } else if (arg == "--raw-size") {
+            if (std::sscanf(value, "%dx%d", &options.rawWidth, &options.rawHeight) != 2) {
+                std::fprintf(stderr, "--raw-size expects WxH, got %s\n", value);
+                return false;
+            }
+        } else if (arg == "--out") {
+            options.out = value;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+struct Result {
+    std::string op;
+    std::string preset;
+    std::string scene;
+    int width = 0;
+    int height = 0;
+    harness::FrameTimeStats times;
+    size_t peakRss = 0;
+    int allocatingFrames = 0;   // Timed frames that allocated
+    uint64_t allocs = 0;        // Allocations over the timed frames
+    uint64_t allocBytes = 0;
+    bool allocsCounted = false; // False when built with VIVID_OPENCV_PROFILING=OFF
+};
+
+// Cook `frames` timed frames after `warmup` untimed ones; `feed` loads frame i
+Result runCase(const Preset& preset, const Options& options, const SceneConfig& config,
+               const std::function<void(Harness&, int)>& feed) {
+    harness::resetPeakRss();
+
+    Harness h(config);
+    std::unique_ptr<vivid::Operator> op = preset.make();
+    h.attach(*op);
+
+    Result result;
+    std::vector<double> seconds;
+    seconds.reserve(options.frames);
+    for (int i = 0; i < options.warmup + options.frames; ++i) {
+        feed(h, i);
+        auto start = std::chrono::steady_clock::now();
+        h.cook();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i >= options.warmup) {
+            seconds.push_back(elapsed.count());
+            AllocStats allocs = preset.allocs(*op);
+            result.allocatingFrames += allocs.lastCount > 0 ? 1 : 0;
+            result.allocs += allocs.lastCount;
+            result.allocBytes += allocs.lastBytes;
+            result.allocsCounted = allocs.cooks > 0;
+        }
+    }
+
+    result.op = preset.op;
+    result.preset = preset.name;
+    result.width = config.width;
+    result.height = config.height;
+    result.times = harness::summarize(std::move(seconds));
+    result.peakRss = harness::peakRssBytes();
+    return result;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void writeJson(FILE* out, const Options& options, const std::vector<Result>& results) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"vivid-opencv operators\",\n");
+    std::fprintf(out, "  \"opencv\": %s,\n", jsonString(cv::getVersionString()).c_str());
+    std::fprintf(out, "  \"threads\": %d,\n", cv::getNumThreads());
+    std::fprintf(out, "  \"kernels\": %s,\n", jsonString(cpuDispatch().kernels).c_str());
+    std::fprintf(out, "  \"hal\": %s,\n", jsonString(cpuDispatch().hal).c_str());
+    std::fprintf(out, "  \"frames\": %d,\n", options.frames);
+    std::fprintf(out, "  \"warmup\": %d,\n", options.warmup);
+    std::fprintf(out, "  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double pixels = static_cast<double>(r.width) * r.height;
+        double fps = r.times.totalSeconds > 0.0 ? r.times.frames / r.times.totalSeconds : 0.0;
+        std::fprintf(out, "%s\n    {", i == 0 ? "" : ",");
+        std::fprintf(out, "\"operator\": %s, ", jsonString(r.op).c_str());
+        std::fprintf(out, "\"preset\": %s, ", jsonString(r.preset).c_str());
+        std::fprintf(out, "\"scene\": %s, ", jsonString(r.scene).c_str());
+        std::fprintf(out, "\"width\": %d, \"height\": %d, ", r.width, r.height);
+        std::fprintf(out, "\"fps\": %.2f, ", fps);
+        std::fprintf(out, "\"nsPerPixel\": %.3f, ", r.times.meanMs * 1e6 / pixels);
+        std::fprintf(out, "\"meanMs\": %.3f, ", r.times.meanMs);
+        std::fprintf(out, "\"p50Ms\": %.3f, ", r.times.p50Ms);
+        std::fprintf(out, "\"p99Ms\": %.3f, ", r.times.p99Ms);
+        std::fprintf(out, "\"maxMs\": %.3f, ", r.times.maxMs);
+        std::fprintf(out, "\"allocatingFrames\": %d, ", r.allocatingFrames);
+        std::fprintf(out, "\"allocsPerFrame\": %.2f, ", static_cast<double>(r.allocs) / r.times.frames);
+        std::fprintf(out, "\"allocBytesPerFrame\": %.0f, ",
+                     static_cast<double>(r.allocBytes) / r.times.frames);
+        std::fprintf(out, "\"peakRssBytes\": %zu}", r.peakRss);
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    harness::RawFrames raw;
+    if (!options.rawPath.empty()) {
+        // Keep the working set bounded; the clip loops if it is shorter than the run
+        if (!raw.load(options.rawPath, options.rawWidth, options.rawHeight, 64)) {
+            std::fprintf(stderr, "can't read BGRA frames from %s (headerless dumps need --raw-size WxH)\n",
+                         options.rawPath.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const Preset& preset : presets()) {
+        std::string caseName = std::string(preset.op) + "/" + preset.name;
+        if (!options.filter.empty() && caseName.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        for (const Resolution& resolution : kResolutions) {
+            if (!contains(options.resolutions, resolution.name)) {
+                continue;
+            }
+            for (const SceneType& scene : kScenes) {
+                if (!contains(options.scenes, scene.name)) {
+                    continue;
+                }
+                SceneConfig config;
+                config.width = resolution.width;
+                config.height = resolution.height;
+                config.kind = scene.kind;
+                config.discs = 12;
+                config.radius = 24.0f * resolution.height / 720.0f;
+
+                std::fprintf(stderr, "%s %s %s\n", caseName.c_str(), scene.name, resolution.name);
+                Result result = runCase(preset, options, config, [](Harness& h, int i) {
+                    const std::vector<uint8_t>& pixels = h.scene().render(i);
+                    h.source().setFrameView(pixels.data(), h.scene().config().width,
+                                            h.scene().config().height);
+                });
+                result.scene = scene.name;
+                results.push_back(std::move(result));
+            }
+        }
+
+        if (raw.count() > 0) {
+            SceneConfig config;
+            config.width = raw.width();
+            config.height = raw.height();
+
+            std::fprintf(stderr, "%s %s\n", caseName.c_str(), options.rawPath.c_str());
+            Result result = runCase(preset, options, config, [&raw](Harness& h, int i) {
+                h.source().setFrameView(raw.frame(i), raw.width(), raw.height());
+            });
+            std::string stem = options.rawPath.substr(options.rawPath.find_last_of("/\\") + 1);
+            result.scene = "raw:" + stem;
+            results.push_back(std::move(result));
+        }
+    }
+
+    FILE* out = stdout;
+    if (!options.out.empty()) {
+        out = std::fopen(options.out.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "can't write %s\n", options.out.c_str());
+            return 2;
+        }
+    }
+    writeJson(out, options, results);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    int status = 0;
+    for (const Result& r : results) {
+        if (!r.allocsCounted) {
+            if (options.failOnAlloc) {
+                std::fprintf(stderr, "allocation counting is compiled out (VIVID_OPENCV_PROFILING=OFF)\n");
+                return 2;
+            }
+            continue;
+        }
+        if (r.allocatingFrames > 0) {
+            std::fprintf(stderr, "%s/%s %s %dx%d: %d of %d steady-state frames allocated (%.1f per frame)\n",
+                         r.op.c_str(), r.preset.c_str(), r.scene.c_str(), r.width, r.height,
+                         r.allocatingFrames, r.times.frames,
+                         static_cast<double>(r.allocs) / r.times.frames);
+            if (options.failOnAlloc) {
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
@@ -0,0 +1,35 @@
+# Fails if a SIMD variant object defines an external symbol outside its own
+# namespace. The linker keeps one copy of each such symbol for the whole
+# library, so a wide copy of a shared inline (an OpenCV intrinsic,
+# std::max, ...) could end up called from baseline code. See
+# vivid_opencv_simd_variants in the top-level CMakeLists.txt.
+#
+#   cmake -DNM=<nm> -DNAMESPACE=opt_AVX2 "-DOBJECTS=<a.o;b.o>" -P check_variant_symbols.cmake
+
+if(NOT NM OR NOT NAMESPACE OR NOT OBJECTS)
+    message(FATAL_ERROR "usage: cmake -DNM=<nm> -DNAMESPACE=<ns> -DOBJECTS=<objects> -P ${CMAKE_CURRENT_LIST_FILE}")
+endif()
+
+set(leaked 0)
+foreach(object ${OBJECTS})
+    execute_process(
+        COMMAND ${NM} -g -C --defined-only ${object}
+        OUTPUT_VARIABLE symbols
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NM} failed on ${object}")
+    endif()
+
+    string(REPLACE "\n" ";" lines "${symbols}")
+    foreach(line IN LISTS lines)
+        if(line STREQUAL "" OR line MATCHES "::${NAMESPACE}::")
+            continue()
+        endif()
+        message(SEND_ERROR "${object}: ${line}")
+        math(EXPR leaked "${leaked} + 1")
+    endforeach()
+endforeach()
+
+if(leaked GREATER 0)
+    message(FATAL_ERROR "${leaked} symbol(s) outside ${NAMESPACE}")
+endif()
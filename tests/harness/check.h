@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @file check.h
+ * @brief Minimal assertion macros for the harness tests
+ */
+
+#include <cstdio>
+
+namespace vivid::opencv::harness {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+} // namespace vivid::opencv::harness
+
+/// Record a failure (and keep going) when `cond` is false
+#define HARNESS_CHECK(cond)                                                        \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ::vivid::opencv::harness::failures()++;                                \
+        }                                                                          \
+    } while (0)
@@ -0,0 +1,213 @@
+/**
+ * @file flow_sequence.cpp
+ * @brief Moving-texture sequences with exact ground-truth flow (test harness)
+ */
+
+#include "flow_sequence.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv::harness {
+
+namespace {
+
+constexpr float kTwoPi = 6.28318530718f;
+constexpr int kTextureSize = 512;  // Power of two, so wrapping is a mask
+
+float smoothstep(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+} // namespace
+
+FlowSequence::FlowSequence(const FlowSequenceConfig& config) : m_config(config) {
+    // Periodic value noise, octaves from 64 down to 4 texels: flow has
+    // structure to lock onto at every processing scale
+    cv::RNG rng(m_config.seed);
+    m_texture.assign(static_cast<size_t>(kTextureSize) * kTextureSize, 0.0f);
+    float weight = 1.0f;
+    for (int cell = 64; cell >= 4; cell /= 2, weight *= 0.7f) {
+        int lattice = kTextureSize / cell;
+        std::vector<float> values(static_cast<size_t>(lattice) * lattice);
+        for (float& value : values) {
+            value = rng.uniform(0.0f, 1.0f);
+        }
+        for (int y = 0; y < kTextureSize; ++y) {
+            int y0 = y / cell;
+            int y1 = (y0 + 1) % lattice;
+            float fy = smoothstep(static_cast<float>(y % cell) / cell);
+            for (int x = 0; x < kTextureSize; ++x) {
+                int x0 = x / cell;
+                int x1 = (x0 + 1) % lattice;
+                float fx = smoothstep(static_cast<float>(x % cell) / cell);
+                float top = values[y0 * lattice + x0] * (1.0f - fx) + values[y0 * lattice + x1] * fx;
+                float bottom = values[y1 * lattice + x0] * (1.0f - fx) + values[y1 * lattice + x1] * fx;
+                m_texture[y * kTextureSize + x] += weight * (top * (1.0f - fy) + bottom * fy);
+            }
+        }
+    }
+    auto [lo, hi] = std::minmax_element(m_texture.begin(), m_texture.end());
+    float low = *lo;
+    float gain = 215.0f / std::max(1e-6f, *hi - low);
+    for (float& value : m_texture) {
+        value = 20.0f + (value - low) * gain;
+    }
+
+    // Motion parameters from `speed`, along a diagonal that isn't axis aligned
+    float half = 0.5f * std::min(m_config.width, m_config.height);
+    float drift = m_config.motion == FlowMotion::Warp ? 0.5f * m_config.speed : m_config.speed;
+    m_driftX = drift * std::cos(0.35f);
+    m_driftY = drift * std::sin(0.35f);
+    m_omega = m_config.speed / std::max(1.0f, half);
+    // Wave slope 0.35 keeps the warp invertible; its peak motion is speed / 2
+    m_waveLength = std::max(8.0f, half);
+    m_waveAmplitude = 0.35f * m_waveLength / kTwoPi;
+    m_wavePhase = 0.5f * m_config.speed / m_waveAmplitude;
+
+    m_pixels.resize(static_cast<size_t>(m_config.width) * m_config.height * 4);
+}
+
+float FlowSequence::sample(float u, float v) const {
+    constexpr float size = static_cast<float>(kTextureSize);
+    constexpr int mask = kTextureSize - 1;
+    u -= std::floor(u / size) * size;
+    v -= std::floor(v / size) * size;
+    int x0 = static_cast<int>(u);
+    int y0 = static_cast<int>(v);
+    float fx = u - x0;
+    float fy = v - y0;
+    x0 &= mask;
+    y0 &= mask;
+    int x1 = (x0 + 1) & mask;
+    int y1 = (y0 + 1) & mask;
+    const float* top = &m_texture[y0 * kTextureSize];
+    const float* bottom = &m_texture[y1 * kTextureSize];
+    return (top[x0] * (1.0f - fx) + top[x1] * fx) * (1.0f - fy) +
+           (bottom[x0] * (1.0f - fx) + bottom[x1] * fx) * fy;
+}
+
+void FlowSequence::waveAt(float x, float y, int t, float& wx, float& wy) const {
+    float k = kTwoPi / m_waveLength;
+    float phase = m_wavePhase * t;
+    wx = m_waveAmplitude * std::sin(k * y + phase);
+    wy = m_waveAmplitude * std::sin(k * x + phase + 1.3f);
+}
+
+void FlowSequence::toTexture(float x, float y, int t, float& u, float& v) const {
+    switch (m_config.motion) {
+    case FlowMotion::Translate:
+        u = x - t * m_driftX;
+        v = y - t * m_driftY;
+        break;
+    case FlowMotion::Rotate: {
+        float cx = 0.5f * (m_config.width - 1);
+        float cy = 0.5f * (m_config.height - 1);
+        float c = std::cos(-m_omega * t);
+        float s = std::sin(-m_omega * t);
+        u = cx + c * (x - cx) - s * (y - cy);
+        v = cy + s * (x - cx) + c * (y - cy);
+        break;
+    }
+    case FlowMotion::Warp: {
+        float wx, wy;
+        waveAt(x, y, t, wx, wy);
+        u = x - t * m_driftX - wx;
+        v = y - t * m_driftY - wy;
+        break;
+    }
+    }
+}
+
+float FlowSequence::intensity(float x, float y, int t) const {
+    float u, v;
+    toTexture(x, y, t, u, v);
+    return sample(u, v);
+}
+
+FlowVector FlowSequence::flow(float x, float y, int t) const {
+    switch (m_config.motion) {
+    case FlowMotion::Translate:
+        return {m_driftX, m_driftY};
+    case FlowMotion::Rotate: {
+        float rx = x - 0.5f * (m_config.width - 1);
+        float ry = y - 0.5f * (m_config.height - 1);
+        float c = std::cos(m_omega);
+        float s = std::sin(m_omega);
+        return {c * rx - s * ry - rx, s * rx + c * ry - ry};
+    }
+    case FlowMotion::Warp: {
+        // Solve toTexture(p, t + 1) == toTexture(x, y, t) for p; the wave
+        // slope (0.35) makes this a contraction
+        float wx0, wy0;
+        waveAt(x, y, t, wx0, wy0);
+        float px = x + m_driftX;
+        float py = y + m_driftY;
+        for (int i = 0; i < 32; ++i) {
+            float wx1, wy1;
+            waveAt(px, py, t + 1, wx1, wy1);
+            px = x + m_driftX + wx1 - wx0;
+            py = y + m_driftY + wy1 - wy0;
+        }
+        return {px - x, py - y};
+    }
+    }
+    return {};
+}
+
+float FlowSequence::margin() const {
+    return 0.05f * std::min(m_config.width, m_config.height) + 2.0f * m_config.speed;
+}
+
+const std::vector<uint8_t>& FlowSequence::render(int t) {
+    uint8_t* out = m_pixels.data();
+    for (int y = 0; y < m_config.height; ++y) {
+        for (int x = 0; x < m_config.width; ++x, out += 4) {
+            uint8_t gray = static_cast<uint8_t>(intensity(static_cast<float>(x), static_cast<float>(y), t) + 0.5f);
+            out[0] = gray;
+            out[1] = gray;
+            out[2] = gray;
+            out[3] = 255;
+        }
+    }
+    return m_pixels;
+}
+
+FlowError endpointError(const FlowFieldView& field, const FlowSequence& sequence, int t) {
+    FlowError error;
+    if (!field.valid()) {
+        return error;
+    }
+    const float margin = sequence.margin();
+    const float right = sequence.config().width - 1 - margin;
+    const float bottom = sequence.config().height - 1 - margin;
+    double sum = 0.0;
+    int outliers = 0;
+    for (int fy = 0; fy < field.height; ++fy) {
+        float y = (fy + 0.5f) * field.toInputY - 0.5f;
+        if (y < margin || y > bottom) {
+            continue;
+        }
+        for (int fx = 0; fx < field.width; ++fx) {
+            float x = (fx + 0.5f) * field.toInputX - 0.5f;
+            if (x < margin || x > right) {
+                continue;
+            }
+            FlowVector truth = sequence.flow(x, y, t);
+            float ex = field.dx(fx, fy) * field.toInputX - truth.dx;
+            float ey = field.dy(fx, fy) * field.toInputY - truth.dy;
+            double endpoint = std::sqrt(ex * ex + ey * ey);
+            double length = std::sqrt(truth.dx * truth.dx + truth.dy * truth.dy);
+            sum += endpoint;
+            outliers += endpoint > 3.0 && endpoint > 0.05 * length ? 1 : 0;
+            error.samples++;
+        }
+    }
+    if (error.samples > 0) {
+        error.mean = sum / error.samples;
+        error.outliers = static_cast<double>(outliers) / error.samples;
+    }
+    return error;
+}
+
+} // namespace vivid::opencv::harness
@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file flow_sequence.h
+ * @brief Moving-texture sequences with exact ground-truth flow (test harness)
+ *
+ * Every frame samples one endless, tileable noise texture through a
+ * per-frame mapping, so the true displacement of each pixel from frame t to
+ * t+1 is known analytically at any (sub-pixel) position. Used to measure
+ * optical flow endpoint error (see bench_flow.cpp).
+ */
+
+#include <vivid/opencv/flow_field.h>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+/**
+ * @brief How the texture moves between frames
+ */
+enum class FlowMotion {
+    Translate,  ///< Constant diagonal translation
+    Rotate,     ///< Rotation about the frame center
+    Warp        ///< Drift plus travelling shear waves (non-rigid)
+};
+
+/**
+ * @brief Sequence layout
+ */
+struct FlowSequenceConfig {
+    int width = 1280;
+    int height = 720;
+    FlowMotion motion = FlowMotion::Translate;
+    float speed = 4.0f;   ///< Typical motion in pixels per frame (see FlowSequence)
+    uint32_t seed = 1;    ///< Texture seed
+};
+
+/// Displacement in pixels
+struct FlowVector {
+    float dx = 0.0f;
+    float dy = 0.0f;
+};
+
+/**
+ * @brief Renders BGRA frames of a moving texture; frame t depends only on t
+ *
+ * `speed` is the translation per frame for Translate, the motion at half the
+ * shorter side from the center for Rotate (corners move faster), and the
+ * drift plus the peak wave motion for Warp.
+ */
+class FlowSequence {
+public:
+    explicit FlowSequence(const FlowSequenceConfig& config = {});
+
+    /// Render frame `t` (tightly packed gray BGRA, valid until the next render)
+    const std::vector<uint8_t>& render(int t);
+
+    /// Intensity (0-255) of frame `t` at a sub-pixel position
+    float intensity(float x, float y, int t) const;
+
+    /**
+     * @brief True motion from frame `t` to `t + 1` of the point at (x, y) in frame t
+     *
+     * The same convention as cv::calcOpticalFlowFarneback:
+     * frame t at (x, y) matches frame t+1 at (x + dx, y + dy).
+     */
+    FlowVector flow(float x, float y, int t) const;
+
+    /// Border in pixels left out of error measurements (points leave the frame there)
+    float margin() const;
+
+    const FlowSequenceConfig& config() const { return m_config; }
+
+private:
+    // Frame t at (x, y) shows the texture at (u, v)
+    void toTexture(float x, float y, int t, float& u, float& v) const;
+
+    // Warp's displacement of frame t at (x, y)
+    void waveAt(float x, float y, int t, float& wx, float& wy) const;
+
+    float sample(float u, float v) const;
+
+    FlowSequenceConfig m_config;
+    std::vector<float> m_texture;  // kTextureSize^2, wraps in both directions
+    std::vector<uint8_t> m_pixels;
+    float m_driftX = 0.0f;         // Translate / Warp drift per frame
+    float m_driftY = 0.0f;
+    float m_omega = 0.0f;          // Rotate: radians per frame
+    float m_waveLength = 1.0f;     // Warp
+    float m_waveAmplitude = 0.0f;
+    float m_wavePhase = 0.0f;      // Warp: radians per frame
+};
+
+/**
+ * @brief Endpoint error of a solved flow field against the ground truth
+ */
+struct FlowError {
+    double mean = 0.0;      ///< Mean endpoint error in input pixels
+    double outliers = 0.0;  ///< Fraction off by > 3 px and > 5% of the true motion (KITTI's Fl)
+    int samples = 0;        ///< Field cells measured
+};
+
+/**
+ * @brief Compare `field`, solved from frame `t` to `t + 1` of `sequence`, to its true flow
+ *
+ * Each field cell is measured at its center in input pixels; cells within
+ * sequence.margin() of the border are skipped.
+ */
+FlowError endpointError(const FlowFieldView& field, const FlowSequence& sequence, int t);
+
+} // namespace vivid::opencv::harness
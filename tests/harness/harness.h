@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file harness.h
+ * @brief Headless cook loop for vivid-opencv operators (test harness)
+ *
+ * Wires operators to a MemorySource fed by a SyntheticScene (or any BGRA
+ * frames) and cooks them with a stub Context, without vivid, a window or a
+ * GPU.
+ *
+ * @par Example
+ * @code
+ * harness::Harness h({1920, 1080});
+ * vivid::opencv::Contours contours;
+ * h.attach(contours);
+ * for (int i = 0; i < 100; ++i) {
+ *     h.step();
+ * }
+ * @endcode
+ */
+
+#include "memory_source.h"
+#include "synthetic_scene.h"
+#include <vivid/context.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+class Harness {
+public:
+    explicit Harness(const SceneConfig& scene = {})
+        : m_ctx(scene.width, scene.height), m_scene(scene) {}
+
+    ~Harness() {
+        for (Operator* op : m_operators) {
+            op->cleanup();
+        }
+    }
+
+    Harness(const Harness&) = delete;
+    Harness& operator=(const Harness&) = delete;
+
+    /// Feed `op` from the memory source and init it. Cooked in attach order.
+    void attach(Operator& op) {
+        op.setInput(0, &m_source);
+        op.init(m_ctx);
+        m_operators.push_back(&op);
+    }
+
+    /// Attach `op` downstream of an already attached operator
+    void attach(Operator& op, Operator& upstream) {
+        op.setInput(0, &upstream);
+        op.init(m_ctx);
+        m_operators.push_back(&op);
+    }
+
+    /// Render the next scene frame into the source, then cook every operator
+    void step() {
+        const std::vector<uint8_t>& pixels = m_scene.render(m_frame);
+        m_source.setFrameView(pixels.data(), m_scene.config().width, m_scene.config().height);
+        cook();
+    }
+
+    /// Cook every operator on whatever the source currently serves
+    void cook() {
+        m_ctx.tick(1.0 / 60.0);
+        m_source.process(m_ctx);
+        for (Operator* op : m_operators) {
+            op->process(m_ctx);
+        }
+        m_frame++;
+    }
+
+    /**
+     * @brief Step until `done()` returns true
+     * @param pause Sleep between steps, so background cooks can complete
+     * @return false if `maxFrames` steps passed first
+     */
+    template <typename Done>
+    bool runUntil(Done done, int maxFrames,
+                  std::chrono::milliseconds pause = std::chrono::milliseconds(0)) {
+        for (int i = 0; i < maxFrames; ++i) {
+            step();
+            if (done()) {
+                return true;
+            }
+            if (pause.count() > 0) {
+                std::this_thread::sleep_for(pause);
+            }
+        }
+        return false;
+    }
+
+    Context& context() { return m_ctx; }
+    SyntheticScene& scene() { return m_scene; }
+    MemorySource& source() { return m_source; }
+
+    /// Frames stepped so far
+    int frame() const { return m_frame; }
+
+private:
+    Context m_ctx;
+    SyntheticScene m_scene;
+    MemorySource m_source;
+    std::vector<Operator*> m_operators;
+    int m_frame = 0;
+};
+
+} // namespace vivid::opencv::harness
@@ -0,0 +1,27 @@
+/**
+ * @file memory_source.cpp
+ * @brief CPU pixel source serving frames from memory (test harness)
+ */
+
+#include "memory_source.h"
+#include <cstring>
+
+namespace vivid::opencv::harness {
+
+void MemorySource::setFrame(const uint8_t* bgra, int width, int height) {
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    m_pixels.resize(bytes);
+    std::memcpy(m_pixels.data(), bgra, bytes);
+    m_view = {m_pixels.data(), width, height, 4, 0};
+}
+
+void MemorySource::setFrameView(const uint8_t* bgra, int width, int height, int stride) {
+    m_view = {bgra, width, height, 4, stride};
+}
+
+void MemorySource::process(Context& ctx) {
+    (void)ctx;
+    didCook();
+}
+
+} // namespace vivid::opencv::harness
@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * @file memory_source.h
+ * @brief CPU pixel source serving frames from memory (test harness)
+ */
+
+#include <vivid/effects/texture_operator.h>
+#include <cstdint>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+/**
+ * @brief Input operator whose cpuPixelView() is a caller-supplied BGRA frame
+ *
+ * Stands in for Webcam/VideoPlayer when cooking operators headless.
+ */
+class MemorySource : public vivid::effects::TextureOperator {
+public:
+    /// Copy a tightly packed BGRA frame; served until the next set call
+    void setFrame(const uint8_t* bgra, int width, int height);
+
+    /// Serve caller memory without copying; it must stay valid while cooked
+    void setFrameView(const uint8_t* bgra, int width, int height, int stride = 0);
+
+    void process(Context& ctx) override;
+    std::string name() const override { return "MemorySource"; }
+
+    OutputKind outputKind() const override { return OutputKind::CpuPixels; }
+    CpuPixelView cpuPixelView() const override { return m_view; }
+
+private:
+    std::vector<uint8_t> m_pixels;
+    CpuPixelView m_view;
+};
+
+} // namespace vivid::opencv::harness
@@ -0,0 +1,79 @@
+/**
+ * @file process_stats.cpp
+ * @brief Process memory and frame-time statistics for benchmarks (test harness)
+ */
+
+#include "process_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace vivid::opencv::harness {
+
+size_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    // VmHWM honors resets through clear_refs; ru_maxrss doesn't
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return static_cast<size_t>(std::stoull(line.substr(6))) * 1024;  // Reported in kB
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);  // Bytes on macOS
+#endif
+}
+
+bool resetPeakRss() {
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";  // Reset VmHWM to the current RSS (Linux 4.0+)
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+#else
+    return false;
+#endif
+}
+
+FrameTimeStats summarize(std::vector<double> seconds) {
+    FrameTimeStats stats;
+    if (seconds.empty()) {
+        return stats;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    auto rank = [&](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p * seconds.size()));
+        return seconds[std::min(seconds.size(), std::max<size_t>(index, 1)) - 1] * 1000.0;
+    };
+
+    stats.frames = static_cast<int>(seconds.size());
+    stats.totalSeconds = std::accumulate(seconds.begin(), seconds.end(), 0.0);
+    stats.meanMs = stats.totalSeconds * 1000.0 / seconds.size();
+    stats.p50Ms = rank(0.50);
+    stats.p99Ms = rank(0.99);
+    stats.maxMs = seconds.back() * 1000.0;
+    return stats;
+}
+
+} // namespace vivid::opencv::harness
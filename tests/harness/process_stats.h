@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file process_stats.h
+ * @brief Process memory and frame-time statistics for benchmarks (test harness)
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+/**
+ * @brief Peak resident set size of this process in bytes (0 if unknown)
+ *
+ * Since the last successful resetPeakRss(), otherwise since process start.
+ */
+size_t peakRssBytes();
+
+/**
+ * @brief Restart peak RSS tracking from the current RSS
+ * @return false where the OS can't reset it (only Linux can); the peak is
+ *         then the process-wide high-water mark
+ */
+bool resetPeakRss();
+
+/**
+ * @brief Summary of per-frame times
+ */
+struct FrameTimeStats {
+    int frames = 0;
+    double totalSeconds = 0.0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+/// Summarize frame times in seconds (nearest-rank percentiles)
+FrameTimeStats summarize(std::vector<double> seconds);
+
+} // namespace vivid::opencv::harness
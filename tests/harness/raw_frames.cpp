@@ -0,0 +1,69 @@
+/**
+ * @file raw_frames.cpp
+ * @brief Loads decoded video frames dumped as BGRA (test harness)
+ */
+
+#include "raw_frames.h"
+#include <vivid/opencv/raw_frame_format.h>
+#include <algorithm>
+#include <fstream>
+
+namespace vivid::opencv::harness {
+
+bool RawFrames::load(const std::string& path, int width, int height, int maxFrames) {
+    m_pixels.clear();
+    m_count = 0;
+    if (maxFrames <= 0) {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    // Recorder files: size from the header, frames after it
+    size_t offset = 0;
+    RawFrameHeader header;
+    if (size >= sizeof(header) && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        header.hasMagic()) {
+        if (header.pixelFormat != kRawFrameBGRA8 || header.headerSize < sizeof(header) ||
+            header.headerSize > size) {
+            return false;
+        }
+        width = static_cast<int>(header.width);
+        height = static_cast<int>(header.height);
+        offset = header.headerSize;
+    }
+    file.clear();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // A trailing partial frame is ignored
+    const size_t frameBytes = static_cast<size_t>(width) * height * 4;
+    size_t available = (size - offset) / frameBytes;
+    m_count = static_cast<int>(std::min<size_t>(available, static_cast<size_t>(maxFrames)));
+    m_pixels.resize(frameBytes * m_count);
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(m_pixels.data()), static_cast<std::streamsize>(m_pixels.size()));
+    if (!file) {
+        m_pixels.clear();
+        m_count = 0;
+    }
+    m_width = width;
+    m_height = height;
+    return m_count > 0;
+}
+
+const uint8_t* RawFrames::frame(int index) const {
+    if (m_count == 0) {
+        return nullptr;
+    }
+    size_t frameBytes = static_cast<size_t>(m_width) * m_height * 4;
+    return m_pixels.data() + frameBytes * (index % m_count);
+}
+
+} // namespace vivid::opencv::harness
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file raw_frames.h
+ * @brief Loads decoded video frames dumped as BGRA (test harness)
+ *
+ * Dump a clip with e.g.
+ * @code
+ * ffmpeg -i examples/contours-video/assets/train.mp4 -f rawvideo -pix_fmt bgra train.bgra
+ * @endcode
+ * The frame size isn't stored in such a file, so it must be passed in.
+ * Files written by RawFrameRecorder (raw_frame_format.h) carry their size.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+class RawFrames {
+public:
+    /**
+     * @brief Read up to `maxFrames` frames of `width` x `height` into memory
+     *
+     * A RawFrameRecorder file's header supplies the size instead, so
+     * `width` and `height` may be 0 for one.
+     * @return false if the file can't be opened or holds no whole frame
+     */
+    bool load(const std::string& path, int width, int height, int maxFrames);
+
+    int count() const { return m_count; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /// Frame `index` modulo count(), tightly packed BGRA
+    const uint8_t* frame(int index) const;
+
+private:
+    std::vector<uint8_t> m_pixels;
+    int m_width = 0;
+    int m_height = 0;
+    int m_count = 0;
+};
+
+} // namespace vivid::opencv::harness
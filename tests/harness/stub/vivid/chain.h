@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * @file chain.h
+ * @brief Headless stand-in for vivid's Chain (test harness only)
+ *
+ * The harness wires operators directly with Operator::setInput(), so no
+ * chain is needed; this header only satisfies the operators' includes.
+ */
+
+#include <vivid/context.h>
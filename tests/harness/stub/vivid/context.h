@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file context.h
+ * @brief Headless stand-in for vivid's Context (test harness only)
+ */
+
+#include <vivid/operator.h>
+#include <cstdint>
+
+namespace vivid {
+
+class Chain;
+
+/**
+ * @brief Frame clock and output size for a headless cook loop
+ *
+ * The harness advances it once per frame with tick().
+ */
+class Context {
+public:
+    Context(int width = 1280, int height = 720) : m_width(width), m_height(height) {}
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    double time() const { return m_time; }
+    double dt() const { return m_dt; }
+    uint64_t frame() const { return m_frame; }
+
+    void setSize(int width, int height) {
+        m_width = width;
+        m_height = height;
+    }
+
+    /// Advance the clock by `dt` seconds
+    void tick(double dt) {
+        m_dt = dt;
+        m_time += dt;
+        m_frame++;
+    }
+
+private:
+    int m_width;
+    int m_height;
+    double m_time = 0.0;
+    double m_dt = 0.0;
+    uint64_t m_frame = 0;
+};
+
+} // namespace vivid
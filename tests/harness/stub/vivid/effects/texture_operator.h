@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * @file texture_operator.h
+ * @brief Headless stand-in for vivid's TextureOperator (test harness only)
+ */
+
+#include <vivid/operator.h>
+
+namespace vivid::effects {
+
+class TextureOperator : public Operator {
+protected:
+    /// No GPU output texture exists headless; CPU-pixel operators size their own output
+    void matchInputResolution(int index) { (void)index; }
+};
+
+} // namespace vivid::effects
@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file operator.h
+ * @brief Headless stand-in for vivid's Operator (test harness only)
+ *
+ * Implements the subset of the operator interface the OpenCV operators use:
+ * the lifecycle, CPU pixel views, indexed inputs and param registration.
+ * Every process() call cooks (needsCook() is always true).
+ */
+
+#include <vivid/param.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vivid {
+
+class Context;
+
+enum class OutputKind {
+    Texture,
+    CpuPixels
+};
+
+class Operator {
+public:
+    /// Zero-copy view of an operator's CPU pixels (BGRA)
+    struct CpuPixelView {
+        const uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int channels = 4;
+        int stride = 0;  ///< Bytes per row (0 = tightly packed)
+
+        bool valid() const { return data != nullptr && width > 0 && height > 0; }
+    };
+
+    virtual ~Operator() = default;
+
+    virtual void init(Context& ctx) { (void)ctx; }
+    virtual void process(Context& ctx) = 0;
+    virtual void cleanup() {}
+    virtual std::string name() const = 0;
+
+    virtual OutputKind outputKind() const { return OutputKind::Texture; }
+    virtual CpuPixelView cpuPixelView() const { return {}; }
+
+    /// Name-based wiring is a chain feature; recorded but not resolved here
+    void input(const std::string& name) { m_inputName = name; }
+
+    /// Connect input `index` to `op` (harness wiring)
+    void setInput(int index, Operator* op) {
+        if (index >= static_cast<int>(m_inputs.size())) {
+            m_inputs.resize(index + 1, nullptr);
+        }
+        m_inputs[index] = op;
+    }
+
+    Operator* getInput(int index) const {
+        return index >= 0 && index < static_cast<int>(m_inputs.size()) ? m_inputs[index] : nullptr;
+    }
+
+    /// Names of the params registered in the constructor
+    const std::vector<std::string>& paramNames() const { return m_paramNames; }
+
+    /// Completed cooks
+    uint64_t cookCount() const { return m_cookCount; }
+
+protected:
+    bool needsCook() const { return true; }
+    void didCook() { m_cookCount++; }
+
+    template <typename T>
+    void registerParam(Param<T>& param) {
+        m_paramNames.push_back(param.name());
+    }
+
+private:
+    std::vector<Operator*> m_inputs;
+    std::vector<std::string> m_paramNames;
+    std::string m_inputName;
+    uint64_t m_cookCount = 0;
+};
+
+} // namespace vivid
@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * @file operator_registry.h
+ * @brief Headless stand-in for vivid's operator registry (test harness only)
+ *
+ * Nothing is registered: the harness constructs operators directly.
+ */
+
+#include <vivid/operator.h>
+#include <type_traits>
+
+#define REGISTER_OPERATOR(Type, category, description, cpuOutput) \
+    static_assert(std::is_base_of_v<::vivid::Operator, Type>, #Type " must derive from vivid::Operator")
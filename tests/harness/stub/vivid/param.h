@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @file param.h
+ * @brief Headless stand-in for vivid's Param (test harness only)
+ *
+ * Holds a value with its declared range, which is all the operators read.
+ * No UI metadata, serialization or change tracking.
+ */
+
+#include <string>
+
+namespace vivid {
+
+template <typename T>
+class Param {
+public:
+    Param(const char* name, T value, T minValue, T maxValue)
+        : m_name(name), m_value(value), m_min(minValue), m_max(maxValue) {}
+
+    operator T() const { return m_value; }
+
+    Param& operator=(T value) {
+        m_value = value;
+        return *this;
+    }
+
+    const std::string& name() const { return m_name; }
+    T get() const { return m_value; }
+    T min() const { return m_min; }
+    T max() const { return m_max; }
+
+private:
+    std::string m_name;
+    T m_value;
+    T m_min;
+    T m_max;
+};
+
+} // namespace vivid
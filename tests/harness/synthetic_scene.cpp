@@ -0,0 +1,99 @@
+/**
+ * @file synthetic_scene.cpp
+ * @brief Deterministic moving-disc scenes with known ground truth (test harness)
+ */
+
+#include "synthetic_scene.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace vivid::opencv::harness {
+
+namespace {
+constexpr float kTwoPi = 6.28318530718f;
+}
+
+SyntheticScene::SyntheticScene(const SceneConfig& config) : m_config(config) {
+    int discs = std::max(1, m_config.discs);
+    m_cols = static_cast<int>(std::ceil(std::sqrt(discs * static_cast<float>(m_config.width) / m_config.height)));
+    m_rows = (discs + m_cols - 1) / m_cols;
+
+    cv::RNG rng(m_config.seed);
+    m_phase.resize(discs);
+    for (float& phase : m_phase) {
+        phase = rng.uniform(0.0f, kTwoPi);
+    }
+
+    // Static low-contrast texture gives optical flow something to lock onto
+    // without producing Canny edges or blob detections of its own
+    cv::Mat gray(m_config.height, m_config.width, CV_8UC1);
+    int low = std::max(0, m_config.background - m_config.noise);
+    int high = std::min(255, m_config.background + m_config.noise + 1);
+    rng.fill(gray, cv::RNG::UNIFORM, low, high);
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0.0);
+
+    m_background.resize(static_cast<size_t>(m_config.width) * m_config.height * 4);
+    cv::Mat bgra(m_config.height, m_config.width, CV_8UC4, m_background.data());
+    cv::cvtColor(gray, bgra, cv::COLOR_GRAY2BGRA);
+    m_pixels = m_background;
+}
+
+const std::vector<uint8_t>& SyntheticScene::render(int t) {
+    cv::Mat frame(m_config.height, m_config.width, CV_8UC4, m_pixels.data());
+    if (m_config.kind == SceneKind::Noise) {
+        // Fresh noise every frame, seeded by t so runs are reproducible
+        cv::RNG rng(m_config.seed * 7919u + static_cast<uint32_t>(t));
+        cv::Mat gray(m_config.height, m_config.width, CV_8UC1);
+        rng.fill(gray, cv::RNG::UNIFORM, 0, 256);
+        cv::cvtColor(gray, frame, cv::COLOR_GRAY2BGRA);
+    } else {
+        std::copy(m_background.begin(), m_background.end(), m_pixels.begin());
+    }
+
+    float cellW = static_cast<float>(m_config.width) / m_cols;
+    float cellH = static_cast<float>(m_config.height) / m_rows;
+    float ampX = std::max(0.0f, cellW * 0.5f - m_config.radius - 4.0f);
+    float ampY = std::max(0.0f, cellH * 0.5f - m_config.radius - 4.0f);
+    float omega = kTwoPi / std::max(1.0f, m_config.period);
+
+    m_discs.resize(m_phase.size());
+    const cv::Scalar gray(m_config.foreground, m_config.foreground, m_config.foreground, 255);
+    for (size_t i = 0; i < m_phase.size(); ++i) {
+        cv::Scalar color = gray;
+        if (!m_config.colors.empty()) {
+            uint32_t rgb = m_config.colors[i % m_config.colors.size()];
+            color = cv::Scalar(rgb & 0xFF, (rgb >> 8) & 0xFF, (rgb >> 16) & 0xFF, 255);
+        }
+        int col = static_cast<int>(i) % m_cols;
+        int row = static_cast<int>(i) / m_cols;
+        // Lissajous path inside the cell: x at omega, y at 2*omega
+        float a = omega * t + m_phase[i];
+        Disc& disc = m_discs[i];
+        disc.x = (col + 0.5f) * cellW + ampX * std::sin(a);
+        disc.y = (row + 0.5f) * cellH + ampY * std::sin(2.0f * a);
+        disc.vx = ampX * omega * std::cos(a);
+        disc.vy = ampY * 2.0f * omega * std::cos(2.0f * a);
+        disc.radius = m_config.radius;
+
+        if (m_config.kind == SceneKind::Shapes && i % 3 != 0) {
+            // Regular polygon inscribed in the disc, spinning with the path
+            int corners = i % 3 == 1 ? 4 : 3;
+            std::vector<cv::Point> polygon(corners);
+            for (int k = 0; k < corners; ++k) {
+                float angle = a + kTwoPi * k / corners;
+                polygon[k] = cv::Point(cvRound((disc.x + disc.radius * std::cos(angle)) * 16.0f),
+                                       cvRound((disc.y + disc.radius * std::sin(angle)) * 16.0f));
+            }
+            cv::fillConvexPoly(frame, polygon, color, cv::LINE_AA, 4);
+        } else {
+            // 4 fractional bits so sub-pixel motion shows up in the antialiased edge
+            cv::circle(frame, cv::Point(cvRound(disc.x * 16.0f), cvRound(disc.y * 16.0f)),
+                       cvRound(disc.radius * 16.0f), color, cv::FILLED, cv::LINE_AA, 4);
+        }
+    }
+    return m_pixels;
+}
+
+} // namespace vivid::opencv::harness
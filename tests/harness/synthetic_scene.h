@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file synthetic_scene.h
+ * @brief Deterministic moving-disc scenes with known ground truth (test harness)
+ */
+
+#include <cstdint>
+#include <vector>
+
+namespace vivid::opencv::harness {
+
+/**
+ * @brief What the moving objects look like
+ */
+enum class SceneKind {
+    Discs,   ///< Solid discs on a static textured background (blob ground truth)
+    Shapes,  ///< Alternating discs, rotating squares and triangles (edge-heavy)
+    Noise    ///< Discs over full-frame noise regenerated every frame (worst case)
+};
+
+/**
+ * @brief Scene layout
+ *
+ * Objects sit on a grid of cells and each oscillates inside its own cell, so
+ * they never touch: a detector should always see exactly `discs` blobs.
+ */
+struct SceneConfig {
+    int width = 1280;
+    int height = 720;
+    int discs = 8;              ///< Number of discs
+    float radius = 24.0f;       ///< Disc radius in pixels
+    float period = 90.0f;       ///< Frames per oscillation
+    uint8_t background = 24;    ///< Background gray level
+    uint8_t foreground = 230;   ///< Disc gray level
+    std::vector<uint32_t> colors; ///< Per-disc 0xRRGGBB, cycled over the discs (empty = gray foreground)
+    int noise = 6;              ///< Static background texture amplitude (gray levels)
+    uint32_t seed = 1;          ///< Texture and phase seed
+    SceneKind kind = SceneKind::Discs;
+};
+
+/**
+ * @brief Ground truth for one object at the last rendered frame
+ */
+struct Disc {
+    float x = 0.0f;     ///< Center x in pixels
+    float y = 0.0f;     ///< Center y in pixels
+    float vx = 0.0f;    ///< Velocity x in pixels per frame
+    float vy = 0.0f;    ///< Velocity y in pixels per frame
+    float radius = 0.0f;
+};
+
+/**
+ * @brief Renders BGRA frames of the scene; frame t depends only on t
+ */
+class SyntheticScene {
+public:
+    explicit SyntheticScene(const SceneConfig& config = {});
+
+    /// Render frame `t` (tightly packed BGRA, valid until the next render)
+    const std::vector<uint8_t>& render(int t);
+
+    /// Object positions and velocities at the last rendered frame
+    const std::vector<Disc>& discs() const { return m_discs; }
+
+    const SceneConfig& config() const { return m_config; }
+
+private:
+    SceneConfig m_config;
+    std::vector<uint8_t> m_background;  // BGRA, rendered once
+    std::vector<uint8_t> m_pixels;
+    std::vector<Disc> m_discs;
+    std::vector<float> m_phase;
+    int m_cols = 1;
+    int m_rows = 1;
+};
+
+} // namespace vivid::opencv::harness
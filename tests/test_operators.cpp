@@ -0,0 +1,2070 @@
+/**
+ * @file test_operators.cpp
+ * @brief Headless correctness checks for Contours, OpticalFlow, FlowViz/FlowStats,
+ *        BlobTrack, BlobGrid, BlobDetector, BrightSpot, CVPipeline, FrameCache, raw
+ *        frame replay and the OpenCV calls routed through hal/
+ *
+ * Usage: test_operators [name]   (no name = run every test)
+ */
+
+#include "alloc_counter.h"
+#include "blob_detector.h"
+#include "flow_common.h"
+#include "frame_cache.h"
+#include "harness/check.h"
+#include "harness/flow_sequence.h"
+#include "harness/harness.h"
+#include "harness/raw_frames.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <vivid/opencv/alloc_stats.h>
+#include <vivid/opencv/blob_grid.h>
+#include <vivid/opencv/blob_track.h>
+#include <vivid/opencv/bright_spot.h>
+#include <vivid/opencv/contours.h>
+#include <vivid/opencv/cpu_dispatch.h>
+#include <vivid/opencv/cv_pipeline.h>
+#include <vivid/opencv/flow_field.h>
+#include <vivid/opencv/flow_stats.h>
+#include <vivid/opencv/flow_viz.h>
+#include <vivid/opencv/frame_stamp.h>
+#include <vivid/opencv/optical_flow.h>
+#include <vivid/opencv/raw_frame_recorder.h>
+#include <vivid/opencv/raw_frame_source.h>
+#include <vivid/opencv/threading.h>
+#include <vivid/opencv/tracing.h>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace vivid::opencv;
+using harness::Harness;
+using harness::SceneConfig;
+
+namespace {
+
+constexpr std::chrono::milliseconds kPause(2);  // Lets background cooks finish between steps
+constexpr int kMaxFrames = 500;
+
+SceneConfig scene() {
+    SceneConfig config;
+    config.width = 640;
+    config.height = 360;
+    config.discs = 6;
+    config.radius = 20.0f;
+    return config;
+}
+
+bool outputMatches(const vivid::Operator& op, const SceneConfig& config) {
+    auto view = op.cpuPixelView();
+    return view.valid() && view.width == config.width && view.height == config.height;
+}
+
+void testContours(int asyncMode) {
+    Harness h(scene());
+    Contours contours;
+    contours.async = asyncMode;
+    h.attach(contours);
+
+    size_t discs = static_cast<size_t>(h.scene().config().discs);
+    bool ready = h.runUntil([&] {
+        return outputMatches(contours, h.scene().config()) && contours.contourCount() >= discs;
+    }, kMaxFrames, kPause);
+    HARNESS_CHECK(ready);
+
+    // Every disc is found on a steady stream of frames
+    h.runUntil([] { return false; }, 20, kPause);
+    HARNESS_CHECK(contours.contourCount() >= discs);
+    if (asyncMode != 0) {
+        AsyncStats stats = contours.asyncStats();
+        HARNESS_CHECK(stats.submitted >= 20);
+        HARNESS_CHECK(stats.completed > 0);
+        HARNESS_CHECK(stats.completed + stats.dropped <= stats.submitted);
+    }
+}
+
+void testOpticalFlow(int asyncMode) {
+    Harness h(scene());
+    OpticalFlow flow;
+    flow.async = asyncMode;
+    h.attach(flow);
+
+    bool ready = h.runUntil([&] { return outputMatches(flow, h.scene().config()); }, kMaxFrames, kPause);
+    HARNESS_CHECK(ready);
+
+    // Moving discs must light up the visualization somewhere
+    h.runUntil([] { return false; }, 10, kPause);
+    auto view = flow.cpuPixelView();
+    HARNESS_CHECK(view.valid());
+    if (view.valid()) {
+        size_t pixels = static_cast<size_t>(view.width) * view.height;
+        bool moving = false;
+        for (size_t i = 0; i < pixels && !moving; ++i) {
+            const uint8_t* p = view.data + i * 4;  // Alpha is always opaque; look at color
+            moving = std::max({p[0], p[1], p[2]}) > 32;
+        }
+        HARNESS_CHECK(moving);
+    }
+}
+
+void testBlobTrack(int asyncMode) {
+    Harness h(scene());
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    blobs.async = asyncMode;
+    h.attach(blobs);
+
+    size_t discs = static_cast<size_t>(h.scene().config().discs);
+    bool ready = h.runUntil([&] { return blobs.blobCount() == discs; }, kMaxFrames, kPause);
+    HARNESS_CHECK(ready);
+
+    // Discs never touch, so track ids stay stable while they move
+    std::vector<int> before;
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        before.push_back(blob.id);
+    }
+    h.runUntil([] { return false; }, 30, kPause);
+    std::vector<int> after;
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        after.push_back(blob.id);
+    }
+    HARNESS_CHECK(blobs.blobCount() == discs);
+    HARNESS_CHECK(before == after);
+
+    // Each track sits on a disc
+    const std::vector<harness::Disc>& truth = h.scene().discs();
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        float best = 1e9f;
+        for (const harness::Disc& disc : truth) {
+            float dx = blob.x - disc.x;
+            float dy = blob.y - disc.y;
+            best = std::min(best, dx * dx + dy * dy);
+        }
+        // Async results lag a frame or two behind the scene
+        float slack = asyncMode ? 3.0f * h.scene().config().radius : 4.0f;
+        HARNESS_CHECK(best <= slack * slack);
+    }
+}
+
+// Every track's events arrive as Enter, Moves, Leave, in cook order and
+// stamped with the capture time and source frame id of the cook that
+// produced them. A full
+// queue drops events and counts them instead of blocking.
+void testBlobEvents() {
+    {
+        BlobEventQueue queue(3);  // Rounded up to 4
+        HARNESS_CHECK(queue.capacity() == 4);
+        BlobEvent event;
+        for (int i = 0; i < 6; ++i) {
+            event.trackId = i;
+            bool pushed = queue.tryPush(event);
+            HARNESS_CHECK(pushed == (i < 4));
+        }
+        HARNESS_CHECK(queue.overflowCount() == 2);
+        HARNESS_CHECK(queue.sizeApprox() == 4);
+        for (int i = 0; i < 4; ++i) {
+            HARNESS_CHECK(queue.tryPop(event) && event.trackId == i);
+        }
+        HARNESS_CHECK(!queue.tryPop(event));
+    }
+
+    SceneConfig config = scene();
+    Harness h(config);
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    h.attach(blobs);
+
+    // Capture time k/60 for the k-th cook, so each event's time names its cook,
+    // and the source frame id each cook published
+    int cooks = 0;
+    std::vector<BlobEvent> events;
+    std::vector<uint64_t> frameIds(1, 0);  // By cook, from 1
+    auto cook = [&](const uint8_t* frame) {
+        blobs.setCaptureTime(++cooks / 60.0);
+        if (frame) {
+            h.source().setFrameView(frame, config.width, config.height);
+            h.cook();
+        } else {
+            h.step();
+        }
+        frameIds.push_back(frameStamp(blobs).frameId);
+        blobs.eventQueue()->drain([&](const BlobEvent& e) { events.push_back(e); });
+    };
+
+    for (int i = 0; i < 60; ++i) {
+        cook(nullptr);
+    }
+    HARNESS_CHECK(blobs.blobCount() == static_cast<size_t>(config.discs));
+
+    // An empty frame: every track misses until it is retired
+    std::vector<uint8_t> empty(static_cast<size_t>(config.width) * config.height * 4, config.background);
+    for (int i = 0; i < static_cast<int>(blobs.trackPersistence) + 5; ++i) {
+        cook(empty.data());
+    }
+    HARNESS_CHECK(blobs.blobCount() == 0);
+
+    // Per track: one Enter first, one Leave last, Moves in between
+    std::vector<int> state(events.size() + 1, 0);  // By track id (ids count up from 1): 0 unseen, 1 live, 2 left
+    int enters = 0;
+    int leaves = 0;
+    bool ordered = true;
+    uint64_t lastFrame = 0;
+    for (const BlobEvent& e : events) {
+        // The frame id is the one the event's cook published
+        auto k = static_cast<size_t>(std::lround(e.timestamp * 60.0));
+        ordered = ordered && e.frame >= lastFrame && k < frameIds.size() &&
+                  e.frame == frameIds[k] && e.frame != 0;
+        lastFrame = e.frame;
+        if (e.trackId < 0 || static_cast<size_t>(e.trackId) >= state.size()) {
+            ordered = false;
+            continue;
+        }
+        int& s = state[e.trackId];
+        switch (e.type) {
+        case BlobEventType::Enter:
+            ordered = ordered && s == 0;
+            s = 1;
+            enters++;
+            break;
+        case BlobEventType::Move:
+            ordered = ordered && s == 1;
+            break;
+        case BlobEventType::Leave:
+            ordered = ordered && s == 1;
+            s = 2;
+            leaves++;
+            break;
+        }
+    }
+    HARNESS_CHECK(ordered);
+    HARNESS_CHECK(enters >= config.discs);
+    HARNESS_CHECK(leaves == enters);
+    HARNESS_CHECK(blobs.eventQueue()->overflowCount() == 0);
+
+    // Six discs entering at once into four slots: two counted as overflow
+    auto small = std::make_shared<BlobEventQueue>(4);
+    blobs.setEventQueue(small);
+    while (blobs.blobCount() == 0 && cooks < 200) {
+        blobs.setCaptureTime(++cooks / 60.0);
+        h.step();
+    }
+    HARNESS_CHECK(small->sizeApprox() == 4);
+    HARNESS_CHECK(small->overflowCount() >= static_cast<uint64_t>(config.discs - 4));
+}
+
+// Discs on straight lines at constant speed: predictions 50 ms (three
+// frames) ahead must land within a pixel or so of where the discs get to,
+// against the ~7 px a track that only held its last position would miss by
+void testBlobPrediction() {
+    struct Path {
+        float x, y;    // At frame 0
+        float vx, vy;  // Pixels per frame
+    };
+    const Path paths[] = {{60, 60, 2.5f, 0.5f}, {80, 180, 3.0f, -0.4f}, {40, 300, 2.0f, -0.25f}};
+
+    SceneConfig config = scene();
+    cv::Mat frame(config.height, config.width, CV_8UC4);
+    auto render = [&](int f) {
+        frame.setTo(cv::Scalar(24, 24, 24, 255));
+        for (const Path& p : paths) {
+            cv::Point center(static_cast<int>(std::lround((p.x + p.vx * f) * 16)),
+                             static_cast<int>(std::lround((p.y + p.vy * f) * 16)));
+            cv::circle(frame, center, 12 * 16, cv::Scalar(230, 230, 230, 255), cv::FILLED,
+                       cv::LINE_AA, 4);
+        }
+    };
+
+    Harness h(config);
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    blobs.predictAhead = 50.0f;
+    h.attach(blobs);
+
+    const int lead = 3;  // Frames in 50 ms at 60 Hz
+    for (int f = 1; f <= 120; ++f) {
+        render(f);
+        h.source().setFrameView(frame.data, config.width, config.height);
+        blobs.setCaptureTime(f / 60.0);
+        h.cook();
+    }
+
+    HARNESS_CHECK(blobs.blobCount() == std::size(paths));
+    PredictionStats error = blobs.predictionError();
+    HARNESS_CHECK(error.samples >= 60);
+    HARNESS_CHECK(error.mean <= 0.5f);
+    HARNESS_CHECK(error.max <= 1.5f);
+
+    // The last cook's predictions point where each disc will be three frames on
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        float best = 1e9f;
+        for (const Path& p : paths) {
+            float dx = blob.predictedX - (p.x + p.vx * (120 + lead));
+            float dy = blob.predictedY - (p.y + p.vy * (120 + lead));
+            best = std::min(best, dx * dx + dy * dy);
+        }
+        HARNESS_CHECK(best <= 1.0f);
+    }
+}
+
+int rootOf(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        i = parent[i] = parent[parent[i]];
+    }
+    return i;
+}
+
+// BlobGrid's clustering matches an O(n^2) single-linkage reference on random
+// blobs for cell sizes above and below the link distance, and BlobTrack
+// labels grouped discs by that clustering
+void testBlobGrid() {
+    cv::RNG rng(31);
+    BlobGrid grid;
+    std::vector<TrackedBlob> blobs;
+    std::vector<int> labels;
+    std::vector<int> parent;
+    std::vector<int> expected;
+    std::vector<std::pair<int, int>> pairs;
+
+    for (int round = 0; round < 24; ++round) {
+        // Whole-pixel positions and a half-pixel link distance: squared
+        // distances are exact in float and never tie with the threshold
+        const int n = rng.uniform(0, 400);
+        const int extent = round % 2 ? 1280 : 240;  // Sparse and crowded
+        blobs.assign(n, TrackedBlob{});
+        for (TrackedBlob& blob : blobs) {
+            blob.x = static_cast<float>(rng.uniform(0, extent));
+            blob.y = static_cast<float>(rng.uniform(0, extent * 9 / 16));
+            blob.size = static_cast<float>(rng.uniform(4, 40));
+        }
+        const float link = rng.uniform(4, 80) + 0.5f;
+        const float cellSizes[] = {link * 0.25f, link, link * 3.0f};
+
+        parent.resize(n);
+        for (int i = 0; i < n; ++i) {
+            parent[i] = i;
+        }
+        size_t linked = 0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                float dx = blobs[j].x - blobs[i].x;
+                float dy = blobs[j].y - blobs[i].y;
+                if (dx * dx + dy * dy <= link * link) {
+                    int a = rootOf(parent, i);
+                    int b = rootOf(parent, j);
+                    parent[std::max(a, b)] = std::min(a, b);
+                    linked++;
+                }
+            }
+        }
+        // Clusters numbered in order of their lowest blob index
+        int expectedCount = 0;
+        std::vector<int> labelOfRoot(n, -1);
+        expected.resize(n);
+        for (int i = 0; i < n; ++i) {
+            int root = rootOf(parent, i);
+            if (labelOfRoot[root] < 0) {
+                labelOfRoot[root] = expectedCount++;
+            }
+            expected[i] = labelOfRoot[root];
+        }
+
+        for (float cellSize : cellSizes) {
+            grid.build(blobs, cellSize);
+            HARNESS_CHECK(grid.cluster(link, labels) == expectedCount);
+            HARNESS_CHECK(labels == expected);
+            grid.pairsWithin(link, pairs);
+            HARNESS_CHECK(pairs.size() == linked);
+        }
+    }
+
+    // Three groups of discs 40 px apart center to center, 150 px between groups
+    SceneConfig config = scene();
+    const cv::Point centers[] = {{80, 100}, {120, 100}, {160, 100},  // Chain: ends 80 px apart
+                                 {320, 200}, {320, 240},
+                                 {520, 120}};
+    const int group[] = {0, 0, 0, 1, 1, 2};
+    cv::Mat frame(config.height, config.width, CV_8UC4, cv::Scalar(24, 24, 24, 255));
+    for (const cv::Point& center : centers) {
+        cv::circle(frame, center, 12, cv::Scalar(230, 230, 230, 255), cv::FILLED);
+    }
+
+    Harness h(config);
+    BlobTrack tracker;
+    tracker.detectDark = 0;
+    tracker.clusterDistance = 50.0f;
+    h.attach(tracker);
+    for (int f = 0; f < 3; ++f) {
+        h.source().setFrameView(frame.data, config.width, config.height);
+        h.cook();
+    }
+
+    HARNESS_CHECK(tracker.blobCount() == std::size(centers));
+    HARNESS_CHECK(tracker.clusterCount() == 3);
+    auto groupOf = [&](const TrackedBlob& blob) {
+        for (size_t i = 0; i < std::size(centers); ++i) {
+            float dx = blob.x - centers[i].x;
+            float dy = blob.y - centers[i].y;
+            if (dx * dx + dy * dy <= 4.0f) {
+                return group[i];
+            }
+        }
+        return -1;
+    };
+    const std::vector<TrackedBlob>& tracked = tracker.blobs();
+    for (const TrackedBlob& a : tracked) {
+        HARNESS_CHECK(groupOf(a) >= 0);
+        HARNESS_CHECK(a.cluster >= 0 && a.cluster < 3);
+        for (const TrackedBlob& b : tracked) {
+            HARNESS_CHECK((a.cluster == b.cluster) == (groupOf(a) == groupOf(b)));
+        }
+    }
+
+    // Clustering off: no labels
+    tracker.clusterDistance = 0.0f;
+    h.cook();
+    HARNESS_CHECK(tracker.clusterCount() == 0);
+    for (const TrackedBlob& blob : tracker.blobs()) {
+        HARNESS_CHECK(blob.cluster == -1);
+    }
+}
+
+// A track's history ring keeps the newest historyLength samples oldest
+// first, wraps without losing order, and is rebuilt when the length changes
+void testTrajectory() {
+    const float x0 = 100.0f, y0 = 180.0f, vx = 4.0f, vy = -1.5f;  // Pixels per frame
+    SceneConfig config = scene();
+    cv::Mat frame(config.height, config.width, CV_8UC4);
+    auto render = [&](int f) {
+        frame.setTo(cv::Scalar(24, 24, 24, 255));
+        cv::Point center(static_cast<int>(std::lround((x0 + vx * f) * 16)),
+                         static_cast<int>(std::lround((y0 + vy * f) * 16)));
+        cv::circle(frame, center, 12 * 16, cv::Scalar(230, 230, 230, 255), cv::FILLED,
+                   cv::LINE_AA, 4);
+    };
+
+    Harness h(config);
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    blobs.historyLength = 5;
+    h.attach(blobs);
+
+    auto cookFrame = [&](int f) {
+        render(f);
+        h.source().setFrameView(frame.data, config.width, config.height);
+        blobs.setCaptureTime(f / 60.0);
+        h.cook();
+    };
+
+    // Every sample is the disc's position at the capture time stored with it
+    auto checkSamples = [&](const TrajectoryView& trail, int newest) {
+        HARNESS_CHECK(!trail.empty());
+        for (int k = 0; k < trail.count; ++k) {
+            int f = newest - (trail.count - 1 - k);
+            HARNESS_CHECK(trail.time(k) == f / 60.0);
+            HARNESS_CHECK(std::abs(trail.x(k) - (x0 + vx * f)) <= 0.5f);
+            HARNESS_CHECK(std::abs(trail.y(k) - (y0 + vy * f)) <= 0.5f);
+        }
+        // The two raw segments hold the same samples in the same order
+        HARNESS_CHECK(trail.firstSegment() + trail.secondSegment() == trail.count);
+        for (int k = 0; k < trail.firstSegment(); ++k) {
+            HARNESS_CHECK(trail.xs[trail.start + k] == trail.x(k));
+        }
+        for (int k = 0; k < trail.secondSegment(); ++k) {
+            HARNESS_CHECK(trail.ys[k] == trail.y(trail.firstSegment() + k));
+        }
+    };
+
+    int first = 0;  // Frame the track was created on
+    bool wrapped = false;
+    for (int f = 1; f <= 13; ++f) {
+        cookFrame(f);
+        if (blobs.blobCount() == 0) {
+            continue;
+        }
+        HARNESS_CHECK(blobs.blobCount() == 1);
+        if (first == 0) {
+            first = f;
+        }
+        TrajectoryView trail = blobs.trajectoryAt(0);
+        int pushed = f - first + 1;
+        HARNESS_CHECK(trail.capacity == 5);
+        HARNESS_CHECK(trail.count == std::min(pushed, 5));
+        HARNESS_CHECK(trail.start == std::max(pushed - 5, 0) % 5);
+        wrapped = wrapped || trail.secondSegment() > 0;
+        checkSamples(trail, f);
+
+        TrajectoryView byId = blobs.trajectory(blobs.blobs()[0].id);
+        HARNESS_CHECK(byId.xs == trail.xs && byId.start == trail.start && byId.count == trail.count);
+    }
+    HARNESS_CHECK(first > 0 && first <= 3);
+    HARNESS_CHECK(wrapped);
+    HARNESS_CHECK(blobs.trajectory(-1).empty());
+
+    // A new length drops the old history, keeps the track and refills the ring
+    blobs.historyLength = 3;
+    for (int f = 14; f <= 17; ++f) {
+        cookFrame(f);
+        TrajectoryView trail = blobs.trajectoryAt(0);
+        HARNESS_CHECK(trail.capacity == 3);
+        HARNESS_CHECK(trail.count <= std::min(f - 12, 3));
+        checkSamples(trail, f);
+    }
+    HARNESS_CHECK(blobs.trajectoryAt(0).count == 3);
+
+    blobs.historyLength = 0;
+    cookFrame(18);
+    HARNESS_CHECK(blobs.blobCount() == 1);
+    HARNESS_CHECK(blobs.trajectoryAt(0).empty());
+}
+
+// Foreground mode ignores static clutter that luma mode detects, tracks only
+// the moving discs once the background is learned, lets stopped discs fade
+// into the background, and relearns after resetBackground()
+void testBlobTrackForeground() {
+    SceneConfig config = scene();
+    cv::Mat clutter(config.height, config.width, CV_8UC4, cv::Scalar(40, 40, 40, 255));
+    const cv::Point statics[] = {{80, 60}, {320, 300}, {560, 60}};
+    for (const cv::Point& center : statics) {
+        cv::circle(clutter, center, 16, cv::Scalar(220, 220, 220, 255), cv::FILLED);
+    }
+    cv::rectangle(clutter, cv::Rect(420, 240, 120, 50), cv::Scalar(200, 200, 200, 255), cv::FILLED);
+
+    const float speed = 6.0f;  // Pixels per frame; slow movers would leave learned ghosts
+    const cv::Point2f starts[] = {{100, 150}, {140, 220}};
+    cv::Mat frame;
+    cv::Mat noise(config.height, config.width, CV_8UC4);
+    auto render = [&](int moving, float travel) {
+        clutter.copyTo(frame);
+        for (int i = 0; i < moving; ++i) {
+            cv::Point center(static_cast<int>(std::lround((starts[i].x + travel) * 16)),
+                             static_cast<int>(std::lround(starts[i].y * 16)));
+            cv::circle(frame, center, 12 * 16, cv::Scalar(230, 230, 230, 255), cv::FILLED,
+                       cv::LINE_AA, 4);
+        }
+        // Temporal sensor noise well below fgMinDiff
+        cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(6));
+        cv::add(frame, noise, frame);
+    };
+
+    Harness h(config);
+    BlobTrack fg;
+    fg.detectMode = static_cast<int>(BlobDetectMode::Foreground);
+    BlobTrack luma;
+    luma.detectDark = 0;
+    h.attach(fg);
+    h.attach(luma);
+    auto cookFrame = [&](int moving, float travel) {
+        render(moving, travel);
+        h.source().setFrameView(frame.data, config.width, config.height);
+        h.cook();
+    };
+
+    // Learn the cluttered background
+    for (int f = 0; f < 30; ++f) {
+        cookFrame(0, 0.0f);
+    }
+    HARNESS_CHECK(fg.blobCount() == 0);
+    HARNESS_CHECK(luma.blobCount() >= std::size(statics));
+
+    // Only the movers are foreground
+    float travel = 0.0f;
+    for (int f = 0; f < 40; ++f, travel += speed) {
+        cookFrame(2, travel);
+        if (f < 3) {
+            continue;
+        }
+        HARNESS_CHECK(fg.blobCount() == std::size(starts));
+        HARNESS_CHECK(luma.blobCount() >= std::size(statics) + std::size(starts));
+        for (const TrackedBlob& blob : fg.blobs()) {
+            float best = 1e9f;
+            for (const cv::Point2f& start : starts) {
+                float dx = blob.x - (start.x + travel);
+                float dy = blob.y - start.y;
+                best = std::min(best, dx * dx + dy * dy);
+            }
+            HARNESS_CHECK(best <= 1.5f * 1.5f);
+        }
+    }
+
+    // Stopped discs fade into the background after roughly 1/bgLearnRate frames
+    fg.bgLearnRate = 0.05f;
+    travel -= speed;
+    int cooks = 0;
+    while (fg.blobCount() > 0 && cooks < 200) {
+        cookFrame(2, travel);
+        cooks++;
+    }
+    HARNESS_CHECK(fg.blobCount() == 0);
+    HARNESS_CHECK(cooks > 30);
+
+    // Removing them now would leave holes in the learned model; a reset relearns
+    fg.resetBackground();
+    for (int f = 0; f < 10; ++f) {
+        cookFrame(0, 0.0f);
+        HARNESS_CHECK(fg.blobCount() == 0);
+    }
+}
+
+cv::SimpleBlobDetector::Params toSimpleBlobParams(const detail::BlobDetectorParams& p) {
+    cv::SimpleBlobDetector::Params params;
+    params.minThreshold = p.minThreshold;
+    params.maxThreshold = p.maxThreshold;
+    params.thresholdStep = p.thresholdStep;
+    params.minRepeatability = static_cast<size_t>(p.minRepeatability);
+    params.minDistBetweenBlobs = p.minDistBetweenBlobs;
+    params.filterByColor = p.filterByColor;
+    params.blobColor = p.blobColor;
+    params.filterByArea = p.filterByArea;
+    params.minArea = p.minArea;
+    params.maxArea = p.maxArea;
+    params.filterByCircularity = p.filterByCircularity;
+    params.minCircularity = p.minCircularity;
+    params.filterByInertia = p.filterByInertia;
+    params.minInertiaRatio = p.minInertiaRatio;
+    params.filterByConvexity = p.filterByConvexity;
+    params.minConvexity = p.minConvexity;
+    return params;
+}
+
+// The persistent BlobDetector finds the same keypoints as a fresh
+// cv::SimpleBlobDetector on every scene kind, while one instance is
+// reconfigured between frames the way animated BlobTrack params do
+void testBlobDetector() {
+    detail::BlobDetectorParams bright;
+    bright.minThreshold = 78;
+    bright.maxThreshold = 178;
+    bright.blobColor = 255;
+    bright.minArea = 100;
+    bright.maxArea = 20000;
+    bright.minConvexity = 0.8f;
+
+    detail::BlobDetectorParams dark;  // Detector defaults: dark blobs
+
+    detail::BlobDetectorParams either = bright;
+    either.filterByColor = false;
+    either.filterByCircularity = true;
+    either.minCircularity = 0.7f;
+    either.filterByConvexity = false;
+    either.minRepeatability = 3;
+    either.minDistBetweenBlobs = 20;
+
+    const detail::BlobDetectorParams* configs[] = {&bright, &dark, &either};
+
+    detail::BlobDetector detector;
+    std::vector<cv::KeyPoint> ours;
+    std::vector<cv::KeyPoint> reference;
+    cv::Mat gray;
+    size_t found = 0;
+    int run = 0;
+
+    for (harness::SceneKind kind : {harness::SceneKind::Discs, harness::SceneKind::Shapes,
+                                    harness::SceneKind::Noise}) {
+        SceneConfig config = scene();
+        config.kind = kind;
+        harness::SyntheticScene synthetic(config);
+        for (int t = 0; t < 60; t += 12) {
+            const std::vector<uint8_t>& pixels = synthetic.render(t);
+            cv::Mat bgra(config.height, config.width, CV_8UC4, const_cast<uint8_t*>(pixels.data()));
+            cv::cvtColor(bgra, gray, cv::COLOR_BGRA2GRAY);
+
+            for (size_t c = 0; c < std::size(configs); ++c) {
+                const detail::BlobDetectorParams& params = *configs[(c + run++) % std::size(configs)];
+                detector.configure(params);
+                detector.detect(gray, ours);
+                cv::SimpleBlobDetector::create(toSimpleBlobParams(params))->detect(gray, reference);
+
+                HARNESS_CHECK(ours.size() == reference.size());
+                if (ours.size() != reference.size()) {
+                    continue;
+                }
+                for (size_t i = 0; i < ours.size(); ++i) {
+                    HARNESS_CHECK(cv::norm(ours[i].pt - reference[i].pt) <= 1e-3);
+                    HARNESS_CHECK(std::abs(ours[i].size - reference[i].size) <= 1e-3f);
+                }
+                found += ours.size();
+            }
+        }
+    }
+    HARNESS_CHECK(found > 0);
+}
+
+// Color mode keeps only the discs inside the default hue range (0-30 degrees):
+// orange discs are tracked, blue (off-hue) and gray (unsaturated) ones are not
+void testBlobTrackColor() {
+    SceneConfig config = scene();
+    config.colors = {0xF06414, 0x143CE6, 0xE6E6E6};  // Orange (22 deg), blue, gray
+    Harness h(config);
+    BlobTrack blobs;
+    blobs.detectMode = static_cast<int>(BlobDetectMode::Color);
+    h.attach(blobs);
+
+    size_t orange = static_cast<size_t>((config.discs + 2) / 3);
+    bool ready = h.runUntil([&] { return blobs.blobCount() == orange; }, kMaxFrames);
+    HARNESS_CHECK(ready);
+
+    h.runUntil([] { return false; }, 10);
+    HARNESS_CHECK(blobs.blobCount() == orange);
+
+    // Every track sits on an orange disc
+    const std::vector<harness::Disc>& truth = h.scene().discs();
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        float best = 1e9f;
+        size_t nearest = 0;
+        for (size_t i = 0; i < truth.size(); ++i) {
+            float dx = blob.x - truth[i].x;
+            float dy = blob.y - truth[i].y;
+            if (dx * dx + dy * dy < best) {
+                best = dx * dx + dy * dy;
+                nearest = i;
+            }
+        }
+        HARNESS_CHECK(nearest % config.colors.size() == 0);
+        HARNESS_CHECK(best <= 4.0f * 4.0f);
+    }
+}
+
+// Sliced detection charges one miss per cook: a track outlives a gap of exactly
+// trackPersistence empty frames and is retired after a longer one
+void testBlobTrackSlicedGap() {
+    Harness h(scene());
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    blobs.sliceCount = 2;
+    blobs.trackPersistence = 6;
+    h.attach(blobs);
+
+    size_t discs = static_cast<size_t>(h.scene().config().discs);
+    bool ready = h.runUntil([&] { return blobs.blobCount() == discs; }, kMaxFrames);
+    HARNESS_CHECK(ready);
+
+    // Hold one frame still so every track stays inside its refinement window
+    const SceneConfig& config = h.scene().config();
+    std::vector<uint8_t> still = h.scene().render(h.frame());
+    std::vector<uint8_t> blank(still.size(), 0);
+    auto serve = [&](const std::vector<uint8_t>& pixels, int cooks) {
+        h.source().setFrameView(pixels.data(), config.width, config.height);
+        for (int i = 0; i < cooks; ++i) {
+            h.cook();
+        }
+    };
+    serve(still, 4);
+    std::vector<int> before;
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        before.push_back(blob.id);
+    }
+    HARNESS_CHECK(before.size() == discs);
+
+    serve(blank, 6);
+    serve(still, 4);
+    std::vector<int> after;
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        after.push_back(blob.id);
+    }
+    HARNESS_CHECK(before == after);
+
+    // One more empty frame than allowed; retirement waits for the end of a slice cycle
+    serve(blank, 7 + 2);
+    HARNESS_CHECK(blobs.blobCount() == 0);
+}
+
+// Band detections are up to sliceCount-1 frames old when a cycle completes;
+// fast discs must still match their tracks instead of spawning duplicates
+void testBlobTrackSlicedFast() {
+    SceneConfig config = scene();
+    config.period = 45.0f;  // Peaks near 25 px per frame, so a band lags a disc by ~75 px
+    Harness h(config);
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    blobs.sliceCount = 4;
+    h.attach(blobs);
+
+    // Capture times on the 60 Hz scene clock rather than however fast we cook
+    auto step = [&] {
+        blobs.setCaptureTime(h.frame() / 60.0);
+        h.step();
+    };
+
+    size_t discs = static_cast<size_t>(config.discs);
+    int frames = 0;
+    while (blobs.blobCount() != discs && frames++ < kMaxFrames) {
+        step();
+    }
+    HARNESS_CHECK(blobs.blobCount() == discs);
+    for (int i = 0; i < 60; ++i) {
+        step();  // Let the velocity estimates settle
+    }
+
+    bool steady = true;
+    for (int i = 0; i < 120; ++i) {
+        step();
+        steady = steady && blobs.blobCount() == discs;
+    }
+    HARNESS_CHECK(steady);
+
+    const std::vector<harness::Disc>& truth = h.scene().discs();
+    for (const TrackedBlob& blob : blobs.blobs()) {
+        if (blob.missed > 0) {
+            continue;
+        }
+        float best = 1e9f;
+        for (const harness::Disc& disc : truth) {
+            float dx = blob.x - disc.x;
+            float dy = blob.y - disc.y;
+            best = std::min(best, dx * dx + dy * dy);
+        }
+        HARNESS_CHECK(best <= 4.0f * 4.0f);
+    }
+}
+
+// A Gaussian spot at a known sub-pixel position, moving, then lost and
+// found again elsewhere. The centroid must land within a tenth of a pixel.
+void testBrightSpot() {
+    SceneConfig config = scene();
+    const int width = config.width;
+    const int height = config.height;
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+    // Gray spot, so luma equals the channel value; sigma 2 px, peak 250
+    auto render = [&](bool visible, float cx, float cy) {
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            pixels[i] = pixels[i + 1] = pixels[i + 2] = 0;
+            pixels[i + 3] = 255;
+        }
+        if (!visible) {
+            return;
+        }
+        for (int y = static_cast<int>(cy) - 8; y <= static_cast<int>(cy) + 8; ++y) {
+            for (int x = static_cast<int>(cx) - 8; x <= static_cast<int>(cx) + 8; ++x) {
+                float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                auto v = static_cast<uint8_t>(std::lround(250.0f * std::exp(-d2 / 8.0f)));
+                uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+                p[0] = p[1] = p[2] = v;
+            }
+        }
+    };
+
+    Harness h(config);
+    BrightSpot spot;
+    h.attach(spot);
+    auto cook = [&](bool visible, float cx, float cy) {
+        render(visible, cx, cy);
+        h.source().setFrameView(pixels.data(), width, height);
+        h.cook();
+    };
+
+    // Acquired by the decimated search, then followed in the tracking window
+    bool accurate = true;
+    for (int i = 0; i < 40; ++i) {
+        float cx = 100.3f + 3.37f * i;
+        float cy = 80.6f + 1.71f * i;
+        cook(true, cx, cy);
+        accurate = accurate && spot.found() && std::abs(spot.x() - cx) <= 0.1f &&
+                   std::abs(spot.y() - cy) <= 0.1f;
+    }
+    HARNESS_CHECK(accurate);
+    HARNESS_CHECK(spot.brightness() >= 245.0f);
+
+    cook(false, 0.0f, 0.0f);
+    HARNESS_CHECK(!spot.found());
+
+    // Far outside the old search window: the global search takes over again
+    cook(true, 517.45f, 291.85f);
+    HARNESS_CHECK(spot.found());
+    HARNESS_CHECK(std::abs(spot.x() - 517.45f) <= 0.1f);
+    HARNESS_CHECK(std::abs(spot.y() - 291.85f) <= 0.1f);
+
+    // Decimation skips rows, never columns: a one-pixel spot on an odd
+    // column is always found, one on an odd row only with decimation 1
+    auto findPoint = [&](int x, int y, int decimation) {
+        render(false, 0.0f, 0.0f);
+        uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+        p[0] = p[1] = p[2] = 250;
+        Harness fresh(config);
+        BrightSpot point;
+        point.decimation = decimation;
+        fresh.attach(point);
+        fresh.source().setFrameView(pixels.data(), width, height);
+        fresh.cook();
+        return point.found() && std::lround(point.x()) == x && std::lround(point.y()) == y;
+    };
+    HARNESS_CHECK(findPoint(301, 120, 2));
+    HARNESS_CHECK(findPoint(303, 120, 4));
+    HARNESS_CHECK(!findPoint(300, 121, 2));
+    HARNESS_CHECK(findPoint(300, 121, 1));
+}
+
+bool stampOrdered(const FrameStamp& stamp) {
+    return stamp.valid() && stamp.captureTime <= stamp.receiveTime &&
+           stamp.receiveTime <= stamp.publishTime &&
+           stamp.pipelineLatencyMs() >= stamp.cookLatencyMs();
+}
+
+// CVPipeline stage graphs from JSON: both documented layouts, defaults and
+// sanitizing, rejected graphs leave the stages alone, and a loaded graph
+// finds the scene's discs
+void testCVPipelineJson() {
+    CVPipeline pipe;
+    HARNESS_CHECK(pipe.setStagesJson(R"({ "stages": [
+        { "type": "luma" },
+        { "type": "blur", "size": 4 },
+        { "type": "threshold", "threshold": 128, "invert": false },
+        { "type": "morphology", "morphOp": "close", "size": 3, "iterations": 2 },
+        { "type": "canny", "threshold": 40, "threshold2": 90 },
+        { "type": "flow", "scale": 5 },
+        { "type": "blobs", "minArea": 80 }
+    ] })"));
+    HARNESS_CHECK(pipe.lastError().empty());
+    const std::vector<CVStage>& stages = pipe.stages();
+    HARNESS_CHECK(stages.size() == 7);
+    if (stages.size() == 7) {
+        HARNESS_CHECK(stages[0].type == CVStageType::Luma);
+        HARNESS_CHECK(stages[1].type == CVStageType::Blur && stages[1].size == 5);  // Forced odd
+        HARNESS_CHECK(stages[2].type == CVStageType::Threshold && stages[2].threshold == 128.0f);
+        HARNESS_CHECK(stages[3].morphOp == CVMorphOp::Close && stages[3].size == 3 &&
+                      stages[3].iterations == 2);
+        HARNESS_CHECK(stages[4].threshold == 40.0f && stages[4].threshold2 == 90.0f);
+        HARNESS_CHECK(stages[5].type == CVStageType::Flow && stages[5].scale == 1.0f);  // Clamped
+        HARNESS_CHECK(stages[6].type == CVStageType::Blobs && stages[6].minArea == 80.0f &&
+                      stages[6].maxArea == CVStage{}.maxArea);
+    }
+
+    // A bare array works too
+    HARNESS_CHECK(pipe.setStagesJson(R"([{ "type": "threshold" }, { "type": "contours" }])"));
+    HARNESS_CHECK(pipe.stages().size() == 2);
+
+    // Every rejected graph keeps the previous stages and says why
+    const char* invalid[] = {
+        R"([{ "type": "luma" }, { "type": "sharpen" }])",
+        R"([{ "size": 3 }])",
+        R"([{ "type": "morphology", "morphOp": "tophat" }])",
+        R"({ "stages": { "type": "luma" } })",
+        R"({ "pipeline": [] })",
+        R"([{ "type": "blur", "size": "big" }])",
+        R"([{ "type": "luma" })",
+    };
+    for (const char* json : invalid) {
+        HARNESS_CHECK(!pipe.setStagesJson(json));
+        HARNESS_CHECK(!pipe.lastError().empty());
+        HARNESS_CHECK(pipe.stages().size() == 2);
+    }
+    pipe.setStagesJson(invalid[0]);
+    HARNESS_CHECK(pipe.lastError().find("stage 1") != std::string::npos);
+
+    HARNESS_CHECK(!pipe.loadStages("/nonexistent/vivid_opencv_stages.json"));
+    HARNESS_CHECK(!pipe.lastError().empty());
+
+    // Loaded from a file, the graph finds every disc
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "vivid_opencv_test_stages.json").string();
+    if (std::FILE* file = std::fopen(path.c_str(), "wb")) {
+        std::fputs(R"({ "stages": [
+            { "type": "threshold", "threshold": 128 },
+            { "type": "morphology", "morphOp": "open", "size": 3 },
+            { "type": "blobs", "minArea": 200 }
+        ] })", file);
+        std::fclose(file);
+    }
+    HARNESS_CHECK(pipe.loadStages(path));
+    std::filesystem::remove(path);
+    HARNESS_CHECK(pipe.stages().size() == 3);
+
+    SceneConfig config = scene();
+    Harness h(config);
+    h.attach(pipe);
+    for (int f = 0; f < 5; ++f) {
+        h.step();
+        HARNESS_CHECK(outputMatches(pipe, config));
+        HARNESS_CHECK(pipe.blobs().size() == static_cast<size_t>(config.discs));
+        for (const CVPipelineBlob& blob : pipe.blobs()) {
+            float best = 1e9f;
+            for (const harness::Disc& disc : h.scene().discs()) {
+                float dx = blob.x - disc.x;
+                float dy = blob.y - disc.y;
+                best = std::min(best, dx * dx + dy * dy);
+            }
+            HARNESS_CHECK(best <= 1.0f);
+        }
+    }
+}
+
+// A Flow stage straight after luma at a power-of-two scale solves on the
+// shared pyramid level; after other stages, and at other scales, it resizes
+void testCVPipelineFlow() {
+    SceneConfig config = scene();
+    Harness h(config);
+    CVPipeline pyramid;
+    pyramid.setStages({{CVStageType::Flow}});  // Default scale 0.5
+    CVPipeline resized;
+    CVStage blur;
+    blur.type = CVStageType::Blur;
+    blur.size = 1;  // Identity, but no longer the cached luma
+    resized.setStages({blur, {CVStageType::Flow}});
+    h.attach(pyramid);
+    h.attach(resized);
+
+    // Mean flow speed in input pixels the pipeline should report
+    auto expected = [](const cv::Mat& prev, const cv::Mat& next) {
+        cv::Mat flow;
+        cv::calcOpticalFlowFarneback(prev, next, flow, 0.5, 3, 15, 3, 5, 1.2, 0);
+        cv::Mat channels[2], magnitude, angle;
+        cv::split(flow, channels);
+        cv::cartToPolar(channels[0], channels[1], magnitude, angle, true);
+        return static_cast<float>(cv::mean(magnitude)[0]) / 0.5f;
+    };
+
+    cv::Mat luma[2];
+    for (int f = 0; f < 2; ++f) {
+        const std::vector<uint8_t>& pixels = h.scene().render(f * 3);
+        cv::Mat bgra(config.height, config.width, CV_8UC4, const_cast<uint8_t*>(pixels.data()));
+        cv::cvtColor(bgra, luma[f], cv::COLOR_BGRA2GRAY);
+        h.source().setFrameView(pixels.data(), config.width, config.height);
+        h.cook();
+    }
+
+    cv::Mat down[2], area[2];
+    for (int f = 0; f < 2; ++f) {
+        cv::pyrDown(luma[f], down[f]);
+        cv::resize(luma[f], area[f], cv::Size(config.width / 2, config.height / 2), 0, 0,
+                   cv::INTER_AREA);
+    }
+    float fromPyramid = expected(down[0], down[1]);
+    float fromResize = expected(area[0], area[1]);
+    HARNESS_CHECK(fromPyramid > 0.05f && fromResize > 0.05f);
+    HARNESS_CHECK(std::abs(pyramid.meanFlow() - fromPyramid) < 1e-4f * fromPyramid + 1e-6f);
+    HARNESS_CHECK(std::abs(resized.meanFlow() - fromResize) < 1e-4f * fromResize + 1e-6f);
+
+    // The shared level is copied, so the next cook still solves against it
+    h.cook();
+    HARNESS_CHECK(pyramid.meanFlow() < 0.01f);
+}
+
+// FrameCache converts each frame once however many operators read it, and
+// keys frames by stamp, so a buffer rewritten in place is never served stale
+void testFrameCache() {
+    detail::FrameCache& cache = detail::FrameCache::instance();
+    SceneConfig config = scene();
+    cv::Mat frame(config.height, config.width, CV_8UC4, cv::Scalar(24, 24, 24, 255));
+    cv::Mat expected;
+
+    // Stand-ins for operators: the cache only uses their addresses
+    int source = 0;
+    int consumers[3] = {};
+    auto acquire = [&](int consumer, uint64_t key) {
+        return cache.acquire(&source, &consumers[consumer], key, frame.data, frame.cols, frame.rows,
+                             frame.step);
+    };
+
+    uint64_t before = cache.conversions();
+    auto first = acquire(0, 1);
+    HARNESS_CHECK(acquire(1, 1) == first);
+    HARNESS_CHECK(acquire(2, 1) == first);
+    HARNESS_CHECK(cache.conversions() - before == 1);
+
+    // A change too small for any pixel sampling to notice, under a new key
+    frame.at<cv::Vec4b>(101, 203) = cv::Vec4b(250, 250, 250, 255);
+    cv::cvtColor(frame, expected, cv::COLOR_BGRA2GRAY);
+    auto second = acquire(0, 2);
+    HARNESS_CHECK(second != first);
+    HARNESS_CHECK(cache.conversions() - before == 2);
+    HARNESS_CHECK(second->luma().at<uint8_t>(101, 203) == expected.at<uint8_t>(101, 203));
+    HARNESS_CHECK(cv::norm(second->luma(), expected, cv::NORM_INF) == 0.0);
+    HARNESS_CHECK(first->luma().at<uint8_t>(101, 203) == 24);  // Still the old frame
+
+    // The same key is shared even though the pixels changed since; a consumer
+    // cooking one frame behind still gets the previous frame without a conversion
+    frame.setTo(cv::Scalar(0, 0, 0, 255));
+    HARNESS_CHECK(acquire(1, 2) == second);
+    HARNESS_CHECK(acquire(2, 1) == first);
+    HARNESS_CHECK(cache.conversions() - before == 2);
+    for (int& consumer : consumers) {
+        cache.release(&consumer);
+    }
+
+    // Three operators on one input: one conversion per frame
+    Harness h(config);
+    Contours contours;
+    BlobTrack blobs;
+    OpticalFlow flow;
+    h.attach(contours);
+    h.attach(blobs);
+    h.attach(flow);
+    h.step();
+    before = cache.conversions();
+    const int frames = 10;
+    for (int f = 0; f < frames; ++f) {
+        h.step();
+    }
+    HARNESS_CHECK(cache.conversions() - before == frames);
+
+    // A source that rewrites one buffer in place, moving a disc by 3 pixels
+    Harness reused(config);
+    BlobTrack tracker;
+    tracker.detectDark = 0;
+    reused.attach(tracker);
+    frame.setTo(cv::Scalar(24, 24, 24, 255));
+    cv::circle(frame, cv::Point(200, 180), 16, cv::Scalar(230, 230, 230, 255), cv::FILLED);
+    reused.source().setFrameView(frame.data, config.width, config.height);
+    for (int f = 0; f < 3; ++f) {
+        reused.cook();
+    }
+    frame.setTo(cv::Scalar(24, 24, 24, 255));
+    cv::circle(frame, cv::Point(203, 180), 16, cv::Scalar(230, 230, 230, 255), cv::FILLED);
+    reused.cook();
+    HARNESS_CHECK(tracker.blobCount() == 1);
+    if (tracker.blobCount() == 1) {
+        HARNESS_CHECK(std::abs(tracker.blobs()[0].x - 203.0f) <= 0.5f);
+        HARNESS_CHECK(std::abs(tracker.blobs()[0].y - 180.0f) <= 0.5f);
+    }
+}
+
+void testFrameStamps() {
+    Harness h(scene());
+    Contours contours;
+    BlobTrack blobs;   // Cooks inline on the contours: same frame
+    OpticalFlow flow;  // Cooks in the background on the contours: lags behind
+    flow.async = 1;
+    h.attach(contours);
+    h.attach(blobs, contours);
+    h.attach(flow, contours);
+
+    bool ready = h.runUntil([&] { return frameStamp(flow).valid(); }, kMaxFrames, kPause);
+    HARNESS_CHECK(ready);
+    h.runUntil([] { return false; }, 10, kPause);
+
+    FrameStamp source = frameStamp(contours);
+    FrameStamp stacked = frameStamp(blobs);
+    FrameStamp lagging = frameStamp(flow);
+    HARNESS_CHECK(stampOrdered(source));
+    HARNESS_CHECK(stampOrdered(stacked));
+    HARNESS_CHECK(stampOrdered(lagging));
+
+    // Frame id and capture time pass through; latency accumulates down the stack
+    HARNESS_CHECK(stacked.frameId == source.frameId);
+    HARNESS_CHECK(stacked.captureTime == source.captureTime);
+    HARNESS_CHECK(stacked.pipelineLatencyMs() >= source.pipelineLatencyMs());
+    HARNESS_CHECK(lagging.frameId <= source.frameId);
+
+    // Every step serves a new source frame
+    h.step();
+    HARNESS_CHECK(frameStamp(contours).frameId > source.frameId);
+}
+
+// Turning async off and on again never brings back a result cooked before the switch
+void testAsyncRestart(int asyncMode) {
+    Harness h(scene());
+    Contours contours;
+    contours.async = asyncMode;
+    h.attach(contours);
+
+    bool ready = h.runUntil([&] { return frameStamp(contours).valid(); }, kMaxFrames, kPause);
+    HARNESS_CHECK(ready);
+    h.runUntil([] { return false; }, 5, kPause);  // Leaves a finished result untaken
+
+    contours.async = 0;
+    h.runUntil([] { return false; }, 5, kPause);
+    contours.async = asyncMode;
+
+    uint64_t last = frameStamp(contours).frameId;
+    bool ordered = true;
+    h.runUntil([&] {
+        uint64_t id = frameStamp(contours).frameId;
+        ordered = ordered && id >= last;
+        last = id;
+        return false;
+    }, 20, kPause);
+    HARNESS_CHECK(ordered);
+}
+
+// The module pool is OpenCV's parallel_for_ backend: cv::parallel_for_ runs
+// every task once on the caller plus pool workers, honors ThreadBudget and
+// the pool size, runs nested loops serially, and cv::setNumThreads resizes it
+void testThreadPool() {
+    ThreadPoolConfig config;
+    config.workers = 3;
+    configureThreadPool(config);
+    HARNESS_CHECK(threadPoolConfig().workers == 3);
+    HARNESS_CHECK(std::strcmp(cv::currentParallelFramework(), "vivid-opencv") == 0);
+    HARNESS_CHECK(cv::getNumThreads() == 4);
+
+    const int tasks = 64;
+    std::vector<std::atomic<int>> runs(tasks);
+    std::vector<int> indices(tasks);
+    std::vector<std::thread::id> threads(tasks);
+    bool nestedSerial = true;
+    std::mutex nestedMutex;
+
+    // Runs a loop of sleepy tasks (so idle workers get to join) and returns
+    // how many distinct threads took part
+    auto runLoop = [&](bool nest) {
+        for (auto& count : runs) {
+            count = 0;
+        }
+        cv::parallel_for_(cv::Range(0, tasks), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                runs[i]++;
+                indices[i] = detail::ThreadPool::currentIndex();  // The backend's getThreadNum()
+                threads[i] = std::this_thread::get_id();
+                if (nest) {
+                    std::thread::id outer = std::this_thread::get_id();
+                    bool serial = true;
+                    cv::parallel_for_(cv::Range(0, 8), [&](const cv::Range& inner) {
+                        serial = serial && std::this_thread::get_id() == outer &&
+                                 inner.start == 0 && inner.end == 8;
+                    });
+                    std::lock_guard<std::mutex> lock(nestedMutex);
+                    nestedSerial = nestedSerial && serial;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }, tasks);
+        for (const auto& count : runs) {
+            HARNESS_CHECK(count == 1);
+        }
+        std::vector<std::thread::id> distinct(threads);
+        std::sort(distinct.begin(), distinct.end());
+        return static_cast<int>(std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+    };
+
+    int used = runLoop(true);
+    HARNESS_CHECK(used >= 2 && used <= 4);
+    HARNESS_CHECK(nestedSerial);
+    for (int i = 0; i < tasks; ++i) {
+        // Worker indices 1..3; the caller is 0, and each index is one thread
+        HARNESS_CHECK(indices[i] >= 0 && indices[i] <= 3);
+        HARNESS_CHECK((indices[i] == 0) == (threads[i] == std::this_thread::get_id()));
+        for (int j = 0; j < i; ++j) {
+            HARNESS_CHECK((indices[i] == indices[j]) == (threads[i] == threads[j]));
+        }
+    }
+
+    // An operator's `threads` cap applies to OpenCV's loops on its thread
+    {
+        detail::ThreadBudget budget(2);
+        HARNESS_CHECK(cv::getNumThreads() == 2);
+        HARNESS_CHECK(runLoop(false) <= 2);
+    }
+    {
+        detail::ThreadBudget budget(1);
+        HARNESS_CHECK(cv::getNumThreads() == 1);
+        HARNESS_CHECK(runLoop(false) == 1);
+        HARNESS_CHECK(threads[0] == std::this_thread::get_id());
+    }
+
+    // Loops from several callers, like async cooks, share the workers: only
+    // the callers come on top of them
+    {
+        const int callers = 3;
+        std::mutex mutex;
+        std::vector<std::thread::id> helpers;
+        std::vector<std::thread> threads;
+        for (int c = 0; c < callers; ++c) {
+            threads.emplace_back([&] {
+                std::thread::id caller = std::this_thread::get_id();
+                cv::parallel_for_(cv::Range(0, tasks), [&](const cv::Range& range) {
+                    if (std::this_thread::get_id() != caller) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        helpers.push_back(std::this_thread::get_id());
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(range.end - range.start));
+                }, tasks);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::sort(helpers.begin(), helpers.end());
+        HARNESS_CHECK(std::unique(helpers.begin(), helpers.end()) - helpers.begin() <= 3);
+    }
+
+    // cv::setNumThreads counts the caller; 0 workers keeps every loop on it
+    cv::setNumThreads(3);
+    HARNESS_CHECK(threadPoolConfig().workers == 2);
+    config.workers = 0;
+    configureThreadPool(config);
+    HARNESS_CHECK(cv::getNumThreads() == 1);
+    HARNESS_CHECK(runLoop(false) == 1);
+
+    configureThreadPool(ThreadPoolConfig{});
+}
+
+void testCpuDispatch() {
+    CpuDispatch info = cpuDispatch();
+    HARNESS_CHECK(!info.variants.empty() && info.variants.front() == "baseline");
+    HARNESS_CHECK(std::find(info.variants.begin(), info.variants.end(), info.kernels) !=
+                  info.variants.end());
+    HARNESS_CHECK(!info.opencv.empty());
+
+    // OPENCV_CPU_DISABLE narrows our kernels along with OpenCV
+    const char* disabled = std::getenv("OPENCV_CPU_DISABLE");
+    if (disabled && std::strstr(disabled, "AVX2")) {
+        HARNESS_CHECK(info.kernels == "baseline");
+        HARNESS_CHECK(info.hal.empty() || info.hal == "baseline");
+    }
+}
+
+// 3x3 Sobel with a replicated border, the way OpenCV defines it
+cv::Mat sobelReference(const cv::Mat& src, bool dx) {
+    cv::Mat dst(src.size(), CV_16S);
+    auto at = [&](int y, int x) {
+        return static_cast<int>(src.at<uchar>(std::clamp(y, 0, src.rows - 1),
+                                              std::clamp(x, 0, src.cols - 1)));
+    };
+    for (int y = 0; y < src.rows; ++y) {
+        for (int x = 0; x < src.cols; ++x) {
+            int v = dx ? (at(y - 1, x + 1) + 2 * at(y, x + 1) + at(y + 1, x + 1)) -
+                         (at(y - 1, x - 1) + 2 * at(y, x - 1) + at(y + 1, x - 1))
+                       : (at(y + 1, x - 1) + 2 * at(y + 1, x) + at(y + 1, x + 1)) -
+                         (at(y - 1, x - 1) + 2 * at(y - 1, x) + at(y - 1, x + 1));
+            dst.at<short>(y, x) = static_cast<short>(v);
+        }
+    }
+    return dst;
+}
+
+// The calls hal/ takes over must give what stock OpenCV gives. Odd widths
+// exercise the vector tails; 641x361 is large enough to split into rows.
+void testHal() {
+    cv::RNG rng(48);
+    cv::Mat bgra(361, 641, CV_8UC4);
+    rng.fill(bgra, cv::RNG::UNIFORM, 0, 256);
+
+    // BGRA -> gray is bit-exact: OpenCV's 14-bit fixed-point weights
+    cv::Mat gray;
+    cv::cvtColor(bgra, gray, cv::COLOR_BGRA2GRAY);
+    int grayErrors = 0;
+    for (int y = 0; y < bgra.rows; ++y) {
+        for (int x = 0; x < bgra.cols; ++x) {
+            cv::Vec4b p = bgra.at<cv::Vec4b>(y, x);
+            int expected = (p[0] * 1868 + p[1] * 9617 + p[2] * 4899 + (1 << 13)) >> 14;
+            grayErrors += gray.at<uchar>(y, x) != expected;
+        }
+    }
+    HARNESS_CHECK(grayErrors == 0);
+
+    // HSV -> BGR round trip stays within rounding
+    cv::Mat bgr, hsv, back;
+    cv::cvtColor(bgra, bgr, cv::COLOR_BGRA2BGR);
+    cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+    cv::cvtColor(hsv, back, cv::COLOR_HSV2BGR);
+    double hsvError = cv::norm(bgr, back, cv::NORM_INF);
+    HARNESS_CHECK(hsvError <= 8.0);  // Hue is quantized to 2 degrees
+
+    // Threshold: every simple type
+    for (int type = cv::THRESH_BINARY; type <= cv::THRESH_TOZERO_INV; ++type) {
+        cv::Mat dst;
+        cv::threshold(gray, dst, 100.7, 200, type);
+        int errors = 0;
+        for (int y = 0; y < gray.rows; ++y) {
+            for (int x = 0; x < gray.cols; ++x) {
+                int v = gray.at<uchar>(y, x);
+                bool above = v > 100;
+                int expected = type == cv::THRESH_BINARY      ? (above ? 200 : 0)
+                             : type == cv::THRESH_BINARY_INV  ? (above ? 0 : 200)
+                             : type == cv::THRESH_TRUNC       ? std::min(v, 100)
+                             : type == cv::THRESH_TOZERO      ? (above ? v : 0)
+                                                              : (above ? 0 : v);
+                errors += dst.at<uchar>(y, x) != expected;
+            }
+        }
+        HARNESS_CHECK(errors == 0);
+    }
+
+    // Sobel as Canny calls it, on the whole image and on an ROI that reads
+    // its border from the surrounding pixels
+    for (bool dx : {true, false}) {
+        cv::Mat full;
+        cv::Sobel(gray, full, CV_16S, dx ? 1 : 0, dx ? 0 : 1, 3, 1, 0, cv::BORDER_REPLICATE);
+        HARNESS_CHECK(cv::norm(full, sobelReference(gray, dx), cv::NORM_INF) == 0.0);
+
+        cv::Rect roi(5, 3, 317, 200);
+        cv::Mat part;
+        cv::Sobel(gray(roi), part, CV_16S, dx ? 1 : 0, dx ? 0 : 1, 3, 1, 0, cv::BORDER_REPLICATE);
+        HARNESS_CHECK(cv::norm(part, full(roi), cv::NORM_INF) == 0.0);
+    }
+
+    // INTER_AREA by 2 (rounded mean of 2x2) and by 4 (mean of 4x4)
+    for (int factor : {2, 4}) {
+        for (const cv::Mat& src : {gray(cv::Rect(0, 0, 640, 360)), bgra(cv::Rect(0, 0, 640, 360))}) {
+            cv::Mat dst;
+            cv::resize(src, dst, cv::Size(src.cols / factor, src.rows / factor), 0, 0, cv::INTER_AREA);
+            const int cn = src.channels();
+            const float area = static_cast<float>(factor * factor);
+            int errors = 0;
+            for (int y = 0; y < dst.rows; ++y) {
+                for (int x = 0; x < dst.cols * cn; ++x) {
+                    int sum = 0;
+                    for (int dy = 0; dy < factor; ++dy) {
+                        const uchar* row = src.ptr<uchar>(y * factor + dy);
+                        for (int k = 0; k < factor; ++k) {
+                            sum += row[(x / cn * factor + k) * cn + x % cn];
+                        }
+                    }
+                    int expected = factor == 2 ? (sum + 2) >> 2 : cvRound(sum / area);
+                    errors += dst.ptr<uchar>(y)[x] != expected;
+                }
+            }
+            HARNESS_CHECK(errors == 0);
+        }
+    }
+
+    // cartToPolar: exact magnitude, angle within fastAtan2's 0.3 degrees
+    cv::Mat fx(1, 1001, CV_32F), fy(1, 1001, CV_32F), mag, angle;
+    rng.fill(fx, cv::RNG::UNIFORM, -50.0, 50.0);
+    rng.fill(fy, cv::RNG::UNIFORM, -50.0, 50.0);
+    fx.at<float>(0, 0) = fy.at<float>(0, 0) = 0.0f;
+    cv::cartToPolar(fx, fy, mag, angle, true);
+    const float* xs = fx.ptr<float>();
+    const float* ys = fy.ptr<float>();
+    double magError = 0.0;
+    double angleError = 0.0;
+    for (int i = 0; i < fx.cols; ++i) {
+        double length = std::sqrt(double(xs[i]) * xs[i] + double(ys[i]) * ys[i]);
+        magError = std::max(magError, std::abs(mag.ptr<float>()[i] - length) / std::max(1.0, length));
+        double expected = std::atan2(ys[i], xs[i]) * 180.0 / CV_PI;
+        expected += expected < 0.0 ? 360.0 : 0.0;
+        double diff = std::abs(angle.ptr<float>()[i] - expected);
+        angleError = std::max(angleError, std::min(diff, 360.0 - diff));
+    }
+    HARNESS_CHECK(magError < 1e-5);
+    HARNESS_CHECK(angleError < 0.3);
+    HARNESS_CHECK(angle.ptr<float>()[0] == 0.0f);
+}
+
+// Record padded frames, replay them from the mapping and step through them
+void testRawFrames() {
+    SceneConfig config;
+    config.width = 96;
+    config.height = 54;
+    config.discs = 2;
+    config.radius = 8.0f;
+    Harness h(config);
+    const int frames = 5;
+    const size_t rowBytes = static_cast<size_t>(config.width) * 4;
+    const size_t frameBytes = rowBytes * config.height;
+    const int stride = static_cast<int>(rowBytes) + 32;
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "vivid_opencv_test_raw_frames.vraw").string();
+
+    RawFrameRecorder rec;
+    rec.maxFrames = frames;
+    h.attach(rec);
+    HARNESS_CHECK(rec.start(path));
+
+    std::vector<std::vector<uint8_t>> expected;
+    std::vector<uint8_t> padded(static_cast<size_t>(stride) * config.height);
+    for (int i = 0; i < frames + 2; ++i) {
+        const std::vector<uint8_t>& pixels = h.scene().render(i);
+        for (int y = 0; y < config.height; ++y) {
+            std::memcpy(padded.data() + y * stride, pixels.data() + y * rowBytes, rowBytes);
+        }
+        h.source().setFrameView(padded.data(), config.width, config.height, stride);
+        h.cook();
+        HARNESS_CHECK(rec.cpuPixelView().data == padded.data());  // Passed through, not copied
+        if (i < frames) {
+            expected.push_back(pixels);
+        }
+    }
+    HARNESS_CHECK(!rec.recording());
+    HARNESS_CHECK(rec.framesWritten() == frames);
+    HARNESS_CHECK(rec.lastError().empty());
+
+    RawFrameSource replay;
+    HARNESS_CHECK(replay.open(path));
+    HARNESS_CHECK(replay.frameCount() == frames);
+    HARNESS_CHECK(replay.width() == config.width && replay.height() == config.height);
+    HARNESS_CHECK(std::abs(replay.recordedFps() - 60.0) < 1e-3);  // The harness ticks at 60 Hz
+
+    // One frame per cook, straight from the mapping, wrapping at the end
+    vivid::Context& ctx = h.context();
+    const uint8_t* first = nullptr;
+    for (int i = 0; i < frames + 2; ++i) {
+        ctx.tick(1.0 / 60.0);
+        replay.process(ctx);
+        auto view = replay.cpuPixelView();
+        HARNESS_CHECK(view.valid() && replay.frameIndex() == i % frames);
+        first = first ? first : view.data;
+        HARNESS_CHECK(view.data == first + frameBytes * (i % frames));
+        HARNESS_CHECK(std::memcmp(view.data, expected[i % frames].data(), frameBytes) == 0);
+    }
+    HARNESS_CHECK(replay.framesServed() == static_cast<uint64_t>(frames + 2));
+
+    // Operators downstream see the replayed frame's stamp
+    Contours contours;
+    contours.setInput(0, &replay);
+    contours.init(ctx);
+    contours.process(ctx);
+    HARNESS_CHECK(frameStamp(contours).frameId == replay.framesServed());
+    contours.cleanup();
+
+    // Holding the last frame, then seeking back
+    replay.loop = 0;
+    replay.seek(frames - 1);
+    for (int i = 0; i < 3; ++i) {
+        ctx.tick(1.0 / 60.0);
+        replay.process(ctx);
+        HARNESS_CHECK(replay.frameIndex() == frames - 1);
+    }
+    replay.seek(1);
+    ctx.tick(1.0 / 60.0);
+    replay.process(ctx);
+    HARNESS_CHECK(replay.frameIndex() == 1);
+
+    // A fixed rate follows the clock: 30 fps at 60 Hz shows each frame twice,
+    // and a recorder downstream keeps each of them once
+    const std::string copyPath = path + ".copy";
+    RawFrameRecorder copy;
+    copy.setInput(0, &replay);
+    copy.init(ctx);
+    HARNESS_CHECK(copy.start(copyPath));
+    replay.fps = 30.0f;
+    replay.seek(0);
+    std::vector<int> shown;
+    for (int i = 0; i < 6; ++i) {
+        ctx.tick(1.0 / 60.0);
+        replay.process(ctx);
+        copy.process(ctx);
+        shown.push_back(replay.frameIndex());
+    }
+    HARNESS_CHECK((shown == std::vector<int>{0, 0, 1, 1, 2, 2}));
+    HARNESS_CHECK(copy.framesWritten() == 3);
+    copy.cleanup();
+    std::filesystem::remove(copyPath);
+    replay.close();
+    HARNESS_CHECK(!replay.isOpen() && !replay.cpuPixelView().valid());
+
+    // The harness loader reads the size from the header
+    harness::RawFrames loaded;
+    HARNESS_CHECK(loaded.load(path, 0, 0, 64) && loaded.count() == frames);
+    HARNESS_CHECK(loaded.count() == 0 ||
+                  std::memcmp(loaded.frame(2), expected[2].data(), frameBytes) == 0);
+
+    // An unfinished recording (frameCount 0, a partial frame) still plays
+    if (std::FILE* file = std::fopen(path.c_str(), "r+b")) {
+        uint64_t unknown = 0;
+        std::fseek(file, offsetof(RawFrameHeader, frameCount), SEEK_SET);
+        std::fwrite(&unknown, sizeof(unknown), 1, file);
+        std::fseek(file, 0, SEEK_END);
+        std::fwrite(expected[0].data(), frameBytes / 2, 1, file);
+        std::fclose(file);
+    }
+    HARNESS_CHECK(replay.open(path) && replay.frameCount() == frames);
+    replay.close();
+
+    // Anything else is refused
+    HARNESS_CHECK(!replay.open(path + ".missing") && !replay.lastError().empty());
+    if (std::FILE* file = std::fopen(path.c_str(), "r+b")) {
+        std::fwrite("NOTRAW!!", 8, 1, file);
+        std::fclose(file);
+    }
+    HARNESS_CHECK(!replay.open(path) && !replay.isOpen());
+    replay.cleanup();
+    std::filesystem::remove(path);
+}
+
+// The ground truth must hold for the sequences, and a quality Farneback
+// setting must measure well under the error of reporting no motion
+void testFlowAccuracy() {
+    for (harness::FlowMotion motion : {harness::FlowMotion::Translate, harness::FlowMotion::Rotate,
+                                       harness::FlowMotion::Warp}) {
+        harness::FlowSequenceConfig config;
+        config.width = 320;
+        config.height = 180;
+        config.motion = motion;
+        config.speed = 3.0f;
+        harness::FlowSequence sequence(config);
+
+        double worst = 0.0;
+        double truthLength = 0.0;
+        int samples = 0;
+        for (float y = 20.0f; y < 160.0f; y += 13.7f) {
+            for (float x = 20.0f; x < 300.0f; x += 17.3f) {
+                harness::FlowVector truth = sequence.flow(x, y, 2);
+                worst = std::max(worst, std::abs(static_cast<double>(
+                    sequence.intensity(x + truth.dx, y + truth.dy, 3) - sequence.intensity(x, y, 2))));
+                truthLength += std::sqrt(truth.dx * truth.dx + truth.dy * truth.dy);
+                samples++;
+            }
+        }
+        HARNESS_CHECK(worst < 0.01);
+        truthLength /= samples;
+
+        harness::SceneConfig size;
+        size.width = config.width;
+        size.height = config.height;
+        Harness h(size);
+        FlowField field;
+        field.scale = 0.5f;
+        field.levels = 3;
+        field.winSize = 15;
+        field.iterations = 3;
+        h.attach(field);
+        harness::FlowError error;
+        for (int t = 0; t < 4; ++t) {
+            const std::vector<uint8_t>& pixels = sequence.render(t);
+            h.source().setFrameView(pixels.data(), config.width, config.height);
+            h.cook();
+            if (t > 0) {
+                error = harness::endpointError(field.field(), sequence, t - 1);
+            }
+        }
+        HARNESS_CHECK(error.samples > 0);
+        HARNESS_CHECK(error.mean < 0.5 * truthLength);
+    }
+}
+
+// FlowViz and FlowStats consume a shared FlowField without re-solving it:
+// every viz mode renders exactly what OpticalFlow's renderer would, the
+// stats are the reduction of the published field over the region, and
+// consumers of anything but a FlowField produce nothing
+void testFlowConsumers() {
+    harness::FlowSequenceConfig config;
+    config.width = 320;
+    config.height = 180;
+    config.speed = 3.0f;
+    harness::FlowSequence sequence(config);
+
+    harness::SceneConfig size;
+    size.width = config.width;
+    size.height = config.height;
+    Harness h(size);
+    FlowField field;
+    field.scale = 0.5f;
+    field.levels = 3;
+    field.winSize = 15;
+    field.iterations = 3;
+    FlowViz vizzes[3];
+    FlowStats whole;
+    FlowStats center;
+    center.regionX = 0.25f;
+    center.regionY = 0.25f;
+    center.regionW = 0.5f;
+    center.regionH = 0.5f;
+    FlowViz orphanViz;
+    FlowStats orphanStats;
+
+    h.attach(field);
+    for (int mode = 0; mode < 3; ++mode) {
+        vizzes[mode].vizMode = mode;
+        vizzes[mode].sensitivity = 2.0f;
+        h.attach(vizzes[mode], field);
+    }
+    h.attach(whole, field);
+    h.attach(center, field);
+    h.attach(orphanViz);
+    h.attach(orphanStats);
+
+    // Reference reduction of the published field over a normalized region
+    auto checkStats = [](const FlowStats& stats, const FlowFieldView& f, float rx, float ry,
+                         float rw, float rh) {
+        int x0 = static_cast<int>(rx * f.width);
+        int y0 = static_cast<int>(ry * f.height);
+        int x1 = static_cast<int>((rx + rw) * f.width);
+        int y1 = static_cast<int>((ry + rh) * f.height);
+        double sumX = 0.0, sumY = 0.0, sumMag = 0.0, maxMag = 0.0;
+        int moving = 0;
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                double dx = f.dx(x, y) * f.toInputX;
+                double dy = f.dy(x, y) * f.toInputY;
+                double mag = std::sqrt(dx * dx + dy * dy);
+                sumX += dx;
+                sumY += dy;
+                sumMag += mag;
+                maxMag = std::max(maxMag, mag);
+                moving += mag > 1.0 ? 1 : 0;
+            }
+        }
+        double count = static_cast<double>(x1 - x0) * (y1 - y0);
+        HARNESS_CHECK(std::abs(stats.meanX() - sumX / count) <= 1e-3);
+        HARNESS_CHECK(std::abs(stats.meanY() - sumY / count) <= 1e-3);
+        HARNESS_CHECK(std::abs(stats.meanMagnitude() - sumMag / count) <= 1e-3);
+        HARNESS_CHECK(std::abs(stats.maxMagnitude() - maxMag) <= 1e-3);
+        HARNESS_CHECK(std::abs(stats.motionFraction() - moving / count) <= 1e-3);
+    };
+
+    uint64_t solves = 0;
+    cv::Mat expected;
+    for (int t = 0; t < 5; ++t) {
+        const std::vector<uint8_t>& pixels = sequence.render(t);
+        h.source().setFrameView(pixels.data(), config.width, config.height);
+        h.cook();
+
+        HARNESS_CHECK(!orphanViz.cpuPixelView().valid());
+        HARNESS_CHECK(!orphanStats.cpuPixelView().valid());
+        HARNESS_CHECK(orphanStats.meanMagnitude() == 0.0f && orphanStats.motionFraction() == 0.0f);
+
+        FlowFieldView f = field.field();
+        if (t == 0) {
+            HARNESS_CHECK(!f.valid());
+            HARNESS_CHECK(whole.meanMagnitude() == 0.0f);
+            continue;
+        }
+        HARNESS_CHECK(f.valid());
+        HARNESS_CHECK(f.frame == ++solves);  // One solve per frame for five consumers
+
+        // The stats pass the frame through
+        auto passed = whole.cpuPixelView();
+        HARNESS_CHECK(passed.valid() && passed.data == field.cpuPixelView().data);
+
+        checkStats(whole, f, 0.0f, 0.0f, 1.0f, 1.0f);
+        checkStats(center, f, 0.25f, 0.25f, 0.5f, 0.5f);
+
+        // Away from the borders the stats follow the true translation
+        harness::FlowVector truth = sequence.flow(config.width * 0.5f, config.height * 0.5f, t - 1);
+        float truthSpeed = std::sqrt(truth.dx * truth.dx + truth.dy * truth.dy);
+        HARNESS_CHECK(std::abs(center.meanX() - truth.dx) <= 0.25f * truthSpeed);
+        HARNESS_CHECK(std::abs(center.meanY() - truth.dy) <= 0.25f * truthSpeed);
+        HARNESS_CHECK(center.motionFraction() >= 0.9f);
+
+        cv::Mat background(config.height, config.width, CV_8UC4, const_cast<uint8_t*>(pixels.data()));
+        cv::Mat flow(f.height, f.width, CV_32FC2, const_cast<float*>(f.data), f.stride * sizeof(float));
+        for (int mode = 0; mode < 3; ++mode) {
+            detail::renderFlow(flow, static_cast<FlowVizMode>(mode), 2.0f, background, expected);
+            auto view = vizzes[mode].cpuPixelView();
+            HARNESS_CHECK(view.valid() && view.width == config.width && view.height == config.height);
+            if (view.valid()) {
+                cv::Mat rendered(view.height, view.width, CV_8UC4, const_cast<uint8_t*>(view.data));
+                HARNESS_CHECK(cv::norm(rendered, expected, cv::NORM_INF) == 0.0);
+            }
+        }
+    }
+
+    // A repeated frame solves to (almost) no motion
+    h.cook();
+    HARNESS_CHECK(field.field().frame == ++solves);
+    HARNESS_CHECK(whole.meanMagnitude() < 0.1f);
+    HARNESS_CHECK(whole.motionFraction() < 0.01f);
+}
+
+// Every Mat buffer is counted once, and its release goes straight to the
+// wrapped allocator. On a repeated frame a warmed-up cook allocates no more
+// than the cook before it: OpenCV's own temporaries recur, but nothing grows.
+void testAllocStats() {
+    Harness h(scene());
+    Contours contours;
+    OpticalFlow flow;
+    BlobTrack blobs;
+    blobs.detectDark = 0;
+    BlobTrack sliced;
+    sliced.detectDark = 0;
+    sliced.sliceCount = 4;
+    h.attach(contours);
+    h.attach(flow);
+    h.attach(blobs);
+    h.attach(sliced);
+
+#if VIVID_OPENCV_PROFILING
+    {
+        // init() installed the counter; a buffer allocated in scope is counted there
+        detail::AllocCounter counter;
+        cv::Mat buffer;
+        {
+            detail::AllocScope scope(&counter);
+            buffer.create(10, 20, CV_8UC4);
+            cv::Mat wrapped(10, 20, CV_8UC4, buffer.data);  // User memory isn't an allocation
+        }
+        HARNESS_CHECK(counter.count == 1 && counter.bytes == 10u * 20u * 4u);
+        HARNESS_CHECK(buffer.u && buffer.u->currAllocator != cv::Mat::getDefaultAllocator());
+    }
+#endif
+
+    auto stats = [&] {
+        return std::vector<AllocStats>{contours.allocStats(), flow.allocStats(), blobs.allocStats(),
+                                       sliced.allocStats()};
+    };
+
+    const std::vector<uint8_t> pixels = h.scene().render(0);
+    auto cook = [&] {
+        h.source().setFrameView(pixels.data(), h.scene().config().width, h.scene().config().height);
+        h.cook();
+    };
+
+    // Peak per-cook counts over the second half of warmup
+    const int warmup = 10;
+    std::vector<AllocStats> peak(4);
+    for (int f = 0; f < warmup; ++f) {
+        cook();
+        std::vector<AllocStats> now = stats();
+        for (size_t i = 0; f >= warmup / 2 && i < now.size(); ++i) {
+            peak[i].lastCount = std::max(peak[i].lastCount, now[i].lastCount);
+            peak[i].lastBytes = std::max(peak[i].lastBytes, now[i].lastBytes);
+        }
+    }
+    std::vector<AllocStats> last = stats();
+    for (const AllocStats& s : last) {
+        HARNESS_CHECK(s.cooks == static_cast<uint64_t>(warmup));
+#if VIVID_OPENCV_PROFILING
+        HARNESS_CHECK(s.totalCount > 0 && s.allocatingCooks > 0);  // Counting is live
+#else
+        HARNESS_CHECK(s.totalCount == 0 && s.lastCount == 0);
+#endif
+    }
+
+    for (int f = 0; f < 20; ++f) {
+        cook();
+        std::vector<AllocStats> now = stats();
+        for (size_t i = 0; i < now.size(); ++i) {
+            HARNESS_CHECK(now[i].lastCount <= peak[i].lastCount);
+            HARNESS_CHECK(now[i].lastBytes <= peak[i].lastBytes);
+            HARNESS_CHECK(now[i].totalCount == last[i].totalCount + now[i].lastCount);
+        }
+        last = std::move(now);
+    }
+}
+
+// BrightSpot, CVPipeline and the flow operators time their stages and count
+// their allocations like the heavy operators
+void testStageProfiles() {
+    Harness h(scene());
+    BrightSpot spot;
+    CVPipeline pipeline;
+    pipeline.setStages({{CVStageType::Blur}, {CVStageType::Threshold}, {CVStageType::Contours}});
+    FlowField field;
+    field.scale = 0.5f;
+    FlowViz viz;
+    FlowStats stats;
+    h.attach(spot);
+    h.attach(pipeline);
+    h.attach(field);
+    h.attach(viz, field);
+    h.attach(stats, field);
+
+    const int frames = 6;
+    for (int f = 0; f < frames; ++f) {
+        h.step();
+    }
+
+    // Samples of the named stage (0 if it never ran)
+    auto samples = [](const std::vector<StageTiming>& timings, const char* name) -> uint64_t {
+        for (const StageTiming& t : timings) {
+            if (std::strcmp(t.name, name) == 0) {
+                return t.samples;
+            }
+        }
+        return 0;
+    };
+
+    struct Profiled {
+        std::vector<StageTiming> timings;
+        AllocStats allocs;
+        std::vector<const char*> stages;  // Stages that run every cook
+    };
+    std::vector<Profiled> ops = {
+        {spot.stageTimings(), spot.allocStats(), {"search", "refine", "draw", "process", "cookLatency"}},
+        {pipeline.stageTimings(), pipeline.allocStats(),
+         {"luma", "blur", "threshold", "contours", "render", "assign", "process"}},
+        {field.stageTimings(), field.allocStats(), {"luma", "storePrev", "process", "cookLatency"}},
+        {viz.stageTimings(), viz.allocStats(), {"render", "assign", "process"}},
+        {stats.stageTimings(), stats.allocStats(), {"process"}},
+    };
+    for (const Profiled& op : ops) {
+#if VIVID_OPENCV_PROFILING
+        HARNESS_CHECK(op.allocs.cooks == static_cast<uint64_t>(frames));
+        for (const char* stage : op.stages) {
+            HARNESS_CHECK(samples(op.timings, stage) == static_cast<uint64_t>(frames));
+        }
+        HARNESS_CHECK(samples(op.timings, "canny") == 0);  // Only stages that ran are listed
+#else
+        HARNESS_CHECK(op.timings.empty() && op.allocs.cooks == 0);
+#endif
+    }
+
+#if VIVID_OPENCV_PROFILING
+    // The first cook has nothing to solve against
+    HARNESS_CHECK(samples(field.stageTimings(), "calcOpticalFlowFarneback") == static_cast<uint64_t>(frames - 1));
+    HARNESS_CHECK(samples(stats.stageTimings(), "reduce") == static_cast<uint64_t>(frames - 1));
+#endif
+
+    field.resetStageTimings();
+    HARNESS_CHECK(field.stageTimings().empty() && field.allocStats().cooks == 0);
+}
+
+// Reads a trace file back as JSON; null if it doesn't parse
+nlohmann::json readTrace(const std::string& path) {
+    std::ifstream file(path);
+    nlohmann::json trace = nlohmann::json::parse(file, nullptr, false);
+    return trace.is_discarded() ? nlohmann::json() : trace;
+}
+
+// Every event in a trace is a well-formed Chrome trace event
+bool checkTraceEvents(const nlohmann::json& trace) {
+    if (!trace.is_object() || !trace.contains("traceEvents") || !trace["traceEvents"].is_array()) {
+        return false;
+    }
+    const nlohmann::json none;
+    bool ok = true;
+    for (const nlohmann::json& event : trace["traceEvents"]) {
+        if (!event.is_object()) {
+            return false;
+        }
+        const nlohmann::json args = event.value("args", none);
+        ok = ok && event.value("name", none).is_string() && event.value("pid", none) == 1 &&
+             event.value("tid", none).is_number_unsigned();
+        std::string ph = event.value("ph", none).is_string() ? event["ph"].get<std::string>() : "";
+        if (ph == "X") {
+            ok = ok && event.value("cat", none).is_string() && event.value("ts", -1.0) >= 0.0 &&
+                 event.value("dur", -1.0) >= 0.0;
+        } else if (ph == "C") {
+            ok = ok && event.value("ts", -1.0) >= 0.0 && args.is_object() && args.size() == 1 &&
+                 args.begin()->is_number();
+        } else {
+            ok = ok && ph == "M" && args.is_object() && args.value("name", none).is_string();
+        }
+    }
+    return ok;
+}
+
+// Traces of real cooks (pool loops, an async worker, latency counters) and
+// of hostile names and values parse as Chrome trace-event JSON, and a full
+// buffer drops events without corrupting the file
+void testTraceJson() {
+    static const char kOddName[] = "quote\" backslash\\ tab\t done";
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "vivid_opencv_test_trace.json").string();
+
+    ThreadPoolConfig pool;
+    pool.workers = 2;
+    configureThreadPool(pool);
+
+    startTracing();
+    std::thread named([] {
+        detail::setTraceThreadName("worker \"\xC3\xA9\" \\");
+        uint64_t now = detail::traceNowNs();
+        detail::traceComplete(kOddName, "test", now, now + 1000);
+        detail::traceCounter("odd", "series", "ms", now, 2.5);
+        detail::traceCounter("odd", "nan", "ms", now, std::nan(""));
+        detail::traceCounter("odd", "inf", "ms", now, HUGE_VAL);
+    });
+    named.join();
+
+    Harness h(scene());
+    Contours contours;
+    BlobTrack blobs;
+    blobs.async = 1;
+    h.attach(contours);
+    h.attach(blobs);
+    h.runUntil([] { return false; }, 20, kPause);
+    stopTracing();
+
+    TraceStats stats = traceStats();
+    HARNESS_CHECK(!stats.enabled);
+    HARNESS_CHECK(stats.recorded > 0 && stats.dropped == 0);
+    HARNESS_CHECK(writeTrace(path));
+    nlohmann::json trace = readTrace(path);
+    HARNESS_CHECK(checkTraceEvents(trace));
+
+    bool oddEvent = false, oddThread = false, counter = false, nonFinite = false, loops = false;
+    if (trace.is_object()) {
+        for (const nlohmann::json& event : trace["traceEvents"]) {
+            const std::string name = event.value("name", "");
+            const std::string ph = event.value("ph", "");
+            oddEvent = oddEvent || (ph == "X" && name == "quote\" backslash\\ tab done");
+            const nlohmann::json args = event.value("args", nlohmann::json::object());
+            oddThread = oddThread || (ph == "M" && args.value("name", "") == "worker \"\xC3\xA9\" \\");
+            counter = counter || (ph == "C" && name == "odd series" && args.value("ms", 0.0) == 2.5);
+            nonFinite = nonFinite || name == "odd nan" || name == "odd inf";
+            loops = loops || (ph == "X" && name != "quote\" backslash\\ tab done");
+        }
+    }
+    HARNESS_CHECK(oddEvent);   // Control characters are dropped, quotes and backslashes escaped
+    HARNESS_CHECK(oddThread);
+    HARNESS_CHECK(counter);
+    HARNESS_CHECK(!nonFinite);
+    HARNESS_CHECK(loops);
+
+    // A buffer too small for the run fills up, counts the rest and still writes valid JSON
+    TraceConfig small;
+    small.capacity = 16;
+    startTracing(small);
+    h.runUntil([] { return false; }, 10, kPause);
+    stopTracing();
+    stats = traceStats();
+    HARNESS_CHECK(stats.recorded == 16);
+    HARNESS_CHECK(stats.dropped > 0);
+    HARNESS_CHECK(writeTrace(path));
+    trace = readTrace(path);
+    HARNESS_CHECK(checkTraceEvents(trace));
+
+    std::filesystem::remove(path);
+    configureThreadPool(ThreadPoolConfig{});
+}
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+const Test kTests[] = {
+    {"contours", [] { testContours(0); }},
+    {"contours_async", [] { testContours(1); }},
+    {"contours_pipelined", [] { testContours(2); }},
+    {"optical_flow", [] { testOpticalFlow(0); }},
+    {"optical_flow_async", [] { testOpticalFlow(1); }},
+    {"optical_flow_pipelined", [] { testOpticalFlow(2); }},
+    {"blob_track", [] { testBlobTrack(0); }},
+    {"blob_track_async", [] { testBlobTrack(1); }},
+    {"blob_events", testBlobEvents},
+    {"blob_prediction", testBlobPrediction},
+    {"blob_grid", testBlobGrid},
+    {"blob_trajectory", testTrajectory},
+    {"blob_track_color", testBlobTrackColor},
+    {"blob_track_foreground", testBlobTrackForeground},
+    {"blob_detector", testBlobDetector},
+    {"blob_track_sliced_gap", testBlobTrackSlicedGap},
+    {"blob_track_sliced_fast", testBlobTrackSlicedFast},
+    {"bright_spot", testBrightSpot},
+    {"cv_pipeline_json", testCVPipelineJson},
+    {"cv_pipeline_flow", testCVPipelineFlow},
+    {"frame_cache", testFrameCache},
+    {"frame_stamps", testFrameStamps},
+    {"contours_async_restart", [] { testAsyncRestart(1); }},
+    {"contours_pipelined_restart", [] { testAsyncRestart(2); }},
+    {"thread_pool", testThreadPool},
+    {"cpu_dispatch", testCpuDispatch},
+    {"hal", testHal},
+    {"raw_frames", testRawFrames},
+    {"flow_accuracy", testFlowAccuracy},
+    {"flow_consumers", testFlowConsumers},
+    {"alloc_stats", testAllocStats},
+    {"stage_profiles", testStageProfiles},
+    {"trace_json", testTraceJson},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    int ran = 0;
+    for (const Test& test : kTests) {
+        if (only && std::strcmp(only, test.name) != 0) {
+            continue;
+        }
+        int before = harness::failures();
+        test.run();
+        std::printf("%s %s\n", harness::failures() == before ? "PASS" : "FAIL", test.name);
+        ran++;
+    }
+    if (ran == 0) {
+        std::fprintf(stderr, "unknown test: %s\n", only);
+        return 2;
+    }
+    return harness::failures() == 0 ? 0 : 1;
+}